@@ -5,6 +5,7 @@
 
 #include <dplib/version.h>
 #include "dplib/net/can/CanBus.h"
+#include "dplib/net/can/CanFrameLogger.h"
 #include "dplib/core/Application.h"
 
 #include <cxxopts.hpp>
@@ -18,6 +19,7 @@ auto main(int argc, char **argv) -> int
     cxxopts::Options options(*argv, "DPFlow");
 
     std::string interface;
+    std::string logFile;
 
     // clang-format off
   options.add_options()
@@ -26,6 +28,8 @@ auto main(int argc, char **argv) -> int
     ("v,verbose", "More output", cxxopts::value<bool>()->default_value("false"))
     ("i,interface", "CAN interface to use", cxxopts::value(interface)->default_value("SocketCAN.can0"))
     ("s,scan", "Scan for available interfaces", cxxopts::value<bool>()->default_value("false"))
+    ("l,log", "Write received frames to a file, or - for standard output", cxxopts::value(logFile)->default_value("-"))
+    ("b,binary", "Write a binary capture instead of candump text", cxxopts::value<bool>()->default_value("false"))
   ;
     // clang-format on
     //
@@ -59,18 +63,26 @@ auto main(int argc, char **argv) -> int
 
     auto bus = CanBus::create(plugin, channel);
 
+    // Formatting and writing happen on the logger's thread, so logging never holds up reception
+    CanFrameLogger logger;
+    const auto format = result["binary"].as<bool>() ? CanFrameLogger::Binary : CanFrameLogger::Candump;
+    if (!logger.open(logFile, format, channel)) {
+        spdlog::error("Cannot log frames: {}", logger.errorMessage());
+        return 1;
+    }
+    logger.attach(*bus);
+    // The logger taps frames as they arrive; nothing else reads the receive queue
+    bus->framesReceived.connect([&]() { bus->flushRx(); });
+
     bus->errorOccurred.connect([](CanInterface::CanBusError error) { spdlog::error("Connection error: {}", error); });
     bus->connectionStateChanged.connect(
         [](CanInterface::CanConnectionState state) { spdlog::info("Connection state changed to {}", state); });
-    bus->framesReceived.connect([&]() {
-        CanFrame frame = bus->recv();
-        while (frame.frameType() != CanFrame::InvalidFrame) {
-            spdlog::info("RX: {}", frame);
-            frame = bus->recv();
-        }
-    });
 
     bus->connect();
 
-    return app.run();
+    const int status = app.run();
+    logger.close();
+    if (logger.dropped() > 0)
+        spdlog::warn("Dropped {} of {} frames while logging", logger.dropped(), logger.written() + logger.dropped());
+    return status;
 }
@@ -0,0 +1,102 @@
+/**
+ * @file change_detect.cpp
+ *
+ * Measure ChangeDetector on a recording of periodic messages that mostly
+ * repeat: each frame changes one byte with the given probability (in
+ * percent).  Decoding every frame with SignalDecoder is compared with
+ * decoding only the frames the detector passes on.
+ *
+ * @code{.sh}
+ * bench_change_detect 256 1000000 10
+ * @endcode
+ */
+
+#include <random>
+#include <string>
+#include <vector>
+
+#include <fmt/core.h>
+
+#include "dplib/ChangeDetector.h"
+#include "dplib/util/ElapsedTimer.h"
+
+using datapanel::ChangeDetector;
+using datapanel::Message;
+using datapanel::Signal;
+using datapanel::SignalDecoder;
+using datapanel::net::can::CanFrame;
+using datapanel::util::ElapsedTimer;
+
+auto main(int argc, char **argv) -> int
+{
+    const size_t ids = argc > 1 ? std::stoul(argv[1]) : 256;
+    const size_t frameCount = argc > 2 ? std::stoul(argv[2]) : 1000000;
+    const unsigned changePercent = argc > 3 ? unsigned(std::stoul(argv[3])) : 10;
+
+    std::vector<Message> messages;
+    for (size_t n = 0; n < ids; n++) {
+        Message message;
+        message.setId(uint32_t(0x18F00000 + n));
+        message.setExtendedId(true);
+        message.setName(fmt::format("Message{}", n));
+        for (unsigned s = 0; s < 8; s++) {
+            Signal signal;
+            signal.setName(fmt::format("Signal{}", s));
+            signal.setStartBit(s * 8);
+            signal.setLength(8);
+            signal.setScale(0.5);
+            message.addSignal(signal);
+        }
+        messages.push_back(message);
+    }
+    SignalDecoder decoder;
+    decoder.compile(messages);
+
+    std::mt19937 random(24);
+    std::vector<std::vector<std::byte>> payloads(ids, std::vector<std::byte>(8));
+    std::vector<CanFrame> frames;
+    frames.reserve(frameCount);
+    for (size_t n = 0; n < frameCount; n++) {
+        const size_t id = n % ids;
+        if (random() % 100 < changePercent)
+            payloads[id][random() % 8] = std::byte(random());
+        CanFrame frame(messages[id].id(), payloads[id]);
+        frame.setExtendedId(true);
+        frames.push_back(frame);
+    }
+
+    std::vector<double> values(decoder.valueCount());
+    double sink = 0;
+    ElapsedTimer timer;
+    timer.start();
+    for (const auto &frame : frames) {
+        const int message = decoder.decode(frame, values.data());
+        for (size_t s = 0; s < decoder.signalCount(message); s++) sink += values[decoder.firstValue(message) + s];
+    }
+    const double decodeNs = double(timer.elapsed().count());
+
+    ChangeDetector frameChanges(ids);
+    size_t changedFrames = 0;
+    frameChanges.frameChanged.connect([&](const CanFrame &) { changedFrames++; });
+    timer.start();
+    frameChanges.process(frames.data(), frames.size());
+    const double compareNs = double(timer.elapsed().count());
+
+    ChangeDetector valueChanges(ids);
+    valueChanges.setDecoder(&decoder);
+    valueChanges.valueChanged.connect([&](const CanFrame &, size_t, double value) { sink += value; });
+    timer.start();
+    valueChanges.process(frames.data(), frames.size());
+    const double detectNs = double(timer.elapsed().count());
+
+    const auto &stats = valueChanges.statistics();
+    const double total = double(frameCount);
+    fmt::print("ids={} frames={} change={}% (checksum {:.0f})\n", ids, frameCount, changePercent, sink);
+    fmt::print("  decode every frame   {:6.2f} ns/frame  {} values\n", decodeNs / total, frameCount * 8);
+    fmt::print("  compare only         {:6.2f} ns/frame  {} frames passed ({:.1f}%)\n", compareNs / total,
+               changedFrames, 100.0 * double(changedFrames) / total);
+    fmt::print("  compare and decode   {:6.2f} ns/frame  {} values passed ({:.1f}%)  {:.1f}x\n", detectNs / total,
+               stats.changedValues, 100.0 * double(stats.changedValues) / (total * 8), decodeNs / detectNs);
+
+    return 0;
+}
@@ -0,0 +1,89 @@
+/**
+ * @file frame_decode.cpp
+ *
+ * Compare per-field CanFrame setters with CanFrameCodec batch decoding
+ * of raw SocketCAN frames.
+ *
+ * @code{.sh}
+ * bench_frame_decode 1000000
+ * @endcode
+ */
+
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <fmt/core.h>
+
+#include "dplib/net/can/CanFrameCodec.h"
+#include "dplib/util/ElapsedTimer.h"
+
+#include <linux/can.h>
+
+using namespace datapanel::net::can;
+using datapanel::util::ElapsedTimer;
+
+/** The conversion readSocket() used before CanFrameCodec */
+static void decodeWithSetters(const canfd_frame &raw, bool fd, CanFrame &frame)
+{
+    frame = CanFrame();
+    frame.setFD(fd);
+    frame.setExtendedId(raw.can_id & CAN_EFF_FLAG);
+    if (raw.can_id & CAN_RTR_FLAG)
+        frame.setFrameType(CanFrame::RemoteRequestFrame);
+    else if (raw.can_id & CAN_ERR_FLAG)
+        frame.setFrameType(CanFrame::ErrorFrame);
+    else
+        frame.setFrameType(CanFrame::DataFrame);
+    if (fd && (raw.flags & CANFD_BRS))
+        frame.setBitrateSwitch(true);
+    if (fd && (raw.flags & CANFD_ESI))
+        frame.setErrorState(true);
+    frame.setId(raw.can_id & CAN_EFF_MASK);
+    frame.setPayload(reinterpret_cast<const std::byte *>(raw.data), raw.len);
+}
+
+auto main(int argc, char **argv) -> int
+{
+    const size_t count = argc > 1 ? std::stoul(argv[1]) : 1000000;
+    constexpr int rounds = 5;
+
+    // Mixed traffic: mostly classic frames, some extended, some FD
+    std::mt19937 rng(1);
+    std::vector<canfd_frame> raw(count);
+    std::vector<uint32_t> sizes(count);
+    for (size_t n = 0; n < count; n++) {
+        std::memset(&raw[n], 0, sizeof(canfd_frame));
+        const uint32_t kind = rng() % 10;
+        const bool fd = kind == 0;
+        raw[n].can_id = kind < 3 ? ((rng() & CAN_EFF_MASK) | CAN_EFF_FLAG) : (rng() & CAN_SFF_MASK);
+        raw[n].len = fd ? 64 : 8;
+        raw[n].flags = fd ? CANFD_BRS : 0;
+        for (int b = 0; b < raw[n].len; b++) raw[n].data[b] = static_cast<uint8_t>(rng());
+        sizes[n] = fd ? CANFD_MTU : CAN_MTU;
+    }
+    std::vector<CanFrame> frames(count);
+
+    double settersNs = 1e30;
+    double batchNs = 1e30;
+    for (int round = 0; round < rounds; round++) {
+        ElapsedTimer timer;
+        timer.start();
+        for (size_t n = 0; n < count; n++) decodeWithSetters(raw[n], sizes[n] == CANFD_MTU, frames[n]);
+        settersNs = std::min(settersNs, static_cast<double>(timer.restart().count()));
+
+        CanFrameCodec::decode(raw.data(), sizes.data(), frames.data(), count);
+        batchNs = std::min(batchNs, static_cast<double>(timer.elapsed().count()));
+    }
+
+    uint64_t checksum = 0;
+    for (const CanFrame &frame : frames) checksum += frame.id() + frame.payloadSize();
+
+    fmt::print("frames={} best of {} rounds, batch decoder: {}\n", count, rounds, CanFrameCodec::implementation());
+    fmt::print("  setters  {:8.2f} ns/frame\n", settersNs / count);
+    fmt::print("  batch    {:8.2f} ns/frame  ({:.2f}x)\n", batchNs / count, settersNs / batchNs);
+    fmt::print("  checksum {}\n", checksum);
+
+    return 0;
+}
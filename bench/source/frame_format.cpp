@@ -0,0 +1,108 @@
+/**
+ * @file frame_format.cpp
+ *
+ * Compare the per-byte fmt hexdump and CanFrame formatting used before
+ * with the table-driven hexdumpTo() and the buffered CanFrame formatter.
+ *
+ * @code{.sh}
+ * bench_frame_format 1000000
+ * @endcode
+ */
+
+#include <chrono>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <fmt/chrono.h>
+#include <fmt/format.h>
+
+#include "dplib/net/can/CanFrame.h"
+#include "dplib/util/ElapsedTimer.h"
+#include "dplib/util/hexdump.h"
+
+using namespace datapanel::net::can;
+using datapanel::util::ByteView;
+using datapanel::util::ElapsedTimer;
+
+/** The hexdump() implementation before hexdumpTo() */
+static std::string legacyHexdump(ByteView data, const std::string &sep = " ")
+{
+    auto out = fmt::memory_buffer();
+    for (auto i = std::begin(data); i < std::end(data); ++i) {
+        fmt::format_to(std::back_inserter(out), "{:02X}{}", *i, i == (std::end(data) - 1) ? "" : sep);
+    }
+    return fmt::to_string(out);
+}
+
+/** The CanFrame formatter before it used hexdumpTo() and cached the date */
+static void legacyFormat(fmt::memory_buffer &out, const CanFrame &frame)
+{
+    const CanFrame::Timestamp ts = frame.timestamp();
+    std::chrono::time_point<std::chrono::system_clock, std::chrono::duration<int>> tp_seconds{
+        std::chrono::duration<int>{ts.seconds()}};
+    fmt::format_to(std::back_inserter(out), "{}.{:09d} 0x{:0{}X}  [{}] {}", tp_seconds, ts.nanoseconds(), frame.id(),
+                   frame.isExtendedId() ? 8 : 3, frame.payloadSize(), legacyHexdump(frame.payload()));
+}
+
+auto main(int argc, char **argv) -> int
+{
+    const size_t count = argc > 1 ? std::stoul(argv[1]) : 1000000;
+    constexpr int rounds = 5;
+
+    // Classic frames a few hundred microseconds apart, some extended, some FD
+    std::mt19937 rng(1);
+    std::vector<CanFrame> frames(count);
+    int64_t ns = 1700000000000000000;
+    for (CanFrame &frame : frames) {
+        const uint32_t kind = rng() % 10;
+        std::byte payload[CanFrame::MaxPayloadSize];
+        const size_t size = kind == 0 ? 64 : 8;
+        for (size_t b = 0; b < size; b++) payload[b] = std::byte(rng());
+        frame = CanFrame(kind < 3 ? rng() & 0x1FFFFFFF : rng() & 0x7FF, std::vector<std::byte>(payload, payload + size));
+        frame.setExtendedId(kind < 3);
+        frame.setFD(kind == 0);
+        ns += 100000 + rng() % 400000;
+        frame.setTimestampNs(ns);
+    }
+
+    double legacyHexNs = 1e30;
+    double tableHexNs = 1e30;
+    double legacyFrameNs = 1e30;
+    double frameNs = 1e30;
+    size_t checksum = 0;
+    fmt::memory_buffer text;
+    char hex[datapanel::util::hexdumpLength(CanFrame::MaxPayloadSize)];
+    for (int round = 0; round < rounds; round++) {
+        ElapsedTimer timer;
+        timer.start();
+        for (const CanFrame &frame : frames) checksum += legacyHexdump(frame.payload()).size();
+        legacyHexNs = std::min(legacyHexNs, static_cast<double>(timer.restart().count()));
+
+        for (const CanFrame &frame : frames) checksum += size_t(datapanel::util::hexdumpTo(frame.payload(), hex) - hex);
+        tableHexNs = std::min(tableHexNs, static_cast<double>(timer.restart().count()));
+
+        for (const CanFrame &frame : frames) {
+            text.clear();
+            legacyFormat(text, frame);
+            checksum += text.size();
+        }
+        legacyFrameNs = std::min(legacyFrameNs, static_cast<double>(timer.restart().count()));
+
+        for (const CanFrame &frame : frames) {
+            text.clear();
+            fmt::format_to(std::back_inserter(text), "{}", frame);
+            checksum += text.size();
+        }
+        frameNs = std::min(frameNs, static_cast<double>(timer.elapsed().count()));
+    }
+
+    fmt::print("frames={} best of {} rounds\n", count, rounds);
+    fmt::print("  hexdump, fmt per byte   {:8.2f} ns/frame\n", legacyHexNs / count);
+    fmt::print("  hexdumpTo, pair table   {:8.2f} ns/frame  ({:.2f}x)\n", tableHexNs / count, legacyHexNs / tableHexNs);
+    fmt::print("  CanFrame, before        {:8.2f} ns/frame\n", legacyFrameNs / count);
+    fmt::print("  CanFrame, buffered      {:8.2f} ns/frame  ({:.2f}x)\n", frameNs / count, legacyFrameNs / frameNs);
+    fmt::print("  checksum {}\n", checksum);
+
+    return 0;
+}
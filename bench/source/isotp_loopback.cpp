@@ -0,0 +1,185 @@
+/**
+ * @file isotp_loopback.cpp
+ *
+ * Measure ISO-TP throughput for 4095-byte transfers between two
+ * IsoTpTransport instances on a simulated 500 kbit/s Virtual bus, against
+ * the time the bus needs for the frames (or the separation time, when
+ * larger).  With a separation time, the shared pacing timer is compared
+ * with arming a new timer for every consecutive frame.
+ *
+ * @code{.sh}
+ * bench_isotp_loopback 10
+ * @endcode
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <fmt/core.h>
+
+#include "dplib/core/EventDispatcher.h"
+#include "dplib/net/can/BitTiming.h"
+#include "dplib/net/can/VirtualCanBackend.h"
+#include "dplib/net/isotp/IsoTpTransport.h"
+#include "dplib/util/ElapsedTimer.h"
+
+using namespace datapanel::net::can;
+using datapanel::core::EventDispatcher;
+using datapanel::net::isotp::IsoTpChannelConfig;
+using datapanel::net::isotp::IsoTpTransport;
+using datapanel::util::ByteView;
+using datapanel::util::ElapsedTimer;
+
+constexpr int Bitrate = 500000;
+constexpr size_t MessageSize = 4095; /**< Largest classic ISO-TP message */
+
+static void runUntil(EventDispatcher &dispatcher, const std::function<bool()> &done)
+{
+    const int tick = dispatcher.addTimer(5, []() {});
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(30);
+    while (!done() && std::chrono::steady_clock::now() < deadline) dispatcher.processEvents();
+    dispatcher.removeTimer(tick);
+}
+
+/** Bus time for one message: first frame, flow control and consecutive frames */
+static double busSeconds(std::chrono::nanoseconds stMin)
+{
+    const CanFrame full(0x7E0, std::vector<std::byte>(8));
+    const double frameSeconds = double(frameBitCount(full)) / Bitrate;
+    const size_t consecutive = (MessageSize - 6 + 6) / 7;  // The rest after the first frame's 6 bytes, 7 at a time
+    const double gap = std::max(frameSeconds, std::chrono::duration<double>(stMin).count());
+    // First frame, flow control and the first consecutive frame, then one frame per gap
+    return 3 * frameSeconds + double(consecutive - 1) * gap;
+}
+
+/** Tester and ECU on their own interfaces of one paced bus */
+struct Loopback {
+    EventDispatcher dispatcher;
+    std::unique_ptr<CanInterface> testerBus = VirtualCanBackend::init("bench-isotp");
+    std::unique_ptr<CanInterface> ecuBus = VirtualCanBackend::init("bench-isotp");
+    IsoTpTransport ecu;
+    size_t received = 0;
+
+    explicit Loopback(uint8_t stMin)
+    {
+        dispatcher.setTimerMode(EventDispatcher::TimerMode::Precise);
+        for (auto *node : {testerBus.get(), ecuBus.get()}) {
+            node->setEventDispatcher(&dispatcher);
+            node->setConfigOption(CanInterface::CfgOptBitrate, Bitrate);
+            node->connect();
+        }
+        IsoTpChannelConfig config;
+        config.txId = 0x7E8;
+        config.rxId = 0x7E0;
+        config.stMin = stMin;
+        ecu.addChannel(config);
+        ecu.attach(*ecuBus);
+        ecu.messageReceived.connect([this](int, ByteView data) { received += data.size() == MessageSize; });
+    }
+
+    ~Loopback()
+    {
+        ecu.detach();
+        testerBus->disconnect();
+        ecuBus->disconnect();
+    }
+};
+
+static double transportSeconds(uint8_t stMin, int transfers)
+{
+    Loopback loop(stMin);
+    IsoTpTransport tester;
+    IsoTpChannelConfig config;
+    config.txId = 0x7E0;
+    config.rxId = 0x7E8;
+    const int channel = tester.addChannel(config);
+    tester.attach(*loop.testerBus);
+
+    const std::vector<std::byte> message(MessageSize, std::byte(0x55));
+    ElapsedTimer timer;
+    timer.start();
+    for (int n = 0; n < transfers; n++) {
+        if (!tester.send(channel, message)) {
+            fmt::print("send failed: {}\n", tester.errorMessage());
+            return 0;
+        }
+        runUntil(loop.dispatcher, [&]() { return loop.received == size_t(n + 1); });
+    }
+    const double seconds = double(timer.elapsed().count()) * 1e-9;
+    tester.detach();
+    return seconds / transfers;
+}
+
+/** Send consecutive frames by hand, arming a new timer after each one */
+static double timerPerFrameSeconds(uint8_t stMin, std::chrono::nanoseconds separation, int transfers)
+{
+    Loopback loop(stMin);
+    CanInterface &tester = *loop.testerBus;
+    bool flowControl = false;
+    tester.framesReceived.connect([&]() {
+        while (tester.countRxPending() > 0) flowControl |= (uint8_t(tester.recv().payload()[0]) >> 4) == 3;
+    });
+
+    auto frame = [](std::initializer_list<uint8_t> head) {
+        std::vector<std::byte> payload(8, std::byte(0x55));
+        size_t n = 0;
+        for (uint8_t b : head) payload[n++] = std::byte(b);
+        return CanFrame(0x7E0, payload);
+    };
+
+    ElapsedTimer timer;
+    timer.start();
+    for (int n = 0; n < transfers; n++) {
+        flowControl = false;
+        tester.send(frame({0x10 | MessageSize >> 8, MessageSize & 0xFF}));
+        runUntil(loop.dispatcher, [&]() { return flowControl; });
+
+        size_t offset = 6;
+        uint8_t sequence = 1;
+        int pending = -1;
+        std::function<void()> next = [&]() {
+            if (pending >= 0)
+                loop.dispatcher.removeTimer(pending);
+            pending = -1;
+            tester.send(frame({uint8_t(0x20 | sequence)}));
+            sequence = (sequence + 1) & 0xF;
+            offset += 7;
+            if (offset < MessageSize)
+                pending = loop.dispatcher.addTimer(separation, next);
+        };
+        next();
+        runUntil(loop.dispatcher, [&]() { return loop.received == size_t(n + 1); });
+    }
+    return double(timer.elapsed().count()) * 1e-9 / transfers;
+}
+
+auto main(int argc, char **argv) -> int
+{
+    const int transfers = argc > 1 ? std::stoi(argv[1]) : 10;
+
+    fmt::print("{} byte transfers at {} bit/s, {} each\n", MessageSize, Bitrate, transfers);
+
+    const double busOnly = busSeconds(std::chrono::nanoseconds(0));
+    const double unpaced = transportSeconds(0, transfers);
+    fmt::print("  STmin 0       bus {:7.2f} ms  transport {:7.2f} ms  ({:.0f}% of bus throughput)\n", busOnly * 1e3,
+               unpaced * 1e3, 100 * busOnly / unpaced);
+
+    using Separation = std::pair<uint8_t, std::chrono::nanoseconds>;
+    for (const auto &[stMin, separation] :
+         {Separation{0xF3, std::chrono::microseconds(300)}, Separation{0xF5, std::chrono::microseconds(500)},
+          Separation{0x01, std::chrono::milliseconds(1)}}) {
+        const double limit = busSeconds(separation);
+        const double paced = transportSeconds(stMin, transfers);
+        const double naive = timerPerFrameSeconds(stMin, separation, transfers);
+        fmt::print("  STmin {:4} us  limit {:7.2f} ms  transport {:7.2f} ms ({:.0f}%)  timer per frame {:7.2f} ms "
+                   "({:.0f}%)\n",
+                   separation.count() / 1000, limit * 1e3, paced * 1e3, 100 * limit / paced, naive * 1e3,
+                   100 * limit / naive);
+    }
+
+    return 0;
+}
@@ -0,0 +1,79 @@
+/**
+ * @file j1939_transport.cpp
+ *
+ * Measure J1939Transport on a bus where many ECUs broadcast multi-packet
+ * messages (BAM) at the same time, their packets interleaved, mixed with
+ * single-frame traffic.
+ *
+ * @code{.sh}
+ * bench_j1939_transport 64 1000
+ * @endcode
+ */
+
+#include <string>
+#include <vector>
+
+#include <fmt/core.h>
+
+#include "dplib/net/j1939/J1939Transport.h"
+#include "dplib/util/ElapsedTimer.h"
+
+using namespace datapanel::net::j1939;
+using datapanel::net::can::CanFrame;
+using datapanel::util::ElapsedTimer;
+
+static CanFrame j1939Frame(Pgn pgn, uint8_t source, uint8_t destination, const uint8_t (&bytes)[8])
+{
+    J1939Id id;
+    id.priority = 7;
+    id.pgn = pgn;
+    id.source = source;
+    id.destination = destination;
+    CanFrame frame(id.encode(), datapanel::util::ByteView(reinterpret_cast<const std::byte *>(bytes), 8));
+    frame.setExtendedId(true);
+    return frame;
+}
+
+auto main(int argc, char **argv) -> int
+{
+    const int ecus = argc > 1 ? std::stoi(argv[1]) : 64;
+    const int rounds = argc > 2 ? std::stoi(argv[2]) : 1000;
+
+    // Each ECU broadcasts a 20-packet DM1 while sending engine data in between
+    const uint16_t size = 136;
+    const uint8_t packets = (size + 6) / 7;
+    std::vector<CanFrame> traffic;
+    for (int ecu = 0; ecu < ecus; ecu++) {
+        const uint8_t bam[8] = {32, uint8_t(size), uint8_t(size >> 8), packets, 0xFF, 0xCA, 0xFE, 0x00};
+        traffic.push_back(j1939Frame(PgnTpCm, uint8_t(ecu), GlobalAddress, bam));
+    }
+    for (uint8_t sequence = 1; sequence <= packets; sequence++) {
+        for (int ecu = 0; ecu < ecus; ecu++) {
+            const uint8_t dt[8] = {sequence, 1, 2, 3, 4, 5, 6, 7};
+            traffic.push_back(j1939Frame(PgnTpDt, uint8_t(ecu), GlobalAddress, dt));
+            if (sequence % 4 == 0) {
+                const uint8_t eec1[8] = {0xF0, 0x7D, 0x7D, 0x00, 0x1C, 0xFF, 0xF0, 0x7D};
+                traffic.push_back(j1939Frame(0xF004, uint8_t(ecu), GlobalAddress, eec1));
+            }
+        }
+    }
+
+    J1939Transport j1939(static_cast<size_t>(ecus));
+    uint64_t bytes = 0;
+    j1939.messageReceived.connect([&bytes](const J1939Message &message) { bytes += message.data.size(); });
+
+    ElapsedTimer timer;
+    timer.start();
+    for (int round = 0; round < rounds; round++) j1939.process(traffic.data(), traffic.size());
+    const double elapsedNs = static_cast<double>(timer.elapsed().count());
+
+    const auto &stats = j1939.statistics();
+    const double frames = double(traffic.size()) * rounds;
+    fmt::print("ecus={} rounds={} frames={}\n", ecus, rounds, frames);
+    fmt::print("  {:8.2f} ns/frame, {:.0f} frames/s\n", elapsedNs / frames, frames * 1e9 / elapsedNs);
+    fmt::print("  messages {} (reassembled {}), aborted {}, no session {}\n", stats.messages, stats.transfers,
+               stats.aborted, stats.noSession);
+    fmt::print("  bytes {}\n", bytes);
+
+    return 0;
+}
@@ -0,0 +1,75 @@
+/**
+ * @file posted_events.cpp
+ *
+ * Measure the cost of posting and delivering events through
+ * Application::postEvent() compared with posting closures to the
+ * dispatcher.
+ *
+ * @code{.sh}
+ * bench_posted_events 1000000
+ * @endcode
+ */
+
+#include <memory>
+#include <string>
+
+#include <fmt/core.h>
+
+#include "dplib/core/Application.h"
+#include "dplib/core/Event.h"
+#include "dplib/core/Object.h"
+#include "dplib/util/ElapsedTimer.h"
+
+using namespace datapanel::core;
+using datapanel::util::ElapsedTimer;
+
+class CountEvent : public Event
+{
+  public:
+    CountEvent() : Event(EventType::User)
+    {
+    }
+};
+
+class Counter : public Object
+{
+  public:
+    bool event(Event *) override
+    {
+        count++;
+        return true;
+    }
+
+    uint64_t count = 0;
+};
+
+auto main(int argc, char **argv) -> int
+{
+    const size_t count = argc > 1 ? std::stoul(argv[1]) : 1000000;
+    constexpr size_t batch = 256;
+
+    Application &app = Application::instance();
+    Counter counter;
+    ElapsedTimer timer;
+
+    timer.start();
+    for (size_t n = 0; n < count; n += batch) {
+        for (size_t k = 0; k < batch; k++) app.postEvent(&counter, std::make_unique<CountEvent>());
+        app.sendPostedEvents();
+    }
+    const double eventNs = timer.restart().count();
+
+    uint64_t calls = 0;
+    EventDispatcher &dispatcher = app.eventDispatcher();
+    for (size_t n = 0; n < count; n += batch) {
+        for (size_t k = 0; k < batch; k++) dispatcher.post([&calls]() { calls++; });
+        dispatcher.processEvents();
+    }
+    const double taskNs = timer.elapsed().count();
+
+    fmt::print("posts={} batch={}\n", count, batch);
+    fmt::print("  postEvent       {:8.1f} ns/event ({} delivered)\n", eventNs / count, counter.count);
+    fmt::print("  dispatcher.post {:8.1f} ns/task  ({} run)\n", taskNs / count, calls);
+
+    return 0;
+}
@@ -0,0 +1,161 @@
+/**
+ * @file signal_decode.cpp
+ *
+ * Measure SignalDecoder on a generated database of 300 messages with
+ * 2,100 signals of mixed byte order, sign and multiplexing, decoding a
+ * stream of frames spread over all messages.  A decoder that looks up
+ * messages in an std::unordered_map and extracts signals bit by bit is
+ * measured for comparison.
+ *
+ * @code{.sh}
+ * bench_signal_decode 300 1000
+ * @endcode
+ */
+
+#include <cmath>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <fmt/core.h>
+
+#include "dplib/DbcImporter.h"
+#include "dplib/SignalDecoder.h"
+#include "dplib/util/ElapsedTimer.h"
+
+using datapanel::DbcImporter;
+using datapanel::Message;
+using datapanel::Signal;
+using datapanel::SignalDecoder;
+using datapanel::net::can::CanFrame;
+using datapanel::util::ElapsedTimer;
+
+constexpr int SignalsPerMessage = 7;
+
+static std::string generateDbc(int messages, std::mt19937 &random)
+{
+    std::string dbc = "VERSION \"\"\n\nBU_: ECU\n\n";
+    for (int m = 0; m < messages; m++) {
+        const bool extended = m % 3 == 0;
+        const uint32_t id = extended ? 0x98F00000 + uint32_t(m) * 0x100 + 0xFE : 0x100 + uint32_t(m) * 3;
+        dbc += fmt::format("BO_ {} Message{}: 8 ECU\n", id, m);
+        const bool multiplexed = m % 10 == 0;
+        if (multiplexed)
+            dbc += " SG_ Mux M : 0|4@1+ (1,0) [0|15] \"\" ECU\n";
+        // Signals of 4 to 16 bits anywhere after the first byte
+        for (int s = multiplexed; s < SignalsPerMessage; s++) {
+            const bool motorola = random() % 2;
+            const unsigned length = 4 + random() % 13;
+            const unsigned first = 8 + random() % (56 - length + 1);
+            const unsigned start = motorola ? first / 8 * 8 + 7 - first % 8 : first;
+            dbc += fmt::format(" SG_ Signal{}{} : {}|{}@{}{} (0.25,-10) [0|0] \"\" ECU\n", s,
+                               multiplexed ? fmt::format(" m{}", s % 4) : "", start, length, motorola ? 0 : 1,
+                               random() % 2 ? '-' : '+');
+        }
+        dbc += "\n";
+    }
+    return dbc;
+}
+
+/** Straightforward decoder: hash map lookup and one bit at a time */
+struct BitDecoder {
+    std::unordered_map<uint32_t, const Message *> messages;
+
+    explicit BitDecoder(const std::vector<Message> &list)
+    {
+        for (const auto &message : list)
+            messages[message.id() | (message.isExtendedId() ? 0x80000000 : 0)] = &message;
+    }
+
+    size_t decode(const CanFrame &frame, double *values) const
+    {
+        const auto it = messages.find(frame.id() | (frame.isExtendedId() ? 0x80000000 : 0));
+        if (it == messages.end())
+            return 0;
+        const auto *data = reinterpret_cast<const uint8_t *>(frame.payload().data());
+        size_t n = 0;
+        for (const auto &signal : it->second->signals()) {
+            uint64_t raw = 0;
+            const unsigned length = signal.length();
+            for (unsigned bit = 0; bit < length; bit++) {
+                unsigned position;
+                if (signal.byteOrder() == Signal::ByteOrder::LittleEndian) {
+                    position = signal.startBit() + length - 1 - bit;
+                    raw = raw << 1 | ((data[position / 8] >> (position % 8)) & 1);
+                } else {
+                    position = signal.startBit() / 8 * 8 + 7 - signal.startBit() % 8 + bit;
+                    raw = raw << 1 | ((data[position / 8] >> (7 - position % 8)) & 1);
+                }
+            }
+            double value = double(raw);
+            if (signal.valueType() == Signal::ValueType::Signed && (raw >> (length - 1)))
+                value -= std::ldexp(1.0, int(length));
+            values[n++] = value * signal.scale() + signal.offset();
+        }
+        return n;
+    }
+};
+
+auto main(int argc, char **argv) -> int
+{
+    const int messageCount = argc > 1 ? std::stoi(argv[1]) : 300;
+    const int rounds = argc > 2 ? std::stoi(argv[2]) : 1000;
+
+    std::mt19937 random(22);
+    DbcImporter dbc;
+    if (!dbc.parse(generateDbc(messageCount, random))) {
+        fmt::print("line {}: {}\n", dbc.errorLine(), dbc.errorMessage());
+        return 1;
+    }
+    SignalDecoder decoder;
+    if (!decoder.compile(dbc.messages())) {
+        fmt::print("{}\n", decoder.errorMessage());
+        return 1;
+    }
+
+    // Frames of every message in random order
+    std::vector<CanFrame> frames;
+    for (int n = 0; n < 4096; n++) {
+        const Message &message = dbc.messages()[random() % dbc.messages().size()];
+        std::vector<std::byte> payload(8);
+        for (auto &b : payload) b = std::byte(random());
+        CanFrame frame(message.id(), payload);
+        frame.setExtendedId(message.isExtendedId());
+        frames.push_back(frame);
+    }
+
+    std::vector<double> values(decoder.valueCount());
+    double checksum = 0;
+    size_t decoded = 0;
+    ElapsedTimer timer;
+    timer.start();
+    for (int round = 0; round < rounds; round++) {
+        for (const auto &frame : frames) {
+            const int message = decoder.decode(frame, values.data());
+            decoded += decoder.signalCount(message);
+            checksum += values[decoder.firstValue(message)];
+        }
+    }
+    const double compiledNs = double(timer.elapsed().count());
+
+    BitDecoder bitDecoder(dbc.messages());
+    std::vector<double> bitValues(SignalsPerMessage);
+    timer.start();
+    for (int round = 0; round < rounds; round++) {
+        for (const auto &frame : frames) {
+            bitDecoder.decode(frame, bitValues.data());
+            checksum += bitValues[0];
+        }
+    }
+    const double bitNs = double(timer.elapsed().count());
+
+    const double total = double(frames.size()) * rounds;
+    fmt::print("messages={} signals={} rounds={} frames={}\n", decoder.messageCount(), decoder.valueCount(), rounds,
+               total);
+    fmt::print("  compiled    {:7.2f} ns/frame  {:6.2f} ns/signal\n", compiledNs / total, compiledNs / decoded);
+    fmt::print("  bit by bit  {:7.2f} ns/frame\n", bitNs / total);
+    fmt::print("  (checksum {})\n", checksum);
+
+    return 0;
+}
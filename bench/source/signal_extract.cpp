@@ -0,0 +1,117 @@
+/**
+ * @file signal_extract.cpp
+ *
+ * Measure SignalExtractor on a recording of one message: eight signals
+ * of mixed byte order and sign extracted into columns, against decoding
+ * the same frames one at a time with SignalDecoder and copying the
+ * values into the columns.
+ *
+ * @code{.sh}
+ * bench_signal_extract 1000000 10
+ * @endcode
+ */
+
+#include <random>
+#include <string>
+#include <vector>
+
+#include <fmt/core.h>
+
+#include "dplib/SignalDecoder.h"
+#include "dplib/SignalExtractor.h"
+#include "dplib/util/ElapsedTimer.h"
+
+using datapanel::Message;
+using datapanel::Signal;
+using datapanel::SignalDecoder;
+using datapanel::SignalExtractor;
+using datapanel::net::can::CanFrame;
+using datapanel::util::ElapsedTimer;
+
+static Message benchMessage()
+{
+    Message message;
+    message.setId(0x0CF00400);
+    message.setExtendedId(true);
+    message.setName("EEC1");
+    const struct {
+        unsigned start, length;
+        bool motorola, isSigned;
+    } layout[] = {{0, 4, false, false},  {4, 4, false, false},   {8, 8, false, true},    {16, 8, false, true},
+                  {24, 16, false, false}, {47, 8, true, false},   {55, 12, true, true},   {60, 4, false, false}};
+    int n = 0;
+    for (const auto &l : layout) {
+        Signal signal;
+        signal.setName(fmt::format("Signal{}", n++));
+        signal.setStartBit(l.start);
+        signal.setLength(l.length);
+        signal.setByteOrder(l.motorola ? Signal::ByteOrder::BigEndian : Signal::ByteOrder::LittleEndian);
+        signal.setValueType(l.isSigned ? Signal::ValueType::Signed : Signal::ValueType::Unsigned);
+        signal.setScale(0.125);
+        signal.setOffset(-125);
+        message.addSignal(signal);
+    }
+    return message;
+}
+
+auto main(int argc, char **argv) -> int
+{
+    const size_t frameCount = argc > 1 ? std::stoul(argv[1]) : 1000000;
+    const int rounds = argc > 2 ? std::stoi(argv[2]) : 10;
+
+    const Message message = benchMessage();
+    std::mt19937 random(23);
+    std::vector<CanFrame> frames;
+    frames.reserve(frameCount);
+    for (size_t n = 0; n < frameCount; n++) {
+        std::vector<std::byte> payload(8);
+        for (auto &b : payload) b = std::byte(random());
+        CanFrame frame(message.id(), payload);
+        frame.setExtendedId(true);
+        frames.push_back(frame);
+    }
+    const size_t signals = message.signals().size();
+
+    SignalDecoder decoder;
+    decoder.compile({message});
+    std::vector<std::vector<double>> perFrameColumns(signals, std::vector<double>(frameCount));
+    std::vector<double> values(decoder.valueCount());
+    ElapsedTimer timer;
+    timer.start();
+    for (int round = 0; round < rounds; round++) {
+        for (size_t n = 0; n < frameCount; n++) {
+            decoder.decode(frames[n], values.data());
+            for (size_t s = 0; s < signals; s++) perFrameColumns[s][n] = values[s];
+        }
+    }
+    const double perFrameNs = double(timer.elapsed().count());
+
+    SignalExtractor extractor;
+    extractor.compile(message);
+    std::vector<std::vector<double>> columns;
+    timer.start();
+    for (int round = 0; round < rounds; round++) extractor.extract(frames.data(), frames.size(), columns);
+    const double columnNs = double(timer.elapsed().count());
+
+    std::vector<std::vector<float>> floatColumns;
+    timer.start();
+    for (int round = 0; round < rounds; round++) extractor.extract(frames.data(), frames.size(), floatColumns);
+    const double floatNs = double(timer.elapsed().count());
+
+    size_t mismatches = 0;
+    for (size_t s = 0; s < signals; s++)
+        for (size_t n = 0; n < frameCount; n++) mismatches += columns[s][n] != perFrameColumns[s][n];
+
+    const double total = double(frameCount) * rounds;
+    fmt::print("frames={} signals={} rounds={} kernel={}\n", frameCount, signals, rounds,
+               SignalExtractor::implementation());
+    fmt::print("  per-frame decode   {:6.2f} ns/frame  {:7.1f} M values/s\n", perFrameNs / total,
+               total * signals / perFrameNs * 1e3);
+    fmt::print("  columns (double)   {:6.2f} ns/frame  {:7.1f} M values/s  {:.1f}x\n", columnNs / total,
+               total * signals / columnNs * 1e3, perFrameNs / columnNs);
+    fmt::print("  columns (float)    {:6.2f} ns/frame  {:7.1f} M values/s  {:.1f}x\n", floatNs / total,
+               total * signals / floatNs * 1e3, perFrameNs / floatNs);
+    fmt::print("  mismatches {}\n", mismatches);
+
+    return 0;
+}
@@ -0,0 +1,134 @@
+/**
+ * @file socketcan_rx.cpp
+ *
+ * Measure SocketCAN receive throughput and system calls per frame for
+ * several receive batch sizes.
+ *
+ * Requires a virtual CAN interface:
+ *
+ * @code{.sh}
+ * sudo modprobe vcan
+ * sudo ip link add dev vcan0 type vcan
+ * sudo ip link set up vcan0
+ * bench_socketcan_rx vcan0 200000
+ * @endcode
+ */
+
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <fmt/core.h>
+
+#include "dplib/core/Application.h"
+#include "dplib/net/can/CanBus.h"
+#include "dplib/net/can/SocketCanBackend.h"
+#include "dplib/util/ElapsedTimer.h"
+
+#include <errno.h>
+#include <net/if.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <linux/can.h>
+#include <linux/can/raw.h>
+
+using namespace datapanel::core;
+using namespace datapanel::net::can;
+using namespace std::chrono_literals;
+
+static int openWriter(const std::string &ifname)
+{
+    int s = ::socket(PF_CAN, SOCK_RAW, CAN_RAW);
+    if (s < 0)
+        return -1;
+
+    sockaddr_can addr = {};
+    addr.can_family = AF_CAN;
+    addr.can_ifindex = ::if_nametoindex(ifname.c_str());
+    if (addr.can_ifindex == 0 || ::bind(s, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) < 0) {
+        ::close(s);
+        return -1;
+    }
+    return s;
+}
+
+static void writeFrames(int s, size_t count)
+{
+    can_frame tx = {};
+    tx.can_dlc = 8;
+    for (size_t n = 0; n < count; n++) {
+        tx.can_id = n & CAN_SFF_MASK;
+        ::memcpy(tx.data, &n, sizeof(tx.data));
+        while (::write(s, &tx, sizeof(tx)) < 0) {
+            if (errno != ENOBUFS && errno != EAGAIN)
+                return;
+            std::this_thread::sleep_for(10us);
+        }
+    }
+}
+
+static void runBatch(Application &app, const std::string &ifname, int writer, size_t count, int batchSize)
+{
+    auto bus = CanBus::create("SocketCAN", ifname);
+    bus->setConfigOption(CanInterface::CfgOptRxBatchSize, batchSize);
+
+    size_t received = 0;
+    bus->framesReceived.connect([&]() { received += bus->recvAll().size(); });
+
+    if (!bus->connect()) {
+        fmt::print("Could not connect to {}: {}\n", ifname, bus->errorMessage());
+        return;
+    }
+
+    datapanel::util::ElapsedTimer timer;
+    timer.start();
+    std::thread tx(writeFrames, writer, count);
+
+    // Stop if the writer is done and nothing has arrived for a while
+    auto idleSince = std::chrono::steady_clock::now();
+    size_t lastReceived = 0;
+    while (received < count) {
+        app.processEvents();
+        const auto now = std::chrono::steady_clock::now();
+        if (received != lastReceived) {
+            lastReceived = received;
+            idleSince = now;
+        } else if (now - idleSince > 1s) {
+            break;
+        }
+    }
+    const double seconds = timer.elapsed().count() / 1e9;
+    tx.join();
+
+    const auto &stats = static_cast<SocketCanBackend &>(*bus).ioStatistics();
+    fmt::print("batch={:<5d} frames={:<9d} lost={:<7d} {:>12.0f} frames/s {:>8.4f} syscalls/frame\n", batchSize,
+               received, count - received, received / seconds,
+               received ? static_cast<double>(stats.rxSyscalls) / received : 0.0);
+
+    bus->disconnect();
+}
+
+auto main(int argc, char **argv) -> int
+{
+    const std::string ifname = argc > 1 ? argv[1] : "vcan0";
+    const size_t count = argc > 2 ? std::stoul(argv[2]) : 200000;
+
+    Application &app = Application::instance();
+
+    int writer = openWriter(ifname);
+    if (writer < 0) {
+        fmt::print("Could not open {}: {}\n", ifname, ::strerror(errno));
+        return 1;
+    }
+
+    // Keep the dispatcher from blocking forever when no frames arrive
+    app.addTimer(100, []() {});
+
+    for (int batchSize : {1, 4, 16, 32, 64, 256}) runBatch(app, ifname, writer, count, batchSize);
+
+    ::close(writer);
+    return 0;
+}
@@ -0,0 +1,85 @@
+/**
+ * @file timer_jitter.cpp
+ *
+ * Compare periodic timer jitter between the coarse (millisecond epoll
+ * timeout) and precise (timerfd) EventDispatcher timer modes.
+ *
+ * @code{.sh}
+ * bench_timer_jitter 1000 5
+ * @endcode
+ */
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include <fmt/core.h>
+
+#include "dplib/core/EventDispatcher.h"
+
+using datapanel::core::EventDispatcher;
+using Clock = std::chrono::steady_clock;
+
+static void measure(EventDispatcher::TimerMode mode, std::chrono::microseconds period, int seconds)
+{
+    EventDispatcher dispatcher;
+    if (!dispatcher.setTimerMode(mode)) {
+        fmt::print("Timer mode not available\n");
+        return;
+    }
+
+    // Lateness relative to the most recent ideal expiry start + k * period.
+    // The dispatcher skips periods it missed entirely; those are counted separately.
+    std::vector<int64_t> lateness;
+    lateness.reserve(seconds * 1000000 / period.count() + 1);
+
+    const auto start = Clock::now();
+    const int64_t periodNs = std::chrono::duration_cast<std::chrono::nanoseconds>(period).count();
+    dispatcher.addTimer(period, [&]() {
+        const int64_t sinceStart = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count();
+        lateness.push_back(sinceStart % periodNs);
+    });
+
+    const auto end = start + std::chrono::seconds(seconds);
+    while (Clock::now() < end) dispatcher.processEvents();
+    const int64_t missed = std::max<int64_t>(0, seconds * 1000000000LL / periodNs - lateness.size());
+
+    constexpr std::array<int64_t, 8> bounds{10000, 50000, 100000, 250000, 500000, 1000000, 2000000, INT64_MAX};
+    std::array<size_t, bounds.size()> histogram{};
+    for (int64_t ns : lateness) {
+        const auto bucket = std::upper_bound(bounds.begin(), bounds.end(), ns);
+        histogram[bucket - bounds.begin()]++;
+    }
+
+    std::sort(lateness.begin(), lateness.end());
+    const auto percentile = [&](double p) { return lateness[static_cast<size_t>(p * (lateness.size() - 1))] / 1e3; };
+
+    fmt::print("{} mode, period {} us, {} fires, {} periods missed\n",
+               mode == EventDispatcher::TimerMode::Precise ? "precise" : "coarse", period.count(), lateness.size(),
+               missed);
+    if (lateness.empty())
+        return;
+    fmt::print("  lateness p50 {:8.1f} us  p99 {:8.1f} us  max {:8.1f} us\n", percentile(0.5), percentile(0.99),
+               lateness.back() / 1e3);
+
+    int64_t lower = 0;
+    for (size_t n = 0; n < bounds.size(); n++) {
+        const std::string label = bounds[n] == INT64_MAX ? fmt::format(">= {} us", lower / 1000)
+                                                         : fmt::format("< {} us", bounds[n] / 1000);
+        fmt::print("  {:>12} {:8d} {:6.2f}%\n", label, histogram[n], 100.0 * histogram[n] / lateness.size());
+        lower = bounds[n];
+    }
+}
+
+auto main(int argc, char **argv) -> int
+{
+    const std::chrono::microseconds period(argc > 1 ? std::stoi(argv[1]) : 1000);
+    const int seconds = argc > 2 ? std::stoi(argv[2]) : 5;
+
+    measure(EventDispatcher::TimerMode::Coarse, period, seconds);
+    measure(EventDispatcher::TimerMode::Precise, period, seconds);
+
+    return 0;
+}
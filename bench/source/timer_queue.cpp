@@ -0,0 +1,84 @@
+/**
+ * @file timer_queue.cpp
+ *
+ * Measure EventDispatcher timer queue cost with many periodic timers,
+ * modelled on cyclic CAN transmit schedules.
+ *
+ * @code{.sh}
+ * bench_timer_queue 10000 3
+ * @endcode
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include <fmt/core.h>
+
+#include "dplib/core/EventDispatcher.h"
+#include "dplib/util/ElapsedTimer.h"
+
+#include <time.h>
+
+using datapanel::core::EventDispatcher;
+using datapanel::util::ElapsedTimer;
+
+static double cpuNs()
+{
+    timespec ts;
+    ::clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+auto main(int argc, char **argv) -> int
+{
+    const size_t count = argc > 1 ? std::stoul(argv[1]) : 10000;
+    const int seconds = argc > 2 ? std::stoi(argv[2]) : 3;
+    constexpr int periods[] = {10, 20, 50, 100};
+
+    EventDispatcher dispatcher;
+    std::vector<int> ids;
+    std::vector<uint64_t> fired(count, 0);
+    ids.reserve(count);
+
+    ElapsedTimer timer;
+    timer.start();
+    for (size_t n = 0; n < count; n++) {
+        ids.push_back(dispatcher.addTimer(periods[n % std::size(periods)], [&fired, n]() { fired[n]++; }));
+    }
+    const double addNs = timer.restart().count();
+
+    uint64_t wakeups = 0;
+    const double cpuStart = cpuNs();
+    ElapsedTimer total;
+    total.start();
+    while (total.elapsed().count() < seconds * 1e9) {
+        dispatcher.processEvents();
+        wakeups++;
+    }
+    const double runNs = total.elapsed().count();
+    const double cpuRunNs = cpuNs() - cpuStart;
+
+    uint64_t fires = 0;
+    double worstRatio = 1.0;
+    for (size_t n = 0; n < count; n++) {
+        fires += fired[n];
+        const double expected = runNs / 1e6 / periods[n % std::size(periods)];
+        worstRatio = std::min(worstRatio, fired[n] / expected);
+    }
+
+    timer.start();
+    for (int id : ids) dispatcher.removeTimer(id);
+    const double removeNs = timer.elapsed().count();
+
+    fmt::print("timers={} run={}s\n", count, seconds);
+    fmt::print("  addTimer     {:10.1f} ns/timer\n", addNs / count);
+    fmt::print("  removeTimer  {:10.1f} ns/timer\n", removeNs / count);
+    fmt::print("  fires        {:10d} ({:.0f}/s)\n", fires, fires / (runNs / 1e9));
+    fmt::print("  dispatch     {:10.1f} CPU ns/fire\n", cpuRunNs / std::max<uint64_t>(fires, 1));
+    fmt::print("  wakeups      {:10d}\n", wakeups);
+    fmt::print("  worst timer  {:10.3f} of expected fires\n", worstRatio);
+
+    return 0;
+}
@@ -0,0 +1,200 @@
+/**
+ * Copyright (c) 2026 Data Panel Corporation
+ * 181 Cheshire Ln, Suite 300
+ * Plymouth, MN 55441
+ * All rights reserved.
+ *
+ * This is the confidential and proprietary information of Data Panel
+ * Corporation. Such confidential information shall not be disclosed and is for
+ * use only in accordance with the license agreement you entered into with Data
+ * Panel.
+ */
+
+/**
+ * @file ChangeDetector.h
+ * @date 2026-10-16
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <sigslot/signal.hpp>
+
+#include "dplib/SignalDecoder.h"
+#include "dplib/net/can/CanFrame.h"
+#include "dplib/net/can/CanInterface.h"
+
+namespace datapanel
+{
+/**
+ * @brief Pass on only frames and signal values that changed
+ *
+ * Keeps the last payload of every identifier in a flat table allocated
+ * up front and compares each received payload with it, 64 bytes at a
+ * time with SSE2 (x86-64) or NEON (AArch64) and with memcmp() elsewhere.
+ * Frames whose length or payload differ, and the first frame of each
+ * identifier, are emitted through frameChanged; repeats are dropped.
+ * Error and remote request frames always pass.
+ *
+ * With a SignalDecoder set, changed frames are also decoded and every
+ * signal value that moved is emitted through valueChanged.  A signal's
+ * deadband suppresses changes up to that size, measured from the last
+ * value emitted, so slow drift is still reported once it adds up.
+ *
+ * @code
+ * ChangeDetector changes;
+ * changes.setDecoder(&decoder);
+ * changes.setDeadband("EEC1", "EngineSpeed", 5.0);
+ * changes.valueChanged.connect([](const can::CanFrame &frame, size_t slot, double value) { publish(slot, value); });
+ * changes.attach(*bus);
+ * @endcode
+ */
+class ChangeDetector
+{
+  public:
+    static constexpr size_t DefaultMaxIds = 2048; /**< Default number of identifiers tracked */
+
+    /**
+     * @brief Counters since construction
+     */
+    struct Statistics {
+        uint64_t frames = 0;        /**< Frames processed */
+        uint64_t changedFrames = 0; /**< Frames emitted through frameChanged */
+        uint64_t untracked = 0;     /**< Frames passed unchecked because the table was full */
+        uint64_t values = 0;        /**< Signal values decoded */
+        uint64_t changedValues = 0; /**< Values emitted through valueChanged */
+    };
+
+    /**
+     * @brief Emitted for each frame that differs from the previous one with its identifier
+     */
+    sigslot::signal<const net::can::CanFrame &> frameChanged;
+
+    /**
+     * @brief Emitted for each signal value that changed: frame, value slot, value
+     *
+     * The slot is the signal's index in the decoder's value array (see
+     * SignalDecoder::valueIndex()).
+     */
+    sigslot::signal<const net::can::CanFrame &, size_t, double> valueChanged;
+
+    /**
+     * @param[in] maxIds Number of identifiers whose last payload is kept
+     */
+    explicit ChangeDetector(size_t maxIds = DefaultMaxIds);
+
+    ChangeDetector(const ChangeDetector &) = delete;
+    ChangeDetector &operator=(const ChangeDetector &) = delete;
+
+    /**
+     * @brief Decode changed frames with @p decoder and report changed values
+     *
+     * Clears the deadbands and the last values.
+     *
+     * @param[in] decoder Compiled decoder, or nullptr to only compare
+     *            frames; must outlive the detector or the next call
+     */
+    void setDecoder(const SignalDecoder *decoder);
+
+    /**
+     * @brief Ignore changes of the value in @p slot up to @p deadband
+     *
+     * @return false if no decoder is set or @p slot is out of range
+     */
+    bool setDeadband(size_t slot, double deadband);
+
+    /**
+     * @brief Ignore changes of a signal up to @p deadband
+     *
+     * @return false if the decoder has no such signal
+     */
+    bool setDeadband(const std::string &message, const std::string &signal, double deadband);
+
+    /**
+     * @return Last value emitted for @p slot, NaN if none
+     */
+    double value(size_t slot) const
+    {
+        return m_values[slot];
+    }
+
+    /**
+     * @brief Receive every frame received by @p source
+     *
+     * The detector sees frames through net::can::CanInterface::framesTapped
+     * and leaves @p source's receive queue to the application.
+     *
+     * @param[in] source Interface to use; must outlive the detector or detach()
+     */
+    void attach(net::can::CanInterface &source);
+
+    /**
+     * @brief Stop using the interface given to attach()
+     */
+    void detach();
+
+    /**
+     * @brief Handle received frames
+     *
+     * @param[in] frames Received frames
+     * @param[in] count Number of frames
+     */
+    void process(const net::can::CanFrame *frames, size_t count);
+
+    /**
+     * @brief Handle one received frame
+     */
+    void process(const net::can::CanFrame &frame)
+    {
+        process(&frame, 1);
+    }
+
+    /**
+     * @brief Forget every last payload and value, so the next frame of each identifier counts as changed
+     */
+    void reset();
+
+    /**
+     * @return Counters since construction
+     */
+    const Statistics &statistics() const
+    {
+        return m_stats;
+    }
+
+  private:
+    static constexpr uint32_t EmptyKey = 0xFFFFFFFF; /**< Key of an unused index slot */
+
+    /** Last payload of one identifier, aligned for vector loads */
+    struct alignas(64) Payload {
+        uint8_t bytes[64];
+    };
+
+    struct Slot {
+        uint32_t key;   /**< Identifier, bit 31 set if extended, or EmptyKey */
+        uint32_t entry; /**< Index in m_payloads */
+        uint8_t length; /**< Length of the stored payload */
+    };
+
+    bool changed(const net::can::CanFrame &frame);
+    void emitValues(const net::can::CanFrame &frame);
+
+    /** Open addressing index of m_payloads, linear probing */
+    std::vector<Slot> m_index;
+    unsigned m_hashShift = 0;
+    std::vector<Payload> m_payloads;
+    size_t m_used = 0; /**< Entries of m_payloads in use */
+
+    const SignalDecoder *m_decoder = nullptr;
+    std::vector<double> m_decoded;   /**< Decoder output */
+    std::vector<double> m_values;    /**< Last value emitted per slot */
+    std::vector<double> m_deadbands; /**< Per slot, 0 to report any change */
+
+    sigslot::scoped_connection m_connection;
+    net::can::CanInterface *m_bus = nullptr;
+    Statistics m_stats;
+};
+}  // namespace datapanel
@@ -0,0 +1,105 @@
+/**
+ * Copyright (c) 2026 Data Panel Corporation
+ * 181 Cheshire Ln, Suite 300
+ * Plymouth, MN 55441
+ * All rights reserved.
+ *
+ * This is the confidential and proprietary information of Data Panel
+ * Corporation. Such confidential information shall not be disclosed and is for
+ * use only in accordance with the license agreement you entered into with Data
+ * Panel.
+ */
+
+/**
+ * @file DbcImporter.h
+ * @date 2026-10-16
+ */
+
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "dplib/Message.h"
+
+namespace datapanel
+{
+/**
+ * @brief Read message and signal definitions from a Vector DBC file
+ *
+ * Imports messages (BO_), their signals (SG_) including simple
+ * multiplexing, message and signal comments (CM_) and float signal
+ * types (SIG_VALTYPE_).  Other sections such as attributes and value
+ * tables are skipped.
+ *
+ * @code
+ * DbcImporter dbc;
+ * if (!dbc.load("vehicle.dbc"))
+ *     spdlog::error("vehicle.dbc:{}: {}", dbc.errorLine(), dbc.errorMessage());
+ * SignalDecoder decoder;
+ * decoder.compile(dbc.messages());
+ * @endcode
+ */
+class DbcImporter
+{
+  public:
+    /**
+     * @brief Import the DBC file at @p path
+     *
+     * @return false if the file cannot be read or is malformed (see
+     *         errorMessage() and errorLine())
+     */
+    bool load(const std::string &path);
+
+    /**
+     * @brief Import DBC text
+     *
+     * Replaces the messages of an earlier import.
+     *
+     * @return false if the text is malformed (see errorMessage() and errorLine())
+     */
+    bool parse(std::string_view text);
+
+    /**
+     * @return Messages in file order
+     */
+    const std::vector<Message> &messages() const
+    {
+        return m_messages;
+    }
+
+    /**
+     * @return The message with identifier @p id, or nullptr
+     */
+    const Message *message(uint32_t id, bool extended = false) const;
+
+    /**
+     * @return Description of the last failed import
+     */
+    const std::string &errorMessage() const
+    {
+        return m_errorMessage;
+    }
+
+    /**
+     * @return Line of the last import error, 0 if not caused by the text
+     */
+    int errorLine() const
+    {
+        return m_errorLine;
+    }
+
+  private:
+    bool parseMessage(std::string_view statement);
+    bool parseSignal(std::string_view statement);
+    bool parseComment(std::string_view statement);
+    bool parseValueType(std::string_view statement);
+    Message *findMessage(uint32_t dbcId);
+    bool fail(std::string message);
+
+    std::vector<Message> m_messages;
+    std::string m_errorMessage;
+    int m_errorLine = 0;
+};
+}  // namespace datapanel
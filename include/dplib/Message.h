@@ -0,0 +1,105 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "dplib/Signal.h"
+
+namespace datapanel
+{
+/**
+ * @brief A CAN message definition: identifier, size and the signals it carries
+ */
+class Message
+{
+  public:
+    uint32_t id() const
+    {
+        return m_id;
+    }
+    void setId(uint32_t id)
+    {
+        m_id = id;
+    }
+    bool isExtendedId() const
+    {
+        return m_extendedId;
+    }
+    void setExtendedId(bool extended)
+    {
+        m_extendedId = extended;
+    }
+    unsigned size() const
+    {
+        return m_size;
+    }
+    void setSize(unsigned size)
+    {
+        m_size = size;
+    }
+
+    std::string name() const
+    {
+        return m_name;
+    }
+
+    void setName(std::string name)
+    {
+        m_name = name;
+    }
+
+    std::string transmitter() const
+    {
+        return m_transmitter;
+    }
+
+    void setTransmitter(std::string transmitter)
+    {
+        m_transmitter = transmitter;
+    }
+
+    std::string comment() const
+    {
+        return m_comment;
+    }
+
+    void setComment(std::string comment)
+    {
+        m_comment = comment;
+    }
+
+    const std::vector<Signal> &signals() const
+    {
+        return m_signals;
+    }
+    std::vector<Signal> &signals()
+    {
+        return m_signals;
+    }
+    void addSignal(Signal signal)
+    {
+        m_signals.push_back(std::move(signal));
+    }
+
+    /**
+     * @return The signal named @p name, or nullptr
+     */
+    const Signal *signal(const std::string &name) const
+    {
+        for (const auto &s : m_signals)
+            if (s.name() == name)
+                return &s;
+        return nullptr;
+    }
+
+  private:
+    uint32_t m_id = 0;
+    bool m_extendedId = false;
+    unsigned m_size = 8;
+
+    std::string m_name;
+    std::string m_transmitter;
+    std::string m_comment;
+    std::vector<Signal> m_signals;
+};
+}  // namespace datapanel
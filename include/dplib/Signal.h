@@ -1,4 +1,5 @@
 #pragma once
+#include <cstdint>
 #include <limits>
 #include <string>
 
@@ -7,6 +8,27 @@ namespace datapanel
 class Signal
 {
   public:
+    /**
+     * @brief Bit order of a signal's raw value in the payload
+     */
+    enum class ByteOrder {
+        LittleEndian, /**< Intel: start bit is the least significant bit */
+        BigEndian,    /**< Motorola: start bit is the most significant bit, in DBC bit numbering */
+    };
+
+    /**
+     * @brief Interpretation of a signal's raw bits
+     */
+    enum class ValueType {
+        Unsigned, /**< Unsigned integer */
+        Signed,   /**< Two's complement integer */
+        Float,    /**< IEEE 754 single precision, 32 bits */
+        Double,   /**< IEEE 754 double precision, 64 bits */
+    };
+
+    /** Multiplex value of a signal present in every frame of its message */
+    static constexpr int NotMultiplexed = -1;
+
     double minimum() const
     {
         return m_minValue;
@@ -60,6 +82,73 @@ class Signal
         m_comment = name;
     }
 
+    unsigned startBit() const
+    {
+        return m_startBit;
+    }
+    void setStartBit(unsigned startBit)
+    {
+        m_startBit = startBit;
+    }
+    unsigned length() const
+    {
+        return m_length;
+    }
+    void setLength(unsigned length)
+    {
+        m_length = length;
+    }
+    ByteOrder byteOrder() const
+    {
+        return m_byteOrder;
+    }
+    void setByteOrder(ByteOrder byteOrder)
+    {
+        m_byteOrder = byteOrder;
+    }
+    ValueType valueType() const
+    {
+        return m_valueType;
+    }
+    void setValueType(ValueType valueType)
+    {
+        m_valueType = valueType;
+    }
+
+    std::string unit() const
+    {
+        return m_unit;
+    }
+
+    void setUnit(std::string unit)
+    {
+        m_unit = unit;
+    }
+
+    /**
+     * @return true if the signal selects which multiplexed signals a frame carries
+     */
+    bool isMultiplexor() const
+    {
+        return m_multiplexor;
+    }
+    void setMultiplexor(bool multiplexor)
+    {
+        m_multiplexor = multiplexor;
+    }
+
+    /**
+     * @return Multiplexor value of the frames carrying the signal, or NotMultiplexed
+     */
+    int multiplexValue() const
+    {
+        return m_multiplexValue;
+    }
+    void setMultiplexValue(int value)
+    {
+        m_multiplexValue = value;
+    }
+
   private:
     double m_minValue = std::numeric_limits<double>::min();
     double m_maxValue = std::numeric_limits<double>::max();
@@ -67,7 +156,15 @@ class Signal
     double m_scale = 1.0;
     double m_offset = 0;
 
+    unsigned m_startBit = 0;
+    unsigned m_length = 1;
+    ByteOrder m_byteOrder = ByteOrder::LittleEndian;
+    ValueType m_valueType = ValueType::Unsigned;
+    bool m_multiplexor = false;
+    int m_multiplexValue = NotMultiplexed;
+
     std::string m_name;
     std::string m_comment;
+    std::string m_unit;
 };
 }  // namespace datapanel
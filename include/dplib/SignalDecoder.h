@@ -0,0 +1,190 @@
+/**
+ * Copyright (c) 2026 Data Panel Corporation
+ * 181 Cheshire Ln, Suite 300
+ * Plymouth, MN 55441
+ * All rights reserved.
+ *
+ * This is the confidential and proprietary information of Data Panel
+ * Corporation. Such confidential information shall not be disclosed and is for
+ * use only in accordance with the license agreement you entered into with Data
+ * Panel.
+ */
+
+/**
+ * @file SignalDecoder.h
+ * @date 2026-10-16
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "dplib/Message.h"
+#include "dplib/net/can/CanFrame.h"
+
+namespace datapanel
+{
+/**
+ * @brief Decode the physical values of all signals of a frame
+ *
+ * compile() turns each message's signals into a flat table of
+ * load/shift/mask operations and indexes the messages by identifier in
+ * an open addressing table, searched for a collision-free (perfect)
+ * hash first.  decode() then looks up the frame's message and converts
+ * every signal without allocating.
+ *
+ * Values are written to a caller-owned array with one slot per signal,
+ * valueCount() in total; the signals of a message occupy consecutive
+ * slots starting at firstValue(), in the message's signal order.
+ * Multiplexed signals not carried by the frame, and signals beyond the
+ * end of a short frame, are set to NaN.
+ *
+ * @code
+ * SignalDecoder decoder;
+ * decoder.compile(dbc.messages());
+ * std::vector<double> values(decoder.valueCount());
+ * const long speed = decoder.valueIndex("EEC1", "EngineSpeed");
+ * if (decoder.decode(frame, values.data()) >= 0)
+ *     updateGauge(values[speed]);
+ * @endcode
+ */
+class SignalDecoder
+{
+  public:
+    /**
+     * @brief Build the decoding tables for @p messages
+     *
+     * Replaces the tables of an earlier compile().
+     *
+     * @return false if a signal does not fit in a 64-byte frame, a float
+     *         signal has the wrong length or two messages share an
+     *         identifier (see errorMessage())
+     */
+    bool compile(const std::vector<Message> &messages);
+
+    /**
+     * @return Number of messages compiled
+     */
+    size_t messageCount() const
+    {
+        return m_messages.size();
+    }
+
+    /**
+     * @return Number of value slots: all signals of all messages
+     */
+    size_t valueCount() const
+    {
+        return m_ops.size();
+    }
+
+    /**
+     * @return Index of the message with identifier @p id, or -1
+     */
+    int messageIndex(uint32_t id, bool extended) const noexcept;
+
+    /**
+     * @return Slot of the first signal of message @p message
+     */
+    size_t firstValue(int message) const
+    {
+        return m_messages[message].firstOp;
+    }
+
+    /**
+     * @return Number of signals of message @p message
+     */
+    size_t signalCount(int message) const
+    {
+        return m_messages[message].opCount;
+    }
+
+    /**
+     * @return Slot of signal @p signal of message @p message, or -1
+     */
+    long valueIndex(const std::string &message, const std::string &signal) const;
+
+    /**
+     * @brief Decode the signals of @p frame into @p values
+     *
+     * @param[in] frame Received frame
+     * @param[out] values valueCount() slots; only the frame's message's are written
+     *
+     * @return Index of the frame's message, or -1 if it has none
+     */
+    int decode(const net::can::CanFrame &frame, double *values) const noexcept
+    {
+        const auto payload = frame.payload();
+        return decode(frame.id(), frame.isExtendedId(), reinterpret_cast<const uint8_t *>(payload.data()),
+                      payload.size(), values);
+    }
+
+    /**
+     * @brief Decode the signals of a frame given by identifier and payload
+     */
+    int decode(uint32_t id, bool extended, const uint8_t *data, size_t size, double *values) const noexcept;
+
+    /**
+     * @return Description of the last failed compile()
+     */
+    const std::string &errorMessage() const
+    {
+        return m_errorMessage;
+    }
+
+  private:
+    static constexpr uint32_t EmptyKey = 0xFFFFFFFF; /**< Key of an unused index slot */
+
+    enum OpFlags : uint8_t {
+        BigEndian = 1, /**< Motorola bit order */
+        Wide = 2,      /**< Spans nine bytes: one more byte after the loaded word */
+        Float = 4,
+        Double = 8,
+        General = 16,  /**< Needs extract() and physical(): wide, floating point or 64-bit unsigned */
+    };
+
+    /** Extraction of one signal's raw value */
+    struct Op {
+        uint64_t mask;     /**< Low @ref Signal::length() bits */
+        uint64_t signBit;  /**< Top bit of a signed value, 0 otherwise */
+        double scale;
+        double offset;
+        int32_t multiplex; /**< Multiplexor value selecting the signal, or -1 */
+        uint8_t byte;      /**< First payload byte loaded */
+        uint8_t shift;     /**< Right shift of the loaded word, or left shift of a wide one */
+        uint8_t flags;     /**< OpFlags */
+        uint8_t endByte;   /**< Payload bytes needed */
+    };
+
+    struct Layout {
+        uint32_t key;        /**< Identifier, bit 31 set if extended */
+        uint32_t firstOp;
+        uint32_t opCount;
+        int32_t multiplexor; /**< Op of the multiplexor signal, or -1 */
+    };
+
+    struct Slot {
+        uint32_t key; /**< Layout::key, or EmptyKey */
+        int32_t message;
+    };
+
+    static uint64_t extract(const Op &op, const uint8_t *data) noexcept;
+    static double physical(const Op &op, uint64_t raw) noexcept;
+    void buildIndex();
+    void clear();
+    bool fail(std::string message);
+
+    std::vector<Op> m_ops;
+    std::vector<Layout> m_messages;
+    std::vector<std::string> m_names; /**< "message.signal" of each op */
+
+    /** Open addressing index of m_messages, linear probing */
+    std::vector<Slot> m_index;
+    uint64_t m_multiplier = 0;
+    unsigned m_hashShift = 0;
+
+    std::string m_errorMessage;
+};
+}  // namespace datapanel
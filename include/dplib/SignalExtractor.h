@@ -0,0 +1,132 @@
+/**
+ * Copyright (c) 2026 Data Panel Corporation
+ * 181 Cheshire Ln, Suite 300
+ * Plymouth, MN 55441
+ * All rights reserved.
+ *
+ * This is the confidential and proprietary information of Data Panel
+ * Corporation. Such confidential information shall not be disclosed and is for
+ * use only in accordance with the license agreement you entered into with Data
+ * Panel.
+ */
+
+/**
+ * @file SignalExtractor.h
+ * @date 2026-10-16
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "dplib/Message.h"
+#include "dplib/SignalDecoder.h"
+#include "dplib/net/can/CanFrame.h"
+
+namespace datapanel
+{
+/**
+ * @brief Extract signals from many frames of one message into columns
+ *
+ * For offline analysis of recorded traffic: given frames that all carry
+ * the compiled message, writes one column of physical values per
+ * signal.  Each column is produced in a single pass over the frames,
+ * four frames at a time with AVX2 gathers, shifts and masks and a fused
+ * multiply-add for scale and offset when the processor supports AVX2
+ * and FMA, and with a scalar loop otherwise.
+ *
+ * Integer signals of up to 52 bits (51 unsigned) that fit in eight
+ * bytes take that path.  Floating point, wider and nine-byte signals are
+ * decoded frame by frame with a SignalDecoder.  As with SignalDecoder,
+ * multiplexed signals a frame does not carry and signals beyond the end
+ * of a short frame are NaN.
+ *
+ * @code
+ * SignalExtractor extractor;
+ * extractor.compile(*dbc.message(0x100), {"EngineSpeed", "CoolantTemp"});
+ * std::vector<std::vector<float>> columns;
+ * extractor.extract(frames.data(), frames.size(), columns);
+ * @endcode
+ */
+class SignalExtractor
+{
+  public:
+    /**
+     * @brief Prepare extraction of signals of @p message
+     *
+     * @param[in] message Message the frames carry
+     * @param[in] signals Names of the signals to extract, in column
+     *            order; all signals of @p message if empty
+     *
+     * @return false if a signal is missing or cannot be decoded (see errorMessage())
+     */
+    bool compile(const Message &message, const std::vector<std::string> &signals = {});
+
+    /**
+     * @return Number of columns extract() produces
+     */
+    size_t signalCount() const
+    {
+        return m_columns.size();
+    }
+
+    /**
+     * @brief Extract every compiled signal from @p frames
+     *
+     * The frames' identifiers are not checked.
+     *
+     * @param[in] frames Frames of the compiled message
+     * @param[in] count Number of frames
+     * @param[out] columns Resized to signalCount() columns of @p count values
+     */
+    void extract(const net::can::CanFrame *frames, size_t count, std::vector<std::vector<double>> &columns) const;
+
+    /**
+     * @brief Extract every compiled signal from @p frames as single precision
+     */
+    void extract(const net::can::CanFrame *frames, size_t count, std::vector<std::vector<float>> &columns) const;
+
+    /**
+     * @return Name of the extraction kernel used on this processor: "AVX2" or "scalar"
+     */
+    static const char *implementation() noexcept;
+
+    /**
+     * @return Description of the last failed compile()
+     */
+    const std::string &errorMessage() const
+    {
+        return m_errorMessage;
+    }
+
+  private:
+    /** Load, shift and mask of a signal that fits in one 64-bit word */
+    struct Column {
+        uint64_t mask;
+        uint64_t signBit;  /**< Top bit of a signed value, 0 otherwise */
+        double scale;
+        double offset;
+        int32_t multiplex; /**< Multiplexor value selecting the signal, or -1 */
+        uint8_t byte;      /**< Payload byte the word is loaded from, at most 56 */
+        uint8_t shift;     /**< Right shift of the loaded word */
+        uint8_t endByte;   /**< Payload bytes needed */
+        bool bigEndian;
+        int general;       /**< Value slot in m_general, or -1 for the word path */
+    };
+
+    template <typename T>
+    void extractColumns(const net::can::CanFrame *frames, size_t count, std::vector<std::vector<T>> &columns) const;
+
+    std::vector<Column> m_columns;
+    Column m_multiplexor{}; /**< Valid if m_hasMultiplexor */
+    bool m_hasMultiplexor = false;
+    /** Decodes the signals the word path cannot */
+    SignalDecoder m_general;
+    uint32_t m_id = 0;
+    bool m_extendedId = false;
+
+    std::string m_errorMessage;
+};
+}  // namespace datapanel
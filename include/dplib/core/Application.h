@@ -17,9 +17,17 @@
  */
 
 #pragma once
+#include <deque>
+#include <functional>
+#include <map>
 #include <memory>
+#include <mutex>
 #include <string>
+#include <vector>
 
+#include <spdlog/spdlog.h>
+
+#include "dplib/core/Event.h"
 #include "dplib/core/EventDispatcher.h"
 #include "dplib/core/Platform.h"
 
@@ -28,7 +36,7 @@ namespace datapanel
 namespace core
 {
 
-class Event;
+class Object;
 
 /**
  * @brief High-level application
@@ -50,10 +58,18 @@ class Application
     {
         return platform->addTimer(periodMs, f);
     }
+    int addTimer(std::chrono::nanoseconds period, EventDispatcher::TimerFunc f)
+    {
+        return platform->addTimer(period, f);
+    }
     bool removeTimer(int id)
     {
         return platform->removeTimer(id);
     }
+    bool setTimerMode(EventDispatcher::TimerMode mode)
+    {
+        return platform->setTimerMode(mode);
+    }
 
     bool addFile(int fd, EventDispatcher::FileOperation op, EventDispatcher::FileFunc f)
     {
@@ -64,6 +80,59 @@ class Application
         return platform->removeFile(fd, op);
     }
 
+    /**
+     * @brief Dispatcher driven by the main thread
+     */
+    EventDispatcher &eventDispatcher()
+    {
+        return platform->eventDispatcher();
+    }
+
+    /**
+     * @brief Deliver an event immediately
+     *
+     * @param[in] receiver Object to receive the event
+     * @param[in] event Event to deliver; ownership stays with the caller
+     *
+     * @return Result of the receiver's Object::event()
+     */
+    bool sendEvent(Object *receiver, Event *event);
+
+    /**
+     * @brief Queue an event for delivery on the main thread
+     *
+     * May be called from any thread.  Queued events are delivered in
+     * batches, once per event loop iteration, highest priority first.
+     * Events posted while a batch is being delivered wait for the next
+     * batch.  If @p event is coalescible and a pending event with the
+     * same receiver, type and priority accepts it through
+     * Event::coalesce(), @p event is discarded.
+     *
+     * @param[in] receiver Object to receive the event
+     * @param[in] event Event to deliver
+     * @param[in] priority Delivery priority, see EventPriority
+     */
+    void postEvent(Object *receiver, std::unique_ptr<Event> event, int priority = NormalEventPriority);
+
+    /**
+     * @brief Deliver all events posted so far
+     *
+     * Called by run() and processEvents().
+     */
+    void sendPostedEvents();
+
+    /**
+     * @brief Discard all pending events posted to @p receiver
+     *
+     * @param[in] receiver Object whose events are discarded
+     */
+    void removePostedEvents(Object *receiver);
+
+    /**
+     * @return Number of events waiting in the posted event queue
+     */
+    size_t postedEventCount() const;
+
     Application(const Application &) = delete;
     void operator=(const Application &) = delete;
 
@@ -77,6 +146,19 @@ class Application
     Application();
     ~Application();
     std::unique_ptr<Platform> platform;
+
+    struct PostedEvent {
+        Object *receiver;
+        std::unique_ptr<Event> event;
+    };
+
+    mutable std::mutex m_postedMutex;
+    /** Pending events by priority, highest first */
+    std::map<int, std::deque<PostedEvent>, std::greater<int>> m_postedEvents;
+    size_t m_postedCount = 0;
+    /** Batch being delivered by sendPostedEvents() */
+    std::vector<PostedEvent> m_deliveryBatch;
+    bool m_delivering = false;
 };
 
 }  // namespace core
@@ -18,10 +18,33 @@
 
 #pragma once
 
+#include <cstddef>
+
 namespace datapanel
 {
 namespace core
 {
+
+/**
+ * @brief Delivery order of posted events
+ *
+ * Events with a higher priority are delivered first; events with equal
+ * priority are delivered in the order they were posted.  Any int may be
+ * used, these are just the common values.
+ */
+enum EventPriority {
+    LowEventPriority = -1,
+    NormalEventPriority = 0,
+    HighEventPriority = 1,
+};
+
+/**
+ * @brief Base class of events delivered to core::Object receivers
+ *
+ * Events are sent synchronously with Application::sendEvent() or queued
+ * with Application::postEvent().  Event objects are allocated from a
+ * per-thread pool, so posting an event does not normally reach malloc.
+ */
 class Event {
 public:
     enum class EventType {
@@ -39,10 +62,41 @@ public:
 
     inline void accept() { m_accept = true; }
     inline void reject() { m_accept = false;}
+    inline bool isAccepted() const { return m_accept; }
+
+    /**
+     * @return true while the event is waiting in the posted event queue
+     */
+    inline bool posted() const { return m_posted; }
+
+    /**
+     * @brief Merge a newer event for the same receiver into this pending one
+     *
+     * Called by Application::postEvent() for each pending event with the
+     * same receiver, type and priority, if @p newer is coalescible().
+     * Return true if this event now represents @p newer as well, in which
+     * case @p newer is discarded.  The default never coalesces.
+     *
+     * @param[in] newer Event being posted
+     *
+     * @return true if @p newer was merged
+     */
+    virtual bool coalesce(const Event &newer);
+
+    /**
+     * @return true if posting this event should look for a pending event to merge into
+     */
+    inline bool coalescible() const { return m_coalescible; }
 
     static int registerEventType(int hint = -1);
+
+    static void *operator new(std::size_t size);
+    static void operator delete(void *ptr, std::size_t size) noexcept;
+
 protected:
     EventType m_type;
+    /** Set by subclasses that override coalesce() */
+    bool m_coalescible = false;
 
 private:
     bool m_accept;
@@ -58,6 +112,11 @@ public:
     ~TimerEvent();
     int timerId() const  {return m_id;}
 
+    /**
+     * @brief A pending timer event absorbs later ticks of the same timer
+     */
+    bool coalesce(const Event &newer) override;
+
 protected:
     int m_id;
 };
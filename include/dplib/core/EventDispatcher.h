@@ -18,11 +18,17 @@
 
 #pragma once
 
+#include <atomic>
 #include <functional>
 #include <list>
 #include <map>
+#include <memory>
 #include <mutex>
 #include <chrono>
+#include <unordered_map>
+#include <vector>
+
+#include "dplib/util/MpscQueue.h"
 
 namespace datapanel
 {
@@ -30,13 +36,30 @@ namespace core
 {
 
 class Timer;
+
+/**
+ * @brief Event loop built on epoll
+ *
+ * Each dispatcher owns its own epoll set and is driven by one thread
+ * calling processEvents().  Other threads interact with it by posting
+ * tasks with post(), which wakes the loop through an eventfd.
+ */
 class EventDispatcher
 {
   public:
     enum FileOperation {Read, Write, Error};
 
+    /**
+     * @brief How the dispatcher waits for timers
+     */
+    enum class TimerMode {
+        Coarse,  /**< Timers wake the loop through the epoll timeout, with millisecond resolution */
+        Precise, /**< Timers wake the loop through a timerfd in the epoll set, with nanosecond resolution */
+    };
+
       using TimerFunc = std::function<void()>;
       using FileFunc = std::function<void()>;
+      using TaskFunc = std::function<void()>;
 
     explicit EventDispatcher();
     ~EventDispatcher();
@@ -44,40 +67,145 @@ class EventDispatcher
     virtual bool processEvents();
     virtual bool pendingEvents();
 
+    /**
+     * @brief Run a function on the dispatcher's thread
+     *
+     * May be called from any thread.  Tasks run in the order they were
+     * posted, during the next processEvents() call.
+     *
+     * @param[in] task Function to run
+     */
+    void post(TaskFunc task);
+
+    /**
+     * @brief Wake the dispatcher if it is waiting in processEvents()
+     *
+     * May be called from any thread.
+     */
+    void wakeUp();
+
+    /**
+     * @brief Make the current or next processEvents() call return as soon as possible
+     *
+     * May be called from any thread.  If no call is running, the next one
+     * returns false immediately without waiting, running tasks or firing
+     * timers.
+     */
+    void interrupt();
+
+    /**
+     * @brief Dispatcher whose processEvents() is running on the calling thread
+     *
+     * @return Current dispatcher, or nullptr if none
+     */
+    static EventDispatcher *current();
+
+    /**
+     * @brief Call a function periodically
+     *
+     * Periodic timers are re-armed from their previous expiry rather than
+     * from the time the callback ran, so they do not drift.  If the loop
+     * falls behind by more than a period, the missed expiries are skipped.
+     *
+     * @param[in] periodMs Period in milliseconds
+     * @param[in] f Function to call
+     *
+     * @return Timer id, used with removeTimer()
+     */
     int addTimer(int periodMs, TimerFunc f);
+
+    /**
+     * @brief Call a function periodically
+     *
+     * Sub-millisecond periods are only honored in TimerMode::Precise;
+     * in TimerMode::Coarse the loop wakes on millisecond boundaries.
+     *
+     * @param[in] period Period, e.g. `std::chrono::microseconds(250)`
+     * @param[in] f Function to call
+     *
+     * @return Timer id, used with removeTimer()
+     */
+    int addTimer(std::chrono::nanoseconds period, TimerFunc f);
+
+    /**
+     * @brief Cancel a timer
+     *
+     * It is safe to cancel a timer from within its own callback.
+     *
+     * @param[in] id Timer id returned by addTimer()
+     *
+     * @return true if the timer existed
+     */
     bool removeTimer(int id);
 
+    /**
+     * @brief Select how the dispatcher waits for timers
+     *
+     * @param[in] mode New timer mode
+     *
+     * @return false if a timerfd could not be created
+     */
+    bool setTimerMode(TimerMode mode);
+
+    /**
+     * @return Current timer mode
+     */
+    TimerMode timerMode() const
+    {
+        return m_timerMode;
+    }
+
+    /**
+     * @brief Call @p f whenever @p fd is ready for @p op
+     *
+     * A file descriptor may be registered once for each operation.  Read
+     * and Write handlers are also called when the descriptor reports an
+     * error or hang-up.
+     *
+     * @param[in] fd File descriptor to watch
+     * @param[in] op Operation to wait for
+     * @param[in] f Handler
+     *
+     * @return false if @p fd is already registered for @p op or cannot be watched
+     */
     bool addFile(int fd, FileOperation op, FileFunc f);
     bool removeFile(int fd, FileOperation op);
 
   protected:
-    bool m_interrupt;
+    using Clock = std::chrono::steady_clock;
+
+    std::atomic<bool> m_interrupt;
 
     struct TimerInfo {
         int id;
-        std::chrono::duration<int, std::chrono::milliseconds::period> period;
-        std::chrono::time_point<std::chrono::steady_clock> expiry;
-        std::function<void()> func;
-        TimerInfo(int id, int periodMs, TimerFunc func)
-        : id(id), func(func) {
-            period = std::chrono::milliseconds(periodMs);
-            expiry = std::chrono::steady_clock::now() + period;
-        }
-        bool operator<(const TimerInfo& rhs) const { return expiry < rhs.expiry;}
-        bool expired() const {
-            auto now = std::chrono::steady_clock::now();
-            return now >= expiry;
-        }
-        void fire() {
-            func();
-            expiry = std::chrono::steady_clock::now() + period;
-        }
+        Clock::duration period;
+        Clock::time_point expiry;
+        std::shared_ptr<TimerFunc> func; /**< Shared so a callback can outlive removeTimer() */
     };
 
-    std::list<TimerInfo> m_timers;
-    std::map<std::pair<int,FileOperation>, FileFunc> m_files;
+    int fireTimers();
+    void armTimerFd();
+    int runTasks();
+    uint32_t fileEvents(int fd) const;
+    void siftUp(size_t pos);
+    void siftDown(size_t pos);
+    void swapTimers(size_t a, size_t b);
+
+    /** Binary min-heap ordered by expiry */
+    std::vector<TimerInfo> m_timers;
+    /** Position of each timer id within m_timers */
+    std::unordered_map<int, size_t> m_timerIndex;
+    std::map<std::pair<int,FileOperation>, std::shared_ptr<FileFunc>> m_files;
     std::mutex m_mutex;
-    int m_epoll_fd;;
+    int m_epoll_fd;
+
+    std::atomic<TimerMode> m_timerMode{TimerMode::Coarse}; /**< Written under m_mutex */
+    int m_timer_fd = -1;
+    Clock::time_point m_timerFdExpiry; /**< Expiry the timerfd is currently armed for */
+
+    int m_wakeup_fd = -1;
+    std::atomic<bool> m_wakeupPending{false}; /**< Set while a write to m_wakeup_fd is unread */
+    util::MpscQueue<TaskFunc> m_tasks;
 };
 
 }  // namespace core
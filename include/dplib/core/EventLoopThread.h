@@ -0,0 +1,115 @@
+/**
+ * Copyright (c) 2026 Data Panel Corporation
+ * 181 Cheshire Ln, Suite 300
+ * Plymouth, MN 55441
+ * All rights reserved.
+ *
+ * This is the confidential and proprietary information of Data Panel
+ * Corporation. Such confidential information shall not be disclosed and is for
+ * use only in accordance with the license agreement you entered into with Data
+ * Panel.
+ */
+
+/**
+ * @file EventLoopThread.h
+ * @date 2026-10-16
+ */
+
+#pragma once
+
+#include <atomic>
+#include <string>
+#include <thread>
+
+#include "dplib/core/EventDispatcher.h"
+
+namespace datapanel
+{
+namespace core
+{
+
+/**
+ * @brief Thread running its own EventDispatcher
+ *
+ * Timers, files and CAN interfaces registered with dispatcher() are
+ * serviced on this thread.  Other threads hand work to it with
+ * `dispatcher().post()`.
+ *
+ * @code
+ * EventLoopThread loop("can0-rx");
+ * loop.setCpuAffinity(2);
+ * loop.start();
+ * bus->setEventDispatcher(&loop.dispatcher());
+ * bus->connect();
+ * @endcode
+ */
+class EventLoopThread
+{
+  public:
+    /**
+     * @param[in] name Thread name, truncated to 15 characters
+     */
+    explicit EventLoopThread(std::string name = "dplib-loop");
+
+    /**
+     * @brief Stops and joins the thread
+     */
+    ~EventLoopThread();
+
+    EventLoopThread(const EventLoopThread &) = delete;
+    EventLoopThread &operator=(const EventLoopThread &) = delete;
+
+    /**
+     * @brief Start running the event loop
+     *
+     * @return false if already running
+     */
+    bool start();
+
+    /**
+     * @brief Stop the event loop and wait for the thread to exit
+     *
+     * Tasks posted before stop() run before the thread exits.  Must not be
+     * called from the loop's own thread.
+     */
+    void stop();
+
+    /**
+     * @return true between start() and stop()
+     */
+    bool running() const
+    {
+        return m_running;
+    }
+
+    /**
+     * @brief Restrict the thread to one CPU
+     *
+     * May be called before or after start().
+     *
+     * @param[in] cpu CPU index, or -1 to allow all CPUs
+     *
+     * @return false if the affinity could not be applied
+     */
+    bool setCpuAffinity(int cpu);
+
+    /**
+     * @return Dispatcher driven by this thread
+     */
+    EventDispatcher &dispatcher()
+    {
+        return m_dispatcher;
+    }
+
+  private:
+    bool applyCpuAffinity();
+
+    EventDispatcher m_dispatcher;
+    std::thread m_thread;
+    std::string m_name;
+    std::atomic<bool> m_running{false};
+    int m_cpu = -1;
+};
+
+}  // namespace core
+}  // namespace datapanel
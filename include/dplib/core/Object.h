@@ -0,0 +1,89 @@
+/**
+ * Copyright (c) 2026 Data Panel Corporation
+ * 181 Cheshire Ln, Suite 300
+ * Plymouth, MN 55441
+ * All rights reserved.
+ *
+ * This is the confidential and proprietary information of Data Panel
+ * Corporation. Such confidential information shall not be disclosed and is for
+ * use only in accordance with the license agreement you entered into with Data
+ * Panel.
+ */
+
+/**
+ * @file Object.h
+ * @date 2026-10-16
+ */
+
+#pragma once
+
+#include <atomic>
+#include <vector>
+
+namespace datapanel
+{
+namespace core
+{
+
+class Event;
+class TimerEvent;
+
+/**
+ * @brief Receiver of events
+ *
+ * Subclasses override event() or one of the specialized handlers.
+ * Posted events are delivered on the application's main thread.
+ * Destroying an object discards any events still posted to it.
+ */
+class Object
+{
+  public:
+    Object();
+    virtual ~Object();
+
+    Object(const Object &) = delete;
+    Object &operator=(const Object &) = delete;
+
+    /**
+     * @brief Handle an event
+     *
+     * The default implementation dispatches TimerEvent to timerEvent().
+     *
+     * @param[in] event Event to handle
+     *
+     * @return true if the event was recognized and handled
+     */
+    virtual bool event(Event *event);
+
+    /**
+     * @brief Start a timer that posts a TimerEvent to this object
+     *
+     * Ticks that occur while a previous TimerEvent is still pending are
+     * coalesced into it.
+     *
+     * @param[in] periodMs Timer period in milliseconds
+     *
+     * @return Timer ID, as reported by TimerEvent::timerId()
+     */
+    int startTimer(int periodMs);
+
+    /**
+     * @brief Stop a timer started with startTimer()
+     *
+     * @param[in] id Timer ID
+     */
+    void killTimer(int id);
+
+  protected:
+    virtual void timerEvent(TimerEvent *event);
+
+  private:
+    /** Number of events in the posted event queue for this receiver */
+    std::atomic<int> m_postedEvents{0};
+    std::vector<int> m_timers;
+
+    friend class Application;
+};
+
+}  // namespace core
+}  // namespace datapanel
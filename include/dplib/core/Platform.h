@@ -56,10 +56,18 @@ class Platform
     {
         return m_eventDispatcher.addTimer(periodMs, f);
     }
+    int addTimer(std::chrono::nanoseconds period, EventDispatcher::TimerFunc f)
+    {
+        return m_eventDispatcher.addTimer(period, f);
+    }
     bool removeTimer(int id)
     {
         return m_eventDispatcher.removeTimer(id);
     }
+    bool setTimerMode(EventDispatcher::TimerMode mode)
+    {
+        return m_eventDispatcher.setTimerMode(mode);
+    }
 
     bool addFile(int fd, EventDispatcher::FileOperation op, EventDispatcher::FileFunc f)
     {
@@ -70,6 +78,11 @@ class Platform
         return m_eventDispatcher.removeFile(fd, op);
     }
 
+    EventDispatcher &eventDispatcher()
+    {
+        return m_eventDispatcher;
+    }
+
   protected:
     EventDispatcher m_eventDispatcher;
 };
@@ -0,0 +1,64 @@
+/**
+ * Copyright (c) 2026 Data Panel Corporation
+ * 181 Cheshire Ln, Suite 300
+ * Plymouth, MN 55441
+ * All rights reserved.
+ *
+ * This is the confidential and proprietary information of Data Panel
+ * Corporation. Such confidential information shall not be disclosed and is for
+ * use only in accordance with the license agreement you entered into with Data
+ * Panel.
+ */
+
+/**
+ * @file BitTiming.h
+ * @date 2026-10-16
+ */
+
+#pragma once
+
+#include <cstdint>
+
+#include "dplib/net/can/CanFrame.h"
+
+namespace datapanel
+{
+namespace net
+{
+namespace can
+{
+
+/**
+ * @brief Number of bit times a frame occupies on the bus
+ *
+ * Includes the worst-case number of stuff bits and the three-bit
+ * interframe space.  CAN FD frames are counted at a single bitrate;
+ * with bitrate switching the data phase is actually shorter.
+ *
+ * @param[in] frame Data or remote request frame
+ *
+ * @return Bit count
+ */
+constexpr uint32_t frameBitCount(const CanFrame &frame) noexcept
+{
+    // CRC delimiter, ACK slot and delimiter, end of frame, interframe space
+    constexpr uint32_t trailer = 1 + 2 + 7 + 3;
+
+    const uint32_t dataBits = frame.frameType() == CanFrame::RemoteRequestFrame ? 0 : 8 * frame.payloadSize();
+
+    if (!frame.isFD()) {
+        // SOF, identifier, RTR/SRR, IDE, reserved, DLC (+ 18-bit extension, RTR, reserved), CRC
+        const uint32_t stuffed = (frame.isExtendedId() ? 39 : 19) + dataBits + 15;
+        return stuffed + (stuffed - 1) / 4 + trailer;
+    }
+
+    // SOF, identifier, RRS/SRR, IDE, FDF, res, BRS, ESI, DLC (+ 18-bit extension)
+    const uint32_t stuffed = (frame.isExtendedId() ? 41 : 22) + dataBits;
+    // Stuff count and CRC, with a fixed stuff bit before every fourth bit
+    const uint32_t crc = 4 + (frame.payloadSize() > 16 ? 21 : 17);
+    return stuffed + (stuffed - 1) / 4 + crc + (crc + 3) / 4 + trailer;
+}
+
+}  // namespace can
+}  // namespace net
+}  // namespace datapanel
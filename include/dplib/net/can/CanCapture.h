@@ -0,0 +1,451 @@
+/**
+ * Copyright (c) 2026 Data Panel Corporation
+ * 181 Cheshire Ln, Suite 300
+ * Plymouth, MN 55441
+ * All rights reserved.
+ *
+ * This is the confidential and proprietary information of Data Panel
+ * Corporation. Such confidential information shall not be disclosed and is for
+ * use only in accordance with the license agreement you entered into with Data
+ * Panel.
+ */
+
+/**
+ * @file CanCapture.h
+ * @date 2026-10-16
+ *
+ * Binary capture files.  A capture is a file header followed by
+ * independent chunks of encoded frames, an index of the chunks, and a
+ * fixed-size trailer pointing at the index:
+ *
+ * | Part          | Contents                                               |
+ * |---------------|--------------------------------------------------------|
+ * | File header   | Magic, format version, creation time                   |
+ * | Chunk         | CanCaptureChunk header, then the (compressed) records  |
+ * | ...           |                                                        |
+ * | Index         | One CanCaptureIndexEntry per chunk                     |
+ * | Trailer       | Index offset, chunk count, magic                       |
+ *
+ * Each chunk header carries the chunk's timestamp range and a bloom
+ * filter of its CAN identifiers, so readers can skip chunks by time or
+ * ID without decompressing them.  A file whose writer never closed it
+ * has no trailer; readers then recover every complete chunk by walking
+ * the chunk headers from the start.
+ *
+ * Records inside a chunk are a flags byte, the timestamp as a zigzag
+ * varint delta from the previous record, the identifier (or error mask)
+ * as a varint, the payload length and the payload.  All fields are
+ * little-endian.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <vector>
+
+#include <sigslot/signal.hpp>
+
+#include "dplib/net/can/CanFrame.h"
+#include "dplib/net/can/CanInterface.h"
+
+namespace datapanel
+{
+namespace net
+{
+namespace can
+{
+
+/**
+ * @brief Chunk header, as stored in front of each chunk and in the index
+ */
+struct CanCaptureChunk {
+    static constexpr uint32_t Magic = 0x4B435044; /**< "DPCK" */
+
+    /**
+     * @brief Record block encoding
+     */
+    enum Compression : uint8_t {
+        None = 0, /**< Records stored as is */
+        Lz4 = 1,  /**< Records stored as one LZ4 block */
+    };
+
+    uint32_t magic = Magic;
+    uint8_t compression = None;
+    uint8_t reserved[3] = {};
+    uint32_t frameCount = 0; /**< Number of records */
+    uint32_t storedSize = 0; /**< Bytes following the header */
+    uint32_t rawSize = 0;    /**< Bytes of records after decompression */
+    uint32_t reserved2 = 0;
+    int64_t firstNs = std::numeric_limits<int64_t>::max(); /**< Earliest timestamp in the chunk */
+    int64_t lastNs = std::numeric_limits<int64_t>::min();  /**< Latest timestamp in the chunk */
+    uint64_t idBloom[4] = {};                              /**< 256-bit bloom filter of identifiers */
+
+    /**
+     * @brief Add an identifier to the bloom filter
+     */
+    void addId(CanFrame::FrameId id) noexcept
+    {
+        const uint32_t h = bloomHash(id);
+        idBloom[(h >> 30) & 3] |= uint64_t(1) << ((h >> 24) & 63);
+        idBloom[(h >> 14) & 3] |= uint64_t(1) << ((h >> 8) & 63);
+    }
+
+    /**
+     * @return false if no frame with @p id is in the chunk; true if one may be
+     */
+    bool mayContain(CanFrame::FrameId id) const noexcept
+    {
+        const uint32_t h = bloomHash(id);
+        return (idBloom[(h >> 30) & 3] & (uint64_t(1) << ((h >> 24) & 63))) &&
+               (idBloom[(h >> 14) & 3] & (uint64_t(1) << ((h >> 8) & 63)));
+    }
+
+  private:
+    static constexpr uint32_t bloomHash(CanFrame::FrameId id) noexcept
+    {
+        uint32_t h = static_cast<uint32_t>(id) * 0x9E3779B1u;
+        return h ^ (h >> 15);
+    }
+};
+
+static_assert(sizeof(CanCaptureChunk) == 72, "Capture chunk header layout changed");
+
+/**
+ * @brief Index entry locating one chunk
+ */
+struct CanCaptureIndexEntry {
+    uint64_t offset; /**< File offset of the chunk header */
+    CanCaptureChunk chunk;
+};
+
+/**
+ * @brief Selects the frames a CanCaptureReader returns
+ */
+struct CanCaptureFilter {
+    int64_t fromNs = std::numeric_limits<int64_t>::min(); /**< Earliest timestamp, inclusive */
+    int64_t toNs = std::numeric_limits<int64_t>::max();   /**< Latest timestamp, exclusive */
+    std::vector<CanFrame::FrameId> ids;                   /**< Identifiers to return, or empty for all frames */
+};
+
+/**
+ * @brief Stream frames into a capture file
+ *
+ * Frames are encoded into an in-memory chunk, which is compressed and
+ * written once it holds about chunkSize bytes of records.  close()
+ * writes the last chunk and the index.  Frames should be written in
+ * roughly increasing timestamp order for time seeks to skip well.
+ *
+ * @code
+ * auto bus = CanBus::create("SocketCAN", "can0");
+ * CanCaptureWriter capture;
+ * capture.open("can0.dpcap");
+ * capture.attach(*bus);
+ * bus->connect();
+ * @endcode
+ */
+class CanCaptureWriter
+{
+  public:
+    static constexpr size_t DefaultChunkSize = 256 * 1024;   /**< Record bytes collected before a chunk is written */
+    static constexpr size_t MaxChunkSize = 64 * 1024 * 1024; /**< Largest chunkSize open() accepts */
+
+    CanCaptureWriter() = default;
+    ~CanCaptureWriter();
+
+    CanCaptureWriter(const CanCaptureWriter &) = delete;
+    CanCaptureWriter &operator=(const CanCaptureWriter &) = delete;
+
+    /**
+     * @brief Create or truncate a capture file
+     *
+     * @param[in] path File to write
+     * @param[in] compression Encoding for chunks; a chunk that does not
+     *            shrink is stored uncompressed regardless
+     * @param[in] chunkSize Record bytes per chunk, at most MaxChunkSize
+     *
+     * @return false if the file could not be created
+     */
+    bool open(const std::string &path, CanCaptureChunk::Compression compression = CanCaptureChunk::Lz4,
+              size_t chunkSize = DefaultChunkSize);
+
+    /**
+     * @brief Write the pending chunk, the index and the trailer
+     *
+     * @return false if writing failed
+     */
+    bool close();
+
+    /**
+     * @return true between open() and close()
+     */
+    bool isOpen() const
+    {
+        return _fd >= 0;
+    }
+
+    /**
+     * @brief Append frames
+     *
+     * Once a chunk could not be written the capture is failed() and
+     * nothing more is written; the frames of that chunk and any after it
+     * are lost.
+     *
+     * @param[in] frames Frames to append
+     * @param[in] count Number of frames
+     *
+     * @return false if a chunk could not be written, now or earlier
+     */
+    bool write(const CanFrame *frames, size_t count);
+
+    /**
+     * @brief Append one frame
+     */
+    bool write(const CanFrame &frame)
+    {
+        return write(&frame, 1);
+    }
+
+    /**
+     * @brief Write the pending frames as a chunk now
+     *
+     * Readers of a file that is still being written see frames once
+     * their chunk is written.
+     *
+     * @return false if writing failed
+     */
+    bool flush();
+
+    /**
+     * @brief Capture every frame received by @p source
+     *
+     * The writer taps @p source (CanInterface::framesTapped), leaving its
+     * receive queue to the application.  Check failed() to find out
+     * whether every frame reached the file.
+     *
+     * @param[in] source Interface to capture; must outlive the writer or detach()
+     */
+    void attach(CanInterface &source);
+
+    /**
+     * @brief Stop capturing the interface given to attach()
+     */
+    void detach();
+
+    /**
+     * @return Number of frames in chunks written to the file since open()
+     */
+    uint64_t framesWritten() const
+    {
+        return _framesWritten;
+    }
+
+    /**
+     * @return true if writing failed since open(); errorMessage() says why
+     */
+    bool failed() const
+    {
+        return _failed;
+    }
+
+    /**
+     * @return Number of chunks written since open()
+     */
+    size_t chunksWritten() const
+    {
+        return _index.size();
+    }
+
+    /**
+     * @return Description of the last failure
+     */
+    const std::string &errorMessage() const
+    {
+        return _errorMessage;
+    }
+
+  private:
+    bool writeAll(const void *data, size_t size);
+
+    int _fd = -1;
+    uint64_t _offset = 0;
+    CanCaptureChunk::Compression _compression = CanCaptureChunk::Lz4;
+    size_t _chunkSize = DefaultChunkSize;
+
+    CanCaptureChunk _chunk;          /**< Header of the chunk being filled */
+    std::vector<std::byte> _records; /**< Encoded records of the chunk being filled */
+    std::vector<std::byte> _packed;  /**< Compression output */
+    int64_t _previousNs = 0;
+
+    std::vector<CanCaptureIndexEntry> _index;
+    uint64_t _framesWritten = 0;
+    bool _failed = false; /**< A write failed; the file ends in a partial chunk */
+
+    sigslot::scoped_connection _connection;
+    std::string _errorMessage;
+};
+
+/**
+ * @brief Read a capture file through a memory mapping
+ *
+ * Frames are returned in file order.  Chunks whose timestamp range lies
+ * outside the filter, or whose bloom filter rules out every requested
+ * identifier, are skipped without being decompressed; uncompressed
+ * chunks are decoded straight from the mapping.
+ *
+ * @code
+ * CanCaptureReader capture;
+ * capture.open("can0.dpcap");
+ * capture.setFilter({start, start + 1000000000, {0x18FEF100}});
+ * CanFrame frame;
+ * while (capture.next(frame)) process(frame);
+ * @endcode
+ */
+class CanCaptureReader
+{
+  public:
+    CanCaptureReader() = default;
+    ~CanCaptureReader();
+
+    CanCaptureReader(const CanCaptureReader &) = delete;
+    CanCaptureReader &operator=(const CanCaptureReader &) = delete;
+
+    /**
+     * @brief Map a capture file and load its index
+     *
+     * @param[in] path File to read
+     *
+     * @return false if the file is not a capture file
+     */
+    bool open(const std::string &path);
+
+    /**
+     * @brief Unmap the file
+     */
+    void close();
+
+    /**
+     * @return true between open() and close()
+     */
+    bool isOpen() const
+    {
+        return _data != nullptr;
+    }
+
+    /**
+     * @return true if the file has no trailer and the index was rebuilt by scanning
+     */
+    bool isRecovered() const
+    {
+        return _recovered;
+    }
+
+    /**
+     * @return Number of chunks in the file
+     */
+    size_t chunkCount() const
+    {
+        return _index.size();
+    }
+
+    /**
+     * @return Header of chunk @p n
+     */
+    const CanCaptureChunk &chunk(size_t n) const
+    {
+        return _index[n].chunk;
+    }
+
+    /**
+     * @return Number of frames in the file
+     */
+    uint64_t frameCount() const;
+
+    /**
+     * @return Earliest frame timestamp in the file, ns
+     */
+    int64_t startNs() const;
+
+    /**
+     * @return Latest frame timestamp in the file, ns
+     */
+    int64_t endNs() const;
+
+    /**
+     * @brief Select frames and rewind to the start
+     *
+     * @param[in] filter Frames to return
+     */
+    void setFilter(const CanCaptureFilter &filter);
+
+    /**
+     * @brief Continue from the first selected frame at or after @p ns
+     *
+     * Chunks that end before @p ns are skipped with a binary search of
+     * the index.
+     *
+     * @param[in] ns Timestamp to seek to
+     */
+    void seek(int64_t ns);
+
+    /**
+     * @brief Read the next selected frame
+     *
+     * @param[out] frame Next frame
+     *
+     * @return false at the end of the file or if a chunk is corrupt
+     */
+    bool next(CanFrame &frame);
+
+    /**
+     * @brief Read up to @p count selected frames
+     *
+     * @return Number of frames read
+     */
+    size_t read(CanFrame *frames, size_t count);
+
+    /**
+     * @return Number of chunks decoded since open()
+     */
+    uint64_t chunksDecoded() const
+    {
+        return _chunksDecoded;
+    }
+
+    /**
+     * @return Description of the last failure
+     */
+    const std::string &errorMessage() const
+    {
+        return _errorMessage;
+    }
+
+  private:
+    bool loadIndex();
+    bool wanted(const CanCaptureChunk &chunk) const;
+    bool loadChunk(size_t n);
+
+    const std::byte *_data = nullptr;
+    size_t _size = 0;
+    bool _recovered = false;
+    std::vector<CanCaptureIndexEntry> _index;
+    std::vector<int64_t> _lastNsUpTo; /**< Running maximum of chunk lastNs, for seeking */
+
+    CanCaptureFilter _filter;
+    std::vector<CanFrame::FrameId> _ids; /**< Sorted filter identifiers */
+    int64_t _fromNs = std::numeric_limits<int64_t>::min();
+
+    size_t _nextChunk = 0;                 /**< Next chunk to consider */
+    std::vector<std::byte> _buffer;        /**< Decompressed records */
+    const std::byte *_cursor = nullptr;    /**< Next record in the current chunk */
+    const std::byte *_chunkEnd = nullptr;  /**< End of the current chunk's records */
+    int64_t _previousNs = 0;
+    uint64_t _chunksDecoded = 0;
+
+    std::string _errorMessage;
+};
+
+}  // namespace can
+}  // namespace net
+}  // namespace datapanel
@@ -0,0 +1,89 @@
+/**
+ * Copyright (c) 2026 Data Panel Corporation
+ * 181 Cheshire Ln, Suite 300
+ * Plymouth, MN 55441
+ * All rights reserved.
+ *
+ * This is the confidential and proprietary information of Data Panel
+ * Corporation. Such confidential information shall not be disclosed and is for
+ * use only in accordance with the license agreement you entered into with Data
+ * Panel.
+ */
+
+/**
+ * @file CanFilter.h
+ * @date 2026-10-16
+ */
+
+#pragma once
+
+#include <cstdint>
+
+#include "dplib/net/can/CanFrame.h"
+
+namespace datapanel
+{
+namespace net
+{
+namespace can
+{
+
+/**
+ * @brief Receive filter for data and remote request frames
+ *
+ * A frame matches when `(frame.id() & mask) == (id & mask)` and the
+ * frame also satisfies the format and frame type constraints.  An
+ * inverted filter matches every frame the plain filter would not.
+ * Semantics are those of SocketCAN's `CAN_RAW_FILTER`.
+ *
+ * @code
+ * // Only 0x100-0x10F in 11-bit format
+ * CanFilter filter{0x100, 0x7F0, CanFilter::BaseFormat};
+ * @endcode
+ */
+struct CanFilter {
+    /**
+     * @brief Identifier formats matched by a filter
+     */
+    enum FrameFormat {
+        AnyFormat,      /**< 11-bit and 29-bit identifiers */
+        BaseFormat,     /**< 11-bit identifiers only */
+        ExtendedFormat, /**< 29-bit identifiers only */
+    };
+
+    /**
+     * @brief Frame types matched by a filter
+     */
+    enum FrameTypes {
+        AnyFrameType,      /**< Data and remote request frames */
+        DataFrames,        /**< Data frames only */
+        RemoteRequestOnly, /**< Remote request frames only */
+    };
+
+    CanFrame::FrameId id = 0;   /**< Identifier to compare against */
+    CanFrame::FrameId mask = 0; /**< Identifier bits that must match; 0 matches every identifier */
+    FrameFormat format = AnyFormat;
+    FrameTypes types = AnyFrameType;
+    bool inverted = false; /**< Match frames the filter would otherwise reject */
+
+    /**
+     * @brief Test a data or remote request frame against this filter
+     *
+     * @param[in] frame Received frame
+     *
+     * @return true if @p frame passes
+     */
+    constexpr bool matches(const CanFrame &frame) const noexcept
+    {
+        bool match = ((frame.id() ^ id) & mask & CAN_EFF_MASK) == 0;
+        if (format != AnyFormat)
+            match = match && (frame.isExtendedId() == (format == ExtendedFormat));
+        if (types != AnyFrameType)
+            match = match && ((frame.frameType() == CanFrame::RemoteRequestFrame) == (types == RemoteRequestOnly));
+        return match != inverted;
+    }
+};
+
+}  // namespace can
+}  // namespace net
+}  // namespace datapanel
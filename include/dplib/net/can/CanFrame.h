@@ -21,15 +21,20 @@
 #include <fmt/chrono.h>
 #include <fmt/core.h>
 
+#include <algorithm>
+#include <array>
 #include <chrono>
 #include <cstdint>
 #include <cstddef>
+#include <cstring>
 #include <vector>
 #include <iostream>
 #include <stdexcept>
 #include <string>
+#include <type_traits>
 #include <bits/types/struct_FILE.h>
 
+#include "dplib/util/ByteView.h"
 #include "dplib/util/hexdump.h"
 
 namespace datapanel
@@ -45,12 +50,17 @@ constexpr uint32_t CAN_EFF_UPPER_MASK = 0x1FFFF800U; /**< Upper 18 bits of 29-bi
 
 /**
  * @brief Represent a single CAN message frame
+ *
+ * The payload is stored inline, so creating, copying and reading frames
+ * never allocates memory.
  */
 class CanFrame
 {
   public:
     using FrameId = uint64_t;
 
+    static constexpr size_t MaxPayloadSize = 64; /**< Largest payload of a CAN FD frame */
+
     /**
      * @brief Moment in time when the frame was received or transmitted
      *
@@ -59,36 +69,47 @@ class CanFrame
     class Timestamp
     {
       public:
-        constexpr Timestamp(int64_t s = 0, int64_t ns = 0) noexcept : _seconds(s), _nanoseconds(ns)
+        /**
+         * @param[in] s Seconds since epoch
+         * @param[in] ns Nanoseconds added to @p s; carried into the seconds
+         *            so that nanoseconds() is always in [0, 1e9), also
+         *            before the epoch
+         */
+        constexpr Timestamp(int64_t s = 0, int64_t ns = 0) noexcept
+            : _seconds(s + ns / 1000000000), _nanoseconds(ns % 1000000000)
         {
+            if (_nanoseconds < 0) {
+                _seconds--;
+                _nanoseconds += 1000000000;
+            }
         }
 
         /**
          * @brief Create a timesamp from a number of nanoseconds
          *
-         * @param[in] ns Nanoseconds since epoch
+         * @param[in] ns Nanoseconds since epoch, negative before the epoch
          *
          * @return A new timestamp
          */
-        constexpr static Timestamp fromNanoseconds(uint64_t ns) noexcept
+        constexpr static Timestamp fromNanoseconds(int64_t ns) noexcept
         {
-            return Timestamp(ns / 1000000000, ns % 1000000000);
+            return Timestamp(0, ns);
         }
 
         /**
          * @brief Create a timestamp from a number of microseconds
          *
-         * @param[in] us Microseconds since epoch
+         * @param[in] us Microseconds since epoch, negative before the epoch
          *
          * @return A new timestamp
          */
-        constexpr static Timestamp fromMicroseconds(uint64_t us) noexcept
+        constexpr static Timestamp fromMicroseconds(int64_t us) noexcept
         {
-            return Timestamp(us / 1000000, us % 1000000);
+            return Timestamp(us / 1000000, (us % 1000000) * 1000);
         }
 
         /**
-         * @brief Integer portion of timestamp
+         * @brief Integer portion of timestamp, rounded towards negative infinity
          *
          * @return Number of integer seconds
          */
@@ -100,13 +121,23 @@ class CanFrame
         /**
          * @brief Fractional portion of timestamp
          *
-         * @return Number of nanoseconds
+         * @return Number of nanoseconds, in [0, 1e9)
          */
         constexpr int64_t nanoseconds() const noexcept
         {
             return _nanoseconds;
         }
 
+        /**
+         * @brief Whole timestamp in nanoseconds
+         *
+         * @return Nanoseconds since epoch
+         */
+        constexpr int64_t toNanoseconds() const noexcept
+        {
+            return _seconds * 1000000000 + _nanoseconds;
+        }
+
       private:
         int64_t _seconds;
         int64_t _nanoseconds;
@@ -124,9 +155,8 @@ class CanFrame
     };
 
     explicit CanFrame(FrameType type = DataFrame) noexcept
-        : _isExtendedId(false), _isErrorState(false), _isFD(false), _isBRS(false), _isEcho(false)
+        : _id(0), _type(DataFrame), _flags(FlagValidId), _length(0), _reserved(0), _timestampNs(0), _payload{}
     {
-        setId(0);
         setFrameType(type);
     }
 
@@ -148,16 +178,11 @@ class CanFrame
         AnyError = CAN_EFF_MASK,
     };
 
-    explicit CanFrame(CanFrame::FrameId id, const std::vector<std::byte> &data)
-        : _type(DataFrame),
-          _isExtendedId(false),
-          _isErrorState(false),
-          _isFD(data.size() > 8),
-          _isBRS(0),
-          _isEcho(0),
-          _payload(data)
+    explicit CanFrame(CanFrame::FrameId id, util::ByteView data) noexcept
+        : _id(0), _type(DataFrame), _flags(0), _length(0), _reserved(0), _timestampNs(0), _payload{}
     {
         setId(id);
+        setPayload(data);
     }
 
     /**
@@ -172,7 +197,8 @@ class CanFrame
      *    if the frame is a flexible data rate frame, or 8 or less if
      *    the frame is a classic CAN frame.
      * 5. Do not have the RTR bit set if the frame is a CANFD frame.
-     * 6. All other frames are invalid.
+     * 6. Were not given a payload longer than MaxPayloadSize.
+     * 7. All other frames are invalid.
      *
      * @return true if the frame is valid, or false if invalid
      */
@@ -182,14 +208,17 @@ class CanFrame
             return false;
 
         // Check for 29-bit ID used with 11-bit frame
-        if (!_isExtendedId && (_id & CAN_EFF_UPPER_MASK))
+        if (!isExtendedId() && (_id & CAN_EFF_UPPER_MASK))
+            return false;
+
+        if (!(_flags & FlagValidId))
             return false;
 
-        if (!_isValidId)
+        if (_flags & FlagOversized)
             return false;
 
-        const size_t len = _payload.size();
-        if (_isFD) {
+        const size_t len = _length;
+        if (isFD()) {
             // FD frames can have 8, 12, 16, 20, 24, 32, 48, or 64 bytes
             if (_type == RemoteRequestFrame)
                 return false;  // FD doesn't support RTR
@@ -204,7 +233,7 @@ class CanFrame
      */
     constexpr FrameType frameType() const noexcept
     {
-        return _type;
+        return static_cast<FrameType>(_type);
     }
 
     /**
@@ -228,7 +257,7 @@ class CanFrame
      */
     constexpr bool isExtendedId() const noexcept
     {
-        return _isExtendedId;
+        return _flags & FlagExtendedId;
     }
 
     /**
@@ -238,7 +267,7 @@ class CanFrame
      */
     constexpr void setExtendedId(bool isExtended) noexcept
     {
-        _isExtendedId = isExtended;
+        setFlag(FlagExtendedId, isExtended);
     }
 
     /**
@@ -265,11 +294,12 @@ class CanFrame
     constexpr void setId(CanFrame::FrameId newId)
     {
         if (newId <= CAN_EFF_MASK) {
-            _isValidId = true;
-            _id = newId;
-            setExtendedId(_isExtendedId || (newId & CAN_EFF_UPPER_MASK));
+            setFlag(FlagValidId, true);
+            _id = static_cast<uint32_t>(newId);
+            if (newId & CAN_EFF_UPPER_MASK)
+                setExtendedId(true);
         } else {
-            _isValidId = false;
+            setFlag(FlagValidId, false);
             _id = 0;
         }
     }
@@ -277,23 +307,72 @@ class CanFrame
     /**
      * @brief Data contents of frame
      *
-     * @return Frame payload data
+     * The view refers to storage inside the frame and is only valid
+     * while the frame exists and its payload is unchanged.
+     *
+     * @return View of frame payload data
+     */
+    util::ByteView payload() const noexcept
+    {
+        return util::ByteView(_payload.data(), _length);
+    }
+
+    /**
+     * @brief Number of payload bytes
+     *
+     * @return Payload length
+     */
+    constexpr size_t payloadSize() const noexcept
+    {
+        return _length;
+    }
+
+    /**
+     * @brief Change payload
+     *
+     * A payload longer than MaxPayloadSize is rejected: the frame is
+     * left empty and invalid until a payload that fits is set.
+     *
+     * @param[in] data New frame payload data
+     * @param[in] size Number of bytes in @p data
+     * @return true if the payload was stored, or false if it is too long
+     */
+    bool setPayload(const std::byte *data, size_t size) noexcept
+    {
+        if (size > MaxPayloadSize) {
+            _length = 0;
+            setFlag(FlagOversized, true);
+            return false;
+        }
+        setFlag(FlagOversized, false);
+        _length = static_cast<uint8_t>(size);
+        if (_length > 0)
+            std::memcpy(_payload.data(), data, _length);
+        if (_length > 8)
+            setFlag(FlagFD, true);
+        return true;
+    }
+
+    /**
+     * @brief Change payload
+     *
+     * @param[in] data New frame payload data
+     * @return true if the payload was stored, or false if it is too long
      */
-    std::vector<std::byte> payload() const
+    bool setPayload(util::ByteView data) noexcept
     {
-        return _payload;
+        return setPayload(data.data(), data.size());
     }
 
     /**
      * @brief Change payload
      *
      * @param[in] data New frame payload data
+     * @return true if the payload was stored, or false if it is too long
      */
-    void setPayload(const std::vector<std::byte> &data)
+    bool setPayload(const std::vector<std::byte> &data) noexcept
     {
-        _payload = data;
-        if (data.size() > 8)
-            _isFD = 0x1;
+        return setPayload(data.data(), data.size());
     }
 
     /**
@@ -303,7 +382,7 @@ class CanFrame
      */
     constexpr Timestamp timestamp() const noexcept
     {
-        return _timestamp;
+        return Timestamp::fromNanoseconds(_timestampNs);
     }
 
     /**
@@ -313,7 +392,27 @@ class CanFrame
      */
     constexpr void setTimestamp(Timestamp ts) noexcept
     {
-        _timestamp = ts;
+        _timestampNs = ts.toNanoseconds();
+    }
+
+    /**
+     * @brief Time frame was received
+     *
+     * @return Nanoseconds since epoch
+     */
+    constexpr int64_t timestampNs() const noexcept
+    {
+        return _timestampNs;
+    }
+
+    /**
+     * @brief Change timestamp
+     *
+     * @param ns Nanoseconds since epoch
+     */
+    constexpr void setTimestampNs(int64_t ns) noexcept
+    {
+        _timestampNs = ns;
     }
 
     /**
@@ -349,7 +448,7 @@ class CanFrame
      */
     constexpr bool isFD() const noexcept
     {
-        return _isFD;
+        return _flags & FlagFD;
     };
 
     /**
@@ -359,11 +458,9 @@ class CanFrame
      */
     constexpr void setFD(bool isFD) noexcept
     {
-        _isFD = isFD;
-        if (!isFD) {
-            _isBRS = false;
-            _isErrorState = false;
-        }
+        setFlag(FlagFD, isFD);
+        if (!isFD)
+            setFlag(FlagBRS | FlagErrorState, false);
     }
 
     /**
@@ -373,7 +470,7 @@ class CanFrame
      */
     constexpr bool isBitrateSwitch() const noexcept
     {
-        return _isBRS;
+        return _flags & FlagBRS;
     }
 
     /**
@@ -385,9 +482,9 @@ class CanFrame
      */
     constexpr void setBitrateSwitch(bool brs) noexcept
     {
-        _isBRS = brs;
+        setFlag(FlagBRS, brs);
         if (brs)
-            _isFD = true;
+            setFlag(FlagFD, true);
     }
 
     /**
@@ -397,7 +494,7 @@ class CanFrame
      */
     constexpr bool isErrorState() const noexcept
     {
-        return _isErrorState;
+        return _flags & FlagErrorState;
     }
 
     /**
@@ -406,7 +503,7 @@ class CanFrame
      */
     constexpr void setErrorState(bool es) noexcept
     {
-        _isErrorState = es;
+        setFlag(FlagErrorState, es);
     }
 
     /**
@@ -417,7 +514,7 @@ class CanFrame
      */
     constexpr bool isLocalEcho() const noexcept
     {
-        return _isEcho;
+        return _flags & FlagEcho;
     }
 
     /**
@@ -427,25 +524,42 @@ class CanFrame
      */
     constexpr void setLocalEcho(bool echo) noexcept
     {
-        _isEcho = echo;
+        setFlag(FlagEcho, echo);
     }
 
   private:
-    uint64_t _id : 29;
-    enum FrameType _type;
-
-    bool _isExtendedId; /**< If set, frame uses 29-bit extended id */
-    bool _isErrorState; /**< If set, frame is an error indicator */
-    bool _isFD;         /**< If set, frame is a CAN FD frame */
-    bool _isBRS;        /**< Bitrate switch */
-    bool _isEcho;       /**< Local echo */
-    bool _isValidId;    /**< If set, ID is valid */
-    uint64_t _error;    /**< Error flags */
-
-    std::vector<std::byte> _payload; /**< Data contents of frame */
-    Timestamp _timestamp;            /**< Time message was received or transmitted */
+    friend class CanFrameCodec;
+
+    /** Bits of _flags */
+    enum Flag : uint8_t {
+        FlagExtendedId = 1 << 0, /**< Frame uses 29-bit extended id */
+        FlagErrorState = 1 << 1, /**< Frame is an error indicator */
+        FlagFD = 1 << 2,         /**< Frame is a CAN FD frame */
+        FlagBRS = 1 << 3,        /**< Bitrate switch */
+        FlagEcho = 1 << 4,       /**< Local echo */
+        FlagValidId = 1 << 5,    /**< ID is valid */
+        FlagOversized = 1 << 6,  /**< Last payload given was too long to store */
+    };
+
+    constexpr void setFlag(uint8_t flag, bool on) noexcept
+    {
+        _flags = on ? (_flags | flag) : (_flags & ~flag);
+    }
+
+    uint32_t _id;                                   /**< Identifier, or error bits for error frames */
+    uint8_t _type;                                  /**< FrameType */
+    uint8_t _flags;                                 /**< Bitwise OR of Flag values */
+    uint8_t _length;                                /**< Number of valid bytes in _payload */
+    uint8_t _reserved;                              /**< Always zero */
+    int64_t _timestampNs;                           /**< Time message was received or transmitted, ns since epoch */
+    std::array<std::byte, MaxPayloadSize> _payload; /**< Data contents of frame */
 };
 
+// Frames are copied with memcpy into rings, shared memory and capture files
+static_assert(std::is_trivially_copyable_v<CanFrame>, "CanFrame must be trivially copyable");
+static_assert(std::is_standard_layout_v<CanFrame>, "CanFrame must have a fixed layout");
+static_assert(sizeof(CanFrame) == 80, "Unexpected CanFrame size");
+
 }  // namespace can
 }  // namespace net
 }  // namespace datapanel
@@ -453,29 +567,51 @@ class CanFrame
 /** @cond formatters */
 template <> struct fmt::formatter<datapanel::net::can::CanFrame::Timestamp> : fmt::formatter<string_view> {
     template <typename FormatContext>
-    auto format(datapanel::net::can::CanFrame::Timestamp &ts, FormatContext &ctx) const
+    auto format(const datapanel::net::can::CanFrame::Timestamp &ts, FormatContext &ctx) const
     {
-        std::chrono::time_point<std::chrono::system_clock, std::chrono::duration<int>> tp_seconds{
-            std::chrono::duration<int>{ts.seconds()}};
-        return fmt::format_to(ctx.out(), "{}.{:09d}", tp_seconds, ts.nanoseconds());
+        // Converting to a calendar time dominates the cost and only changes once a second
+        struct SecondsText {
+            int64_t seconds = INT64_MIN;
+            size_t length = 0;
+            char text[64];
+        };
+        thread_local SecondsText cache;
+        if (ts.seconds() != cache.seconds) {
+            std::chrono::time_point<std::chrono::system_clock, std::chrono::duration<int>> tp_seconds{
+                std::chrono::duration<int>{ts.seconds()}};
+            cache.length = std::min(fmt::format_to_n(cache.text, sizeof(cache.text), "{}", tp_seconds).size,
+                                    sizeof(cache.text));
+            cache.seconds = ts.seconds();
+        }
+        auto out = std::copy_n(cache.text, cache.length, ctx.out());
+
+        if (ts.nanoseconds() < 0 || ts.nanoseconds() >= 1000000000)
+            return fmt::format_to(out, ".{:09d}", ts.nanoseconds());
+        char fraction[10];
+        fraction[0] = '.';
+        for (int64_t i = 9, ns = ts.nanoseconds(); i > 0; i--, ns /= 10) fraction[i] = char('0' + ns % 10);
+        return std::copy_n(fraction, sizeof(fraction), out);
     }
 };
 
 template <> struct fmt::formatter<datapanel::net::can::CanFrame> : fmt::formatter<string_view> {
-    template <typename FormatContext> auto format(datapanel::net::can::CanFrame &frame, FormatContext &ctx) const
+    template <typename FormatContext> auto format(const datapanel::net::can::CanFrame &frame, FormatContext &ctx) const
     {
         switch (frame.frameType()) {
             case datapanel::net::can::CanFrame::FrameType::InvalidFrame:
                 return fmt::format_to(ctx.out(), "[INVALID FRAME]");
-            case datapanel::net::can::CanFrame::FrameType::DataFrame:
+            case datapanel::net::can::CanFrame::FrameType::DataFrame: {
+                char hex[datapanel::util::hexdumpLength(datapanel::net::can::CanFrame::MaxPayloadSize)];
+                const char *end = datapanel::util::hexdumpTo(frame.payload(), hex);
                 return fmt::format_to(ctx.out(), "{} 0x{:0{}X}  [{}] {}", frame.timestamp(), frame.id(),
-                                      frame.isExtendedId() ? 8 : 3, frame.payload().size(),
-                                      datapanel::util::hexdump(frame.payload()));
+                                      frame.isExtendedId() ? 8 : 3, frame.payloadSize(),
+                                      fmt::string_view(hex, size_t(end - hex)));
+            }
             case datapanel::net::can::CanFrame::FrameType::ErrorFrame:
                 return fmt::format_to(ctx.out(), "[ERROR FRAME]");
             case datapanel::net::can::CanFrame::FrameType::RemoteRequestFrame:
                 return fmt::format_to(ctx.out(), "{} 0x{:0{}X}r [{}]", frame.timestamp(), frame.id(),
-                                      frame.isExtendedId() ? 8 : 3, frame.payload().size());
+                                      frame.isExtendedId() ? 8 : 3, frame.payloadSize());
             case datapanel::net::can::CanFrame::FrameType::UnknownFrame:
             default:
                 break;
@@ -0,0 +1,111 @@
+/**
+ * Copyright (c) 2026 Data Panel Corporation
+ * 181 Cheshire Ln, Suite 300
+ * Plymouth, MN 55441
+ * All rights reserved.
+ *
+ * This is the confidential and proprietary information of Data Panel
+ * Corporation. Such confidential information shall not be disclosed and is for
+ * use only in accordance with the license agreement you entered into with Data
+ * Panel.
+ */
+
+/**
+ * @file CanFrameCodec.h
+ * @date 2026-10-16
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "dplib/net/can/CanFrame.h"
+
+struct can_frame;
+struct canfd_frame;
+struct msghdr;
+
+namespace datapanel
+{
+namespace net
+{
+namespace can
+{
+
+/**
+ * @brief Conversion between SocketCAN wire structs and CanFrame
+ *
+ * The batch decoders extract identifiers and flags for several frames
+ * at once with SSE2 (x86-64) or NEON (AArch64) and fall back to scalar
+ * code elsewhere.  Decoded frames have a zero timestamp and the local
+ * echo flag cleared; callers fill those in from the socket metadata.
+ */
+class CanFrameCodec
+{
+  public:
+    /**
+     * @brief Decode one frame
+     *
+     * @param[in] raw Frame as read from a SocketCAN socket
+     * @param[in] fd true if @p raw was read as a CANFD_MTU sized frame
+     * @param[out] frame Decoded frame
+     */
+    static void decode(const canfd_frame &raw, bool fd, CanFrame &frame) noexcept;
+
+    /**
+     * @brief Decode frames read from a socket with `CAN_RAW_FD_FRAMES` enabled
+     *
+     * @param[in] raw Frames as read from the socket
+     * @param[in] sizes Number of bytes read for each frame: `CAN_MTU` for
+     *            classic frames, `CANFD_MTU` for FD frames.  Frames of any
+     *            other size decode as CanFrame::InvalidFrame.
+     * @param[out] frames Decoded frames, @p count entries
+     * @param[in] count Number of frames
+     */
+    static void decode(const canfd_frame *raw, const uint32_t *sizes, CanFrame *frames, size_t count) noexcept;
+
+    /**
+     * @brief Decode classic frames
+     *
+     * @param[in] raw Frames as read from a socket without `CAN_RAW_FD_FRAMES`
+     * @param[out] frames Decoded frames, @p count entries
+     * @param[in] count Number of frames
+     */
+    static void decode(const can_frame *raw, CanFrame *frames, size_t count) noexcept;
+
+    /**
+     * @brief Encode a frame for writing to a SocketCAN socket
+     *
+     * @param[in] frame Frame to encode
+     * @param[out] raw Wire representation; unused bytes are zeroed
+     *
+     * @return Number of bytes to write: `CAN_MTU` or `CANFD_MTU`
+     */
+    static size_t encode(const CanFrame &frame, canfd_frame &raw) noexcept;
+
+    /**
+     * @brief Extract the receive timestamp from a message's control data
+     *
+     * SCM_TIMESTAMPING is preferred over SCM_TIMESTAMPNS when both are
+     * present, and its raw hardware stamp over its software stamp.
+     *
+     * @param[in] hdr Message header filled by recvmsg() or recvmmsg()
+     *
+     * @return Timestamp, or a zero timestamp if @p hdr carries none
+     */
+    static CanFrame::Timestamp timestamp(const msghdr &hdr) noexcept;
+
+    /**
+     * @return Name of the instruction set used by the batch decoders
+     */
+    static const char *implementation() noexcept;
+
+  private:
+    static void store(CanFrame &frame, uint32_t id, uint32_t type, uint32_t extended, const uint8_t *data,
+                      uint8_t len, uint8_t flags, bool fd) noexcept;
+};
+
+}  // namespace can
+}  // namespace net
+}  // namespace datapanel
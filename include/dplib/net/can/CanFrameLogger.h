@@ -0,0 +1,206 @@
+/**
+ * Copyright (c) 2026 Data Panel Corporation
+ * 181 Cheshire Ln, Suite 300
+ * Plymouth, MN 55441
+ * All rights reserved.
+ *
+ * This is the confidential and proprietary information of Data Panel
+ * Corporation. Such confidential information shall not be disclosed and is for
+ * use only in accordance with the license agreement you entered into with Data
+ * Panel.
+ */
+
+/**
+ * @file CanFrameLogger.h
+ * @date 2026-10-16
+ */
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include <sigslot/signal.hpp>
+
+#include "dplib/net/can/CanCapture.h"
+#include "dplib/net/can/CanFrame.h"
+#include "dplib/net/can/CanInterface.h"
+#include "dplib/util/SpscRing.h"
+
+namespace datapanel
+{
+namespace net
+{
+namespace can
+{
+
+/**
+ * @brief Log received frames from a background thread
+ *
+ * log() copies frames into a preallocated ring and returns; it never
+ * allocates, formats, blocks or makes a system call unless the writer
+ * thread is asleep and needs waking.  The writer thread formats and
+ * writes the frames, either as `candump -l` text (readable by the
+ * Replay backend and can-utils) or as a binary capture
+ * (CanCaptureWriter).  When the writer falls a full ring behind, new
+ * frames are dropped and counted in dropped() rather than holding up
+ * the caller.
+ *
+ * log() may be called from one thread at a time.
+ *
+ * @code
+ * CanFrameLogger logger;
+ * logger.open("-", CanFrameLogger::Candump, "can0");
+ * bus->framesReceived.connect([&]() {
+ *     CanFrame frame;
+ *     while ((frame = bus->recv()).frameType() != CanFrame::InvalidFrame) logger.log(frame);
+ * });
+ * @endcode
+ */
+class CanFrameLogger
+{
+  public:
+    static constexpr size_t DefaultCapacity = 65536; /**< Default number of frames the ring holds */
+    static constexpr int FlushIntervalMs = 200;      /**< Longest time text output stays buffered */
+
+    /**
+     * @brief Output formats
+     */
+    enum Format {
+        Candump, /**< `candump -l` text lines */
+        Binary,  /**< Capture file, see CanCaptureWriter */
+    };
+
+    /**
+     * @param[in] capacity Frames the ring holds before log() starts dropping
+     */
+    explicit CanFrameLogger(size_t capacity = DefaultCapacity);
+    ~CanFrameLogger();
+
+    CanFrameLogger(const CanFrameLogger &) = delete;
+    CanFrameLogger &operator=(const CanFrameLogger &) = delete;
+
+    /**
+     * @brief Create the output and start the writer thread
+     *
+     * @param[in] path File to write, or "-" for standard output (Candump only)
+     * @param[in] format Output format
+     * @param[in] channel Interface name written on each Candump line
+     *
+     * @return false if the output could not be created
+     */
+    bool open(const std::string &path, Format format = Candump, const std::string &channel = "can0");
+
+    /**
+     * @brief Write every frame logged so far, then stop the writer thread
+     *
+     * @return false if writing failed at any point
+     */
+    bool close();
+
+    /**
+     * @return true between open() and close()
+     */
+    bool isOpen() const
+    {
+        return _writer.joinable();
+    }
+
+    /**
+     * @brief Queue frames for writing
+     *
+     * @param[in] frames Frames to log
+     * @param[in] count Number of frames
+     *
+     * @return Number of frames queued; the rest were dropped
+     */
+    size_t log(const CanFrame *frames, size_t count) noexcept;
+
+    /**
+     * @brief Queue one frame for writing
+     *
+     * @return false if the frame was dropped
+     */
+    bool log(const CanFrame &frame) noexcept
+    {
+        return log(&frame, 1) == 1;
+    }
+
+    /**
+     * @brief Log every frame received by @p source
+     *
+     * Frames are logged from CanInterface::framesTapped; @p source's
+     * receive queue still fills and is left to the application.
+     *
+     * @param[in] source Interface to log; must outlive the logger or detach()
+     */
+    void attach(CanInterface &source);
+
+    /**
+     * @brief Stop logging the interface given to attach()
+     */
+    void detach();
+
+    /**
+     * @return Frames written to the output since open(); buffered frames count once they are flushed
+     */
+    uint64_t written() const
+    {
+        return _written.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @return Frames dropped because the writer fell behind or a write failed, since open()
+     */
+    uint64_t dropped() const
+    {
+        return _ring.dropped() + _discarded.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @return Description of the last failure; only stable once close() returned
+     */
+    const std::string &errorMessage() const
+    {
+        return _errorMessage;
+    }
+
+  private:
+    void runWriter();
+    bool writeText(const CanFrame *frames, size_t count);
+    bool flushText();
+    void countCaptured(bool ok);
+
+    util::SpscRing<CanFrame> _ring;
+    Format _format = Candump;
+    std::string _channel;
+
+    int _fd = -1;
+    bool _ownsFd = false;
+    std::unique_ptr<char[]> _text; /**< Formatted lines waiting to be written */
+    size_t _textUsed = 0;
+    size_t _textFrames = 0; /**< Frames formatted into _text */
+    CanCaptureWriter _capture;
+    uint64_t _handed = 0; /**< Frames given to _capture */
+
+    std::thread _writer;
+    std::mutex _mutex;
+    std::condition_variable _wake;
+    std::atomic<bool> _sleeping{false};
+    bool _stop = false;
+    bool _failed = false;
+    std::atomic<uint64_t> _written{0};
+    std::atomic<uint64_t> _discarded{0}; /**< Frames the writer threw away after a write error */
+
+    sigslot::scoped_connection _connection;
+    std::string _errorMessage;
+};
+
+}  // namespace can
+}  // namespace net
+}  // namespace datapanel
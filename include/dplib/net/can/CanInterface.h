@@ -21,9 +21,11 @@
 #include <list>
 #include <variant>
 #include <map>
-#include <mutex>
+#include <vector>
 
+#include "dplib/net/can/CanFilter.h"
 #include "dplib/net/can/CanFrame.h"
+#include "dplib/util/SpscRing.h"
 
 #include <fmt/format.h>
 #include <magic_enum.hpp>
@@ -32,6 +34,11 @@
 
 namespace datapanel
 {
+namespace core
+{
+class EventDispatcher;
+}
+
 namespace net
 {
 namespace can
@@ -65,8 +72,45 @@ class CanInterfaceInfo
  * | @ref CfgOptRxOwn | bool | Receive frames transmitted via this interface |
  * | @ref CfgOptBitrate | int | Bitrate of CAN interface |
  * | @ref CfgOptFD | bool | If set, Flexible Data Rate is enabled |
+ * | @ref CfgOptRxBatchSize | int | Maximum number of frames read from the device per system call |
+ * | @ref CfgOptTimestampSource | int | Receive timestamp source, see @ref TimestampSource |
+ * | @ref CfgOptRxQueueSize | int | Capacity of the receive queue |
+ * | @ref CfgOptTxQueueSize | int | Capacity of the transmit queue |
+ * | @ref CfgOptQueueOverflowPolicy | int | util::OverflowPolicy for both queues; Block is transmit only |
+ * | @ref CfgOptQueuedTx | bool | send() queues frames for transmission from the event loop |
  * | @ref CfgOptOther | | Interface-specific |
  *
+ * ## Receive Filters
+ *
+ * setRxFilters() and setErrorFilter() restrict which frames are
+ * received.  Backends that can filter in the driver or kernel do so
+ * (see applyRxFilters()); otherwise frames are filtered in software
+ * before they are queued.  Until filters are set, every frame the
+ * backend delivers is received.
+ *
+ * ## Queues
+ *
+ * Received and outgoing frames are held in bounded lock-free
+ * single-producer/single-consumer rings.  The backend produces
+ * received frames and consumes transmitted frames; the application
+ * is the other side.  Each direction supports one producer thread and
+ * one consumer thread.  Queue options can only be changed while the
+ * interface is disconnected.
+ *
+ * util::OverflowPolicy::Block only applies to the transmit queue, and
+ * only makes sense when send() is called from a thread other than the
+ * one servicing the interface.  The receive queue is filled by the
+ * servicing thread, which is also where framesReceived handlers drain
+ * it, so blocking there would never end; it drops the newest frame
+ * instead.
+ *
+ * ## Receive Taps
+ *
+ * Components that process every received frame (loggers, transports,
+ * statistics) connect to framesTapped instead of draining the receive
+ * queue.  Each tap sees every accepted frame, in batches, before
+ * framesReceived is emitted, and the queue is left to the
+ * application.  Any number of taps can be connected.
  */
 class CanInterface
 {
@@ -110,11 +154,25 @@ class CanInterface
      * @brief Configuration options for CAN interfaces
      */
     enum ConfigOption {
-        CfgOptLoopback, /**< When set, frames sent from other applications on this interface are received */
-        CfgOptRxOwn,    /**< When set, frames sent from this interface are also received. */
-        CfgOptBitrate,  /**< Data bitrate */
-        CfgOptFD,       /**< If set, Flexible Data Rate support is enabled */
-        CfgOptOther,    /**< Interface-specific option */
+        CfgOptLoopback,            /**< When set, frames sent from other applications on this interface are received */
+        CfgOptRxOwn,               /**< When set, frames sent from this interface are also received. */
+        CfgOptBitrate,             /**< Data bitrate */
+        CfgOptFD,                  /**< If set, Flexible Data Rate support is enabled */
+        CfgOptRxBatchSize,         /**< Maximum number of frames received per read operation */
+        CfgOptTimestampSource,     /**< Where receive timestamps come from (TimestampSource) */
+        CfgOptRxQueueSize,         /**< Maximum number of frames in the receive queue */
+        CfgOptTxQueueSize,         /**< Maximum number of frames in the transmit queue */
+        CfgOptQueueOverflowPolicy, /**< What to do with frames that do not fit in a queue (util::OverflowPolicy) */
+        CfgOptQueuedTx,            /**< When set, send() queues frames and the event loop transmits them in batches */
+        CfgOptOther,               /**< Interface-specific option */
+    };
+
+    /**
+     * @brief Receive timestamp sources, used with CfgOptTimestampSource
+     */
+    enum TimestampSource {
+        SoftwareTimestamp, /**< Taken by the operating system when the frame is received */
+        HardwareTimestamp, /**< Taken by the CAN controller, or software if the driver has no hardware clock */
     };
 
     sigslot::signal<CanInterface::CanBusError> errorOccurred;
@@ -122,12 +180,28 @@ class CanInterface
     sigslot::signal<> framesReceived;
     sigslot::signal<> framesTransmitted;
 
+    /**
+     * @brief Emitted with each batch of accepted received frames
+     *
+     * Handlers are called as `handler(const CanFrame *frames, size_t count)`
+     * on the thread servicing the interface, with at most TapBatchSize
+     * frames, before framesReceived.  They see frames the receive queue
+     * drops when it is full, and do not remove anything from the queue.
+     * The frames are only valid during the call.  A handler must not make
+     * the same interface receive frames before it returns.
+     */
+    sigslot::signal<const CanFrame *, size_t> framesTapped;
+
     /**
      * @brief Used with ConfigOption to configure interfaces
      */
     using ConfigOptionValue = std::variant<int, double, bool, std::string>;
 
-    CanInterface()
+    static constexpr int DefaultRxQueueSize = 8192; /**< Default value of CfgOptRxQueueSize */
+    static constexpr int DefaultTxQueueSize = 1024; /**< Default value of CfgOptTxQueueSize */
+    static constexpr size_t TapBatchSize = 64;      /**< Largest batch passed to framesTapped handlers */
+
+    CanInterface() : _rxFrames(DefaultRxQueueSize), _txFrames(DefaultTxQueueSize)
     {
     }
     virtual ~CanInterface() = default;
@@ -154,9 +228,9 @@ class CanInterface
     ConfigOptionValue configOption(ConfigOption opt) const;
 
     /**
-     * @brief Get a list of all supported options for the interface
+     * @brief Get a list of all options that have been configured for the interface
      *
-     * @return List of supported ConfigOption keys
+     * @return List of configured ConfigOption keys
      */
     std::list<ConfigOption> configOptions() const;
 
@@ -170,13 +244,23 @@ class CanInterface
     virtual bool send(const CanFrame &frame) = 0;
 
     /**
-     * @brief Returns the most-recently received CAN frame
+     * @brief Remove the oldest frame from the receive queue
      *
      * @return Received frame, or CanFrame::InvalidFrame if no
      *         frame was available
      */
     virtual CanFrame recv();
 
+    /**
+     * @brief Remove up to @p max frames from the receive queue
+     *
+     * @param[out] frames Receives the removed frames, oldest first
+     * @param[in] max Number of entries in @p frames
+     *
+     * @return Number of frames removed; 0 if none were available
+     */
+    size_t recv(CanFrame *frames, size_t max);
+
     /**
      * @brief Get all messages in the receive buffer
      *
@@ -265,6 +349,20 @@ class CanInterface
      */
     size_t countTxPending() const;
 
+    /**
+     * @brief Number of received frames discarded because the receive queue was full
+     *
+     * @return Receive overflow count since the queue was configured
+     */
+    uint64_t countRxDropped() const;
+
+    /**
+     * @brief Number of outgoing frames discarded because the transmit queue was full
+     *
+     * @return Transmit overflow count since the queue was configured
+     */
+    uint64_t countTxDropped() const;
+
     /**
      * @brief Clear transmit buffer
      *
@@ -279,6 +377,69 @@ class CanInterface
      */
     void flushRx();
 
+    /**
+     * @brief Only receive data and remote request frames matching one of @p filters
+     *
+     * Filters may be changed at any time.  While connected, call this from
+     * the thread servicing the interface.
+     *
+     * @param[in] filters Accepted frames; an empty list accepts all frames
+     *
+     * @return false if connected and the filters could not be installed
+     *         in the driver, in which case software filtering is used
+     */
+    bool setRxFilters(const std::vector<CanFilter> &filters);
+
+    /**
+     * @return Filters set by setRxFilters()
+     */
+    const std::vector<CanFilter> &rxFilters() const;
+
+    /**
+     * @brief Select the error frames to receive
+     *
+     * @param[in] errors Bitwise OR of CanFrame::FrameError values;
+     *            CanFrame::NoError receives no error frames
+     *
+     * @return false if connected and the filter could not be installed
+     *         in the driver, in which case software filtering is used
+     */
+    bool setErrorFilter(uint32_t errors);
+
+    /**
+     * @return Error frame mask set by setErrorFilter()
+     */
+    uint32_t errorFilter() const;
+
+    /**
+     * @return true if receive filters are applied in software rather than by the driver
+     */
+    bool softwareFiltering() const;
+
+    /**
+     * @brief Service this interface from a specific event loop
+     *
+     * By default the interface is serviced by the application's main
+     * dispatcher.  Pinning busy interfaces to dispatchers running on
+     * their own threads (see core::EventLoopThread) keeps receive
+     * processing off the main thread.  Signals such as framesReceived
+     * are then emitted on that dispatcher's thread.
+     *
+     * @note The dispatcher can only be changed while disconnected.
+     *
+     * @param[in] dispatcher Dispatcher to use, or nullptr for the application dispatcher
+     *
+     * @return true on success, or false if connected
+     */
+    bool setEventDispatcher(core::EventDispatcher *dispatcher);
+
+    /**
+     * @brief Dispatcher servicing this interface
+     *
+     * @return Pinned dispatcher, or the application dispatcher if none was set
+     */
+    core::EventDispatcher &eventDispatcher() const;
+
     /**
      * @brief Probe for supported channel names
      *
@@ -295,7 +456,77 @@ class CanInterface
     void clearError();
 
     void enqueueRxFrames(const std::list<CanFrame> &frames);
-    void enqueueTxFrame(const CanFrame &frame);
+
+    /**
+     * @brief Reserve the next receive queue slot for a frame decoded in place
+     *
+     * Used by backends to avoid building and copying temporary frames.
+     * The slot's previous contents are unspecified.  Call commitRxFrame()
+     * once the frame is complete, then notifyRxFrames() after the batch.
+     *
+     * While software filtering is active, or framesTapped has handlers,
+     * the slot is a staging frame outside the queue, so frames the filters
+     * reject never take a queue slot and taps see frames the queue drops.
+     *
+     * @return Slot to fill, or nullptr if the queue is full and the frame
+     *         is dropped
+     */
+    CanFrame *claimRxFrame();
+
+    /**
+     * @brief Queue the frame written to the slot returned by claimRxFrame()
+     *
+     * Frames rejected by the software filters are discarded.  If the
+     * frame is not committed, the next claimRxFrame() returns the same slot.
+     *
+     * @return true if the frame was queued or passed to framesTapped
+     */
+    bool commitRxFrame();
+
+    /**
+     * @brief Emit framesTapped and framesReceived after a batch of commitRxFrame() calls
+     */
+    void notifyRxFrames();
+
+    /**
+     * @brief Check for room in the receive queue without counting a drop
+     *
+     * Backends that can hold frames back, rather than lose them, test
+     * this before claimRxFrame().
+     *
+     * @return true if claimRxFrame() would find the queue full
+     */
+    bool rxQueueFull() const;
+
+    /**
+     * @brief Test a received frame against the software filters
+     *
+     * @param[in] frame Received frame
+     *
+     * @return true if @p frame should be queued
+     */
+    bool acceptRxFrame(const CanFrame &frame) const;
+
+    /**
+     * @brief Install rxFilters() and errorFilter() in the driver
+     *
+     * Backends call this once their device is open; CanInterface calls it
+     * after open() if the backend did not, and whenever the filters change
+     * while connected.
+     */
+    void installRxFilters();
+
+    /**
+     * @brief Push the filters into the driver or kernel
+     *
+     * Subclasses override this when the device can filter frames itself.
+     * The default implementation returns false, which selects software
+     * filtering.
+     *
+     * @return true if the driver now filters frames
+     */
+    virtual bool applyRxFilters();
+    bool enqueueTxFrame(const CanFrame &frame);
     CanFrame dequeueTxFrame();
     bool pendingTxFrames() const;
 
@@ -330,16 +561,32 @@ class CanInterface
     virtual bool close() = 0;
 
   private:
+    void configureQueues();
+    void emitTapped();
+
     /** Incoming CanFrames */
-    std::list<CanFrame> _rxFrames;
-    /** Mutex to guard receive list */
-    std::mutex _rxLock;
+    util::SpscRing<CanFrame> _rxFrames;
     /** Outgoing CanFrames */
-    std::list<CanFrame> _txFrames;
+    util::SpscRing<CanFrame> _txFrames;
+    /** Frame returned by claimRxFrame() while software filtering is active */
+    CanFrame _rxStaged;
+    /** Accepted frames waiting for framesTapped; claimRxFrame() decodes into the next one */
+    CanFrame _tapped[TapBatchSize];
+    size_t _tappedCount = 0;
+    bool _tapping = false;     /**< framesTapped had handlers when the current batch started */
+    bool _rxBatchOpen = false; /**< claimRxFrame() was called since the last notifyRxFrames() */
 
     /** Supported options and their values */
     std::map<ConfigOption, ConfigOptionValue> _configOptions;
 
+    std::vector<CanFilter> _rxFilters;
+    uint32_t _errorFilter = CanFrame::NoError;
+    bool _filtersSet = false;       /**< setRxFilters() or setErrorFilter() was called */
+    bool _filtersInstalled = false; /**< applyRxFilters() succeeded for the current connection */
+
+    /** Dispatcher servicing this interface; nullptr for the application dispatcher */
+    core::EventDispatcher *_eventDispatcher = nullptr;
+
     CanBusError _lastError = CanBusError::NoError;
     CanConnectionState _state = CanConnectionState::DisconnectedState;
     std::string _errorMessage;
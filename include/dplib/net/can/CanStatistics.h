@@ -0,0 +1,271 @@
+/**
+ * Copyright (c) 2026 Data Panel Corporation
+ * 181 Cheshire Ln, Suite 300
+ * Plymouth, MN 55441
+ * All rights reserved.
+ *
+ * This is the confidential and proprietary information of Data Panel
+ * Corporation. Such confidential information shall not be disclosed and is for
+ * use only in accordance with the license agreement you entered into with Data
+ * Panel.
+ */
+
+/**
+ * @file CanStatistics.h
+ * @date 2026-10-16
+ */
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+#include <sigslot/signal.hpp>
+
+#include "dplib/net/can/CanFrame.h"
+#include "dplib/net/can/CanInterface.h"
+#include "dplib/util/SpscRing.h"
+
+namespace datapanel
+{
+namespace net
+{
+namespace can
+{
+
+/**
+ * @brief Per-identifier frame rate, inter-arrival jitter and length counts, and bus load
+ *
+ * process() runs on the receive path; any number of other threads may
+ * read the counters at the same time without locks.  Identifiers are
+ * kept in a flat open addressing table allocated up front; each entry
+ * is updated under its own sequence counter, so a reader retries
+ * instead of seeing a half-updated entry, and the writer never waits.
+ *
+ * Gaps between frames of one identifier are taken from the frame
+ * timestamps and counted in a log-linear (HDR-style) histogram of
+ * JitterSubBuckets buckets per power of two microseconds, giving
+ * percentiles to within 12.5%.  Minimum, maximum and mean are exact.
+ *
+ * Bus load is the frameBitCount() of every data and remote request
+ * frame, worst-case stuff bits included, over the time between two
+ * totals() snapshots.
+ *
+ * process() may be called from one thread at a time.
+ *
+ * @code
+ * CanStatistics stats;
+ * stats.attach(*bus);
+ * // Another thread, once a second:
+ * const auto now = stats.totals();
+ * fmt::print("load {:.1f}%\n", 100 * CanStatistics::busLoad(last, now, 500000));
+ * last = now;
+ * @endcode
+ */
+class CanStatistics
+{
+  public:
+    static constexpr size_t DefaultMaxIds = 2048;   /**< Default number of identifiers tracked */
+    static constexpr unsigned JitterSubBuckets = 8; /**< Histogram buckets per power of two */
+    static constexpr size_t JitterBuckets = 240;    /**< Histogram buckets, gaps up to 2^32 us */
+
+    /**
+     * @brief Counters of one identifier
+     */
+    struct IdStatistics {
+        uint32_t id = 0;
+        bool extendedId = false;
+        uint64_t frames = 0;                        /**< Data and remote request frames */
+        int64_t firstNs = 0;                        /**< Timestamp of the first frame */
+        int64_t lastNs = 0;                         /**< Timestamp of the last frame */
+        uint64_t gapMinNs = 0;                      /**< Shortest gap between frames, 0 if fewer than two */
+        uint64_t gapMaxNs = 0;                      /**< Longest gap between frames */
+        uint64_t gapSumNs = 0;                      /**< Sum of the frames - 1 gaps */
+        std::array<uint64_t, 16> dlc{};             /**< Frames per DLC code */
+        std::array<uint32_t, JitterBuckets> gaps{}; /**< Gap histogram, see gapBucket() */
+
+        /**
+         * @return Frames per second between the first and the last frame, 0 if fewer than two
+         */
+        double rate() const;
+
+        /**
+         * @return Mean gap between frames in nanoseconds, 0 if fewer than two
+         */
+        double gapMeanNs() const;
+
+        /**
+         * @brief Gap not exceeded by @p percent of the gaps
+         *
+         * @param[in] percent Percentile, 0 to 100
+         *
+         * @return Upper end of the histogram bucket holding the percentile,
+         *         clamped to the gap range, in nanoseconds; 0 if fewer than two frames
+         */
+        uint64_t gapPercentileNs(double percent) const;
+    };
+
+    /**
+     * @brief Counters of the whole bus
+     */
+    struct Totals {
+        uint64_t frames = 0;      /**< Data and remote request frames */
+        uint64_t errorFrames = 0; /**< Error frames */
+        uint64_t untracked = 0;   /**< Frames of identifiers that did not fit the table */
+        uint64_t bits = 0;        /**< Bit times of the data and remote request frames */
+        int64_t firstNs = 0;      /**< Timestamp of the first frame */
+        int64_t lastNs = 0;       /**< Timestamp of the last frame */
+    };
+
+    /**
+     * @param[in] maxIds Number of identifiers tracked; frames of further identifiers only count in totals()
+     */
+    explicit CanStatistics(size_t maxIds = DefaultMaxIds);
+
+    CanStatistics(const CanStatistics &) = delete;
+    CanStatistics &operator=(const CanStatistics &) = delete;
+
+    /**
+     * @brief Count received frames
+     *
+     * @param[in] frames Received frames
+     * @param[in] count Number of frames
+     */
+    void process(const CanFrame *frames, size_t count) noexcept;
+
+    /**
+     * @brief Count one received frame
+     */
+    void process(const CanFrame &frame) noexcept
+    {
+        process(&frame, 1);
+    }
+
+    /**
+     * @brief Count every frame received by @p source
+     *
+     * Frames are counted through CanInterface::framesTapped, so the
+     * receive queue and other taps still see them.
+     *
+     * @param[in] source Interface to use; must outlive the engine or detach()
+     */
+    void attach(CanInterface &source);
+
+    /**
+     * @brief Stop counting the interface given to attach()
+     */
+    void detach();
+
+    /**
+     * @brief Zero every counter; identifiers keep their place in the table
+     *
+     * Must be called from the thread calling process().
+     */
+    void reset() noexcept;
+
+    /**
+     * @return Number of identifiers seen, up to the table size
+     */
+    size_t idCount() const noexcept
+    {
+        return _used.load(std::memory_order_acquire);
+    }
+
+    /**
+     * @brief Read the counters of the @p index th identifier seen
+     *
+     * @param[in] index 0 to idCount() - 1
+     * @param[out] out Counters
+     *
+     * @return false if @p index is out of range
+     */
+    bool idStatistics(size_t index, IdStatistics &out) const noexcept;
+
+    /**
+     * @brief Read the counters of one identifier
+     *
+     * @param[in] id Identifier
+     * @param[in] extendedId true for a 29-bit identifier
+     * @param[out] out Counters
+     *
+     * @return false if no frame with that identifier was counted
+     */
+    bool find(uint32_t id, bool extendedId, IdStatistics &out) const noexcept;
+
+    /**
+     * @return Counters of the whole bus
+     */
+    Totals totals() const noexcept;
+
+    /**
+     * @brief Share of the bus occupied between two totals() snapshots
+     *
+     * @param[in] earlier Older snapshot; a default-constructed one means since the first frame
+     * @param[in] later Newer snapshot
+     * @param[in] bitrate Nominal bitrate in bit/s
+     *
+     * @return Bus load, 0 to 1 (and more if the timestamps are off), 0 if no time passed
+     */
+    static double busLoad(const Totals &earlier, const Totals &later, uint32_t bitrate) noexcept;
+
+    /**
+     * @return Histogram bucket of a gap of @p gapUs microseconds
+     */
+    static size_t gapBucket(uint64_t gapUs) noexcept;
+
+    /**
+     * @return Largest gap in microseconds counted in @p bucket
+     */
+    static uint64_t gapBucketUpperUs(size_t bucket) noexcept;
+
+  private:
+    static constexpr uint32_t EmptySlot = 0xFFFFFFFF; /**< Unused index slot */
+
+    /**
+     * @brief Counters of one identifier, written under a sequence counter
+     *
+     * The sequence is odd while process() updates the entry.
+     */
+    struct alignas(util::CacheLineSize) Entry {
+        std::atomic<uint32_t> sequence;
+        std::atomic<uint32_t> key; /**< Identifier, bit 31 set if extended */
+        std::atomic<uint64_t> frames;
+        std::atomic<int64_t> firstNs;
+        std::atomic<int64_t> lastNs;
+        std::atomic<uint64_t> gapMinNs;
+        std::atomic<uint64_t> gapMaxNs;
+        std::atomic<uint64_t> gapSumNs;
+        std::atomic<uint64_t> dlc[16];
+        std::atomic<uint32_t> gaps[JitterBuckets];
+    };
+
+    struct alignas(util::CacheLineSize) TotalsEntry {
+        std::atomic<uint32_t> sequence;
+        std::atomic<uint64_t> frames;
+        std::atomic<uint64_t> errorFrames;
+        std::atomic<uint64_t> untracked;
+        std::atomic<uint64_t> bits;
+        std::atomic<int64_t> firstNs;
+        std::atomic<int64_t> lastNs;
+    };
+
+    Entry *lookup(uint32_t key) noexcept;
+    static void read(const Entry &entry, IdStatistics &out) noexcept;
+
+    /** Open addressing index of _entries by key, linear probing; holds entry numbers */
+    std::unique_ptr<std::atomic<uint32_t>[]> _index;
+    size_t _indexMask = 0;
+    unsigned _hashShift = 0;
+    std::unique_ptr<Entry[]> _entries;
+    size_t _maxIds;
+    std::atomic<size_t> _used{0}; /**< Entries of _entries in use, published after the entry's key */
+    TotalsEntry _totals;
+
+    sigslot::scoped_connection _connection;
+};
+
+}  // namespace can
+}  // namespace net
+}  // namespace datapanel
@@ -0,0 +1,167 @@
+/**
+ * Copyright (c) 2026 Data Panel Corporation
+ * 181 Cheshire Ln, Suite 300
+ * Plymouth, MN 55441
+ * All rights reserved.
+ *
+ * This is the confidential and proprietary information of Data Panel
+ * Corporation. Such confidential information shall not be disclosed and is for
+ * use only in accordance with the license agreement you entered into with Data
+ * Panel.
+ */
+
+/**
+ * @file ReplayBackend.h
+ * @date 2026-10-16
+ */
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include <sigslot/signal.hpp>
+
+#include "dplib/net/can/CanFrame.h"
+#include "dplib/net/can/CanInterface.h"
+#include "dplib/util/SpscRing.h"
+
+namespace datapanel
+{
+namespace net
+{
+namespace can
+{
+
+class ReplaySource;
+
+/**
+ * @brief CAN interface that plays back a recorded capture
+ *
+ * The channel is the path of a capture file, either a native capture
+ * written by CanCaptureWriter or a `candump -l` log.  Frames arrive
+ * through framesReceived with their recorded timestamps, released by a
+ * pacing thread at the recorded inter-frame intervals divided by the
+ * replay speed.  Replay does not drop frames: if the application falls
+ * behind, the pacing thread waits for it and the delay shows up in
+ * pacingStatistics().
+ *
+ * Options are given as a comma-separated @ref CfgOptOther string:
+ *
+ * | Option | Description |
+ * | ------ | ----------- |
+ * | `speed=<factor>` | Replay @p factor times faster than recorded; default 1 |
+ * | `speed=max` | Replay as fast as the application receives frames |
+ * | `loop` | Start over at the end of the file instead of finishing |
+ *
+ * Use setRxFilters() to replay only some identifiers.  Replay channels
+ * are receive-only; send() fails with CanInterface::OperationError.
+ *
+ * @code
+ * auto bus = CanBus::create("Replay", "field-test.dpcap");
+ * bus->setConfigOption(CanInterface::CfgOptOther, std::string("speed=100"));
+ * bus->connect();
+ * @endcode
+ */
+class ReplayBackend : public CanInterface
+{
+  public:
+    static constexpr int RetryMs = 1;                   /**< Retry delay while the receive queue is full */
+    static constexpr int64_t LateThresholdNs = 1000000; /**< Frames released later than this count as late */
+
+    /**
+     * @brief How closely frames were released on schedule
+     */
+    struct PacingStatistics {
+        uint64_t frames = 0;     /**< Frames released */
+        uint64_t loops = 0;      /**< Completed passes through the file */
+        int64_t meanErrorNs = 0; /**< Mean delay between a frame's scheduled and actual release */
+        int64_t maxErrorNs = 0;  /**< Largest such delay */
+        uint64_t lateFrames = 0; /**< Frames released more than LateThresholdNs late */
+    };
+
+    /**
+     * @brief Emitted on the interface's dispatcher once the last frame has been received
+     *
+     * Never emitted when looping.
+     */
+    sigslot::signal<> replayFinished;
+
+    ~ReplayBackend();
+
+    bool open() override;
+    bool close() override;
+
+    bool send(const CanFrame &frame) override;
+
+    /**
+     * @return Pacing accuracy since connect()
+     */
+    PacingStatistics pacingStatistics() const;
+
+    /**
+     * @return true once every frame has been received, if not looping
+     */
+    bool isFinished() const
+    {
+        return _finishedReported;
+    }
+
+    /**
+     * @brief Parse one line of a `candump -l` log
+     *
+     * Accepts classic, remote request, FD and error frames, for example
+     * `(1436509052.249713) can0 18FEF100#0102030405060708`, with an
+     * optional trailing `T` (transmitted, received as local echo) or
+     * `R` direction marker.
+     *
+     * @param[in] line Log line
+     * @param[out] frame Parsed frame
+     *
+     * @return false if @p line is not a frame
+     */
+    static bool parseCandumpLine(const std::string &line, CanFrame &frame);
+
+    static std::unique_ptr<CanInterface> init(const std::string &channel);
+
+    static std::list<CanInterfaceInfo> availableChannels();
+
+  private:
+    explicit ReplayBackend(const std::string &channel);
+
+    bool parseOptions();
+    void runPacer();
+    void readInbox();
+
+    std::string _path;
+    double _speed = 1.0; /**< 0 replays as fast as possible */
+    bool _loop = false;
+
+    std::unique_ptr<ReplaySource> _source;
+    int _eventFd = -1;
+    int _retryTimer = -1;
+
+    /** Frames released by the pacing thread, drained by the dispatcher */
+    util::SpscRing<CanFrame> _inbox;
+    std::atomic<bool> _signalled{false};
+    std::atomic<bool> _waitingForSpace{false};
+    std::atomic<bool> _finished{false};
+    bool _finishedReported = false;
+
+    std::thread _pacer;
+    mutable std::mutex _mutex;
+    std::condition_variable _wake;
+    bool _stopPacer = false;
+    PacingStatistics _stats;
+    int64_t _totalErrorNs = 0;
+};
+
+}  // namespace can
+}  // namespace net
+}  // namespace datapanel
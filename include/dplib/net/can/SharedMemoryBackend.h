@@ -0,0 +1,251 @@
+/**
+ * Copyright (c) 2026 Data Panel Corporation
+ * 181 Cheshire Ln, Suite 300
+ * Plymouth, MN 55441
+ * All rights reserved.
+ *
+ * This is the confidential and proprietary information of Data Panel
+ * Corporation. Such confidential information shall not be disclosed and is for
+ * use only in accordance with the license agreement you entered into with Data
+ * Panel.
+ */
+
+/**
+ * @file SharedMemoryBackend.h
+ * @date 2026-10-16
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <string>
+#include <thread>
+
+#include <sigslot/signal.hpp>
+
+#include "dplib/net/can/CanFrame.h"
+#include "dplib/net/can/CanInterface.h"
+
+namespace datapanel
+{
+namespace net
+{
+namespace can
+{
+
+struct ShmHeader;
+struct ShmSlot;
+
+/**
+ * @brief Publish frames into a POSIX shared-memory ring
+ *
+ * One process owns the CAN socket and publishes every received frame
+ * into `/dev/shm/dplib-can-<name>`.  Any number of processes, up to
+ * @ref MaxReaders, attach to the ring with SharedMemoryBackend and keep
+ * their own cursor, so the kernel only delivers each frame once and
+ * readers pay no system calls for it.
+ *
+ * Lossy readers that fall more than a ring behind skip ahead and count
+ * the frames they missed.  Lossless readers are never overwritten; when
+ * one of them is a full ring behind, publish() drops the new frames
+ * instead and counts them in dropped().
+ *
+ * @code
+ * auto bus = CanBus::create("SocketCAN", "can0");
+ * SharedMemoryPublisher publisher("can0");
+ * publisher.open();
+ * publisher.attach(*bus);
+ * bus->connect();
+ * @endcode
+ */
+class SharedMemoryPublisher
+{
+  public:
+    static constexpr size_t DefaultCapacity = 65536; /**< Default number of frames in the ring */
+    static constexpr size_t MaxReaders = 32;         /**< Largest number of attached readers */
+
+    /**
+     * @param[in] name Channel name readers attach to
+     * @param[in] capacity Minimum number of frames in the ring, rounded up to a power of two
+     */
+    explicit SharedMemoryPublisher(std::string name, size_t capacity = DefaultCapacity);
+    ~SharedMemoryPublisher();
+
+    SharedMemoryPublisher(const SharedMemoryPublisher &) = delete;
+    SharedMemoryPublisher &operator=(const SharedMemoryPublisher &) = delete;
+
+    /**
+     * @brief Create the shared-memory segment
+     *
+     * A segment left behind by a publisher that exited without calling
+     * close() is replaced.
+     *
+     * @return false if the segment could not be created or another
+     *         live process is publishing on the same channel
+     */
+    bool open();
+
+    /**
+     * @brief Tell readers the channel is closed and remove the segment
+     */
+    void close();
+
+    /**
+     * @return true between open() and close()
+     */
+    bool isOpen() const
+    {
+        return _header != nullptr;
+    }
+
+    /**
+     * @brief Copy frames into the ring and wake sleeping readers
+     *
+     * @param[in] frames Frames to publish
+     * @param[in] count Number of frames
+     *
+     * @return Number of frames published; the rest were dropped because
+     *         a lossless reader has fallen a full ring behind
+     */
+    size_t publish(const CanFrame *frames, size_t count);
+
+    /**
+     * @brief Publish one frame
+     *
+     * @return false if the frame was dropped
+     */
+    bool publish(const CanFrame &frame)
+    {
+        return publish(&frame, 1) == 1;
+    }
+
+    /**
+     * @brief Publish every frame received by @p source
+     *
+     * Frames are published from CanInterface::framesTapped, so the
+     * publishing process can still receive them from @p source.
+     *
+     * @param[in] source Interface to forward; must outlive the publisher or detach()
+     */
+    void attach(CanInterface &source);
+
+    /**
+     * @brief Stop forwarding the interface given to attach()
+     */
+    void detach();
+
+    /**
+     * @return Number of frames published since open()
+     */
+    uint64_t published() const;
+
+    /**
+     * @return Number of frames dropped because of lossless readers since open()
+     */
+    uint64_t dropped() const;
+
+    /**
+     * @return Description of the last failure
+     */
+    const std::string &errorMessage() const
+    {
+        return _errorMessage;
+    }
+
+  private:
+    uint64_t minLosslessCursor();
+
+    std::string _name;
+    size_t _capacity;
+    int _fd = -1;
+    size_t _mapSize = 0;
+    ShmHeader *_header = nullptr;
+    ShmSlot *_slots = nullptr;
+
+    uint64_t _head = 0;             /**< Local copy of the ring head */
+    uint64_t _minCursor = 0;        /**< Lower bound of every lossless reader's cursor */
+    uint32_t _readerGeneration = 0; /**< Reader table generation _minCursor was computed for */
+
+    sigslot::scoped_connection _connection;
+    std::string _errorMessage;
+};
+
+/**
+ * @brief CAN interface reading frames published by SharedMemoryPublisher
+ *
+ * The channel is the name given to the publisher.  Reading needs no
+ * system calls: a helper thread sleeps on a futex in the shared segment
+ * and signals an eventfd in eventDispatcher() when the publisher wakes
+ * it, after which the dispatcher copies all new frames into the receive
+ * queue.  The frame ring itself is mapped read-only.
+ *
+ * Readers start with the next frame published after connect().  By
+ * default they are lossy; set @ref CfgOptOther to @ref LosslessOption
+ * before connecting to hold the publisher back instead.  A lossless
+ * reader whose receive queue is full leaves the remaining frames in the
+ * ring and retries after @ref RetryMs.
+ *
+ * Shared-memory channels are receive-only; send() fails with
+ * CanInterface::OperationError.
+ */
+class SharedMemoryBackend : public CanInterface
+{
+  public:
+    static constexpr const char *LosslessOption = "lossless"; /**< CfgOptOther value selecting a lossless reader */
+    static constexpr int RetryMs = 1; /**< Delay before a lossless reader with a full queue retries */
+
+    ~SharedMemoryBackend();
+
+    bool open() override;
+    bool close() override;
+
+    bool send(const CanFrame &frame) override;
+
+    /**
+     * @return Number of frames a lossy reader missed because it fell a ring behind
+     */
+    uint64_t countLost() const
+    {
+        return _lost;
+    }
+
+    static std::unique_ptr<CanInterface> init(const std::string &channel);
+
+    static std::list<CanInterfaceInfo> availableChannels();
+
+  private:
+    explicit SharedMemoryBackend(const std::string &channel) : _name(channel)
+    {
+    }
+
+    bool attachReader(bool lossless);
+    void waitForFrames();
+    void readRing();
+    void unmap();
+
+    std::string _name;
+    int _fd = -1;
+    int _eventFd = -1;
+    size_t _controlSize = 0;
+    size_t _dataSize = 0;
+    ShmHeader *_header = nullptr;
+    const ShmSlot *_slots = nullptr;
+    int _reader = -1; /**< Index of our entry in the reader table */
+
+    uint64_t _cursor = 0;
+    uint64_t _lost = 0;
+    bool _lossless = false;
+    bool _closedReported = false;
+    int _retryTimer = -1;
+
+    std::thread _waiter;
+    std::atomic<bool> _stopWaiter{false};
+    std::atomic<bool> _notified{false};
+};
+
+}  // namespace can
+}  // namespace net
+}  // namespace datapanel
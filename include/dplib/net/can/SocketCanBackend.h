@@ -27,6 +27,10 @@
 #include <sys/uio.h>
 #include <linux/can.h>
 #include <sys/time.h>
+#include <linux/errqueue.h>
+
+#include <atomic>
+#include <vector>
 
 namespace datapanel
 {
@@ -36,10 +40,46 @@ namespace can
 {
 /**
  * @brief CAN interface using Linux SocketCAN API
+ *
+ * Frames are read in batches of up to @ref CfgOptRxBatchSize frames
+ * per `recvmmsg()` call.  Receive timestamps are delivered by the
+ * kernel with nanosecond resolution as control messages alongside each
+ * frame (`SCM_TIMESTAMPNS`, or `SCM_TIMESTAMPING` when
+ * @ref CfgOptTimestampSource selects hardware timestamps).
+ *
+ * With @ref CfgOptQueuedTx set, send() only adds the frame to the
+ * transmit queue.  The queue is drained with `sendmmsg()` whenever
+ * epoll reports the socket writable, and framesTransmitted is emitted
+ * after each batch.  A full device queue (`ENOBUFS`) is retried after
+ * @ref TxRetryMs instead of losing the frame.  The transmit queue has
+ * a single producer, so queued send() calls must all come from one
+ * thread; that thread need not be the one servicing the interface.
+ *
+ * Receive filters are installed in the kernel with `CAN_RAW_FILTER` and
+ * `CAN_RAW_ERR_FILTER`, so rejected frames are never copied to user
+ * space.
  */
 class SocketCanBackend : public CanInterface
 {
   public:
+    /**
+     * @brief Counters for system calls issued by the backend
+     */
+    struct IoStatistics {
+        uint64_t rxSyscalls = 0;         /**< Number of receive system calls */
+        uint64_t rxFrames = 0;           /**< Number of frames received */
+        uint64_t txSyscalls = 0;         /**< Number of queued transmit system calls */
+        uint64_t txFrames = 0;           /**< Number of queued frames transmitted */
+        uint64_t txErrors = 0;           /**< Number of queued frames rejected by the kernel */
+        uint64_t rxControlTruncated = 0; /**< Number of frames whose control data did not fit (MSG_CTRUNC) */
+    };
+
+    static constexpr int DefaultRxBatchSize = 32; /**< Default value of CfgOptRxBatchSize */
+    static constexpr int MaxRxBatchSize = 1024;   /**< Largest supported value of CfgOptRxBatchSize */
+    static constexpr size_t MaxRxFilters = 512;   /**< Kernel limit on the number of receive filters */
+    static constexpr int TxBatchSize = 64;        /**< Maximum number of queued frames per sendmmsg() */
+    static constexpr int TxRetryMs = 1;           /**< Delay before retrying when the device queue is full */
+
     ~SocketCanBackend();
 
     bool open() override;
@@ -57,8 +97,29 @@ class SocketCanBackend : public CanInterface
 
     static std::list<CanInterfaceInfo> availableChannels();
 
+    /**
+     * @brief System call counters
+     *
+     * @return Counters accumulated since the backend was created
+     */
+    const IoStatistics &ioStatistics() const
+    {
+        return _ioStats;
+    }
+
+  protected:
+    bool applyRxFilters() override;
+
   private:
+    friend class SocketCanBackendTest; /**< Feeds readSocket() from a socketpair in the allocation tests */
+
     bool applyConfigOption(ConfigOption opt, const ConfigOptionValue &value);
+    bool applyTimestampSource(TimestampSource source);
+    void setupRxBuffers();
+    void setupTxBuffers();
+    void armTx();
+    void disarmTx();
+    void drainTx();
 
     SocketCanBackend(const std::string &channel) : _ifname(channel)
     {
@@ -68,14 +129,31 @@ class SocketCanBackend : public CanInterface
     int _socket = -1;
 
     struct sockaddr_can _addr;
-    canfd_frame _raw_frame;
-    msghdr _msg;
-    iovec _iov;
-    char _ctrlmsg[CMSG_SPACE(sizeof(timeval)) + CMSG_SPACE(sizeof(uint32_t))];
+
+    /** Control message buffer for a single received frame, large enough for every enabled timestamp */
+    struct RxControl {
+        alignas(cmsghdr) char data[CMSG_SPACE(sizeof(timespec)) + CMSG_SPACE(sizeof(scm_timestamping))];
+    };
+
+    std::vector<canfd_frame> _rxBuffers; /**< Raw frames filled by recvmmsg */
+    std::vector<iovec> _rxIov;           /**< One iovec per entry in _rxBuffers */
+    std::vector<RxControl> _rxControl;   /**< One control buffer per entry in _rxBuffers */
+    std::vector<mmsghdr> _rxMsgs;        /**< Message headers passed to recvmmsg */
 
     void readSocket();
 
+    std::vector<canfd_frame> _txBuffers; /**< Encoded frames waiting for sendmmsg */
+    std::vector<iovec> _txIov;           /**< One iovec per entry in _txBuffers */
+    std::vector<mmsghdr> _txMsgs;        /**< Message headers passed to sendmmsg */
+    int _txHead = 0;                     /**< First entry of _txMsgs not sent yet */
+    int _txCount = 0;                    /**< Number of valid entries in _txMsgs */
+    std::atomic<bool> _txArmed{false};   /**< Socket is registered for EPOLLOUT */
+    int _txRetryTimer = -1;
+    bool _queuedTx = false;
+
     bool _fdEnabled = false;
+    int _rxBatchSize = DefaultRxBatchSize;
+    IoStatistics _ioStats;
 };
 
 }  // namespace can
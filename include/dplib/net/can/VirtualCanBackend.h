@@ -0,0 +1,254 @@
+/**
+ * Copyright (c) 2026 Data Panel Corporation
+ * 181 Cheshire Ln, Suite 300
+ * Plymouth, MN 55441
+ * All rights reserved.
+ *
+ * This is the confidential and proprietary information of Data Panel
+ * Corporation. Such confidential information shall not be disclosed and is for
+ * use only in accordance with the license agreement you entered into with Data
+ * Panel.
+ */
+
+/**
+ * @file VirtualCanBackend.h
+ * @date 2026-10-16
+ */
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "dplib/net/can/CanFrame.h"
+#include "dplib/net/can/CanInterface.h"
+#include "dplib/util/SpscRing.h"
+
+namespace datapanel
+{
+namespace net
+{
+namespace can
+{
+
+class VirtualCanBackend;
+
+/**
+ * @brief Simulated CAN bus shared by VirtualCanBackend interfaces
+ *
+ * Every interface connected to a bus with the same name receives the
+ * frames the others send.  Buses exist while an interface is connected
+ * or a caller holds the pointer returned by find().
+ *
+ * With a bitrate of 0 (the default) frames are delivered as soon as
+ * they are sent.  With a bitrate set, a pacing thread transmits one
+ * frame at a time: at each bus idle point the pending frame with the
+ * highest arbitration priority wins, and it is delivered after
+ * frameBitCount() bit times, timestamped with the end of its
+ * transmission.
+ *
+ * Errors can be injected at random with setErrorRate() or on demand
+ * with injectError().  A corrupted transmission is replaced by an
+ * error frame, and the sender retransmits it.  Each sender tracks a
+ * transmit error counter as CAN controllers do: it goes error passive
+ * after 16 consecutive errors and bus-off after 32, until restarted.
+ */
+class VirtualCanBus
+{
+  public:
+    /**
+     * @brief Bus counters
+     */
+    struct Statistics {
+        uint64_t frames = 0; /**< Frames transmitted successfully */
+        uint64_t errors = 0; /**< Transmissions destroyed by errors */
+        uint64_t bits = 0;   /**< Bit times used by paced transmissions */
+    };
+
+    ~VirtualCanBus();
+
+    VirtualCanBus(const VirtualCanBus &) = delete;
+    VirtualCanBus &operator=(const VirtualCanBus &) = delete;
+
+    /**
+     * @brief Get the bus with the given name, creating it if needed
+     *
+     * @param[in] name Bus name
+     *
+     * @return Shared bus
+     */
+    static std::shared_ptr<VirtualCanBus> find(const std::string &name);
+
+    /**
+     * @return Names of all existing buses
+     */
+    static std::list<std::string> names();
+
+    /**
+     * @return Bus name
+     */
+    const std::string &name() const
+    {
+        return _name;
+    }
+
+    /**
+     * @brief Simulate a nominal bitrate
+     *
+     * @param[in] bitrate Bits per second, or 0 to deliver frames immediately
+     */
+    void setBitrate(int bitrate);
+
+    /**
+     * @return Simulated bitrate, or 0 if frames are delivered immediately
+     */
+    int bitrate() const
+    {
+        return _bitrate;
+    }
+
+    /**
+     * @brief Destroy a random fraction of transmissions
+     *
+     * @param[in] probability Chance that a transmission fails, from 0 to 1
+     * @param[in] seed Seed for the deterministic random sequence
+     */
+    void setErrorRate(double probability, uint32_t seed = 1);
+
+    /**
+     * @brief Send an error frame to every connected interface
+     *
+     * @param[in] error Bitwise OR of CanFrame::FrameError values
+     */
+    void injectError(uint32_t error);
+
+    /**
+     * @return Counters since the bus was created
+     */
+    Statistics statistics() const;
+
+    /**
+     * @return Number of connected interfaces
+     */
+    size_t nodeCount() const;
+
+  private:
+    friend class VirtualCanBackend;
+
+    explicit VirtualCanBus(std::string name);
+
+    void attach(VirtualCanBackend *node);
+    void detach(VirtualCanBackend *node);
+    bool transmit(VirtualCanBackend *sender, const CanFrame &frame);
+    void schedule();
+    void runPacer();
+    bool corrupted();
+    void deliver(const CanFrame &frame, VirtualCanBackend *sender, int64_t timestampNs);
+    void deliverError(uint32_t error, int64_t timestampNs);
+
+    std::string _name;
+    mutable std::mutex _mutex;
+    std::condition_variable _wake;
+    std::vector<VirtualCanBackend *> _nodes;
+
+    std::atomic<int> _bitrate{0};
+    uint32_t _errorThreshold = 0; /**< Transmissions fail when the next random number is below this */
+    std::mt19937 _random;
+    Statistics _stats;
+
+    std::thread _pacer;
+    bool _stopPacer = false;
+    int64_t _busFreeAt = 0; /**< Steady clock time the current transmission ends, ns */
+    int64_t _clockOffset;   /**< Realtime minus steady clock, for frame timestamps */
+};
+
+/**
+ * @brief CAN interface on a VirtualCanBus
+ *
+ * The channel names the bus.  No kernel support or privileges are
+ * needed, so interfaces can be created freely in tests and benchmarks.
+ * Received frames are handed to eventDispatcher() through an eventfd.
+ *
+ * Setting @ref CfgOptBitrate changes the bitrate of the whole bus.
+ * With @ref CfgOptRxOwn set, the interface also receives the frames it
+ * sends, marked as local echo.  Error frames are only received if
+ * selected with setErrorFilter().
+ */
+class VirtualCanBackend : public CanInterface
+{
+  public:
+    static constexpr int WarningLimit = 96;          /**< Transmit error count that raises CanBusState::Warning */
+    static constexpr int ErrorPassiveLimit = 128;    /**< Transmit error count that raises CanBusState::Error */
+    static constexpr int BusOffLimit = 256;          /**< Transmit error count that takes the interface bus-off */
+    static constexpr size_t DefaultInboxSize = 8192; /**< Frames that can wait for the interface's dispatcher */
+
+    ~VirtualCanBackend();
+
+    bool open() override;
+    bool close() override;
+
+    void setConfigOption(ConfigOption opt, const ConfigOptionValue &value) override;
+    bool send(const CanFrame &frame) override;
+
+    bool restart() override;
+    CanBusState busStatus() override;
+
+    /**
+     * @return Bus the interface is connected to, or nullptr if disconnected
+     */
+    VirtualCanBus *bus() const
+    {
+        return _bus.get();
+    }
+
+    /**
+     * @return Frames lost because the dispatcher did not keep up with the bus
+     */
+    uint64_t countInboxDropped() const
+    {
+        return _inbox.dropped();
+    }
+
+    static std::unique_ptr<CanInterface> init(const std::string &channel);
+
+    static std::list<CanInterfaceInfo> availableChannels();
+
+  private:
+    friend class VirtualCanBus;
+
+    explicit VirtualCanBackend(const std::string &channel) : _name(channel), _inbox(DefaultInboxSize)
+    {
+    }
+
+    void post(const CanFrame &frame);
+    void signal();
+    void readInbox();
+
+    std::string _name;
+    std::shared_ptr<VirtualCanBus> _bus;
+    int _eventFd = -1;
+    bool _fdEnabled = false;
+    std::atomic<bool> _rxOwn{false};
+
+    /** Frames delivered by the bus; filled under the bus mutex, drained by the dispatcher */
+    util::SpscRing<CanFrame> _inbox;
+    std::atomic<bool> _signalled{false};
+    std::atomic<uint32_t> _transmitted{0}; /**< Frames sent since the dispatcher last looked */
+
+    // Owned by the bus, under its mutex
+    int _txErrors = 0; /**< Transmit error counter */
+    bool _hasTxHead = false;
+    CanFrame _txHead;
+};
+
+}  // namespace can
+}  // namespace net
+}  // namespace datapanel
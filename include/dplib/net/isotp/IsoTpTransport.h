@@ -0,0 +1,266 @@
+/**
+ * Copyright (c) 2026 Data Panel Corporation
+ * 181 Cheshire Ln, Suite 300
+ * Plymouth, MN 55441
+ * All rights reserved.
+ *
+ * This is the confidential and proprietary information of Data Panel
+ * Corporation. Such confidential information shall not be disclosed and is for
+ * use only in accordance with the license agreement you entered into with Data
+ * Panel.
+ */
+
+/**
+ * @file IsoTpTransport.h
+ * @date 2026-10-16
+ */
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <sigslot/signal.hpp>
+
+#include "dplib/net/can/CanFrame.h"
+#include "dplib/net/can/CanInterface.h"
+#include "dplib/util/ByteView.h"
+
+namespace datapanel
+{
+namespace core
+{
+class EventDispatcher;
+}
+
+namespace net
+{
+namespace isotp
+{
+
+/**
+ * @brief Addressing and flow control settings of one ISO-TP channel
+ */
+struct IsoTpChannelConfig {
+    can::CanFrame::FrameId txId = 0; /**< Identifier of frames sent on the channel */
+    can::CanFrame::FrameId rxId = 0; /**< Identifier of frames received on the channel */
+    bool extendedId = false;         /**< Use 29-bit identifiers */
+    size_t frameSize = 8;            /**< Largest frame sent: 8 for classic CAN, up to 64 for CAN FD */
+    bool padding = true;             /**< Pad classic frames to 8 bytes */
+    uint8_t paddingByte = 0xCC;      /**< Value of padding bytes */
+    uint8_t blockSize = 0;           /**< Consecutive frames the peer may send per flow control, 0 for all */
+    uint8_t stMin = 0;               /**< Separation time requested from the peer, in ISO 15765-2 encoding */
+    size_t maxMessageSize = 4095;    /**< Largest message sent or received; buffers are allocated up front */
+};
+
+/**
+ * @brief ISO 15765-2 transport protocol over a CAN interface
+ *
+ * Segments outgoing messages into single, first and consecutive frames
+ * and reassembles incoming ones, with block size and STmin flow
+ * control, for classic CAN and CAN FD frame sizes.  Messages longer
+ * than 4095 bytes use the 32-bit first frame length.  Any number of
+ * channels can send and receive at once; each owns receive and
+ * transmit buffers of its @ref IsoTpChannelConfig::maxMessageSize
+ * allocated by addChannel(), so transfers do not allocate.
+ *
+ * Consecutive frames the peer allows without a separation time are
+ * sent back to back, limited only by the interface's transmit queue.
+ * Separation times are kept by one periodic timer shared by all
+ * channels on the event dispatcher's high-resolution timer path and
+ * scheduled from the previous frame's due time, so timer latency does
+ * not add to every frame.  Sub-millisecond STmin values need the
+ * dispatcher in core::EventDispatcher::TimerMode::Precise.
+ *
+ * @code
+ * IsoTpTransport isotp;
+ * IsoTpChannelConfig config;
+ * config.txId = 0x7E0;
+ * config.rxId = 0x7E8;
+ * const int ecu = isotp.addChannel(config);
+ * isotp.messageReceived.connect([](int channel, util::ByteView response) { handleUds(response); });
+ * isotp.attach(*bus);
+ * isotp.send(ecu, request);
+ * @endcode
+ */
+class IsoTpTransport
+{
+  public:
+    static constexpr int TimeoutMs = 1000;    /**< N_Bs and N_Cr: longest wait for flow control or the next frame */
+    static constexpr int MaxWaitFrames = 10;  /**< Flow control WAIT frames accepted in a row */
+    static constexpr int TimeoutCheckMs = 20; /**< Interval of the timeout timer */
+
+    /**
+     * @brief How a transfer ended
+     */
+    enum Result {
+        Ok,            /**< Transfer complete */
+        Timeout,       /**< The peer did not answer or send the next frame in time */
+        WrongSequence, /**< A consecutive frame was lost */
+        Overflow,      /**< The message is larger than the receiver accepts */
+        WaitLimit,     /**< The peer asked to wait too many times */
+        BadFrame,      /**< The peer sent an invalid protocol frame */
+        TxFailed,      /**< The interface rejected a frame */
+        Interrupted,   /**< A new message from the peer replaced the one in progress */
+    };
+
+    /**
+     * @brief Emitted for each complete message: channel, data
+     *
+     * The data is only valid during the call.
+     */
+    sigslot::signal<int, util::ByteView> messageReceived;
+
+    /**
+     * @brief Emitted when a message from the peer is abandoned: channel, reason
+     */
+    sigslot::signal<int, Result> receiveFailed;
+
+    /**
+     * @brief Emitted when a send() transfer ends: channel, result
+     */
+    sigslot::signal<int, Result> sendFinished;
+
+    IsoTpTransport();
+    ~IsoTpTransport();
+
+    IsoTpTransport(const IsoTpTransport &) = delete;
+    IsoTpTransport &operator=(const IsoTpTransport &) = delete;
+
+    /**
+     * @brief Add a channel
+     *
+     * @param[in] config Identifiers and flow control settings
+     *
+     * @return Channel number, or -1 if @p config is invalid or its
+     *         receive identifier is already used (see errorMessage())
+     */
+    int addChannel(const IsoTpChannelConfig &config);
+
+    /**
+     * @return Number of channels added
+     */
+    size_t channelCount() const
+    {
+        return _channels.size();
+    }
+
+    /**
+     * @brief Dispatcher used for timers instead of the attached interface's
+     *
+     * @param[in] dispatcher Dispatcher, or nullptr to use the interface's
+     */
+    void setEventDispatcher(core::EventDispatcher *dispatcher);
+
+    /**
+     * @brief Send and receive through @p bus
+     *
+     * Received frames are taken from can::CanInterface::framesTapped;
+     * @p bus's receive queue still holds them for the application.
+     *
+     * @param[in] bus Interface to use; must outlive the transport or detach()
+     */
+    void attach(can::CanInterface &bus);
+
+    /**
+     * @brief Stop using the interface given to attach()
+     */
+    void detach();
+
+    /**
+     * @brief Start sending a message
+     *
+     * The data is copied.  sendFinished is emitted when the transfer
+     * ends, before send() returns for single-frame messages.
+     *
+     * @param[in] channel Channel number
+     * @param[in] data Message, at most the channel's maxMessageSize bytes
+     *
+     * @return false if the channel is busy sending, the message is too
+     *         long or no interface is attached (see errorMessage())
+     */
+    bool send(int channel, util::ByteView data);
+
+    /**
+     * @return true while a send() transfer is in progress on @p channel
+     */
+    bool isSending(int channel) const;
+
+    /**
+     * @brief Handle received frames
+     *
+     * Frames whose identifier is not a channel's receive identifier are
+     * ignored.
+     *
+     * @param[in] frames Received frames
+     * @param[in] count Number of frames
+     */
+    void process(const can::CanFrame *frames, size_t count);
+
+    /**
+     * @brief Handle one received frame
+     */
+    void process(const can::CanFrame &frame)
+    {
+        process(&frame, 1);
+    }
+
+    /**
+     * @brief Abandon transfers whose timeout expired before @p now
+     *
+     * Called by the timeout timer.
+     */
+    void expireTimeouts(std::chrono::steady_clock::time_point now);
+
+    /**
+     * @return Description of the last failed call
+     */
+    const std::string &errorMessage() const
+    {
+        return _errorMessage;
+    }
+
+  private:
+    struct Channel;
+
+    void handleFrame(Channel &channel, const can::CanFrame &frame, std::chrono::steady_clock::time_point now);
+    void handleFlowControl(Channel &channel, const uint8_t *data, size_t size,
+                           std::chrono::steady_clock::time_point now);
+    void startReceive(Channel &channel, size_t length, const uint8_t *data, size_t size,
+                      std::chrono::steady_clock::time_point now);
+    void pump(Channel &channel, std::chrono::steady_clock::time_point now);
+    void pace();
+    void retryBlocked();
+    bool sendFrame(Channel &channel, const uint8_t *data, size_t size);
+    bool sendFlowControl(Channel &channel, uint8_t status);
+    void finishSend(Channel &channel, Result result);
+    void failReceive(Channel &channel, Result result);
+    void startTimeoutTimer();
+    void updatePacer();
+    void stopTimers();
+    core::EventDispatcher *dispatcher() const;
+
+    std::vector<std::unique_ptr<Channel>> _channels;
+    /** Channel for each receive identifier, bit 31 set if extended */
+    std::unordered_map<uint32_t, int> _channelByRxId;
+
+    can::CanInterface *_bus = nullptr;
+    core::EventDispatcher *_dispatcher = nullptr;
+    core::EventDispatcher *_timerDispatcher = nullptr; /**< Dispatcher running the timers */
+    int _timeoutTimer = -1;
+    int _pacer = -1;
+    std::chrono::nanoseconds _pacerPeriod{0};
+    size_t _busy = 0;    /**< Channels with a transfer in progress */
+    size_t _blocked = 0; /**< Channels waiting for room in the transmit queue */
+    sigslot::scoped_connection _rxConnection;
+    sigslot::scoped_connection _txConnection;
+    std::string _errorMessage;
+};
+
+}  // namespace isotp
+}  // namespace net
+}  // namespace datapanel
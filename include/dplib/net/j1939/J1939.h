@@ -0,0 +1,101 @@
+/**
+ * Copyright (c) 2026 Data Panel Corporation
+ * 181 Cheshire Ln, Suite 300
+ * Plymouth, MN 55441
+ * All rights reserved.
+ *
+ * This is the confidential and proprietary information of Data Panel
+ * Corporation. Such confidential information shall not be disclosed and is for
+ * use only in accordance with the license agreement you entered into with Data
+ * Panel.
+ */
+
+/**
+ * @file J1939.h
+ * @date 2026-10-16
+ */
+
+#pragma once
+
+#include <cstdint>
+
+#include "dplib/util/ByteView.h"
+
+namespace datapanel
+{
+namespace net
+{
+namespace j1939
+{
+
+using Pgn = uint32_t; /**< Parameter group number, 18 bits */
+
+constexpr uint8_t NullAddress = 0xFE;   /**< Source address of a node without an address */
+constexpr uint8_t GlobalAddress = 0xFF; /**< Destination address of broadcasts */
+
+constexpr Pgn PgnTpDt = 0xEB00; /**< Transport protocol data transfer (TP.DT) */
+constexpr Pgn PgnTpCm = 0xEC00; /**< Transport protocol connection management (TP.CM) */
+
+/**
+ * @brief Fields of a 29-bit J1939 identifier
+ *
+ * PDU1 parameter groups (PDU format below 240) carry a destination
+ * address in the PDU specific byte; PDU2 groups are always broadcast
+ * and the PDU specific byte is part of the PGN.
+ */
+struct J1939Id {
+    uint8_t priority = 6;                /**< 0 (highest) to 7 */
+    Pgn pgn = 0;                         /**< Parameter group number; zero PDU specific byte for PDU1 */
+    uint8_t source = NullAddress;        /**< Source address */
+    uint8_t destination = GlobalAddress; /**< Destination address, GlobalAddress for PDU2 */
+
+    /**
+     * @brief Split a 29-bit identifier into its fields
+     */
+    static constexpr J1939Id decode(uint32_t id) noexcept
+    {
+        J1939Id result;
+        const uint8_t pduFormat = uint8_t(id >> 16);
+        const uint8_t pduSpecific = uint8_t(id >> 8);
+        result.priority = uint8_t((id >> 26) & 0x7);
+        result.source = uint8_t(id);
+        if (pduFormat < 240) {
+            result.pgn = (id >> 8) & 0x3FF00;
+            result.destination = pduSpecific;
+        } else {
+            result.pgn = (id >> 8) & 0x3FFFF;
+            result.destination = GlobalAddress;
+        }
+        return result;
+    }
+
+    /**
+     * @brief Build the 29-bit identifier
+     */
+    constexpr uint32_t encode() const noexcept
+    {
+        uint32_t id = uint32_t(priority & 0x7) << 26 | (pgn & 0x3FFFF) << 8 | source;
+        if (((pgn >> 8) & 0xFF) < 240)
+            id = (id & ~uint32_t(0xFF00)) | uint32_t(destination) << 8;
+        return id;
+    }
+};
+
+/**
+ * @brief Complete J1939 message, single frame or reassembled
+ *
+ * @ref data refers to the received frame or to the transport session
+ * buffer and is only valid until the handler it was passed to returns.
+ */
+struct J1939Message {
+    Pgn pgn = 0;                         /**< Parameter group number */
+    uint8_t priority = 6;                /**< Priority of the frame, or of the TP.CM frame that announced it */
+    uint8_t source = NullAddress;        /**< Sender */
+    uint8_t destination = GlobalAddress; /**< Receiver, GlobalAddress for broadcasts */
+    int64_t timestampNs = 0;             /**< Timestamp of the last frame of the message */
+    util::ByteView data;                 /**< Message data */
+};
+
+}  // namespace j1939
+}  // namespace net
+}  // namespace datapanel
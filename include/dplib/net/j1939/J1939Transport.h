@@ -0,0 +1,241 @@
+/**
+ * Copyright (c) 2026 Data Panel Corporation
+ * 181 Cheshire Ln, Suite 300
+ * Plymouth, MN 55441
+ * All rights reserved.
+ *
+ * This is the confidential and proprietary information of Data Panel
+ * Corporation. Such confidential information shall not be disclosed and is for
+ * use only in accordance with the license agreement you entered into with Data
+ * Panel.
+ */
+
+/**
+ * @file J1939Transport.h
+ * @date 2026-10-16
+ */
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include <sigslot/signal.hpp>
+
+#include "dplib/net/can/CanFrame.h"
+#include "dplib/net/can/CanInterface.h"
+#include "dplib/net/j1939/J1939.h"
+
+namespace datapanel
+{
+namespace core
+{
+class EventDispatcher;
+}
+
+namespace net
+{
+namespace j1939
+{
+
+/**
+ * @brief Receive J1939 messages, reassembling transport protocol transfers
+ *
+ * Single-frame parameter groups are passed straight through.  Messages
+ * of up to 1785 bytes sent with the transport protocol, either as a
+ * broadcast (BAM) or as a connection (RTS/CTS), are reassembled in a
+ * table of sessions allocated up front, so a busy bus never allocates.
+ * One broadcast and one connection per sender and receiver pair can be
+ * in progress at once, as J1939-21 allows.
+ *
+ * By default the transport only listens, reassembling every connection
+ * it sees.  After setAddress(), connections addressed to that address
+ * are answered with CTS and end-of-message acknowledgements through the
+ * attached interface.
+ *
+ * Sessions that stall are aborted after the J1939-21 T1 and T2
+ * timeouts, checked by a timer on the event dispatcher of the attached
+ * interface or the one given to setEventDispatcher().
+ *
+ * @code
+ * J1939Transport j1939;
+ * j1939.messageReceived.connect([](const J1939Message &message) {
+ *     if (message.pgn == 0xFECA)
+ *         handleDm1(message.source, message.data);
+ * });
+ * j1939.attach(*bus);
+ * @endcode
+ */
+class J1939Transport
+{
+  public:
+    static constexpr size_t DefaultMaxSessions = 128; /**< Default number of concurrent transfers */
+    static constexpr size_t MaxMessageSize = 1785;    /**< Largest transport protocol message */
+    static constexpr int T1Ms = 750;                  /**< Longest wait for the next TP.DT */
+    static constexpr int T2Ms = 1250;                 /**< Longest wait for TP.DT after a TP.CM */
+    static constexpr int TimeoutCheckMs = 50;         /**< Interval of the timeout timer */
+
+    /**
+     * @brief Connection abort reasons, as sent in TP.CM_Abort
+     */
+    enum AbortReason : uint8_t {
+        AlreadyInSession = 1,   /**< Receiver is busy with another connection */
+        NoResources = 2,        /**< No free session */
+        Timeout = 3,            /**< A T1 or T2 timeout expired */
+        CtsDuringTransfer = 4,  /**< CTS received while data was being transferred */
+        RetransmitLimit = 5,    /**< Too many retransmission requests */
+        UnexpectedTransfer = 6, /**< TP.DT without a session */
+        BadSequence = 7,        /**< TP.DT sequence number out of order */
+        BadSize = 9,            /**< Announced size or packet count invalid */
+        PeerAbort = 0xFF,       /**< The other side sent TP.CM_Abort; not sent on the bus */
+    };
+
+    /**
+     * @brief Counters since construction
+     */
+    struct Statistics {
+        uint64_t messages = 0;       /**< Messages delivered, including single frames */
+        uint64_t transfers = 0;      /**< Transport protocol messages reassembled */
+        uint64_t aborted = 0;        /**< Sessions aborted, including timeouts */
+        uint64_t timeouts = 0;       /**< Sessions that timed out */
+        uint64_t noSession = 0;      /**< Transfers ignored because every session was in use */
+        uint64_t strayTransfers = 0; /**< TP.DT frames without a session */
+    };
+
+    /**
+     * @brief Emitted for each complete message
+     *
+     * The message data is only valid during the call.
+     */
+    sigslot::signal<const J1939Message &> messageReceived;
+
+    /**
+     * @brief Emitted when a transfer is abandoned: source, destination, PGN, reason
+     */
+    sigslot::signal<uint8_t, uint8_t, Pgn, AbortReason> transferAborted;
+
+    /**
+     * @param[in] maxSessions Number of transfers that can be in progress at once
+     */
+    explicit J1939Transport(size_t maxSessions = DefaultMaxSessions);
+    ~J1939Transport();
+
+    J1939Transport(const J1939Transport &) = delete;
+    J1939Transport &operator=(const J1939Transport &) = delete;
+
+    /**
+     * @brief Answer connections addressed to @p address
+     *
+     * @param[in] address Own source address, or NullAddress to only listen
+     */
+    void setAddress(uint8_t address)
+    {
+        _address = address;
+    }
+
+    /**
+     * @return Own source address, NullAddress when only listening
+     */
+    uint8_t address() const
+    {
+        return _address;
+    }
+
+    /**
+     * @brief Dispatcher used for timeouts instead of the attached interface's
+     *
+     * @param[in] dispatcher Dispatcher, or nullptr to disable timeouts
+     */
+    void setEventDispatcher(core::EventDispatcher *dispatcher);
+
+    /**
+     * @brief Receive every frame received by @p source
+     *
+     * Frames come from can::CanInterface::framesTapped, so the receive
+     * queue is left to the application.  Replies are sent through
+     * @p source, and timeouts use its dispatcher.
+     *
+     * @param[in] source Interface to use; must outlive the transport or detach()
+     */
+    void attach(can::CanInterface &source);
+
+    /**
+     * @brief Stop using the interface given to attach()
+     */
+    void detach();
+
+    /**
+     * @brief Handle received frames
+     *
+     * Frames that are not 29-bit data frames are ignored.
+     *
+     * @param[in] frames Received frames
+     * @param[in] count Number of frames
+     */
+    void process(const can::CanFrame *frames, size_t count);
+
+    /**
+     * @brief Handle one received frame
+     */
+    void process(const can::CanFrame &frame)
+    {
+        process(&frame, 1);
+    }
+
+    /**
+     * @brief Abort transfers whose timeout expired before @p now
+     *
+     * Called by the timeout timer.
+     */
+    void expireSessions(std::chrono::steady_clock::time_point now);
+
+    /**
+     * @return Number of transfers in progress
+     */
+    size_t activeSessions() const
+    {
+        return _activeCount;
+    }
+
+    /**
+     * @return Counters since construction
+     */
+    const Statistics &statistics() const
+    {
+        return _stats;
+    }
+
+  private:
+    struct Session;
+
+    void handleFrame(const can::CanFrame &frame, std::chrono::steady_clock::time_point now);
+    void handleConnection(const J1939Id &id, const can::CanFrame &frame, std::chrono::steady_clock::time_point now);
+    void handleTransfer(const J1939Id &id, const can::CanFrame &frame, std::chrono::steady_clock::time_point now);
+    Session *openSession(uint16_t key);
+    Session *findSession(uint16_t key);
+    void closeSession(Session &session);
+    void abortSession(Session &session, AbortReason reason, bool notifyPeer);
+    void sendConnection(uint8_t destination, const uint8_t *data);
+    void sendCts(Session &session);
+    void startTimer();
+    void stopTimer();
+
+    std::vector<Session> _sessions;
+    std::unique_ptr<uint16_t[]> _index; /**< Session number + 1 for each source << 8 | destination, 0 if none */
+    std::vector<uint16_t> _free;        /**< Unused session numbers */
+    size_t _activeCount = 0;
+
+    uint8_t _address = NullAddress;
+    can::CanInterface *_bus = nullptr;
+    core::EventDispatcher *_dispatcher = nullptr;
+    core::EventDispatcher *_timerDispatcher = nullptr; /**< Dispatcher running _timer */
+    int _timer = -1;
+    sigslot::scoped_connection _connection;
+    Statistics _stats;
+};
+
+}  // namespace j1939
+}  // namespace net
+}  // namespace datapanel
@@ -0,0 +1,111 @@
+/**
+ * Copyright (c) 2026 Data Panel Corporation
+ * 181 Cheshire Ln, Suite 300
+ * Plymouth, MN 55441
+ * All rights reserved.
+ *
+ * This is the confidential and proprietary information of Data Panel
+ * Corporation. Such confidential information shall not be disclosed and is for
+ * use only in accordance with the license agreement you entered into with Data
+ * Panel.
+ */
+
+/**
+ * @file ByteView.h
+ * @date 2026-10-15
+ */
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <vector>
+
+namespace datapanel
+{
+namespace util
+{
+
+/**
+ * @brief Non-owning, read-only view of contiguous bytes
+ *
+ * Similar to `std::span<const std::byte>`.  The viewed memory must
+ * outlive the view.
+ */
+class ByteView
+{
+  public:
+    using const_iterator = const std::byte *;
+
+    constexpr ByteView() noexcept : _data(nullptr), _size(0)
+    {
+    }
+
+    constexpr ByteView(const std::byte *data, size_t size) noexcept : _data(data), _size(size)
+    {
+    }
+
+    ByteView(const std::vector<std::byte> &data) noexcept : _data(data.data()), _size(data.size())
+    {
+    }
+
+    template <size_t N> constexpr ByteView(const std::array<std::byte, N> &data) noexcept : _data(data.data()), _size(N)
+    {
+    }
+
+    /**
+     * @return Pointer to the first byte
+     */
+    constexpr const std::byte *data() const noexcept
+    {
+        return _data;
+    }
+
+    /**
+     * @return Number of bytes in view
+     */
+    constexpr size_t size() const noexcept
+    {
+        return _size;
+    }
+
+    /**
+     * @return true if the view contains no bytes
+     */
+    constexpr bool empty() const noexcept
+    {
+        return _size == 0;
+    }
+
+    constexpr const std::byte &operator[](size_t index) const noexcept
+    {
+        return _data[index];
+    }
+
+    constexpr const_iterator begin() const noexcept
+    {
+        return _data;
+    }
+
+    constexpr const_iterator end() const noexcept
+    {
+        return _data + _size;
+    }
+
+    /**
+     * @brief Copy the viewed bytes into a new vector
+     *
+     * @return Owning copy of the data
+     */
+    std::vector<std::byte> toVector() const
+    {
+        return std::vector<std::byte>(begin(), end());
+    }
+
+  private:
+    const std::byte *_data;
+    size_t _size;
+};
+
+}  // namespace util
+}  // namespace datapanel
@@ -0,0 +1,113 @@
+/**
+ * Copyright (c) 2026 Data Panel Corporation
+ * 181 Cheshire Ln, Suite 300
+ * Plymouth, MN 55441
+ * All rights reserved.
+ *
+ * This is the confidential and proprietary information of Data Panel
+ * Corporation. Such confidential information shall not be disclosed and is for
+ * use only in accordance with the license agreement you entered into with Data
+ * Panel.
+ */
+
+/**
+ * @file MpscQueue.h
+ * @date 2026-10-16
+ */
+
+#pragma once
+
+#include <atomic>
+#include <utility>
+
+#include "dplib/util/SpscRing.h"
+
+namespace datapanel
+{
+namespace util
+{
+
+/**
+ * @brief Unbounded lock-free multiple-producer/single-consumer queue
+ *
+ * Any number of threads may push(); one thread may pop().  Each push
+ * allocates one node.  Based on Dmitry Vyukov's intrusive MPSC queue:
+ * a push that has started but not yet finished linking its node may be
+ * invisible to pop() for a moment, so producers should wake the
+ * consumer after pushing.
+ *
+ * @tparam T Item type; must be default constructible and movable
+ */
+template <typename T> class MpscQueue
+{
+  public:
+    MpscQueue() : _tail(new Node)
+    {
+        _head.store(_tail, std::memory_order_relaxed);
+    }
+
+    ~MpscQueue()
+    {
+        while (_tail != nullptr) {
+            Node *next = _tail->next.load(std::memory_order_relaxed);
+            delete _tail;
+            _tail = next;
+        }
+    }
+
+    MpscQueue(const MpscQueue &) = delete;
+    MpscQueue &operator=(const MpscQueue &) = delete;
+
+    /**
+     * @brief Add an item (any thread)
+     *
+     * @param[in] item Item to add
+     */
+    void push(T item)
+    {
+        Node *node = new Node;
+        node->value = std::move(item);
+        Node *prev = _head.exchange(node, std::memory_order_acq_rel);
+        prev->next.store(node, std::memory_order_release);
+    }
+
+    /**
+     * @brief Remove the oldest item (consumer only)
+     *
+     * @param[out] item Receives the removed item
+     *
+     * @return false if the queue was empty
+     */
+    bool pop(T &item)
+    {
+        Node *next = _tail->next.load(std::memory_order_acquire);
+        if (next == nullptr)
+            return false;
+
+        item = std::move(next->value);
+        next->value = T();
+        delete _tail;
+        _tail = next;
+        return true;
+    }
+
+    /**
+     * @return true if no completed push is waiting (consumer only)
+     */
+    bool empty() const
+    {
+        return _tail->next.load(std::memory_order_acquire) == nullptr;
+    }
+
+  private:
+    struct Node {
+        std::atomic<Node *> next{nullptr};
+        T value;
+    };
+
+    alignas(CacheLineSize) std::atomic<Node *> _head;
+    alignas(CacheLineSize) Node *_tail;
+};
+
+}  // namespace util
+}  // namespace datapanel
@@ -0,0 +1,284 @@
+/**
+ * Copyright (c) 2026 Data Panel Corporation
+ * 181 Cheshire Ln, Suite 300
+ * Plymouth, MN 55441
+ * All rights reserved.
+ *
+ * This is the confidential and proprietary information of Data Panel
+ * Corporation. Such confidential information shall not be disclosed and is for
+ * use only in accordance with the license agreement you entered into with Data
+ * Panel.
+ */
+
+/**
+ * @file SpscRing.h
+ * @date 2026-10-15
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <type_traits>
+
+namespace datapanel
+{
+namespace util
+{
+
+/** Size of a cache line, used to keep producer and consumer state apart */
+constexpr size_t CacheLineSize = 64;
+
+/**
+ * @brief What a bounded queue does when an item is added while it is full
+ */
+enum class OverflowPolicy {
+    DropNewest, /**< Discard the item being added */
+    DropOldest, /**< Discard the oldest queued item to make room */
+    Block,      /**< Wait until the consumer makes room; the consumer must run on another thread */
+};
+
+/**
+ * @brief Bounded lock-free single-producer/single-consumer ring buffer
+ *
+ * One thread may call the producer methods (push()) while another
+ * thread calls the consumer methods (pop()).  size(), dropped() and
+ * clear() may be called from either thread.  reset() must only be called
+ * while neither side is active.
+ *
+ * The capacity is rounded up to a power of two.  Storage is allocated
+ * once by the constructor or reset(); pushing and popping never
+ * allocate.
+ *
+ * With OverflowPolicy::DropOldest the producer discards the oldest item
+ * itself.  Both sides take an item by advancing the head, so the
+ * consumer owns an item before it reads it.  Each slot carries a sequence
+ * number that the owner advances once it is done with the slot, and the
+ * producer only writes a slot after that.  No slot is ever read while it
+ * is being written.
+ *
+ * @tparam T Item type
+ */
+template <typename T> class SpscRing
+{
+    static_assert(std::is_trivially_copyable_v<T>, "SpscRing items must be trivially copyable");
+
+  public:
+    /**
+     * @param[in] capacity Minimum number of items the ring can hold
+     * @param[in] policy Behavior when pushing into a full ring
+     */
+    explicit SpscRing(size_t capacity = 1024, OverflowPolicy policy = OverflowPolicy::DropNewest)
+    {
+        reset(capacity, policy);
+    }
+
+    SpscRing(const SpscRing &) = delete;
+    SpscRing &operator=(const SpscRing &) = delete;
+
+    /**
+     * @brief Discard all items and change the capacity and overflow policy
+     *
+     * @note Not thread safe.
+     *
+     * @param[in] capacity Minimum number of items the ring can hold
+     * @param[in] policy Behavior when pushing into a full ring
+     */
+    void reset(size_t capacity, OverflowPolicy policy)
+    {
+        size_t rounded = 1;
+        while (rounded < capacity) rounded <<= 1;
+
+        if (rounded != _capacity) {
+            _slots = std::make_unique<Slot[]>(rounded);
+            _capacity = rounded;
+            _mask = rounded - 1;
+        }
+        for (size_t i = 0; i < _capacity; i++) _slots[i].seq.store(i, std::memory_order_relaxed);
+        _policy = policy;
+        _head.store(0, std::memory_order_relaxed);
+        _tail.store(0, std::memory_order_relaxed);
+        _headCache = 0;
+        _tailCache = 0;
+        _dropped.store(0, std::memory_order_relaxed);
+    }
+
+    /**
+     * @return Maximum number of items
+     */
+    size_t capacity() const noexcept
+    {
+        return _capacity;
+    }
+
+    /**
+     * @return Behavior when pushing into a full ring
+     */
+    OverflowPolicy overflowPolicy() const noexcept
+    {
+        return _policy;
+    }
+
+    /**
+     * @brief Add an item (producer only)
+     *
+     * @param[in] item Item to add
+     *
+     * @return false if @p item was dropped because the ring was full
+     */
+    bool push(const T &item) noexcept
+    {
+        T *slot = claim();
+        if (slot == nullptr)
+            return false;
+        *slot = item;
+        publish();
+        return true;
+    }
+
+    /**
+     * @brief Reserve the next free slot for in-place construction (producer only)
+     *
+     * The slot becomes visible to the consumer when publish() is called.
+     * Calling claim() again without publish() returns the same slot.
+     *
+     * @return Pointer to the free slot, or nullptr if the ring is full
+     *         and the policy is OverflowPolicy::DropNewest
+     */
+    T *claim() noexcept
+    {
+        const uint64_t tail = _tail.load(std::memory_order_relaxed);
+        while (tail - _headCache >= _capacity) {
+            _headCache = _head.load(std::memory_order_acquire);
+            if (tail - _headCache < _capacity)
+                break;
+
+            switch (_policy) {
+                case OverflowPolicy::DropNewest:
+                    _dropped.fetch_add(1, std::memory_order_relaxed);
+                    return nullptr;
+                case OverflowPolicy::DropOldest:
+                    if (_head.compare_exchange_weak(_headCache, _headCache + 1, std::memory_order_acq_rel)) {
+                        release(_headCache);
+                        _dropped.fetch_add(1, std::memory_order_relaxed);
+                        _headCache++;
+                    }
+                    break;
+                case OverflowPolicy::Block:
+                    std::this_thread::yield();
+                    break;
+            }
+        }
+
+        // The consumer may still be copying out the item that last used this slot
+        Slot &slot = _slots[tail & _mask];
+        while (slot.seq.load(std::memory_order_acquire) != tail) std::this_thread::yield();
+        return &slot.item;
+    }
+
+    /**
+     * @brief Make the slot returned by claim() visible to the consumer (producer only)
+     */
+    void publish() noexcept
+    {
+        _tail.store(_tail.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+    /**
+     * @brief Remove the oldest item (consumer only)
+     *
+     * @param[out] item Receives the removed item
+     *
+     * @return false if the ring was empty
+     */
+    bool pop(T &item) noexcept
+    {
+        uint64_t head = _head.load(std::memory_order_relaxed);
+        while (true) {
+            // clear() and DropOldest can move head past the cached tail
+            if (head >= _tailCache) {
+                _tailCache = _tail.load(std::memory_order_acquire);
+                if (head >= _tailCache)
+                    return false;
+            }
+            // Fails only if the producer dropped this item first
+            if (_head.compare_exchange_weak(head, head + 1, std::memory_order_acq_rel, std::memory_order_acquire))
+                break;
+        }
+        item = _slots[head & _mask].item;
+        release(head);
+        return true;
+    }
+
+    /**
+     * @return Number of queued items
+     */
+    size_t size() const noexcept
+    {
+        const uint64_t head = _head.load(std::memory_order_acquire);
+        const uint64_t tail = _tail.load(std::memory_order_acquire);
+        return tail > head ? static_cast<size_t>(tail - head) : 0;
+    }
+
+    /**
+     * @return true if there are no queued items
+     */
+    bool empty() const noexcept
+    {
+        return size() == 0;
+    }
+
+    /**
+     * @brief Discard all queued items
+     */
+    void clear() noexcept
+    {
+        uint64_t head = _head.load(std::memory_order_relaxed);
+        uint64_t tail = _tail.load(std::memory_order_acquire);
+        while (head < tail && !_head.compare_exchange_weak(head, tail, std::memory_order_acq_rel)) {
+            tail = _tail.load(std::memory_order_acquire);
+        }
+        for (; head < tail; head++) release(head);
+    }
+
+    /**
+     * @return Number of items discarded because the ring was full
+     */
+    uint64_t dropped() const noexcept
+    {
+        return _dropped.load(std::memory_order_relaxed);
+    }
+
+  private:
+    struct Slot {
+        std::atomic<uint64_t> seq; /**< Index of the next item that may be written to the slot */
+        T item;
+    };
+
+    /** Hand the slot of item @p index back to the producer once its owner is done with it */
+    void release(uint64_t index) noexcept
+    {
+        _slots[index & _mask].seq.store(index + _capacity, std::memory_order_release);
+    }
+
+    // Consumer-owned state
+    alignas(CacheLineSize) std::atomic<uint64_t> _head{0};
+    uint64_t _tailCache = 0;
+
+    // Producer-owned state
+    alignas(CacheLineSize) std::atomic<uint64_t> _tail{0};
+    uint64_t _headCache = 0;
+    std::atomic<uint64_t> _dropped{0};
+
+    // Read-only after reset()
+    alignas(CacheLineSize) std::unique_ptr<Slot[]> _slots;
+    size_t _capacity = 0;
+    size_t _mask = 0;
+    OverflowPolicy _policy = OverflowPolicy::DropNewest;
+};
+
+}  // namespace util
+}  // namespace datapanel
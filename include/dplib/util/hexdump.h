@@ -18,9 +18,13 @@
 
 #pragma once
 
+#include <cstddef>
 #include <string>
+#include <string_view>
 #include <vector>
 
+#include "dplib/util/ByteView.h"
+
 namespace datapanel
 {
 namespace util
@@ -40,6 +44,35 @@ namespace util
  *
  * @since 1.0
  */
-std::string hexdump(const std::vector<std::byte> &data, const std::string &sep = " ");
+std::string hexdump(ByteView data, const std::string &sep = " ");
+
+/**
+ * @brief Number of characters hexdumpTo() writes for @p bytes bytes of data
+ *
+ * @param[in] bytes Size of the data
+ * @param[in] sepLength Length of the separator
+ *
+ * @since 1.1
+ */
+constexpr size_t hexdumpLength(size_t bytes, size_t sepLength = 1) noexcept
+{
+    return bytes == 0 ? 0 : bytes * 2 + (bytes - 1) * sepLength;
+}
+
+/**
+ * @brief Format raw binary data as hexadecimal into a caller's buffer
+ *
+ * Produces the same text as hexdump() without allocating, using a
+ * byte-to-digit-pair table.  The output is not NUL-terminated.
+ *
+ * @param[in] data Raw data to format
+ * @param[out] out Buffer of at least hexdumpLength(data.size(), sep.size()) characters
+ * @param[in] sep Will be inserted between each byte of data
+ *
+ * @return Pointer past the last character written
+ *
+ * @since 1.1
+ */
+char *hexdumpTo(ByteView data, char *out, std::string_view sep = " ") noexcept;
 }  // namespace util
 }  // namespace datapanel
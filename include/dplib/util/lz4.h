@@ -0,0 +1,70 @@
+/**
+ * Copyright (c) 2026 Data Panel Corporation
+ * 181 Cheshire Ln, Suite 300
+ * Plymouth, MN 55441
+ * All rights reserved.
+ *
+ * This is the confidential and proprietary information of Data Panel
+ * Corporation. Such confidential information shall not be disclosed and is for
+ * use only in accordance with the license agreement you entered into with Data
+ * Panel.
+ */
+
+/**
+ * @file lz4.h
+ * @date 2026-10-16
+ */
+
+#pragma once
+
+#include <cstddef>
+
+namespace datapanel
+{
+namespace util
+{
+
+/**
+ * @brief Largest possible size of lz4Compress() output
+ *
+ * @param[in] size Input size in bytes
+ *
+ * @return Output buffer size that is always large enough
+ */
+constexpr size_t lz4CompressBound(size_t size) noexcept
+{
+    return size + size / 255 + 16;
+}
+
+/**
+ * @brief Compress a block in the LZ4 block format
+ *
+ * The output is a raw LZ4 block, without frame header or checksum, and
+ * can be decompressed by any LZ4 implementation.  The compressor is a
+ * single-pass greedy matcher tuned for speed over ratio.
+ *
+ * @param[in] src Data to compress
+ * @param[in] size Number of bytes in @p src
+ * @param[out] dst Output buffer
+ * @param[in] capacity Size of @p dst; lz4CompressBound(@p size) always suffices
+ *
+ * @return Compressed size, or 0 if @p dst is too small
+ */
+size_t lz4Compress(const std::byte *src, size_t size, std::byte *dst, size_t capacity) noexcept;
+
+/**
+ * @brief Decompress an LZ4 block
+ *
+ * Malformed input is detected and never reads or writes out of bounds.
+ *
+ * @param[in] src Compressed block
+ * @param[in] size Number of bytes in @p src
+ * @param[out] dst Output buffer
+ * @param[in] capacity Size of @p dst
+ *
+ * @return Decompressed size, or 0 if the block is malformed or does not fit
+ */
+size_t lz4Decompress(const std::byte *src, size_t size, std::byte *dst, size_t capacity) noexcept;
+
+}  // namespace util
+}  // namespace datapanel
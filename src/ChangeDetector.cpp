@@ -0,0 +1,172 @@
+#include "dplib/ChangeDetector.h"
+
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+using namespace datapanel;
+using datapanel::net::can::CanFrame;
+using datapanel::net::can::CanInterface;
+
+namespace
+{
+constexpr double NaN = std::numeric_limits<double>::quiet_NaN();
+
+/** 0xFF for the first @p length bytes from PrefixMask + 64 - length */
+alignas(64) constexpr uint8_t PrefixMask[128] = {
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+};
+
+/**
+ * @return true if the first @p length bytes differ
+ *
+ * Both buffers must hold 64 readable bytes; @p stored must be 64-byte aligned.
+ */
+inline bool payloadDiffers(const uint8_t *stored, const uint8_t *incoming, size_t length) noexcept
+{
+    const uint8_t *mask = PrefixMask + 64 - length;
+#if defined(__SSE2__)
+    __m128i diff = _mm_setzero_si128();
+    for (int n = 0; n < 64; n += 16) {
+        const __m128i a = _mm_load_si128(reinterpret_cast<const __m128i *>(stored + n));
+        const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i *>(incoming + n));
+        const __m128i m = _mm_loadu_si128(reinterpret_cast<const __m128i *>(mask + n));
+        diff = _mm_or_si128(diff, _mm_and_si128(_mm_xor_si128(a, b), m));
+    }
+    return _mm_movemask_epi8(_mm_cmpeq_epi8(diff, _mm_setzero_si128())) != 0xFFFF;
+#elif defined(__ARM_NEON)
+    uint8x16_t diff = vdupq_n_u8(0);
+    for (int n = 0; n < 64; n += 16)
+        diff = vorrq_u8(diff, vandq_u8(veorq_u8(vld1q_u8(stored + n), vld1q_u8(incoming + n)), vld1q_u8(mask + n)));
+    const uint64x2_t lanes = vreinterpretq_u64_u8(diff);
+    return (vgetq_lane_u64(lanes, 0) | vgetq_lane_u64(lanes, 1)) != 0;
+#else
+    (void)mask;
+    return std::memcmp(stored, incoming, length) != 0;
+#endif
+}
+}  // namespace
+
+ChangeDetector::ChangeDetector(size_t maxIds) : m_payloads(maxIds)
+{
+    unsigned bits = 1;
+    while ((size_t(1) << bits) < maxIds * 2) bits++;
+    m_hashShift = 64 - bits;
+    m_index.assign(size_t(1) << bits, Slot{EmptyKey, 0, 0});
+}
+
+void ChangeDetector::setDecoder(const SignalDecoder *decoder)
+{
+    m_decoder = decoder;
+    const size_t count = decoder ? decoder->valueCount() : 0;
+    m_decoded.assign(count, 0);
+    m_values.assign(count, NaN);
+    m_deadbands.assign(count, 0);
+}
+
+bool ChangeDetector::setDeadband(size_t slot, double deadband)
+{
+    if (slot >= m_deadbands.size() || !(deadband >= 0))
+        return false;
+    m_deadbands[slot] = deadband;
+    return true;
+}
+
+bool ChangeDetector::setDeadband(const std::string &message, const std::string &signal, double deadband)
+{
+    const long slot = m_decoder ? m_decoder->valueIndex(message, signal) : -1;
+    return slot >= 0 && setDeadband(size_t(slot), deadband);
+}
+
+void ChangeDetector::attach(CanInterface &source)
+{
+    detach();
+    m_bus = &source;
+    m_connection =
+        source.framesTapped.connect([this](const CanFrame *frames, size_t count) { process(frames, count); });
+}
+
+void ChangeDetector::detach()
+{
+    m_connection.disconnect();
+    m_bus = nullptr;
+}
+
+void ChangeDetector::process(const CanFrame *frames, size_t count)
+{
+    for (size_t n = 0; n < count; n++) {
+        const CanFrame &frame = frames[n];
+        m_stats.frames++;
+        if (frame.frameType() == CanFrame::DataFrame && !changed(frame))
+            continue;
+        m_stats.changedFrames++;
+        frameChanged(frame);
+        if (m_decoder && frame.frameType() == CanFrame::DataFrame)
+            emitValues(frame);
+    }
+}
+
+void ChangeDetector::reset()
+{
+    for (auto &slot : m_index) slot.key = EmptyKey;
+    m_used = 0;
+    std::fill(m_values.begin(), m_values.end(), NaN);
+}
+
+bool ChangeDetector::changed(const CanFrame &frame)
+{
+    const uint32_t key = uint32_t(frame.id()) | (frame.isExtendedId() ? 0x80000000 : 0);
+    const size_t mask = m_index.size() - 1;
+    size_t index = size_t((key * 0x9E3779B97F4A7C15) >> m_hashShift);
+    while (m_index[index].key != key && m_index[index].key != EmptyKey) index = (index + 1) & mask;
+
+    Slot &slot = m_index[index];
+    const auto *incoming = reinterpret_cast<const uint8_t *>(frame.payload().data());
+    const size_t length = frame.payloadSize();
+    if (slot.key == EmptyKey) {
+        if (m_used == m_payloads.size()) {
+            m_stats.untracked++;
+            return true;
+        }
+        slot.key = key;
+        slot.entry = uint32_t(m_used++);
+    } else if (slot.length == length && !payloadDiffers(m_payloads[slot.entry].bytes, incoming, length)) {
+        return false;
+    }
+    // The whole payload array: a fixed-size copy is a few vector moves
+    std::memcpy(m_payloads[slot.entry].bytes, incoming, CanFrame::MaxPayloadSize);
+    slot.length = uint8_t(length);
+    return true;
+}
+
+void ChangeDetector::emitValues(const CanFrame &frame)
+{
+    const int message = m_decoder->decode(frame, m_decoded.data());
+    if (message < 0)
+        return;
+    const size_t first = m_decoder->firstValue(message);
+    const size_t end = first + m_decoder->signalCount(message);
+    m_stats.values += end - first;
+    for (size_t slot = first; slot < end; slot++) {
+        const double value = m_decoded[slot];
+        // NaN: a multiplexed signal the frame does not carry, or past the end of a short frame
+        if (std::isnan(value))
+            continue;
+        const double last = m_values[slot];
+        const double deadband = m_deadbands[slot];
+        if (!std::isnan(last) && (deadband > 0 ? std::abs(value - last) <= deadband : value == last))
+            continue;
+        m_values[slot] = value;
+        m_stats.changedValues++;
+        valueChanged(frame, slot, value);
+    }
+}
@@ -0,0 +1,362 @@
+#include "dplib/DbcImporter.h"
+
+#include <cctype>
+#include <cstdlib>
+#include <fstream>
+#include <iterator>
+
+#include <fmt/core.h>
+
+using namespace datapanel;
+
+namespace
+{
+constexpr uint32_t DbcExtendedFlag = 0x80000000;    // Bit 31 of a BO_ identifier marks a 29-bit identifier
+constexpr uint32_t IndependentSignals = 0xC0000000;  // Pseudo message VECTOR__INDEPENDENT_SIG_MSG
+
+/** Reads the tokens of one DBC statement */
+class Cursor
+{
+  public:
+    explicit Cursor(std::string_view text) : m_text(text)
+    {
+    }
+
+    void skipSpace()
+    {
+        while (m_pos < m_text.size() && (m_text[m_pos] == ' ' || m_text[m_pos] == '\t' || m_text[m_pos] == '\n'))
+            m_pos++;
+    }
+
+    char peek()
+    {
+        skipSpace();
+        return m_pos < m_text.size() ? m_text[m_pos] : '\0';
+    }
+
+    bool eat(char c)
+    {
+        if (peek() != c)
+            return false;
+        m_pos++;
+        return true;
+    }
+
+    /** Identifier or keyword */
+    bool word(std::string_view &out)
+    {
+        skipSpace();
+        const size_t start = m_pos;
+        while (m_pos < m_text.size() &&
+               (std::isalnum(static_cast<unsigned char>(m_text[m_pos])) || m_text[m_pos] == '_'))
+            m_pos++;
+        out = m_text.substr(start, m_pos - start);
+        return !out.empty();
+    }
+
+    bool number(double &out)
+    {
+        skipSpace();
+        char buffer[64];
+        size_t n = 0;
+        while (m_pos + n < m_text.size() && n < sizeof(buffer) - 1 &&
+               (std::isdigit(static_cast<unsigned char>(m_text[m_pos + n])) ||
+                std::string_view("+-.eE").find(m_text[m_pos + n]) != std::string_view::npos))
+            n++;
+        m_text.copy(buffer, n, m_pos);
+        buffer[n] = '\0';
+        char *end = nullptr;
+        out = std::strtod(buffer, &end);
+        if (n == 0 || end != buffer + n)
+            return false;
+        m_pos += n;
+        return true;
+    }
+
+    bool integer(unsigned long long &out)
+    {
+        skipSpace();
+        const size_t start = m_pos;
+        out = 0;
+        while (m_pos < m_text.size() && std::isdigit(static_cast<unsigned char>(m_text[m_pos])))
+            out = out * 10 + unsigned(m_text[m_pos++] - '0');
+        return m_pos > start && m_pos - start <= 19;
+    }
+
+    /** Double-quoted string, with backslash escapes */
+    bool quoted(std::string &out)
+    {
+        if (!eat('"'))
+            return false;
+        out.clear();
+        while (m_pos < m_text.size() && m_text[m_pos] != '"') {
+            if (m_text[m_pos] == '\\' && m_pos + 1 < m_text.size())
+                m_pos++;
+            out += m_text[m_pos++];
+        }
+        return eat('"');
+    }
+
+  private:
+    std::string_view m_text;
+    size_t m_pos = 0;
+};
+
+/** @return true if @p line leaves a string open */
+bool opensString(std::string_view line, bool inString)
+{
+    for (size_t n = 0; n < line.size(); n++) {
+        if (inString && line[n] == '\\')
+            n++;
+        else if (line[n] == '"')
+            inString = !inString;
+    }
+    return inString;
+}
+}  // namespace
+
+bool DbcImporter::load(const std::string &path)
+{
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        m_errorLine = 0;
+        m_errorMessage = fmt::format("Cannot open {}", path);
+        return false;
+    }
+    const std::string text((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    return parse(text);
+}
+
+bool DbcImporter::parse(std::string_view text)
+{
+    m_messages.clear();
+    m_errorMessage.clear();
+
+    bool inMessage = false;  // Signals belong to the last BO_
+    bool inSymbols = false;  // Indented lines after NS_ list keywords, not statements
+    std::string statement;
+    int line = 0;
+    size_t pos = 0;
+    while (pos < text.size()) {
+        // A statement is a line, continued while a string is open
+        statement.clear();
+        m_errorLine = line + 1;
+        bool inString = false;
+        do {
+            size_t end = text.find('\n', pos);
+            if (end == std::string_view::npos)
+                end = text.size();
+            std::string_view part = text.substr(pos, end - pos);
+            if (!part.empty() && part.back() == '\r')
+                part.remove_suffix(1);
+            if (!statement.empty())
+                statement += '\n';
+            statement += part;
+            inString = opensString(part, inString);
+            pos = end + 1;
+            line++;
+        } while (inString && pos < text.size());
+
+        Cursor cursor(statement);
+        std::string_view keyword;
+        if (!cursor.word(keyword))
+            continue;
+        if (inSymbols && (statement[0] == ' ' || statement[0] == '\t'))
+            continue;
+        inSymbols = keyword == "NS_";
+
+        bool ok = true;
+        if (keyword == "BO_") {
+            const size_t count = m_messages.size();
+            ok = parseMessage(statement);
+            inMessage = m_messages.size() > count;
+        } else if (keyword == "SG_") {
+            ok = !inMessage || parseSignal(statement);
+        } else if (keyword == "CM_") {
+            inMessage = false;
+            ok = parseComment(statement);
+        } else if (keyword == "SIG_VALTYPE_") {
+            inMessage = false;
+            ok = parseValueType(statement);
+        } else {
+            inMessage = false;
+        }
+        if (!ok) {
+            m_messages.clear();
+            return false;
+        }
+    }
+    m_errorLine = 0;
+    return true;
+}
+
+const Message *DbcImporter::message(uint32_t id, bool extended) const
+{
+    for (const auto &message : m_messages)
+        if (message.id() == id && message.isExtendedId() == extended)
+            return &message;
+    return nullptr;
+}
+
+bool DbcImporter::parseMessage(std::string_view statement)
+{
+    // BO_ <id> <name>: <size> <transmitter>
+    Cursor cursor(statement);
+    std::string_view keyword, name, transmitter;
+    unsigned long long id = 0, size = 0;
+    cursor.word(keyword);
+    if (!cursor.integer(id) || id > 0xFFFFFFFF || !cursor.word(name) || !cursor.eat(':') || !cursor.integer(size))
+        return fail("Malformed message definition");
+    cursor.word(transmitter);
+    if (id == IndependentSignals)
+        return true;
+    if (size > 64)
+        return fail(fmt::format("Message {} is larger than 64 bytes", name));
+
+    Message message;
+    message.setId(uint32_t(id) & ~DbcExtendedFlag);
+    message.setExtendedId((id & DbcExtendedFlag) || message.id() > 0x7FF);
+    if (message.id() > 0x1FFFFFFF)
+        return fail(fmt::format("Message {} has an invalid identifier", name));
+    message.setName(std::string(name));
+    message.setSize(unsigned(size));
+    message.setTransmitter(std::string(transmitter));
+    m_messages.push_back(std::move(message));
+    return true;
+}
+
+bool DbcImporter::parseSignal(std::string_view statement)
+{
+    // SG_ <name> [M|m<value>] : <start>|<length>@<order><sign> (<scale>,<offset>) [<min>|<max>] "<unit>" <receivers>
+    Cursor cursor(statement);
+    std::string_view keyword, name, mux;
+    cursor.word(keyword);
+    if (!cursor.word(name))
+        return fail("Malformed signal definition");
+
+    Signal signal;
+    signal.setName(std::string(name));
+    if (cursor.peek() != ':') {
+        if (!cursor.word(mux))
+            return fail(fmt::format("Malformed multiplexer of signal {}", name));
+        if (mux.back() == 'M') {
+            signal.setMultiplexor(true);
+            mux.remove_suffix(1);
+        }
+        if (!mux.empty()) {
+            if (mux[0] != 'm' || mux.size() == 1 || mux.size() > 10)
+                return fail(fmt::format("Malformed multiplexer of signal {}", name));
+            int value = 0;
+            for (char c : mux.substr(1)) {
+                if (!std::isdigit(static_cast<unsigned char>(c)))
+                    return fail(fmt::format("Malformed multiplexer of signal {}", name));
+                value = value * 10 + (c - '0');
+            }
+            signal.setMultiplexValue(value);
+        }
+    }
+
+    unsigned long long start = 0, length = 0;
+    double scale = 0, offset = 0, minimum = 0, maximum = 0;
+    std::string unit;
+    if (!cursor.eat(':') || !cursor.integer(start) || !cursor.eat('|') || !cursor.integer(length) ||
+        !cursor.eat('@'))
+        return fail(fmt::format("Malformed layout of signal {}", name));
+    const char order = cursor.peek();
+    if ((order != '0' && order != '1') || !cursor.eat(order))
+        return fail(fmt::format("Malformed byte order of signal {}", name));
+    const char sign = cursor.peek();
+    if ((sign != '+' && sign != '-') || !cursor.eat(sign))
+        return fail(fmt::format("Malformed value type of signal {}", name));
+    if (!cursor.eat('(') || !cursor.number(scale) || !cursor.eat(',') || !cursor.number(offset) || !cursor.eat(')'))
+        return fail(fmt::format("Malformed scale of signal {}", name));
+    if (!cursor.eat('[') || !cursor.number(minimum) || !cursor.eat('|') || !cursor.number(maximum) ||
+        !cursor.eat(']'))
+        return fail(fmt::format("Malformed range of signal {}", name));
+    if (!cursor.quoted(unit))
+        return fail(fmt::format("Malformed unit of signal {}", name));
+    if (start > 511 || length == 0 || length > 64)
+        return fail(fmt::format("Signal {} does not fit in a frame", name));
+
+    signal.setStartBit(unsigned(start));
+    signal.setLength(unsigned(length));
+    signal.setByteOrder(order == '1' ? Signal::ByteOrder::LittleEndian : Signal::ByteOrder::BigEndian);
+    signal.setValueType(sign == '-' ? Signal::ValueType::Signed : Signal::ValueType::Unsigned);
+    signal.setScale(scale);
+    signal.setOffset(offset);
+    signal.setMinimum(minimum);
+    signal.setMaximum(maximum);
+    signal.setUnit(unit);
+    m_messages.back().addSignal(std::move(signal));
+    return true;
+}
+
+bool DbcImporter::parseComment(std::string_view statement)
+{
+    // CM_ [BU_ <node> | BO_ <id> | SG_ <id> <signal> | EV_ <variable>] "<comment>";
+    Cursor cursor(statement);
+    std::string_view keyword, object, signalName;
+    unsigned long long id = 0;
+    std::string comment;
+    cursor.word(keyword);
+    if (cursor.peek() == '"')
+        return true;
+    if (!cursor.word(object))
+        return fail("Malformed comment");
+    if (object != "BO_" && object != "SG_")
+        return true;
+    if (!cursor.integer(id) || (object == "SG_" && !cursor.word(signalName)) || !cursor.quoted(comment))
+        return fail("Malformed comment");
+
+    Message *message = findMessage(uint32_t(id));
+    if (!message)
+        return true;
+    if (object == "BO_") {
+        message->setComment(comment);
+        return true;
+    }
+    for (auto &signal : message->signals())
+        if (signal.name() == signalName)
+            signal.setComment(comment);
+    return true;
+}
+
+bool DbcImporter::parseValueType(std::string_view statement)
+{
+    // SIG_VALTYPE_ <id> <signal> : <1 for float, 2 for double>;
+    Cursor cursor(statement);
+    std::string_view keyword, signalName;
+    unsigned long long id = 0, type = 0;
+    cursor.word(keyword);
+    if (!cursor.integer(id) || !cursor.word(signalName) || !cursor.eat(':') || !cursor.integer(type) || type > 2)
+        return fail("Malformed signal value type");
+
+    Message *message = findMessage(uint32_t(id));
+    if (!message)
+        return true;
+    for (auto &signal : message->signals()) {
+        if (signal.name() != signalName)
+            continue;
+        if (type == 1)
+            signal.setValueType(Signal::ValueType::Float);
+        else if (type == 2)
+            signal.setValueType(Signal::ValueType::Double);
+    }
+    return true;
+}
+
+Message *DbcImporter::findMessage(uint32_t dbcId)
+{
+    const uint32_t id = dbcId & ~DbcExtendedFlag;
+    const bool extended = (dbcId & DbcExtendedFlag) || id > 0x7FF;
+    for (auto &message : m_messages)
+        if (message.id() == id && message.isExtendedId() == extended)
+            return &message;
+    return nullptr;
+}
+
+bool DbcImporter::fail(std::string message)
+{
+    m_errorMessage = std::move(message);
+    return false;
+}
@@ -0,0 +1,276 @@
+#include "dplib/SignalDecoder.h"
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+
+#include <fmt/core.h>
+
+using namespace datapanel;
+
+namespace
+{
+constexpr size_t MaxPayload = 64;
+constexpr size_t PaddedPayload = MaxPayload + 8;  // Room for a wide load at the last byte
+
+constexpr uint32_t messageKey(uint32_t id, bool extended)
+{
+    return extended ? id | 0x80000000 : id;
+}
+
+// Written as byte shifts so the compiler emits a single load, byte-swapped as needed
+inline uint64_t loadLittleEndian(const uint8_t *p)
+{
+    return uint64_t(p[0]) | uint64_t(p[1]) << 8 | uint64_t(p[2]) << 16 | uint64_t(p[3]) << 24 |
+           uint64_t(p[4]) << 32 | uint64_t(p[5]) << 40 | uint64_t(p[6]) << 48 | uint64_t(p[7]) << 56;
+}
+
+inline uint64_t loadBigEndian(const uint8_t *p)
+{
+    return uint64_t(p[0]) << 56 | uint64_t(p[1]) << 48 | uint64_t(p[2]) << 40 | uint64_t(p[3]) << 32 |
+           uint64_t(p[4]) << 24 | uint64_t(p[5]) << 16 | uint64_t(p[6]) << 8 | uint64_t(p[7]);
+}
+
+inline uint64_t byteSwap(uint64_t v)
+{
+    v = (v & 0x00FF00FF00FF00FF) << 8 | (v >> 8 & 0x00FF00FF00FF00FF);
+    v = (v & 0x0000FFFF0000FFFF) << 16 | (v >> 16 & 0x0000FFFF0000FFFF);
+    return v << 32 | v >> 32;
+}
+}  // namespace
+
+bool SignalDecoder::compile(const std::vector<Message> &messages)
+{
+    clear();
+    for (const auto &message : messages) {
+        Layout layout;
+        layout.key = messageKey(message.id(), message.isExtendedId());
+        layout.firstOp = uint32_t(m_ops.size());
+        layout.opCount = uint32_t(message.signals().size());
+        layout.multiplexor = -1;
+
+        for (const auto &signal : message.signals()) {
+            const unsigned length = signal.length();
+            if (length == 0 || length > 64)
+                return fail(fmt::format("Signal {}.{} has {} bits", message.name(), signal.name(), length));
+            if ((signal.valueType() == Signal::ValueType::Float && length != 32) ||
+                (signal.valueType() == Signal::ValueType::Double && length != 64))
+                return fail(fmt::format("Floating point signal {}.{} has {} bits", message.name(), signal.name(),
+                                        length));
+
+            Op op{};
+            op.mask = length == 64 ? ~uint64_t(0) : (uint64_t(1) << length) - 1;
+            op.scale = signal.scale();
+            op.offset = signal.offset();
+            op.multiplex = signal.multiplexValue();
+            // First bit and last bit counted from the start of the payload, in load order
+            unsigned first = 0;
+            if (signal.byteOrder() == Signal::ByteOrder::LittleEndian) {
+                first = signal.startBit();
+                op.shift = uint8_t(first % 8);
+            } else {
+                // DBC numbers Motorola bits LSB first within each byte
+                first = signal.startBit() / 8 * 8 + 7 - signal.startBit() % 8;
+                op.flags |= BigEndian;
+                const unsigned used = first % 8 + length;  // Bits of the word up to the signal's LSB
+                op.shift = uint8_t(used <= 64 ? 64 - used : used - 64);
+            }
+            if (first % 8 + length > 64)
+                op.flags |= Wide;
+            const unsigned last = first + length - 1;
+            if (last >= MaxPayload * 8)
+                return fail(fmt::format("Signal {}.{} does not fit in a 64-byte frame", message.name(), signal.name()));
+            op.byte = uint8_t(first / 8);
+            op.endByte = uint8_t(last / 8 + 1);
+
+            switch (signal.valueType()) {
+                case Signal::ValueType::Signed:
+                    op.signBit = uint64_t(1) << (length - 1);
+                    break;
+                case Signal::ValueType::Float:
+                    op.flags |= Float;
+                    break;
+                case Signal::ValueType::Double:
+                    op.flags |= Double;
+                    break;
+                default:
+                    break;
+            }
+            if ((op.flags & (Wide | Float | Double)) || (length == 64 && !op.signBit))
+                op.flags |= General;
+
+            if (signal.isMultiplexor() && signal.multiplexValue() == Signal::NotMultiplexed) {
+                if (layout.multiplexor >= 0)
+                    return fail(fmt::format("Message {} has more than one multiplexor", message.name()));
+                layout.multiplexor = int32_t(m_ops.size());
+            }
+            m_ops.push_back(op);
+            m_names.push_back(message.name() + "." + signal.name());
+        }
+
+        for (const auto &other : m_messages) {
+            if (other.key == layout.key)
+                return fail(fmt::format("Message {} reuses identifier 0x{:X}", message.name(), message.id()));
+        }
+        m_messages.push_back(layout);
+    }
+
+    buildIndex();
+    return true;
+}
+
+void SignalDecoder::clear()
+{
+    m_ops.clear();
+    m_messages.clear();
+    m_names.clear();
+    m_index.clear();
+}
+
+bool SignalDecoder::fail(std::string message)
+{
+    clear();
+    m_errorMessage = std::move(message);
+    return false;
+}
+
+void SignalDecoder::buildIndex()
+{
+    // Prefer a multiplier that maps every identifier to its own slot, so
+    // lookups of known messages touch a single slot; table sizes up to 8x
+    // the message count are tried before settling for linear probing.
+    unsigned minBits = 1;
+    while ((size_t(1) << minBits) < m_messages.size() * 2) minBits++;
+
+    std::vector<bool> used;
+    uint64_t seed = 0x9E3779B97F4A7C15;
+    bool perfect = false;
+    for (unsigned bits = minBits; bits <= minBits + 3 && !perfect; bits++) {
+        for (int attempt = 0; attempt < 64 && !perfect; attempt++) {
+            // splitmix64 step; odd multipliers only
+            seed += 0x9E3779B97F4A7C15;
+            uint64_t z = seed;
+            z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9;
+            z = (z ^ (z >> 27)) * 0x94D049BB133111EB;
+            const uint64_t multiplier = (z ^ (z >> 31)) | 1;
+
+            used.assign(size_t(1) << bits, false);
+            perfect = true;
+            for (const auto &layout : m_messages) {
+                const size_t slot = size_t((layout.key * multiplier) >> (64 - bits));
+                if (used[slot]) {
+                    perfect = false;
+                    break;
+                }
+                used[slot] = true;
+            }
+            if (perfect || (bits == minBits && attempt == 0)) {
+                m_multiplier = multiplier;
+                m_hashShift = 64 - bits;
+            }
+        }
+    }
+
+    m_index.assign(size_t(1) << (64 - m_hashShift), Slot{EmptyKey, -1});
+    const size_t mask = m_index.size() - 1;
+    for (size_t n = 0; n < m_messages.size(); n++) {
+        size_t slot = size_t((m_messages[n].key * m_multiplier) >> m_hashShift);
+        while (m_index[slot].key != EmptyKey) slot = (slot + 1) & mask;
+        m_index[slot] = Slot{m_messages[n].key, int32_t(n)};
+    }
+}
+
+int SignalDecoder::messageIndex(uint32_t id, bool extended) const noexcept
+{
+    if (m_index.empty())
+        return -1;
+    const uint32_t key = messageKey(id, extended);
+    const size_t mask = m_index.size() - 1;
+    size_t slot = size_t((key * m_multiplier) >> m_hashShift);
+    while (true) {
+        const Slot &entry = m_index[slot];
+        if (entry.key == key)
+            return entry.message;
+        if (entry.key == EmptyKey)
+            return -1;
+        slot = (slot + 1) & mask;
+    }
+}
+
+long SignalDecoder::valueIndex(const std::string &message, const std::string &signal) const
+{
+    const std::string name = message + "." + signal;
+    for (size_t n = 0; n < m_names.size(); n++)
+        if (m_names[n] == name)
+            return long(n);
+    return -1;
+}
+
+uint64_t SignalDecoder::extract(const Op &op, const uint8_t *data) noexcept
+{
+    const uint8_t *p = data + op.byte;
+    if (op.flags & BigEndian) {
+        const uint64_t word = loadBigEndian(p);
+        if (op.flags & Wide)
+            return ((word << op.shift) | (p[8] >> (8 - op.shift))) & op.mask;
+        return (word >> op.shift) & op.mask;
+    }
+    const uint64_t word = loadLittleEndian(p);
+    if (op.flags & Wide)
+        return ((word >> op.shift) | (uint64_t(p[8]) << (64 - op.shift))) & op.mask;
+    return (word >> op.shift) & op.mask;
+}
+
+double SignalDecoder::physical(const Op &op, uint64_t raw) noexcept
+{
+    double value;
+    if (op.flags & Float) {
+        const uint32_t bits = uint32_t(raw);
+        float f;
+        std::memcpy(&f, &bits, sizeof(f));
+        value = f;
+    } else if (op.flags & Double) {
+        std::memcpy(&value, &raw, sizeof(value));
+    } else if (op.signBit) {
+        value = double(int64_t((raw ^ op.signBit) - op.signBit));
+    } else {
+        value = double(raw);
+    }
+    return value * op.scale + op.offset;
+}
+
+int SignalDecoder::decode(uint32_t id, bool extended, const uint8_t *data, size_t size, double *values) const noexcept
+{
+    const int index = messageIndex(id, extended);
+    if (index < 0)
+        return -1;
+    const Layout &layout = m_messages[index];
+
+    // Zero padding lets every op load a full word without bounds checks
+    uint8_t padded[PaddedPayload] = {};
+    size = std::min(size, MaxPayload);
+    std::memcpy(padded, data, size);
+
+    int64_t multiplex = -2;  // Matches no signal's multiplex value
+    if (layout.multiplexor >= 0 && m_ops[layout.multiplexor].endByte <= size)
+        multiplex = int64_t(extract(m_ops[layout.multiplexor], padded));
+
+    const Op *op = m_ops.data() + layout.firstOp;
+    double *out = values + layout.firstOp;
+    constexpr double NaN = std::numeric_limits<double>::quiet_NaN();
+    for (uint32_t n = 0; n < layout.opCount; n++, op++) {
+        double value;
+        if (op->flags & General) {
+            value = physical(*op, extract(*op, padded));
+        } else {
+            // Selects rather than branches on byte order and sign, which vary from signal to signal
+            uint64_t word = loadLittleEndian(padded + op->byte);
+            word = (op->flags & BigEndian) ? byteSwap(word) : word;
+            const uint64_t raw = (word >> op->shift) & op->mask;
+            value = double(int64_t((raw ^ op->signBit) - op->signBit)) * op->scale + op->offset;
+        }
+        const bool present = op->endByte <= size && (op->multiplex < 0 || op->multiplex == multiplex);
+        out[n] = present ? value : NaN;
+    }
+    return index;
+}
@@ -0,0 +1,292 @@
+#include "dplib/SignalExtractor.h"
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+
+#include <fmt/core.h>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define SIGNAL_EXTRACTOR_AVX2 1
+#include <immintrin.h>
+#endif
+
+using namespace datapanel;
+using datapanel::net::can::CanFrame;
+
+namespace
+{
+constexpr uint8_t LastWordByte = 56;  // Loads at later bytes would read past the payload
+constexpr double NaN = std::numeric_limits<double>::quiet_NaN();
+constexpr size_t BlockFrames = 256;
+
+/** @return true if @p signal is an integer that one shifted and masked 64-bit word holds */
+bool fitsWord(const Signal &signal)
+{
+    const unsigned length = signal.length();
+    const unsigned first = signal.byteOrder() == Signal::ByteOrder::LittleEndian
+                               ? signal.startBit()
+                               : signal.startBit() / 8 * 8 + 7 - signal.startBit() % 8;
+    // Doubles represent the raw value exactly, and the AVX2 conversion is exact below 2^51
+    const unsigned maxLength = signal.valueType() == Signal::ValueType::Signed ? 52 : 51;
+    return (signal.valueType() == Signal::ValueType::Signed || signal.valueType() == Signal::ValueType::Unsigned) &&
+           length >= 1 && length <= maxLength && first % 8 + length <= 64 && first + length <= 512;
+}
+
+inline uint64_t loadLittleEndian(const uint8_t *p)
+{
+    return uint64_t(p[0]) | uint64_t(p[1]) << 8 | uint64_t(p[2]) << 16 | uint64_t(p[3]) << 24 |
+           uint64_t(p[4]) << 32 | uint64_t(p[5]) << 40 | uint64_t(p[6]) << 48 | uint64_t(p[7]) << 56;
+}
+
+inline uint64_t byteSwap(uint64_t v)
+{
+    v = (v & 0x00FF00FF00FF00FF) << 8 | (v >> 8 & 0x00FF00FF00FF00FF);
+    v = (v & 0x0000FFFF0000FFFF) << 16 | (v >> 16 & 0x0000FFFF0000FFFF);
+    return v << 32 | v >> 32;
+}
+
+// Kernels take the column type as a template parameter: SignalExtractor::Column is private
+
+template <typename Column> inline uint64_t wordRaw(const Column &column, const uint8_t *payload)
+{
+    uint64_t word = loadLittleEndian(payload + column.byte);
+    word = column.bigEndian ? byteSwap(word) : word;
+    return (word >> column.shift) & column.mask;
+}
+
+template <typename Column, typename T>
+void extractScalar(const Column &column, const Column *multiplexor, const CanFrame *frames, size_t begin, size_t end,
+                   T *out)
+{
+    for (size_t n = begin; n < end; n++) {
+        const auto *payload = reinterpret_cast<const uint8_t *>(frames[n].payload().data());
+        const size_t size = frames[n].payloadSize();
+        const uint64_t raw = wordRaw(column, payload);
+        const double value =
+            double(int64_t((raw ^ column.signBit) - column.signBit)) * column.scale + column.offset;
+        bool present = size >= column.endByte;
+        if (multiplexor)
+            present &= size >= multiplexor->endByte && wordRaw(*multiplexor, payload) == uint64_t(column.multiplex);
+        out[n] = T(present ? value : NaN);
+    }
+}
+
+#ifdef SIGNAL_EXTRACTOR_AVX2
+bool hasAvx2()
+{
+    static const bool supported = __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+    return supported;
+}
+
+__attribute__((target("avx2,fma"))) inline void store(double *out, __m256d value)
+{
+    _mm256_storeu_pd(out, value);
+}
+
+__attribute__((target("avx2,fma"))) inline void store(float *out, __m256d value)
+{
+    _mm_storeu_ps(out, _mm256_cvtpd_ps(value));
+}
+
+/** Raw values of four frames: gather a word from each, byte swap for Motorola, shift and mask */
+template <typename Column>
+__attribute__((target("avx2,fma"))) inline __m256i gatherRaw(const Column &column, const char *base, __m256i index)
+{
+    const __m256i swap = _mm256_setr_epi8(7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1,
+                                          0, 15, 14, 13, 12, 11, 10, 9, 8);
+    __m256i word = _mm256_i64gather_epi64(reinterpret_cast<const long long *>(base), index, 1);
+    if (column.bigEndian)
+        word = _mm256_shuffle_epi8(word, swap);
+    word = _mm256_srl_epi64(word, _mm_cvtsi32_si128(column.shift));
+    return _mm256_and_si256(word, _mm256_set1_epi64x(int64_t(column.mask)));
+}
+
+template <typename Column, typename T>
+__attribute__((target("avx2,fma"))) void extractAvx2(const Column &column, const Column *multiplexor,
+                                                     const CanFrame *frames, size_t count, T *out)
+{
+    const auto *base = reinterpret_cast<const char *>(frames);
+    const int64_t payloadOffset = reinterpret_cast<const char *>(frames[0].payload().data()) - base;
+    const int64_t stride = sizeof(CanFrame);
+    const __m256i lanes = _mm256_setr_epi64x(0, stride, 2 * stride, 3 * stride);
+    const __m256i step = _mm256_set1_epi64x(4 * stride);
+    __m256i index = _mm256_add_epi64(lanes, _mm256_set1_epi64x(payloadOffset + column.byte));
+    __m256i multiplexIndex =
+        _mm256_add_epi64(lanes, _mm256_set1_epi64x(payloadOffset + (multiplexor ? multiplexor->byte : 0)));
+
+    // Adding 1.5 * 2^52 to the bits of an integer below 2^51 in magnitude gives that double plus 1.5 * 2^52
+    const __m256i magicBits = _mm256_set1_epi64x(0x4338000000000000);
+    const __m256d magic = _mm256_set1_pd(6755399441055744.0);
+    const __m256i signBit = _mm256_set1_epi64x(int64_t(column.signBit));
+    const __m256d scale = _mm256_set1_pd(column.scale);
+    const __m256d offset = _mm256_set1_pd(column.offset);
+    const __m256i selector = _mm256_set1_epi64x(column.multiplex);
+    const __m256d nan = _mm256_set1_pd(NaN);
+    const size_t needed = std::max<size_t>(column.endByte, multiplexor ? multiplexor->endByte : 0);
+
+    size_t n = 0;
+    for (; n + 4 <= count; n += 4) {
+        const __m256i frameIndex = index;
+        const __m256i frameMultiplexIndex = multiplexIndex;
+        index = _mm256_add_epi64(index, step);
+        multiplexIndex = _mm256_add_epi64(multiplexIndex, step);
+        if (frames[n].payloadSize() < needed || frames[n + 1].payloadSize() < needed ||
+            frames[n + 2].payloadSize() < needed || frames[n + 3].payloadSize() < needed) {
+            extractScalar(column, multiplexor, frames, n, n + 4, out);
+            continue;
+        }
+
+        __m256i raw = gatherRaw(column, base, frameIndex);
+        raw = _mm256_sub_epi64(_mm256_xor_si256(raw, signBit), signBit);
+        __m256d value = _mm256_sub_pd(_mm256_castsi256_pd(_mm256_add_epi64(raw, magicBits)), magic);
+        value = _mm256_fmadd_pd(value, scale, offset);
+        if (multiplexor) {
+            const __m256i selected = _mm256_cmpeq_epi64(gatherRaw(*multiplexor, base, frameMultiplexIndex), selector);
+            value = _mm256_blendv_pd(nan, value, _mm256_castsi256_pd(selected));
+        }
+        store(out + n, value);
+    }
+    extractScalar(column, multiplexor, frames, n, count, out);
+}
+#endif
+}  // namespace
+
+bool SignalExtractor::compile(const Message &message, const std::vector<std::string> &signals)
+{
+    m_columns.clear();
+    m_hasMultiplexor = false;
+    m_id = message.id();
+    m_extendedId = message.isExtendedId();
+
+    std::vector<const Signal *> selected;
+    if (signals.empty()) {
+        for (const auto &signal : message.signals()) selected.push_back(&signal);
+    } else {
+        for (const auto &name : signals) {
+            const Signal *signal = message.signal(name);
+            if (!signal) {
+                m_errorMessage = fmt::format("Message {} has no signal {}", message.name(), name);
+                return false;
+            }
+            selected.push_back(signal);
+        }
+    }
+
+    const Signal *multiplexor = nullptr;
+    for (const auto &signal : message.signals())
+        if (signal.isMultiplexor() && signal.multiplexValue() == Signal::NotMultiplexed)
+            multiplexor = &signal;
+
+    const auto wordColumn = [](const Signal &signal) {
+        Column column{};
+        const unsigned length = signal.length();
+        column.mask = (uint64_t(1) << length) - 1;
+        column.signBit = signal.valueType() == Signal::ValueType::Signed ? uint64_t(1) << (length - 1) : 0;
+        column.scale = signal.scale();
+        column.offset = signal.offset();
+        column.multiplex = signal.multiplexValue();
+        column.bigEndian = signal.byteOrder() == Signal::ByteOrder::BigEndian;
+        const unsigned first =
+            column.bigEndian ? signal.startBit() / 8 * 8 + 7 - signal.startBit() % 8 : signal.startBit();
+        column.byte = uint8_t(std::min<unsigned>(first / 8, LastWordByte));
+        const unsigned bitInWord = first - column.byte * 8u;
+        column.shift = uint8_t(column.bigEndian ? 64 - bitInWord - length : bitInWord);
+        column.endByte = uint8_t((first + length - 1) / 8 + 1);
+        column.general = -1;
+        return column;
+    };
+
+    const bool wordMultiplexor = multiplexor && fitsWord(*multiplexor);
+    if (wordMultiplexor) {
+        m_multiplexor = wordColumn(*multiplexor);
+        m_hasMultiplexor = true;
+    }
+
+    Message general;
+    general.setId(message.id());
+    general.setExtendedId(message.isExtendedId());
+    general.setName(message.name());
+    bool generalMultiplexed = false;
+    for (const Signal *signal : selected) {
+        const bool multiplexed = signal->multiplexValue() != Signal::NotMultiplexed;
+        if (fitsWord(*signal) && (!multiplexed || wordMultiplexor)) {
+            m_columns.push_back(wordColumn(*signal));
+            continue;
+        }
+        Column column{};
+        column.general = int(general.signals().size());
+        m_columns.push_back(column);
+        general.addSignal(*signal);
+        generalMultiplexed |= multiplexed;
+    }
+    // The decoder needs the multiplexor to tell which multiplexed signals a frame carries
+    if (generalMultiplexed && multiplexor && !general.signal(multiplexor->name()))
+        general.addSignal(*multiplexor);
+
+    if (!m_general.compile({general})) {
+        m_errorMessage = m_general.errorMessage();
+        m_columns.clear();
+        m_hasMultiplexor = false;
+        return false;
+    }
+    return true;
+}
+
+void SignalExtractor::extract(const CanFrame *frames, size_t count, std::vector<std::vector<double>> &columns) const
+{
+    extractColumns(frames, count, columns);
+}
+
+void SignalExtractor::extract(const CanFrame *frames, size_t count, std::vector<std::vector<float>> &columns) const
+{
+    extractColumns(frames, count, columns);
+}
+
+template <typename T>
+void SignalExtractor::extractColumns(const CanFrame *frames, size_t count, std::vector<std::vector<T>> &columns) const
+{
+    columns.resize(m_columns.size());
+    for (auto &column : columns) column.resize(count);
+
+    // Signals the word path cannot decode go frame by frame
+    if (m_general.valueCount() > 0) {
+        std::vector<double> values(m_general.valueCount());
+        for (size_t n = 0; n < count; n++) {
+            const auto payload = frames[n].payload();
+            m_general.decode(m_id, m_extendedId, reinterpret_cast<const uint8_t *>(payload.data()), payload.size(),
+                             values.data());
+            for (size_t c = 0; c < m_columns.size(); c++)
+                if (m_columns[c].general >= 0)
+                    columns[c][n] = T(values[m_columns[c].general]);
+        }
+    }
+
+    // Blocks of frames small enough to stay in the L1 cache while every column reads them
+    for (size_t begin = 0; begin < count; begin += BlockFrames) {
+        const size_t blockCount = std::min(BlockFrames, count - begin);
+        for (size_t c = 0; c < m_columns.size(); c++) {
+            const Column &column = m_columns[c];
+            if (column.general >= 0)
+                continue;
+            const Column *multiplexor = column.multiplex != Signal::NotMultiplexed ? &m_multiplexor : nullptr;
+            T *out = columns[c].data() + begin;
+#ifdef SIGNAL_EXTRACTOR_AVX2
+            if (hasAvx2()) {
+                extractAvx2(column, multiplexor, frames + begin, blockCount, out);
+                continue;
+            }
+#endif
+            extractScalar(column, multiplexor, frames + begin, 0, blockCount, out);
+        }
+    }
+}
+
+const char *SignalExtractor::implementation() noexcept
+{
+#ifdef SIGNAL_EXTRACTOR_AVX2
+    if (hasAvx2())
+        return "AVX2";
+#endif
+    return "scalar";
+}
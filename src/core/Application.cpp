@@ -1,9 +1,11 @@
+#include <algorithm>
 #include <iostream>
 #include <spdlog/spdlog.h>
 #include <spdlog/sinks/stdout_color_sinks.h>
 #include <memory>
 #include "dplib/core/Application.h"
 
+#include "dplib/core/Object.h"
 #include "dplib/core/Platform.h"
 
 using namespace datapanel::core;
@@ -33,16 +35,118 @@ int Application::run()
     m_logger->info("Starting application");
     started = true;
     running = true;
-    while (running) { platform->processEvents(); }
+    while (running) {
+        platform->processEvents();
+        sendPostedEvents();
+    }
 
     m_logger->info("Exited with status {}", exitStatus);
 
     return exitStatus;
 }
 
+void Application::processEvents()
+{
+    platform->processEvents();
+    sendPostedEvents();
+}
+
 void Application::exit(int status)
 {
     m_logger->info("Exiting application, status={}", status);
     exitStatus = status;
     running = false;
 }
+
+bool Application::sendEvent(Object *receiver, Event *event)
+{
+    return receiver->event(event);
+}
+
+void Application::postEvent(Object *receiver, std::unique_ptr<Event> event, int priority)
+{
+    if (receiver == nullptr || event == nullptr)
+        return;
+
+    {
+        std::lock_guard<std::mutex> lock(m_postedMutex);
+        auto &queue = m_postedEvents[priority];
+
+        int candidates = event->coalescible() ? receiver->m_postedEvents.load(std::memory_order_relaxed) : 0;
+        for (auto it = queue.rbegin(); candidates > 0 && it != queue.rend(); ++it) {
+            if (it->receiver != receiver)
+                continue;
+            candidates--;
+            if (it->event->type() == event->type() && it->event->coalesce(*event))
+                return;
+        }
+
+        event->m_posted = true;
+        queue.push_back(PostedEvent{receiver, std::move(event)});
+        receiver->m_postedEvents.fetch_add(1, std::memory_order_relaxed);
+        m_postedCount++;
+    }
+
+    eventDispatcher().wakeUp();
+}
+
+void Application::sendPostedEvents()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_postedMutex);
+        if (m_delivering || m_postedCount == 0)
+            return;
+        m_delivering = true;
+        m_deliveryBatch.reserve(m_postedCount);
+        for (auto &[priority, queue] : m_postedEvents) {
+            for (auto &posted : queue) m_deliveryBatch.push_back(std::move(posted));
+            queue.clear();
+        }
+        m_postedCount = 0;
+    }
+
+    for (size_t n = 0; n < m_deliveryBatch.size(); n++) {
+        Object *receiver;
+        std::unique_ptr<Event> event;
+        {
+            // removePostedEvents() may clear entries of this batch while it is being delivered
+            std::lock_guard<std::mutex> lock(m_postedMutex);
+            receiver = m_deliveryBatch[n].receiver;
+            event = std::move(m_deliveryBatch[n].event);
+            if (receiver == nullptr)
+                continue;
+            receiver->m_postedEvents.fetch_sub(1, std::memory_order_release);
+        }
+        event->m_posted = false;
+        sendEvent(receiver, event.get());
+    }
+
+    std::lock_guard<std::mutex> lock(m_postedMutex);
+    m_deliveryBatch.clear();
+    m_delivering = false;
+}
+
+void Application::removePostedEvents(Object *receiver)
+{
+    std::lock_guard<std::mutex> lock(m_postedMutex);
+    for (auto &[priority, queue] : m_postedEvents) {
+        const size_t before = queue.size();
+        queue.erase(std::remove_if(queue.begin(), queue.end(),
+                                   [receiver](const PostedEvent &posted) { return posted.receiver == receiver; }),
+                    queue.end());
+        m_postedCount -= before - queue.size();
+    }
+    for (auto &posted : m_deliveryBatch) {
+        if (posted.receiver == receiver) {
+            posted.receiver = nullptr;
+            posted.event.reset();
+        }
+    }
+    receiver->m_postedEvents.store(0, std::memory_order_release);
+}
+
+size_t Application::postedEventCount() const
+{
+    std::lock_guard<std::mutex> lock(m_postedMutex);
+    return m_postedCount;
+}
@@ -1,17 +1,128 @@
 #include <dplib/core/Event.h>
 
+#include <array>
 #include <mutex>
+#include <new>
 #include <set>
 
 using namespace datapanel::core;
 
+/**
+ * Per-thread free lists of event-sized blocks.  Blocks freed on a thread
+ * other than the one that allocated them simply join the freeing thread's
+ * lists, which suits the usual pattern of events being posted and freed
+ * on the main thread.
+ *
+ * The pool is trivially destructible so events deleted during static
+ * destruction (after thread-local destructors ran) still find it; the
+ * separate EventPoolReaper empties it and turns it into a pass-through.
+ */
+class EventPool
+{
+  public:
+    static constexpr std::size_t Granularity = 16;
+    static constexpr std::size_t MaxPooledSize = 256;
+    static constexpr std::size_t MaxFreeBlocks = 1024;
+
+    void drain() noexcept
+    {
+        closed = true;
+        for (auto &list : freeLists) {
+            while (list.head != nullptr) {
+                Block *next = list.head->next;
+                ::operator delete(list.head);
+                list.head = next;
+            }
+            list.count = 0;
+        }
+    }
+
+    void *allocate(std::size_t size)
+    {
+        if (size > MaxPooledSize || closed)
+            return ::operator new(size);
+        FreeList &list = freeLists[sizeClass(size)];
+        if (list.head == nullptr)
+            return ::operator new(roundUp(size));
+        Block *block = list.head;
+        list.head = block->next;
+        list.count--;
+        return block;
+    }
+
+    void release(void *ptr, std::size_t size) noexcept
+    {
+        if (size > MaxPooledSize) {
+            ::operator delete(ptr);
+            return;
+        }
+        FreeList &list = freeLists[sizeClass(size)];
+        if (list.count >= MaxFreeBlocks || closed) {
+            ::operator delete(ptr);
+            return;
+        }
+        Block *block = static_cast<Block *>(ptr);
+        block->next = list.head;
+        list.head = block;
+        list.count++;
+    }
+
+  private:
+    struct Block {
+        Block *next;
+    };
+    struct FreeList {
+        Block *head = nullptr;
+        std::size_t count = 0;
+    };
+
+    static std::size_t sizeClass(std::size_t size)
+    {
+        return (size - 1) / Granularity;
+    }
+    static std::size_t roundUp(std::size_t size)
+    {
+        return (sizeClass(size) + 1) * Granularity;
+    }
+
+    std::array<FreeList, MaxPooledSize / Granularity> freeLists;
+    bool closed = false;
+};
+
+static thread_local EventPool eventPool;
+
+struct EventPoolReaper {
+    ~EventPoolReaper()
+    {
+        eventPool.drain();
+    }
+};
+
+static thread_local EventPoolReaper eventPoolReaper;
+
+void *Event::operator new(std::size_t size)
+{
+    // Touch the reaper so its destructor is registered for this thread
+    (void)&eventPoolReaper;
+    return eventPool.allocate(size);
+}
+
+void Event::operator delete(void *ptr, std::size_t size) noexcept
+{
+    eventPool.release(ptr, size);
+}
+
 Event::Event(EventType type) : m_type(type), m_accept(true), m_posted(false)
 {
 }
 
 Event::~Event()
 {
-    // TODO: remove references to pending posted event
+}
+
+bool Event::coalesce(const Event &)
+{
+    return false;
 }
 
 class UserEventRegistry
@@ -44,8 +155,14 @@ int Event::registerEventType(int hint)
 
 TimerEvent::TimerEvent(int timerId) : Event(EventType::Timer), m_id(timerId)
 {
+    m_coalescible = true;
 }
 
 TimerEvent::~TimerEvent()
 {
 }
+
+bool TimerEvent::coalesce(const Event &newer)
+{
+    return static_cast<const TimerEvent &>(newer).m_id == m_id;
+}
@@ -3,44 +3,230 @@
 #include <spdlog/spdlog.h>
 
 #include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/timerfd.h>
 #include <unistd.h>
 #include <sys/ioctl.h>
+#include <algorithm>
 #include <atomic>
+#include <cstring>
 
 using namespace datapanel::core;
 
 static std::atomic_int nextTimerId{1};
 
+static thread_local EventDispatcher *currentDispatcher = nullptr;
+
 EventDispatcher::EventDispatcher() :m_interrupt(false) {
-    m_epoll_fd = ::epoll_create1(0);
+    m_epoll_fd = ::epoll_create1(EPOLL_CLOEXEC);
+
+    m_wakeup_fd = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    addFile(m_wakeup_fd, Read, [this]() {
+        // Drain before clearing the flag: a wakeUp() landing in between then
+        // writes a fresh count that keeps the eventfd readable.
+        uint64_t count;
+        [[maybe_unused]] auto n = ::read(m_wakeup_fd, &count, sizeof(count));
+        m_wakeupPending.store(false, std::memory_order_release);
+    });
 }
 
 EventDispatcher::~EventDispatcher() {
+    setTimerMode(TimerMode::Coarse);
+    removeFile(m_wakeup_fd, Read);
+    ::close(m_wakeup_fd);
     ::close(m_epoll_fd);
+    if (currentDispatcher == this)
+        currentDispatcher = nullptr;
+}
+
+EventDispatcher *EventDispatcher::current() {
+    return currentDispatcher;
+}
+
+void EventDispatcher::post(TaskFunc task) {
+    m_tasks.push(std::move(task));
+    wakeUp();
+}
+
+void EventDispatcher::wakeUp() {
+    // Only the first wake-up since the loop last drained the eventfd needs a system call
+    if (m_wakeupPending.exchange(true, std::memory_order_acq_rel))
+        return;
+    const uint64_t one = 1;
+    [[maybe_unused]] auto n = ::write(m_wakeup_fd, &one, sizeof(one));
+}
+
+void EventDispatcher::interrupt() {
+    m_interrupt = true;
+    wakeUp();
+}
+
+int EventDispatcher::runTasks() {
+    int count = 0;
+    TaskFunc task;
+    while (!m_interrupt && m_tasks.pop(task)) {
+        task();
+        count++;
+    }
+    return count;
 }
 
 int EventDispatcher::addTimer(int periodMs, std::function<void()> func) {
+    return addTimer(std::chrono::milliseconds(periodMs), std::move(func));
+}
+
+int EventDispatcher::addTimer(std::chrono::nanoseconds period, TimerFunc func) {
     std::lock_guard<std::mutex> lock(m_mutex);
 
     int id = nextTimerId++;
-    m_timers.emplace_back(id, periodMs, func);
-    m_timers.sort();
+    const Clock::duration interval = std::chrono::duration_cast<Clock::duration>(period);
+    m_timers.push_back(TimerInfo{id, interval, Clock::now() + interval, std::make_shared<TimerFunc>(std::move(func))});
+    m_timerIndex[id] = m_timers.size() - 1;
+    siftUp(m_timers.size() - 1);
+    armTimerFd();
 
     return id;
 }
 
+bool EventDispatcher::setTimerMode(TimerMode mode) {
+    if (mode == m_timerMode)
+        return true;
+
+    if (mode == TimerMode::Precise) {
+        const int fd = ::timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+        if (fd < 0) {
+            spdlog::error("Could not create timerfd: {}", ::strerror(errno));
+            return false;
+        }
+        // Expired timers are fired at the end of every processEvents(); the
+        // handler only needs to clear the expiration count.
+        addFile(fd, Read, [fd]() {
+            uint64_t expirations;
+            [[maybe_unused]] auto n = ::read(fd, &expirations, sizeof(expirations));
+        });
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_timer_fd = fd;
+        m_timerFdExpiry = Clock::time_point::max();
+        m_timerMode = mode;
+        armTimerFd();
+    } else {
+        removeFile(m_timer_fd, Read);
+        std::lock_guard<std::mutex> lock(m_mutex);
+        ::close(m_timer_fd);
+        m_timer_fd = -1;
+        m_timerMode = mode;
+    }
+    return true;
+}
+
+void EventDispatcher::armTimerFd() {
+    // Caller holds m_mutex
+    if (m_timerMode != TimerMode::Precise)
+        return;
+
+    // With no timers left the timerfd is disarmed rather than left to fire
+    const Clock::time_point expiry = m_timers.empty() ? Clock::time_point::max() : m_timers.front().expiry;
+    if (expiry == m_timerFdExpiry)
+        return;
+
+    struct itimerspec spec = {};
+    if (expiry != Clock::time_point::max()) {
+        // steady_clock is CLOCK_MONOTONIC on Linux
+        const auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(expiry.time_since_epoch()).count();
+        spec.it_value.tv_sec = ns / 1000000000;
+        spec.it_value.tv_nsec = ns % 1000000000;
+        if (spec.it_value.tv_sec == 0 && spec.it_value.tv_nsec == 0)
+            spec.it_value.tv_nsec = 1;  // all zero would disarm the timer
+    }
+
+    if (::timerfd_settime(m_timer_fd, TFD_TIMER_ABSTIME, &spec, nullptr) == 0)
+        m_timerFdExpiry = expiry;
+}
+
 bool EventDispatcher::removeTimer(int id) {
     std::lock_guard<std::mutex> lock(m_mutex);
-    int countBefore = m_timers.size();
+    auto it = m_timerIndex.find(id);
+    if (it == m_timerIndex.end())
+        return false;
+
+    const size_t pos = it->second;
+    m_timerIndex.erase(it);
+
+    const size_t last = m_timers.size() - 1;
+    if (pos != last) {
+        m_timers[pos] = std::move(m_timers[last]);
+        m_timerIndex[m_timers[pos].id] = pos;
+    }
+    m_timers.pop_back();
+
+    if (pos < m_timers.size()) {
+        siftUp(pos);
+        siftDown(pos);
+    }
+    // Removing the earliest timer moves the next expiry
+    armTimerFd();
+    return true;
+}
+
+void EventDispatcher::swapTimers(size_t a, size_t b) {
+    std::swap(m_timers[a], m_timers[b]);
+    m_timerIndex[m_timers[a].id] = a;
+    m_timerIndex[m_timers[b].id] = b;
+}
+
+void EventDispatcher::siftUp(size_t pos) {
+    while (pos > 0) {
+        const size_t parent = (pos - 1) / 2;
+        if (m_timers[parent].expiry <= m_timers[pos].expiry)
+            break;
+        swapTimers(pos, parent);
+        pos = parent;
+    }
+}
 
-    m_timers.remove_if([&](const TimerInfo& t) { return t.id == id; });
-    int countAfter = m_timers.size();
-    return (countAfter - countBefore) > 0;
+void EventDispatcher::siftDown(size_t pos) {
+    const size_t count = m_timers.size();
+    while (true) {
+        const size_t left = 2 * pos + 1;
+        const size_t right = left + 1;
+        size_t smallest = pos;
+        if (left < count && m_timers[left].expiry < m_timers[smallest].expiry)
+            smallest = left;
+        if (right < count && m_timers[right].expiry < m_timers[smallest].expiry)
+            smallest = right;
+        if (smallest == pos)
+            break;
+        swapTimers(pos, smallest);
+        pos = smallest;
+    }
+}
+
+static uint32_t epollEvents(EventDispatcher::FileOperation op)
+{
+    switch (op) {
+        case EventDispatcher::Read:
+            return EPOLLIN;
+        case EventDispatcher::Write:
+            return EPOLLOUT;
+        case EventDispatcher::Error:
+            return EPOLLERR;
+        default:
+            return 0;
+    }
+}
+
+uint32_t EventDispatcher::fileEvents(int fd) const
+{
+    uint32_t events = 0;
+    for (auto it = m_files.lower_bound({fd, Read}); it != m_files.end() && it->first.first == fd; ++it)
+        events |= epollEvents(it->first.second);
+    return events;
 }
 
 bool EventDispatcher::addFile(int fd, FileOperation op, FileFunc func)
 {
-    if (fd < 0)
+    if (fd < 0 || epollEvents(op) == 0)
         return false;
 
     std::lock_guard<std::mutex> lock(m_mutex);
@@ -49,28 +235,16 @@ bool EventDispatcher::addFile(int fd, FileOperation op, FileFunc func)
     if (m_files.count(key) > 0)
         return false;
 
+    // One epoll registration per fd covers all of its operations
+    const uint32_t current = fileEvents(fd);
     struct epoll_event event;
     event.data.fd = fd;
-    switch (op) {
-        case Read:
-            event.events = EPOLLIN;
-            break;
-        case Write:
-            event.events = EPOLLOUT;
-            break;
-        case Error:
-            event.events = EPOLLERR;
-            break;
-        default:
-            // TODO: log error?
-            return false;
-    }
-
-    if (::epoll_ctl(m_epoll_fd, EPOLL_CTL_ADD, fd, &event)) {
+    event.events = current | epollEvents(op);
+    if (::epoll_ctl(m_epoll_fd, current ? EPOLL_CTL_MOD : EPOLL_CTL_ADD, fd, &event)) {
         return false;
     }
 
-    m_files[key] = func;
+    m_files[key] = std::make_shared<FileFunc>(std::move(func));
 
     return true;
 }
@@ -82,71 +256,110 @@ bool EventDispatcher::removeFile(int fd, FileOperation op)
     if (m_files.count(key) == 0)
         return false;
 
+    m_files.erase(key);
+
+    const uint32_t remaining = fileEvents(fd);
     struct epoll_event event;
     event.data.fd = fd;
-    switch (op) {
-        case Read:
-            event.events = EPOLLIN;
-            break;
-        case Write:
-            event.events = EPOLLOUT;
-            break;
-        case Error:
-            event.events = EPOLLERR;
-            break;
-        default:
-            // TODO: log error?
-            return false;
-    }
-
-    if (::epoll_ctl(m_epoll_fd, EPOLL_CTL_DEL, fd, &event)) {
+    event.events = remaining;
+    if (::epoll_ctl(m_epoll_fd, remaining ? EPOLL_CTL_MOD : EPOLL_CTL_DEL, fd, &event)) {
         return false;
     }
 
-    m_files.erase(key);
-
     return true;
 }
 
 bool EventDispatcher::pendingEvents() {
-    return false;
+    return !m_tasks.empty();
+}
+
+int EventDispatcher::fireTimers() {
+    int count = 0;
+    const auto now = Clock::now();
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (!m_timers.empty() && m_timers.front().expiry <= now) {
+        TimerInfo &t = m_timers.front();
+
+        // Re-arm from the previous expiry so periodic timers do not drift,
+        // skipping any periods that were missed entirely.
+        if (t.period <= Clock::duration::zero()) {
+            t.expiry = now + Clock::duration(1);
+        } else {
+            t.expiry += t.period;
+            if (t.expiry <= now)
+                t.expiry += ((now - t.expiry) / t.period + 1) * t.period;
+        }
+
+        std::shared_ptr<TimerFunc> func = t.func;
+        siftDown(0);
+
+        lock.unlock();
+        (*func)();
+        count++;
+        lock.lock();
+    }
+    armTimerFd();
+    return count;
 }
 
 bool EventDispatcher::processEvents() {
-    m_interrupt = false;
+    // current() only reports this dispatcher until the call returns, so no thread
+    // is left pointing at a dispatcher that may since have been destroyed
+    struct CurrentScope {
+        EventDispatcher *previous = currentDispatcher;
+        ~CurrentScope() { currentDispatcher = previous; }
+    } scope;
+    currentDispatcher = this;
 
-    int count = 0;
+    // An interrupt raised between calls is consumed here without waiting
+    if (m_interrupt.exchange(false))
+        return false;
 
     int timeoutMs = -1;
-    if (m_timers.size() > 0) {
-        auto earliestTimer = m_timers.begin();
-        auto remaining = earliestTimer->expiry - std::chrono::steady_clock::now();
-        timeoutMs = std::chrono::ceil<std::chrono::milliseconds>(remaining).count();
+    if (pendingEvents()) {
+        timeoutMs = 0;
+    } else {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_timerMode == TimerMode::Coarse && m_timers.size() > 0) {
+            auto remaining = m_timers.front().expiry - Clock::now();
+            timeoutMs = std::max<int>(0, std::chrono::ceil<std::chrono::milliseconds>(remaining).count());
+        }
     }
 
     constexpr int maxEvents = 10;
     struct epoll_event events[maxEvents];
     int readyFds = ::epoll_wait(m_epoll_fd, events, maxEvents, timeoutMs);
-    for (int n = 0; n < readyFds; n++) {
-        int fd = events[n].events;
-        FileOperation op = static_cast<FileOperation>(events[n].data.fd);
-        std::pair<int,FileOperation> key{fd, op};
-        if (m_files.count(key) > 0) {
-            m_files[key]();
-        } else {
-            // TODO: log error for unexpected event?
-        }
-    }
+    for (int n = 0; n < readyFds && !m_interrupt; n++) {
+        const int fd = events[n].data.fd;
+        const uint32_t ready = events[n].events;
 
-    for (auto& t : m_timers) {
-        if (t.expired()) {
-            t.fire();
-            count++;
-        } else {
-            // It's a sorted list, so we can stop now
-            break;
+        // Errors and hang-ups also wake readers and writers so they can see the failure
+        std::shared_ptr<FileFunc> funcs[3];
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            const auto lookup = [&](FileOperation op) {
+                auto it = m_files.find(std::pair<int, FileOperation>{fd, op});
+                return it != m_files.end() ? it->second : nullptr;
+            };
+            if (ready & (EPOLLIN | EPOLLERR | EPOLLHUP))
+                funcs[Read] = lookup(Read);
+            if (ready & (EPOLLOUT | EPOLLERR | EPOLLHUP))
+                funcs[Write] = lookup(Write);
+            if (ready & (EPOLLERR | EPOLLHUP))
+                funcs[Error] = lookup(Error);
+        }
+        for (auto &func : funcs) {
+            if (func)
+                (*func)();
         }
     }
 
+    int count = runTasks();
+    if (!m_interrupt)
+        count += fireTimers();
+
+    // This call is returning, which is what the interrupt asked for
+    m_interrupt = false;
     return count > 0;
 }
@@ -0,0 +1,66 @@
+#include <dplib/core/EventLoopThread.h>
+#include <spdlog/spdlog.h>
+
+#include <pthread.h>
+#include <sched.h>
+#include <cstring>
+
+using namespace datapanel::core;
+
+EventLoopThread::EventLoopThread(std::string name) : m_name(std::move(name))
+{
+}
+
+EventLoopThread::~EventLoopThread()
+{
+    stop();
+}
+
+bool EventLoopThread::start()
+{
+    if (m_running.exchange(true))
+        return false;
+
+    m_thread = std::thread([this]() {
+        while (m_running) m_dispatcher.processEvents();
+        // Run anything posted before stop() was requested
+        while (m_dispatcher.pendingEvents()) m_dispatcher.processEvents();
+    });
+    ::pthread_setname_np(m_thread.native_handle(), m_name.substr(0, 15).c_str());
+    applyCpuAffinity();
+
+    return true;
+}
+
+void EventLoopThread::stop()
+{
+    if (!m_thread.joinable())
+        return;
+
+    m_dispatcher.post([this]() { m_running = false; });
+    m_thread.join();
+}
+
+bool EventLoopThread::setCpuAffinity(int cpu)
+{
+    m_cpu = cpu;
+    return m_thread.joinable() ? applyCpuAffinity() : true;
+}
+
+bool EventLoopThread::applyCpuAffinity()
+{
+    cpu_set_t cpus;
+    CPU_ZERO(&cpus);
+    if (m_cpu < 0) {
+        for (int n = 0; n < CPU_SETSIZE; n++) CPU_SET(n, &cpus);
+    } else {
+        CPU_SET(m_cpu, &cpus);
+    }
+
+    const int err = ::pthread_setaffinity_np(m_thread.native_handle(), sizeof(cpus), &cpus);
+    if (err != 0) {
+        spdlog::warn("Cannot set CPU affinity of {} to {}: {}", m_name, m_cpu, ::strerror(err));
+        return false;
+    }
+    return true;
+}
@@ -2,7 +2,10 @@
 
 #include "dplib/core/EventDispatcher.h"
 #include "dplib/net/can/CanBus.h"
+#include "dplib/net/can/ReplayBackend.h"
+#include "dplib/net/can/SharedMemoryBackend.h"
 #include "dplib/net/can/SocketCanBackend.h"
+#include "dplib/net/can/VirtualCanBackend.h"
 
 #include "dplib/core/Platform.h"
 
@@ -47,8 +50,11 @@ bool PlatformLinux::appStart()
 
     CanBusPluginInfo info{"SocketCAN", SocketCanBackend::init, SocketCanBackend::availableChannels};
     CanBus::registerPlugin(info);
+    CanBus::registerPlugin({"SharedMemory", SharedMemoryBackend::init, SharedMemoryBackend::availableChannels});
+    CanBus::registerPlugin({"Virtual", VirtualCanBackend::init, VirtualCanBackend::availableChannels});
+    CanBus::registerPlugin({"Replay", ReplayBackend::init, ReplayBackend::availableChannels});
 
-    m_logger->info("Registered SocketCAN plugins");
+    m_logger->info("Registered CAN plugins");
 
     struct termios ctrl;
     tcgetattr(STDIN_FILENO, &ctrl);
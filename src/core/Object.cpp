@@ -0,0 +1,56 @@
+#include <dplib/core/Application.h>
+#include <dplib/core/Event.h>
+#include <dplib/core/Object.h>
+
+#include <algorithm>
+#include <memory>
+
+using namespace datapanel::core;
+
+Object::Object()
+{
+}
+
+Object::~Object()
+{
+    for (int id : m_timers) Application::instance().removeTimer(id);
+    if (m_postedEvents.load(std::memory_order_acquire) > 0)
+        Application::instance().removePostedEvents(this);
+}
+
+bool Object::event(Event *event)
+{
+    switch (event->type()) {
+        case Event::EventType::Timer:
+            timerEvent(static_cast<TimerEvent *>(event));
+            return true;
+        default:
+            return false;
+    }
+}
+
+void Object::timerEvent(TimerEvent *)
+{
+}
+
+int Object::startTimer(int periodMs)
+{
+    Application &app = Application::instance();
+
+    // The timer ID is only known once the timer exists
+    auto id = std::make_shared<int>(-1);
+    *id = app.addTimer(periodMs, [this, id]() {
+        Application::instance().postEvent(this, std::make_unique<TimerEvent>(*id));
+    });
+    m_timers.push_back(*id);
+    return *id;
+}
+
+void Object::killTimer(int id)
+{
+    auto it = std::find(m_timers.begin(), m_timers.end(), id);
+    if (it == m_timers.end())
+        return;
+    m_timers.erase(it);
+    Application::instance().removeTimer(id);
+}
@@ -0,0 +1,531 @@
+/**
+ * Copyright (c) 2026 Data Panel Corporation
+ * 181 Cheshire Ln, Suite 300
+ * Plymouth, MN 55441
+ * All rights reserved.
+ *
+ * This is the confidential and proprietary information of Data Panel
+ * Corporation. Such confidential information shall not be disclosed and is for
+ * use only in accordance with the license agreement you entered into with Data
+ * Panel.
+ */
+
+/**
+ * @file CanCapture.cpp
+ * @date 2026-10-16
+ */
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+
+#include <fmt/format.h>
+
+#include "dplib/net/can/CanCapture.h"
+
+#include "dplib/util/lz4.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace datapanel::net::can;
+
+namespace
+{
+constexpr char FileMagic[8] = {'D', 'P', 'C', 'A', 'P', '\r', '\n', '\x1a'};
+constexpr uint16_t FileVersion = 1;
+constexpr uint32_t TrailerMagic = 0x58495044;  // "DPIX"
+
+/** Largest encoded record: flags, timestamp and identifier varints, length, payload */
+constexpr size_t MaxRecordSize = 1 + 10 + 5 + 1 + CanFrame::MaxPayloadSize;
+
+struct FileHeader {
+    char magic[8];
+    uint16_t version;
+    uint16_t headerSize;
+    uint32_t flags;
+    int64_t createdNs;
+};
+
+struct Trailer {
+    uint64_t indexOffset;
+    uint32_t chunkCount;
+    uint32_t magic;
+};
+
+static_assert(sizeof(FileHeader) == 24 && sizeof(Trailer) == 16, "Capture file layout changed");
+
+// Record flags byte; the low three bits hold the frame type
+enum RecordFlag : uint8_t {
+    RecordTypeMask = 0x07,
+    RecordExtendedId = 0x08,
+    RecordFD = 0x10,
+    RecordBRS = 0x20,
+    RecordErrorState = 0x40,
+    RecordEcho = 0x80,
+};
+
+inline std::byte *putVarint(std::byte *p, uint64_t v) noexcept
+{
+    while (v >= 0x80) {
+        *p++ = std::byte(v | 0x80);
+        v >>= 7;
+    }
+    *p++ = std::byte(v);
+    return p;
+}
+
+inline bool getVarint(const std::byte *&p, const std::byte *end, uint64_t &v) noexcept
+{
+    v = 0;
+    for (int shift = 0; shift < 64 && p < end; shift += 7) {
+        const uint8_t b = uint8_t(*p++);
+        v |= uint64_t(b & 0x7F) << shift;
+        if (!(b & 0x80))
+            return true;
+    }
+    return false;
+}
+
+inline uint64_t zigzag(int64_t v) noexcept
+{
+    return (uint64_t(v) << 1) ^ uint64_t(v >> 63);
+}
+
+inline int64_t unzigzag(uint64_t v) noexcept
+{
+    return int64_t(v >> 1) ^ -int64_t(v & 1);
+}
+}  // namespace
+
+CanCaptureWriter::~CanCaptureWriter()
+{
+    close();
+}
+
+bool CanCaptureWriter::open(const std::string &path, CanCaptureChunk::Compression compression, size_t chunkSize)
+{
+    close();
+
+    _fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (_fd < 0) {
+        _errorMessage = fmt::format("Cannot create {}: {}", path, std::strerror(errno));
+        return false;
+    }
+
+    _offset = 0;
+    _compression = compression;
+    _chunkSize = std::clamp<size_t>(chunkSize, MaxRecordSize, MaxChunkSize);
+    _chunk = CanCaptureChunk();
+    _records.clear();
+    _records.reserve(_chunkSize + MaxRecordSize);
+    _previousNs = 0;
+    _index.clear();
+    _framesWritten = 0;
+    _failed = false;
+
+    FileHeader header{};
+    std::memcpy(header.magic, FileMagic, sizeof(FileMagic));
+    header.version = FileVersion;
+    header.headerSize = sizeof(FileHeader);
+    header.createdNs = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+    if (!writeAll(&header, sizeof(header))) {
+        ::close(_fd);
+        _fd = -1;
+        return false;
+    }
+    return true;
+}
+
+bool CanCaptureWriter::close()
+{
+    detach();
+    if (_fd < 0)
+        return true;
+
+    bool ok = flush();
+    if (ok) {
+        Trailer trailer{_offset, uint32_t(_index.size()), TrailerMagic};
+        ok = writeAll(_index.data(), _index.size() * sizeof(CanCaptureIndexEntry)) &&
+             writeAll(&trailer, sizeof(trailer));
+    }
+    if (::close(_fd) < 0 && ok) {
+        _errorMessage = fmt::format("Cannot close capture: {}", std::strerror(errno));
+        ok = false;
+    }
+    _fd = -1;
+    return ok;
+}
+
+bool CanCaptureWriter::write(const CanFrame *frames, size_t count)
+{
+    if (_fd < 0) {
+        _errorMessage = "Capture is not open";
+        return false;
+    }
+    if (_failed)
+        return false;
+
+    for (size_t i = 0; i < count; i++) {
+        const CanFrame &frame = frames[i];
+        const bool isError = frame.frameType() == CanFrame::ErrorFrame;
+
+        uint8_t flags = uint8_t(frame.frameType()) & RecordTypeMask;
+        if (frame.isExtendedId())
+            flags |= RecordExtendedId;
+        if (frame.isFD())
+            flags |= RecordFD;
+        if (frame.isBitrateSwitch())
+            flags |= RecordBRS;
+        if (frame.isErrorState())
+            flags |= RecordErrorState;
+        if (frame.isLocalEcho())
+            flags |= RecordEcho;
+
+        const int64_t ns = frame.timestampNs();
+        const size_t length = frame.payloadSize();
+
+        const size_t used = _records.size();
+        _records.resize(used + MaxRecordSize);
+        std::byte *p = _records.data() + used;
+        *p++ = std::byte(flags);
+        p = putVarint(p, zigzag(ns - _previousNs));
+        p = putVarint(p, isError ? uint64_t(frame.error()) : uint64_t(frame.id()));
+        *p++ = std::byte(length);
+        if (length > 0) {
+            std::memcpy(p, frame.payload().data(), length);
+            p += length;
+        }
+        _records.resize(size_t(p - _records.data()));
+
+        _previousNs = ns;
+        _chunk.frameCount++;
+        _chunk.firstNs = std::min(_chunk.firstNs, ns);
+        _chunk.lastNs = std::max(_chunk.lastNs, ns);
+        if (!isError)
+            _chunk.addId(frame.id());
+
+        if (_records.size() >= _chunkSize && !flush())
+            return false;
+    }
+    return true;
+}
+
+bool CanCaptureWriter::flush()
+{
+    if (_fd < 0 || _failed || _chunk.frameCount == 0)
+        return _fd >= 0 && !_failed;
+
+    const std::byte *stored = _records.data();
+    _chunk.compression = CanCaptureChunk::None;
+    _chunk.rawSize = uint32_t(_records.size());
+    _chunk.storedSize = _chunk.rawSize;
+
+    if (_compression == CanCaptureChunk::Lz4) {
+        _packed.resize(util::lz4CompressBound(_records.size()));
+        const size_t packed = util::lz4Compress(_records.data(), _records.size(), _packed.data(), _packed.size());
+        if (packed > 0 && packed < _records.size()) {
+            stored = _packed.data();
+            _chunk.compression = CanCaptureChunk::Lz4;
+            _chunk.storedSize = uint32_t(packed);
+        }
+    }
+
+    _index.push_back({_offset, _chunk});
+    if (!writeAll(&_chunk, sizeof(_chunk)) || !writeAll(stored, _chunk.storedSize)) {
+        _index.pop_back();
+        return false;
+    }
+
+    _framesWritten += _chunk.frameCount;
+    _chunk = CanCaptureChunk();
+    _records.clear();
+    _previousNs = 0;
+    return true;
+}
+
+void CanCaptureWriter::attach(CanInterface &source)
+{
+    detach();
+    _connection = source.framesTapped.connect([this](const CanFrame *frames, size_t count) { write(frames, count); });
+}
+
+void CanCaptureWriter::detach()
+{
+    _connection.disconnect();
+}
+
+bool CanCaptureWriter::writeAll(const void *data, size_t size)
+{
+    const char *p = static_cast<const char *>(data);
+    while (size > 0) {
+        const ssize_t n = ::write(_fd, p, size);
+        if (n < 0) {
+            if (errno == EINTR)
+                continue;
+            _errorMessage = fmt::format("Cannot write capture: {}", std::strerror(errno));
+            _failed = true;
+            return false;
+        }
+        p += n;
+        size -= size_t(n);
+        _offset += uint64_t(n);
+    }
+    return true;
+}
+
+CanCaptureReader::~CanCaptureReader()
+{
+    close();
+}
+
+bool CanCaptureReader::open(const std::string &path)
+{
+    close();
+
+    const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        _errorMessage = fmt::format("Cannot open {}: {}", path, std::strerror(errno));
+        return false;
+    }
+
+    struct stat st;
+    if (::fstat(fd, &st) < 0 || size_t(st.st_size) < sizeof(FileHeader)) {
+        _errorMessage = fmt::format("{} is not a capture file", path);
+        ::close(fd);
+        return false;
+    }
+
+    _size = size_t(st.st_size);
+    void *data = ::mmap(nullptr, _size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (data == MAP_FAILED) {
+        _errorMessage = fmt::format("Cannot map {}: {}", path, std::strerror(errno));
+        return false;
+    }
+    ::madvise(data, _size, MADV_RANDOM);
+    _data = static_cast<const std::byte *>(data);
+
+    FileHeader header;
+    std::memcpy(&header, _data, sizeof(header));
+    if (std::memcmp(header.magic, FileMagic, sizeof(FileMagic)) != 0 || header.version != FileVersion) {
+        _errorMessage = fmt::format("{} is not a version {} capture file", path, FileVersion);
+        close();
+        return false;
+    }
+
+    if (!loadIndex()) {
+        close();
+        return false;
+    }
+
+    _lastNsUpTo.resize(_index.size());
+    int64_t last = std::numeric_limits<int64_t>::min();
+    for (size_t i = 0; i < _index.size(); i++) {
+        last = std::max(last, _index[i].chunk.lastNs);
+        _lastNsUpTo[i] = last;
+    }
+
+    _chunksDecoded = 0;
+    setFilter(CanCaptureFilter());
+    return true;
+}
+
+void CanCaptureReader::close()
+{
+    if (_data != nullptr)
+        ::munmap(const_cast<std::byte *>(_data), _size);
+    _data = nullptr;
+    _size = 0;
+    _index.clear();
+    _lastNsUpTo.clear();
+    _cursor = _chunkEnd = nullptr;
+}
+
+bool CanCaptureReader::loadIndex()
+{
+    _index.clear();
+    _recovered = false;
+
+    const size_t start = sizeof(FileHeader);
+    if (_size >= start + sizeof(Trailer)) {
+        Trailer trailer;
+        std::memcpy(&trailer, _data + _size - sizeof(trailer), sizeof(trailer));
+        const uint64_t indexSize = uint64_t(trailer.chunkCount) * sizeof(CanCaptureIndexEntry);
+        // Each bound is checked on its own so that no sum of file values can wrap
+        const uint64_t indexEnd = _size - sizeof(trailer);
+        if (trailer.magic == TrailerMagic && trailer.indexOffset >= start && trailer.indexOffset <= indexEnd &&
+            indexSize == indexEnd - trailer.indexOffset) {
+            _index.resize(trailer.chunkCount);
+            std::memcpy(_index.data(), _data + trailer.indexOffset, indexSize);
+            for (const CanCaptureIndexEntry &entry : _index) {
+                if (entry.chunk.magic != CanCaptureChunk::Magic || entry.offset < start ||
+                    entry.offset > trailer.indexOffset ||
+                    trailer.indexOffset - entry.offset < sizeof(CanCaptureChunk) ||
+                    entry.chunk.storedSize > trailer.indexOffset - entry.offset - sizeof(CanCaptureChunk)) {
+                    _errorMessage = "Capture index is corrupt";
+                    return false;
+                }
+            }
+            return true;
+        }
+    }
+
+    // No trailer: the writer did not finish, so keep every complete chunk
+    _recovered = true;
+    for (size_t offset = start; offset + sizeof(CanCaptureChunk) <= _size;) {
+        CanCaptureIndexEntry entry;
+        entry.offset = offset;
+        std::memcpy(&entry.chunk, _data + offset, sizeof(entry.chunk));
+        if (entry.chunk.magic != CanCaptureChunk::Magic ||
+            entry.chunk.storedSize > _size - offset - sizeof(CanCaptureChunk))
+            break;
+        _index.push_back(entry);
+        offset += sizeof(CanCaptureChunk) + entry.chunk.storedSize;
+    }
+    return true;
+}
+
+uint64_t CanCaptureReader::frameCount() const
+{
+    uint64_t count = 0;
+    for (const CanCaptureIndexEntry &entry : _index) count += entry.chunk.frameCount;
+    return count;
+}
+
+int64_t CanCaptureReader::startNs() const
+{
+    int64_t first = std::numeric_limits<int64_t>::max();
+    for (const CanCaptureIndexEntry &entry : _index) first = std::min(first, entry.chunk.firstNs);
+    return first;
+}
+
+int64_t CanCaptureReader::endNs() const
+{
+    return _lastNsUpTo.empty() ? std::numeric_limits<int64_t>::min() : _lastNsUpTo.back();
+}
+
+void CanCaptureReader::setFilter(const CanCaptureFilter &filter)
+{
+    _filter = filter;
+    _ids = filter.ids;
+    std::sort(_ids.begin(), _ids.end());
+    _ids.erase(std::unique(_ids.begin(), _ids.end()), _ids.end());
+    seek(filter.fromNs);
+}
+
+void CanCaptureReader::seek(int64_t ns)
+{
+    _fromNs = std::max(ns, _filter.fromNs);
+    _nextChunk = size_t(std::lower_bound(_lastNsUpTo.begin(), _lastNsUpTo.end(), _fromNs) - _lastNsUpTo.begin());
+    _cursor = _chunkEnd = nullptr;
+}
+
+bool CanCaptureReader::wanted(const CanCaptureChunk &chunk) const
+{
+    if (chunk.frameCount == 0 || chunk.lastNs < _fromNs || chunk.firstNs >= _filter.toNs)
+        return false;
+    if (_ids.empty())
+        return true;
+    return std::any_of(_ids.begin(), _ids.end(), [&](CanFrame::FrameId id) { return chunk.mayContain(id); });
+}
+
+bool CanCaptureReader::loadChunk(size_t n)
+{
+    const CanCaptureIndexEntry &entry = _index[n];
+    const std::byte *stored = _data + entry.offset + sizeof(CanCaptureChunk);
+
+    _chunksDecoded++;
+    _previousNs = 0;
+    if (entry.chunk.compression == CanCaptureChunk::None) {
+        _cursor = stored;
+        _chunkEnd = stored + entry.chunk.storedSize;
+        return true;
+    }
+
+    if (entry.chunk.compression != CanCaptureChunk::Lz4) {
+        _errorMessage = fmt::format("Capture chunk {} has unknown compression {}", n, entry.chunk.compression);
+        return false;
+    }
+    // No writer produces more; a corrupt header must not make us allocate gigabytes
+    if (entry.chunk.rawSize > CanCaptureWriter::MaxChunkSize + MaxRecordSize) {
+        _errorMessage = fmt::format("Capture chunk {} is corrupt", n);
+        return false;
+    }
+    _buffer.resize(entry.chunk.rawSize);
+    if (util::lz4Decompress(stored, entry.chunk.storedSize, _buffer.data(), _buffer.size()) != _buffer.size()) {
+        _errorMessage = fmt::format("Capture chunk {} is corrupt", n);
+        return false;
+    }
+    _cursor = _buffer.data();
+    _chunkEnd = _cursor + _buffer.size();
+    return true;
+}
+
+bool CanCaptureReader::next(CanFrame &frame)
+{
+    if (_data == nullptr)
+        return false;
+
+    while (true) {
+        if (_cursor == _chunkEnd) {
+            while (_nextChunk < _index.size() && !wanted(_index[_nextChunk].chunk)) _nextChunk++;
+            if (_nextChunk == _index.size() || !loadChunk(_nextChunk)) {
+                _nextChunk = _index.size();
+                _cursor = _chunkEnd = nullptr;
+                return false;
+            }
+            _nextChunk++;
+            continue;
+        }
+
+        const std::byte *p = _cursor;
+        const uint8_t flags = uint8_t(*p++);
+        uint64_t delta, id;
+        if (!getVarint(p, _chunkEnd, delta) || !getVarint(p, _chunkEnd, id) || p == _chunkEnd ||
+            size_t(uint8_t(*p)) > std::min<size_t>(size_t(_chunkEnd - p - 1), CanFrame::MaxPayloadSize)) {
+            _errorMessage = fmt::format("Capture chunk {} is corrupt", _nextChunk - 1);
+            _nextChunk = _index.size();
+            _cursor = _chunkEnd = nullptr;
+            return false;
+        }
+        const size_t length = size_t(uint8_t(*p++));
+        const std::byte *payload = p;
+        _cursor = p + length;
+
+        const int64_t ns = _previousNs + unzigzag(delta);
+        _previousNs = ns;
+        if (ns < _fromNs || ns >= _filter.toNs)
+            continue;
+
+        const auto type = CanFrame::FrameType(flags & RecordTypeMask);
+        if (!_ids.empty() &&
+            (type == CanFrame::ErrorFrame || !std::binary_search(_ids.begin(), _ids.end(), CanFrame::FrameId(id))))
+            continue;
+
+        frame = CanFrame(type);
+        if (type == CanFrame::ErrorFrame)
+            frame.setError(CanFrame::FrameError(id));
+        else
+            frame.setId(CanFrame::FrameId(id));
+        frame.setExtendedId(flags & RecordExtendedId);
+        frame.setPayload(payload, length);
+        frame.setFD(flags & RecordFD);
+        frame.setBitrateSwitch(flags & RecordBRS);
+        frame.setErrorState(flags & RecordErrorState);
+        frame.setLocalEcho(flags & RecordEcho);
+        frame.setTimestampNs(ns);
+        return true;
+    }
+}
+
+size_t CanCaptureReader::read(CanFrame *frames, size_t count)
+{
+    size_t n = 0;
+    while (n < count && next(frames[n])) n++;
+    return n;
+}
@@ -0,0 +1,235 @@
+/**
+ * Copyright (c) 2026 Data Panel Corporation
+ * 181 Cheshire Ln, Suite 300
+ * Plymouth, MN 55441
+ * All rights reserved.
+ *
+ * This is the confidential and proprietary information of Data Panel
+ * Corporation. Such confidential information shall not be disclosed and is for
+ * use only in accordance with the license agreement you entered into with Data
+ * Panel.
+ */
+
+/**
+ * @file
+ * @date 2026-10-16
+ */
+
+#include "dplib/net/can/CanFrameCodec.h"
+
+#include <algorithm>
+#include <cstring>
+
+// After dplib headers: CanFrame.h declares constants with the same names as these macros
+#include <linux/can.h>
+#include <linux/errqueue.h>
+#include <sys/socket.h>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+using namespace datapanel::net::can;
+
+namespace
+{
+/** Identifier and flags extracted from a block of can_id words */
+struct IdLanes {
+    alignas(16) uint32_t id[4];
+    alignas(16) uint32_t type[4];
+    alignas(16) uint32_t extended[4];
+};
+
+// Frame type is RemoteRequestFrame if RTR is set, else ErrorFrame if ERR is set, else DataFrame
+static_assert(CanFrame::DataFrame == 1 && CanFrame::ErrorFrame == 2 && CanFrame::RemoteRequestFrame == 3);
+
+inline void extractScalar(const uint32_t *canIds, IdLanes &lanes, size_t count) noexcept
+{
+    for (size_t n = 0; n < count; n++) {
+        const uint32_t canId = canIds[n];
+        const uint32_t rtr = (canId >> 30) & 1;
+        const uint32_t err = (canId >> 29) & 1;
+        lanes.id[n] = canId & CAN_EFF_MASK;
+        lanes.type[n] = 1 + (rtr << 1) + (err & ~rtr);
+        lanes.extended[n] = (canId >> 31) | ((canId & CAN_EFF_UPPER_MASK) != 0);
+    }
+}
+
+inline void extract4(const uint32_t *canIds, IdLanes &lanes) noexcept
+{
+#if defined(__SSE2__)
+    const __m128i canId = _mm_load_si128(reinterpret_cast<const __m128i *>(canIds));
+    const __m128i one = _mm_set1_epi32(1);
+    const __m128i rtr = _mm_and_si128(_mm_srli_epi32(canId, 30), one);
+    const __m128i err = _mm_and_si128(_mm_srli_epi32(canId, 29), one);
+    const __m128i upper = _mm_and_si128(canId, _mm_set1_epi32(CAN_EFF_UPPER_MASK));
+    const __m128i upperSet = _mm_andnot_si128(_mm_cmpeq_epi32(upper, _mm_setzero_si128()), one);
+
+    _mm_store_si128(reinterpret_cast<__m128i *>(lanes.id), _mm_and_si128(canId, _mm_set1_epi32(CAN_EFF_MASK)));
+    _mm_store_si128(reinterpret_cast<__m128i *>(lanes.type),
+                    _mm_add_epi32(_mm_add_epi32(one, _mm_slli_epi32(rtr, 1)), _mm_andnot_si128(rtr, err)));
+    _mm_store_si128(reinterpret_cast<__m128i *>(lanes.extended), _mm_or_si128(_mm_srli_epi32(canId, 31), upperSet));
+#elif defined(__ARM_NEON)
+    const uint32x4_t canId = vld1q_u32(canIds);
+    const uint32x4_t one = vdupq_n_u32(1);
+    const uint32x4_t rtr = vandq_u32(vshrq_n_u32(canId, 30), one);
+    const uint32x4_t err = vandq_u32(vshrq_n_u32(canId, 29), one);
+    const uint32x4_t upperSet = vandq_u32(vtstq_u32(canId, vdupq_n_u32(CAN_EFF_UPPER_MASK)), one);
+
+    vst1q_u32(lanes.id, vandq_u32(canId, vdupq_n_u32(CAN_EFF_MASK)));
+    vst1q_u32(lanes.type, vaddq_u32(vaddq_u32(one, vshlq_n_u32(rtr, 1)), vbicq_u32(err, rtr)));
+    vst1q_u32(lanes.extended, vorrq_u32(vshrq_n_u32(canId, 31), upperSet));
+#else
+    extractScalar(canIds, lanes, 4);
+#endif
+}
+}  // namespace
+
+/** Fill every field of @p frame; the frame's previous contents are ignored */
+inline void CanFrameCodec::store(CanFrame &frame, uint32_t id, uint32_t type, uint32_t extended, const uint8_t *data,
+                                 uint8_t len, uint8_t flags, bool fd) noexcept
+{
+    const uint8_t maxLen = fd ? CANFD_MAX_DLEN : CAN_MAX_DLEN;
+    if (len > maxLen)
+        len = maxLen;
+
+    frame._id = id;
+    frame._type = static_cast<uint8_t>(type);
+    frame._flags = CanFrame::FlagValidId;
+    if (extended)
+        frame._flags |= CanFrame::FlagExtendedId;
+    if (fd || len > CAN_MAX_DLEN)
+        frame._flags |= CanFrame::FlagFD;
+    if (fd && (flags & CANFD_BRS))
+        frame._flags |= CanFrame::FlagBRS;
+    if (fd && (flags & CANFD_ESI))
+        frame._flags |= CanFrame::FlagErrorState;
+    frame._reserved = 0;
+    frame._length = len;
+    // Fixed-size copies compile to a few vector moves; bytes past len are never exposed
+    if (fd)
+        std::memcpy(frame._payload.data(), data, CANFD_MAX_DLEN);
+    else
+        std::memcpy(frame._payload.data(), data, CAN_MAX_DLEN);
+    frame._timestampNs = 0;
+}
+
+void CanFrameCodec::decode(const canfd_frame &raw, bool fd, CanFrame &frame) noexcept
+{
+    IdLanes lanes;
+    extractScalar(&raw.can_id, lanes, 1);
+    store(frame, lanes.id[0], lanes.type[0], lanes.extended[0], raw.data, raw.len, raw.flags, fd);
+}
+
+void CanFrameCodec::decode(const canfd_frame *raw, const uint32_t *sizes, CanFrame *frames, size_t count) noexcept
+{
+    alignas(16) uint32_t canIds[4];
+    IdLanes lanes;
+
+    for (size_t base = 0; base < count; base += 4) {
+        const size_t block = std::min<size_t>(4, count - base);
+        for (size_t n = 0; n < block; n++) canIds[n] = raw[base + n].can_id;
+        if (block == 4)
+            extract4(canIds, lanes);
+        else
+            extractScalar(canIds, lanes, block);
+
+        for (size_t n = 0; n < block; n++) {
+            const canfd_frame &in = raw[base + n];
+            const uint32_t size = sizes[base + n];
+            if (size != CAN_MTU && size != CANFD_MTU) {
+                frames[base + n] = CanFrame(CanFrame::InvalidFrame);
+                continue;
+            }
+            store(frames[base + n], lanes.id[n], lanes.type[n], lanes.extended[n], in.data, in.len, in.flags,
+                  size == CANFD_MTU);
+        }
+    }
+}
+
+void CanFrameCodec::decode(const can_frame *raw, CanFrame *frames, size_t count) noexcept
+{
+    alignas(16) uint32_t canIds[4];
+    IdLanes lanes;
+
+    for (size_t base = 0; base < count; base += 4) {
+        const size_t block = std::min<size_t>(4, count - base);
+        for (size_t n = 0; n < block; n++) canIds[n] = raw[base + n].can_id;
+        if (block == 4)
+            extract4(canIds, lanes);
+        else
+            extractScalar(canIds, lanes, block);
+
+        for (size_t n = 0; n < block; n++) {
+            const can_frame &in = raw[base + n];
+            store(frames[base + n], lanes.id[n], lanes.type[n], lanes.extended[n], in.data, in.can_dlc, 0, false);
+        }
+    }
+}
+
+size_t CanFrameCodec::encode(const CanFrame &frame, canfd_frame &raw) noexcept
+{
+    canid_t id = frame.id();
+    if (frame.isExtendedId())
+        id |= CAN_EFF_FLAG;
+
+    if (frame.frameType() == CanFrame::RemoteRequestFrame) {
+        id |= CAN_RTR_FLAG;
+    } else if (frame.frameType() == CanFrame::ErrorFrame) {
+        id = static_cast<canid_t>((frame.error()) & CanFrame::AnyError);
+        id |= CAN_ERR_FLAG;
+    }
+
+    const util::ByteView payload = frame.payload();
+    std::memset(&raw, 0, sizeof(raw));
+    raw.can_id = id;
+    raw.len = payload.size();
+    if (frame.isFD()) {
+        raw.flags |= frame.isBitrateSwitch() ? CANFD_BRS : 0;
+        raw.flags |= frame.isErrorState() ? CANFD_ESI : 0;
+    }
+    std::memcpy(raw.data, payload.data(), raw.len);
+
+    // can_frame shares the canfd_frame layout; can_dlc is the len field
+    return frame.isFD() ? CANFD_MTU : CAN_MTU;
+}
+
+CanFrame::Timestamp CanFrameCodec::timestamp(const msghdr &hdr) noexcept
+{
+    // CMSG_NXTHDR only reads the header but is not declared const
+    msghdr &msg = const_cast<msghdr &>(hdr);
+    const cmsghdr *software = nullptr;
+    for (cmsghdr *cmsg = CMSG_FIRSTHDR(&msg); cmsg != nullptr; cmsg = CMSG_NXTHDR(&msg, cmsg)) {
+        if (cmsg->cmsg_level != SOL_SOCKET)
+            continue;
+
+        if (cmsg->cmsg_type == SCM_TIMESTAMPING) {
+            // ts[0] is the software timestamp, ts[2] the raw hardware timestamp
+            scm_timestamping stamps;
+            std::memcpy(&stamps, CMSG_DATA(cmsg), sizeof(stamps));
+            const timespec &ts = (stamps.ts[2].tv_sec || stamps.ts[2].tv_nsec) ? stamps.ts[2] : stamps.ts[0];
+            return CanFrame::Timestamp(ts.tv_sec, ts.tv_nsec);
+        } else if (cmsg->cmsg_type == SCM_TIMESTAMPNS && software == nullptr) {
+            software = cmsg;
+        }
+    }
+
+    if (software == nullptr)
+        return CanFrame::Timestamp();
+    timespec ts;
+    std::memcpy(&ts, CMSG_DATA(software), sizeof(ts));
+    return CanFrame::Timestamp(ts.tv_sec, ts.tv_nsec);
+}
+
+const char *CanFrameCodec::implementation() noexcept
+{
+#if defined(__SSE2__)
+    return "SSE2";
+#elif defined(__ARM_NEON)
+    return "NEON";
+#else
+    return "scalar";
+#endif
+}
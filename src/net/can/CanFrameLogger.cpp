@@ -0,0 +1,316 @@
+/**
+ * Copyright (c) 2026 Data Panel Corporation
+ * 181 Cheshire Ln, Suite 300
+ * Plymouth, MN 55441
+ * All rights reserved.
+ *
+ * This is the confidential and proprietary information of Data Panel
+ * Corporation. Such confidential information shall not be disclosed and is for
+ * use only in accordance with the license agreement you entered into with Data
+ * Panel.
+ */
+
+/**
+ * @file CanFrameLogger.cpp
+ * @date 2026-10-16
+ */
+
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+
+#include <fmt/format.h>
+
+#include "dplib/net/can/CanFrameLogger.h"
+#include "dplib/util/hexdump.h"
+
+#include <fcntl.h>
+#include <unistd.h>
+
+using namespace datapanel::net::can;
+
+namespace
+{
+constexpr size_t WriteBatchSize = 256;
+constexpr size_t TextBufferSize = 64 * 1024;
+/**
+ * Longest candump line apart from the channel name: a ten-digit timestamp,
+ * an extended identifier with FD flags, 64 data bytes and the echo mark
+ */
+constexpr size_t MaxLineSize = sizeof("(0000000000.000000) ") - 1 + sizeof(" 00000000##0") - 1 +
+                               2 * CanFrame::MaxPayloadSize + sizeof(" T\n") - 1;
+
+constexpr char HexDigits[] = "0123456789ABCDEF";
+
+char *putHex(char *p, uint32_t value, int digits)
+{
+    for (int shift = 4 * (digits - 1); shift >= 0; shift -= 4) *p++ = HexDigits[(value >> shift) & 0xF];
+    return p;
+}
+
+char *putDecimal(char *p, uint64_t value, int minDigits)
+{
+    char digits[20];
+    int n = 0;
+    do {
+        digits[n++] = char('0' + value % 10);
+        value /= 10;
+    } while (value != 0);
+    while (n < minDigits) digits[n++] = '0';
+    while (n > 0) *p++ = digits[--n];
+    return p;
+}
+
+/** Format one `candump -l` line, as parsed by ReplayBackend::parseCandumpLine() */
+char *putCandumpLine(char *p, const CanFrame &frame, const std::string &channel)
+{
+    const uint64_t ns = frame.timestampNs() > 0 ? uint64_t(frame.timestampNs()) : 0;
+    *p++ = '(';
+    p = putDecimal(p, ns / 1000000000, 10);
+    *p++ = '.';
+    p = putDecimal(p, ns % 1000000000 / 1000, 6);
+    *p++ = ')';
+    *p++ = ' ';
+    std::memcpy(p, channel.data(), channel.size());
+    p += channel.size();
+    *p++ = ' ';
+
+    if (frame.frameType() == CanFrame::ErrorFrame) {
+        p = putHex(p, 0x20000000 | uint32_t(frame.error()), 8);
+    } else if (frame.isExtendedId()) {
+        p = putHex(p, uint32_t(frame.id()), 8);
+    } else {
+        p = putHex(p, uint32_t(frame.id()), 3);
+    }
+    *p++ = '#';
+
+    if (frame.frameType() == CanFrame::RemoteRequestFrame) {
+        *p++ = 'R';
+        if (frame.payloadSize() > 0)
+            *p++ = char('0' + frame.payloadSize());
+    } else {
+        if (frame.isFD()) {
+            *p++ = '#';
+            *p++ = HexDigits[(frame.isBitrateSwitch() ? 1 : 0) | (frame.isErrorState() ? 2 : 0)];
+        }
+        p = datapanel::util::hexdumpTo(frame.payload(), p, "");
+    }
+
+    if (frame.isLocalEcho()) {
+        *p++ = ' ';
+        *p++ = 'T';
+    }
+    *p++ = '\n';
+    return p;
+}
+}  // namespace
+
+CanFrameLogger::CanFrameLogger(size_t capacity) : _ring(capacity, util::OverflowPolicy::DropNewest)
+{
+}
+
+CanFrameLogger::~CanFrameLogger()
+{
+    close();
+}
+
+bool CanFrameLogger::open(const std::string &path, Format format, const std::string &channel)
+{
+    close();
+
+    _format = format;
+    _channel = channel;
+    _failed = false;
+    _errorMessage.clear();
+
+    if (format == Binary) {
+        if (path == "-") {
+            _errorMessage = "Binary frame logs cannot be written to standard output";
+            return false;
+        }
+        if (!_capture.open(path)) {
+            _errorMessage = _capture.errorMessage();
+            return false;
+        }
+    } else {
+        if (channel.size() > TextBufferSize - MaxLineSize) {
+            _errorMessage = "Channel name is too long";
+            return false;
+        }
+        if (path == "-") {
+            _fd = STDOUT_FILENO;
+            _ownsFd = false;
+        } else {
+            _fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+            if (_fd < 0) {
+                _errorMessage = fmt::format("Cannot create {}: {}", path, std::strerror(errno));
+                return false;
+            }
+            _ownsFd = true;
+        }
+        if (!_text)
+            _text = std::make_unique<char[]>(TextBufferSize);
+        _textUsed = 0;
+        _textFrames = 0;
+    }
+
+    _ring.reset(_ring.capacity(), util::OverflowPolicy::DropNewest);
+    _written = 0;
+    _discarded = 0;
+    _handed = 0;
+    _sleeping = false;
+    _stop = false;
+    _writer = std::thread(&CanFrameLogger::runWriter, this);
+    return true;
+}
+
+bool CanFrameLogger::close()
+{
+    detach();
+    if (!_writer.joinable())
+        return true;
+
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _stop = true;
+    }
+    _wake.notify_one();
+    _writer.join();
+
+    bool ok = !_failed;
+    if (_format == Binary) {
+        const bool closed = _capture.close();
+        if (ok)
+            countCaptured(closed);
+        ok = ok && closed;
+    } else {
+        if (!flushText())
+            ok = false;
+        if (_ownsFd)
+            ::close(_fd);
+        _fd = -1;
+    }
+    return ok;
+}
+
+size_t CanFrameLogger::log(const CanFrame *frames, size_t count) noexcept
+{
+    size_t queued = 0;
+    for (size_t i = 0; i < count; i++) queued += _ring.push(frames[i]);
+
+    // Pairs with the fence in runWriter(): either it sees the frames or we see it asleep
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (_sleeping.load(std::memory_order_relaxed) && _sleeping.exchange(false)) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _wake.notify_one();
+    }
+    return queued;
+}
+
+void CanFrameLogger::attach(CanInterface &source)
+{
+    detach();
+    _connection = source.framesTapped.connect([this](const CanFrame *frames, size_t count) { log(frames, count); });
+}
+
+void CanFrameLogger::detach()
+{
+    _connection.disconnect();
+}
+
+void CanFrameLogger::runWriter()
+{
+    using Clock = std::chrono::steady_clock;
+    const auto flushInterval = std::chrono::milliseconds(FlushIntervalMs);
+
+    CanFrame batch[WriteBatchSize];
+    auto lastFlush = Clock::now();
+
+    while (true) {
+        size_t count = 0;
+        while (count < WriteBatchSize && _ring.pop(batch[count])) count++;
+
+        if (count > 0) {
+            if (_failed) {
+                _discarded.fetch_add(count, std::memory_order_relaxed);
+                continue;
+            }
+            if (_format == Binary) {
+                _handed += count;
+                countCaptured(_capture.write(batch, count));
+            } else if (!writeText(batch, count)) {
+                _failed = true;
+            }
+            continue;
+        }
+
+        // Idle: write buffered text once it is old enough, then sleep until frames arrive
+        auto now = Clock::now();
+        if (_textUsed > 0 && now - lastFlush >= flushInterval) {
+            if (!_failed && !flushText())
+                _failed = true;
+            lastFlush = now;
+        }
+
+        std::unique_lock<std::mutex> lock(_mutex);
+        if (_stop)
+            break;
+        _sleeping.store(true, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (_ring.empty()) {
+            if (_textUsed > 0)
+                _wake.wait_until(lock, lastFlush + flushInterval);
+            else
+                _wake.wait(lock);
+        }
+        _sleeping.store(false, std::memory_order_relaxed);
+    }
+}
+
+bool CanFrameLogger::writeText(const CanFrame *frames, size_t count)
+{
+    for (size_t i = 0; i < count; i++) {
+        if (TextBufferSize - _textUsed < MaxLineSize + _channel.size() && !flushText()) {
+            _discarded.fetch_add(count - i, std::memory_order_relaxed);
+            return false;
+        }
+        _textUsed = size_t(putCandumpLine(_text.get() + _textUsed, frames[i], _channel) - _text.get());
+        _textFrames++;
+    }
+    return true;
+}
+
+bool CanFrameLogger::flushText()
+{
+    const char *p = _text.get();
+    size_t size = _textUsed;
+    const size_t frames = _textFrames;
+    _textUsed = 0;
+    _textFrames = 0;
+    while (size > 0) {
+        const ssize_t n = ::write(_fd, p, size);
+        if (n < 0) {
+            if (errno == EINTR)
+                continue;
+            _errorMessage = fmt::format("Cannot write frame log: {}", std::strerror(errno));
+            _discarded.fetch_add(frames, std::memory_order_relaxed);
+            return false;
+        }
+        p += n;
+        size -= size_t(n);
+    }
+    _written.fetch_add(frames, std::memory_order_relaxed);
+    return true;
+}
+
+void CanFrameLogger::countCaptured(bool ok)
+{
+    // Frames count as written once their chunk is in the file
+    const uint64_t captured = _capture.framesWritten();
+    _written.store(captured, std::memory_order_relaxed);
+    if (!ok) {
+        _discarded.fetch_add(_handed - captured, std::memory_order_relaxed);
+        _errorMessage = _capture.errorMessage();
+        _failed = true;
+    }
+}
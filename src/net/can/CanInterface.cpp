@@ -16,6 +16,7 @@
  * @date 2023-04-27
  */
 
+#include <algorithm>
 #include <string>
 #include <sstream>
 #include <chrono>
@@ -23,8 +24,10 @@
 #include <fmt/core.h>
 #include <fmt/chrono.h>
 
+#include "dplib/core/Application.h"
 #include "dplib/net/can/CanInterface.h"
 
+using namespace datapanel;
 using namespace datapanel::net::can;
 
 CanInterface::CanBusError CanInterface::error() const
@@ -61,31 +64,194 @@ size_t CanInterface::countTxPending() const
     return _txFrames.size();
 }
 
+uint64_t CanInterface::countRxDropped() const
+{
+    return _rxFrames.dropped();
+}
+
+uint64_t CanInterface::countTxDropped() const
+{
+    return _txFrames.dropped();
+}
+
 void CanInterface::enqueueRxFrames(const std::list<CanFrame> &frames)
 {
-    std::lock_guard<std::mutex> guard(_rxLock);
-    _rxFrames.insert(_rxFrames.end(), frames.begin(), frames.end());
+    const bool tapping = framesTapped.slot_count() > 0;
+    const bool filtering = softwareFiltering();
+    for (const auto &frame : frames) {
+        if (filtering && !acceptRxFrame(frame))
+            continue;
+        if (tapping) {
+            _tapped[_tappedCount] = frame;
+            if (++_tappedCount == TapBatchSize)
+                emitTapped();
+        }
+        _rxFrames.push(frame);
+    }
+
+    emitTapped();
+    framesReceived();
+}
+
+CanFrame *CanInterface::claimRxFrame()
+{
+    // Whether anything is tapping is only checked once per batch
+    if (!_rxBatchOpen) {
+        _rxBatchOpen = true;
+        _tapping = framesTapped.slot_count() > 0;
+    }
+    // Tapped frames are staged in the tap batch and copied into the queue from there,
+    // so the taps see them even when the queue is full
+    if (_tapping)
+        return &_tapped[_tappedCount];
+    // Frames that still have to pass the software filters are staged outside the
+    // queue, so a rejected frame never takes (or under DropOldest, evicts) a slot
+    if (softwareFiltering())
+        return &_rxStaged;
+    return _rxFrames.claim();
+}
+
+bool CanInterface::commitRxFrame()
+{
+    if (_tapping) {
+        const CanFrame &frame = _tapped[_tappedCount];
+        if (softwareFiltering() && !acceptRxFrame(frame))
+            return false;
+        _rxFrames.push(frame);
+        if (++_tappedCount == TapBatchSize)
+            emitTapped();
+        return true;
+    }
+    if (softwareFiltering())
+        return acceptRxFrame(_rxStaged) && _rxFrames.push(_rxStaged);
+    _rxFrames.publish();
+    return true;
+}
 
+void CanInterface::notifyRxFrames()
+{
+    emitTapped();
+    _rxBatchOpen = false;
     framesReceived();
 }
 
-void CanInterface::enqueueTxFrame(const CanFrame &frame)
+void CanInterface::emitTapped()
+{
+    if (_tappedCount == 0)
+        return;
+    const size_t count = _tappedCount;
+    framesTapped(static_cast<const CanFrame *>(_tapped), count);
+    _tappedCount = 0;
+}
+
+bool CanInterface::rxQueueFull() const
+{
+    return _rxFrames.size() >= _rxFrames.capacity();
+}
+
+bool CanInterface::acceptRxFrame(const CanFrame &frame) const
+{
+    if (frame.frameType() == CanFrame::ErrorFrame)
+        return (frame.error() & _errorFilter) != 0;
+
+    if (_rxFilters.empty())
+        return true;
+    return std::any_of(_rxFilters.begin(), _rxFilters.end(),
+                       [&frame](const CanFilter &filter) { return filter.matches(frame); });
+}
+
+bool CanInterface::setRxFilters(const std::vector<CanFilter> &filters)
+{
+    _rxFilters = filters;
+    _filtersSet = true;
+    if (_state != ConnectedState)
+        return true;
+    installRxFilters();
+    return _filtersInstalled;
+}
+
+const std::vector<CanFilter> &CanInterface::rxFilters() const
+{
+    return _rxFilters;
+}
+
+bool CanInterface::setErrorFilter(uint32_t errors)
+{
+    _errorFilter = errors & CanFrame::AnyError;
+    _filtersSet = true;
+    if (_state != ConnectedState)
+        return true;
+    installRxFilters();
+    return _filtersInstalled;
+}
+
+uint32_t CanInterface::errorFilter() const
 {
-    _txFrames.push_back(frame);
+    return _errorFilter;
+}
+
+bool CanInterface::softwareFiltering() const
+{
+    return _filtersSet && !_filtersInstalled;
+}
+
+void CanInterface::installRxFilters()
+{
+    _filtersInstalled = applyRxFilters();
+}
+
+bool CanInterface::applyRxFilters()
+{
+    return false;
+}
+
+bool CanInterface::enqueueTxFrame(const CanFrame &frame)
+{
+    return _txFrames.push(frame);
 }
 
 CanFrame CanInterface::dequeueTxFrame()
 {
-    if (_txFrames.empty())
-        return CanFrame(CanFrame::InvalidFrame);
-    return _txFrames.front();
+    CanFrame frame(CanFrame::InvalidFrame);
+    _txFrames.pop(frame);
+    return frame;
+}
+
+bool CanInterface::pendingTxFrames() const
+{
+    return !_txFrames.empty();
 }
 
 void CanInterface::setConfigOption(ConfigOption opt, const ConfigOptionValue &value)
 {
-    if (_configOptions.count(opt) > 0) {
-        _configOptions[opt] = value;
+    const bool isQueueOption =
+        (opt == CfgOptRxQueueSize) || (opt == CfgOptTxQueueSize) || (opt == CfgOptQueueOverflowPolicy);
+
+    if (isQueueOption && _state != DisconnectedState) {
+        setError(fmt::format("Cannot change {} while connected", opt), CanInterface::ConfigurationError);
+        return;
     }
+
+    _configOptions[opt] = value;
+
+    if (isQueueOption)
+        configureQueues();
+}
+
+void CanInterface::configureQueues()
+{
+    const auto intOption = [this](ConfigOption opt, int fallback) {
+        const ConfigOptionValue value = configOption(opt);
+        const int *pval = std::get_if<int>(&value);
+        return (pval && *pval > 0) ? *pval : fallback;
+    };
+
+    const auto policy = static_cast<util::OverflowPolicy>(
+        intOption(CfgOptQueueOverflowPolicy, static_cast<int>(util::OverflowPolicy::DropNewest)));
+    // The receive queue is filled and drained on the servicing thread, so it must never block
+    const auto rxPolicy = (policy == util::OverflowPolicy::Block) ? util::OverflowPolicy::DropNewest : policy;
+    _rxFrames.reset(intOption(CfgOptRxQueueSize, DefaultRxQueueSize), rxPolicy);
+    _txFrames.reset(intOption(CfgOptTxQueueSize, DefaultTxQueueSize), policy);
 }
 
 CanInterface::ConfigOptionValue CanInterface::configOption(ConfigOption opt) const
@@ -121,7 +287,6 @@ void CanInterface::flushTx()
 
 void CanInterface::flushRx()
 {
-    std::lock_guard<std::mutex> guard(_rxLock);
     _rxFrames.clear();
 }
 
@@ -134,12 +299,22 @@ CanFrame CanInterface::recv()
 
     clearError();
 
-    std::lock_guard<std::mutex> guard(_rxLock);
-    if (_rxFrames.empty()) {
-        return CanFrame(CanFrame::InvalidFrame);
+    CanFrame frame(CanFrame::InvalidFrame);
+    _rxFrames.pop(frame);
+    return frame;
+}
+
+size_t CanInterface::recv(CanFrame *frames, size_t max)
+{
+    if (_state != ConnectedState) {
+        setError("Cannot receive while interface is disconnected", CanInterface::OperationError);
+        return 0;
     }
+    clearError();
 
-    return _rxFrames.front();
+    size_t count = 0;
+    while (count < max && _rxFrames.pop(frames[count])) count++;
+    return count;
 }
 
 std::list<CanFrame> CanInterface::recvAll()
@@ -150,9 +325,9 @@ std::list<CanFrame> CanInterface::recvAll()
     }
     clearError();
 
-    std::lock_guard<std::mutex> guard(_rxLock);
     std::list<CanFrame> frames;
-    frames.swap(_rxFrames);
+    CanFrame frame;
+    while (_rxFrames.pop(frame)) frames.push_back(frame);
     return frames;
 }
 
@@ -165,10 +340,15 @@ bool CanInterface::connect()
     }
 
     setState(ConnectionPendingState);
+    _filtersInstalled = false;
+    _tappedCount = 0;
+    _rxBatchOpen = false;
     if (!open()) {
         setState(DisconnectedState);
         return false;
     }
+    if (_filtersSet && !_filtersInstalled)
+        installRxFilters();
 
     clearError();
 
@@ -185,6 +365,21 @@ void CanInterface::disconnect()
     close();
 }
 
+bool CanInterface::setEventDispatcher(core::EventDispatcher *dispatcher)
+{
+    if (_state != DisconnectedState)
+        return false;
+    _eventDispatcher = dispatcher;
+    return true;
+}
+
+core::EventDispatcher &CanInterface::eventDispatcher() const
+{
+    if (_eventDispatcher != nullptr)
+        return *_eventDispatcher;
+    return core::Application::instance().eventDispatcher();
+}
+
 CanInterface::CanConnectionState CanInterface::state() const
 {
     return _state;
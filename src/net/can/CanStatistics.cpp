@@ -0,0 +1,294 @@
+#include "dplib/net/can/CanStatistics.h"
+
+#include <algorithm>
+#include <cmath>
+#include <thread>
+
+#include "dplib/net/can/BitTiming.h"
+
+using namespace datapanel::net::can;
+
+namespace
+{
+/** DLC code of each payload length */
+constexpr uint8_t DlcCode[CanFrame::MaxPayloadSize + 1] = {
+    0,  1,  2,  3,  4,  5,  6,  7,  8,  9,  9,  9,  9,  10, 10, 10, 10, 11, 11, 11, 11, 12,
+    12, 12, 12, 13, 13, 13, 13, 13, 13, 13, 13, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14,
+    14, 14, 14, 14, 14, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15,
+};
+
+/** Add to a counter only the calling thread writes; a plain add rather than a locked one */
+template <typename T> inline void add(std::atomic<T> &counter, T value) noexcept
+{
+    counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+}
+
+template <typename T> inline T get(const std::atomic<T> &counter) noexcept
+{
+    return counter.load(std::memory_order_relaxed);
+}
+
+/** Start writing an entry guarded by @p sequence */
+inline uint32_t beginWrite(std::atomic<uint32_t> &sequence) noexcept
+{
+    const uint32_t value = sequence.load(std::memory_order_relaxed);
+    sequence.store(value + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    return value + 2;
+}
+
+inline void endWrite(std::atomic<uint32_t> &sequence, uint32_t value) noexcept
+{
+    sequence.store(value, std::memory_order_release);
+}
+
+/** Read an entry guarded by @p sequence with @p read until no write overlapped */
+template <typename Read> inline void readConsistent(const std::atomic<uint32_t> &sequence, Read read) noexcept
+{
+    while (true) {
+        const uint32_t before = sequence.load(std::memory_order_acquire);
+        if (before & 1) {
+            // The writer may have been preempted mid-update; let it finish
+            std::this_thread::yield();
+            continue;
+        }
+        read();
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (sequence.load(std::memory_order_relaxed) == before)
+            return;
+    }
+}
+}  // namespace
+
+double CanStatistics::IdStatistics::rate() const
+{
+    if (frames < 2 || lastNs <= firstNs)
+        return 0;
+    return double(frames - 1) * 1e9 / double(lastNs - firstNs);
+}
+
+double CanStatistics::IdStatistics::gapMeanNs() const
+{
+    return frames < 2 ? 0 : double(gapSumNs) / double(frames - 1);
+}
+
+uint64_t CanStatistics::IdStatistics::gapPercentileNs(double percent) const
+{
+    if (frames < 2)
+        return 0;
+    uint64_t total = 0;
+    for (const auto count : gaps) total += count;
+    const auto target = std::max<uint64_t>(1, uint64_t(std::ceil(std::clamp(percent, 0.0, 100.0) / 100 * total)));
+    uint64_t seen = 0;
+    size_t bucket = 0;
+    while (bucket < JitterBuckets - 1 && (seen += gaps[bucket]) < target) bucket++;
+    const uint64_t upperNs = (gapBucketUpperUs(bucket) + 1) * 1000 - 1;
+    return std::clamp(upperNs, gapMinNs, gapMaxNs);
+}
+
+CanStatistics::CanStatistics(size_t maxIds) : _entries(new Entry[maxIds]()), _maxIds(maxIds), _totals()
+{
+    unsigned bits = 1;
+    while ((size_t(1) << bits) < maxIds * 2) bits++;
+    _hashShift = 64 - bits;
+    _indexMask = (size_t(1) << bits) - 1;
+    _index.reset(new std::atomic<uint32_t>[_indexMask + 1]);
+    for (size_t n = 0; n <= _indexMask; n++) _index[n].store(EmptySlot, std::memory_order_relaxed);
+}
+
+void CanStatistics::process(const CanFrame *frames, size_t count) noexcept
+{
+    if (count == 0)
+        return;
+
+    uint64_t counted = 0, errors = 0, untracked = 0, bits = 0;
+    for (size_t n = 0; n < count; n++) {
+        const CanFrame &frame = frames[n];
+        if (frame.frameType() == CanFrame::ErrorFrame) {
+            errors++;
+            continue;
+        }
+        if (frame.frameType() != CanFrame::DataFrame && frame.frameType() != CanFrame::RemoteRequestFrame)
+            continue;
+        counted++;
+        bits += frameBitCount(frame);
+
+        Entry *entry = lookup(uint32_t(frame.id()) | (frame.isExtendedId() ? 0x80000000 : 0));
+        if (!entry) {
+            untracked++;
+            continue;
+        }
+        const int64_t now = frame.timestampNs();
+        const uint32_t sequence = beginWrite(entry->sequence);
+        const uint64_t seen = get(entry->frames);
+        if (seen == 0) {
+            entry->firstNs.store(now, std::memory_order_relaxed);
+        } else {
+            const uint64_t gap = uint64_t(std::max<int64_t>(0, now - get(entry->lastNs)));
+            if (seen == 1 || gap < get(entry->gapMinNs))
+                entry->gapMinNs.store(gap, std::memory_order_relaxed);
+            if (gap > get(entry->gapMaxNs))
+                entry->gapMaxNs.store(gap, std::memory_order_relaxed);
+            add(entry->gapSumNs, gap);
+            add(entry->gaps[gapBucket(gap / 1000)], 1u);
+        }
+        entry->frames.store(seen + 1, std::memory_order_relaxed);
+        entry->lastNs.store(now, std::memory_order_relaxed);
+        add(entry->dlc[DlcCode[frame.payloadSize()]], uint64_t(1));
+        endWrite(entry->sequence, sequence);
+    }
+
+    // The totals change once per batch
+    const uint32_t sequence = beginWrite(_totals.sequence);
+    if (get(_totals.frames) + get(_totals.errorFrames) == 0)
+        _totals.firstNs.store(frames[0].timestampNs(), std::memory_order_relaxed);
+    _totals.lastNs.store(frames[count - 1].timestampNs(), std::memory_order_relaxed);
+    add(_totals.frames, counted);
+    add(_totals.errorFrames, errors);
+    add(_totals.untracked, untracked);
+    add(_totals.bits, bits);
+    endWrite(_totals.sequence, sequence);
+}
+
+void CanStatistics::attach(CanInterface &source)
+{
+    detach();
+    _connection = source.framesTapped.connect([this](const CanFrame *frames, size_t count) { process(frames, count); });
+}
+
+void CanStatistics::detach()
+{
+    _connection.disconnect();
+}
+
+void CanStatistics::reset() noexcept
+{
+    const size_t used = _used.load(std::memory_order_relaxed);
+    for (size_t n = 0; n < used; n++) {
+        Entry &entry = _entries[n];
+        const uint32_t sequence = beginWrite(entry.sequence);
+        entry.frames.store(0, std::memory_order_relaxed);
+        entry.firstNs.store(0, std::memory_order_relaxed);
+        entry.lastNs.store(0, std::memory_order_relaxed);
+        entry.gapMinNs.store(0, std::memory_order_relaxed);
+        entry.gapMaxNs.store(0, std::memory_order_relaxed);
+        entry.gapSumNs.store(0, std::memory_order_relaxed);
+        for (auto &count : entry.dlc) count.store(0, std::memory_order_relaxed);
+        for (auto &count : entry.gaps) count.store(0, std::memory_order_relaxed);
+        endWrite(entry.sequence, sequence);
+    }
+
+    const uint32_t sequence = beginWrite(_totals.sequence);
+    _totals.frames.store(0, std::memory_order_relaxed);
+    _totals.errorFrames.store(0, std::memory_order_relaxed);
+    _totals.untracked.store(0, std::memory_order_relaxed);
+    _totals.bits.store(0, std::memory_order_relaxed);
+    _totals.firstNs.store(0, std::memory_order_relaxed);
+    _totals.lastNs.store(0, std::memory_order_relaxed);
+    endWrite(_totals.sequence, sequence);
+}
+
+bool CanStatistics::idStatistics(size_t index, IdStatistics &out) const noexcept
+{
+    if (index >= idCount())
+        return false;
+    read(_entries[index], out);
+    return true;
+}
+
+bool CanStatistics::find(uint32_t id, bool extendedId, IdStatistics &out) const noexcept
+{
+    const uint32_t key = id | (extendedId ? 0x80000000 : 0);
+    size_t slot = size_t((key * 0x9E3779B97F4A7C15) >> _hashShift);
+    while (true) {
+        const uint32_t entry = _index[slot].load(std::memory_order_acquire);
+        if (entry == EmptySlot)
+            return false;
+        if (get(_entries[entry].key) == key) {
+            read(_entries[entry], out);
+            return true;
+        }
+        slot = (slot + 1) & _indexMask;
+    }
+}
+
+CanStatistics::Totals CanStatistics::totals() const noexcept
+{
+    Totals out;
+    readConsistent(_totals.sequence, [&]() {
+        out.frames = get(_totals.frames);
+        out.errorFrames = get(_totals.errorFrames);
+        out.untracked = get(_totals.untracked);
+        out.bits = get(_totals.bits);
+        out.firstNs = get(_totals.firstNs);
+        out.lastNs = get(_totals.lastNs);
+    });
+    return out;
+}
+
+double CanStatistics::busLoad(const Totals &earlier, const Totals &later, uint32_t bitrate) noexcept
+{
+    const bool sinceStart = earlier.frames + earlier.errorFrames == 0;
+    const int64_t spanNs = later.lastNs - (sinceStart ? later.firstNs : earlier.lastNs);
+    if (spanNs <= 0 || bitrate == 0)
+        return 0;
+    return double(later.bits - earlier.bits) / (double(spanNs) * 1e-9 * bitrate);
+}
+
+size_t CanStatistics::gapBucket(uint64_t gapUs) noexcept
+{
+    if (gapUs < 2 * JitterSubBuckets)
+        return size_t(gapUs);
+    gapUs = std::min<uint64_t>(gapUs, 0xFFFFFFFF);
+    // Bucket by the power of two and the three bits below the top one
+    const unsigned shift = 63 - unsigned(__builtin_clzll(gapUs)) - 3;
+    return (shift + 1) * JitterSubBuckets + size_t(gapUs >> shift) - JitterSubBuckets;
+}
+
+uint64_t CanStatistics::gapBucketUpperUs(size_t bucket) noexcept
+{
+    if (bucket < 2 * JitterSubBuckets)
+        return bucket;
+    const unsigned shift = unsigned(bucket / JitterSubBuckets) - 1;
+    const uint64_t top = bucket % JitterSubBuckets + JitterSubBuckets;
+    return ((top + 1) << shift) - 1;
+}
+
+CanStatistics::Entry *CanStatistics::lookup(uint32_t key) noexcept
+{
+    size_t slot = size_t((key * 0x9E3779B97F4A7C15) >> _hashShift);
+    while (true) {
+        const uint32_t entry = _index[slot].load(std::memory_order_relaxed);
+        if (entry == EmptySlot)
+            break;
+        if (get(_entries[entry].key) == key)
+            return &_entries[entry];
+        slot = (slot + 1) & _indexMask;
+    }
+
+    const size_t used = _used.load(std::memory_order_relaxed);
+    if (used == _maxIds)
+        return nullptr;
+    _entries[used].key.store(key, std::memory_order_relaxed);
+    // Publish the key before the index slot and the count that lead readers to it
+    _index[slot].store(uint32_t(used), std::memory_order_release);
+    _used.store(used + 1, std::memory_order_release);
+    return &_entries[used];
+}
+
+void CanStatistics::read(const Entry &entry, IdStatistics &out) noexcept
+{
+    const uint32_t key = get(entry.key);
+    out.id = key & 0x7FFFFFFF;
+    out.extendedId = key & 0x80000000;
+    readConsistent(entry.sequence, [&]() {
+        out.frames = get(entry.frames);
+        out.firstNs = get(entry.firstNs);
+        out.lastNs = get(entry.lastNs);
+        out.gapMinNs = get(entry.gapMinNs);
+        out.gapMaxNs = get(entry.gapMaxNs);
+        out.gapSumNs = get(entry.gapSumNs);
+        for (size_t n = 0; n < out.dlc.size(); n++) out.dlc[n] = get(entry.dlc[n]);
+        for (size_t n = 0; n < out.gaps.size(); n++) out.gaps[n] = get(entry.gaps[n]);
+    });
+}
@@ -0,0 +1,488 @@
+/**
+ * Copyright (c) 2026 Data Panel Corporation
+ * 181 Cheshire Ln, Suite 300
+ * Plymouth, MN 55441
+ * All rights reserved.
+ *
+ * This is the confidential and proprietary information of Data Panel
+ * Corporation. Such confidential information shall not be disclosed and is for
+ * use only in accordance with the license agreement you entered into with Data
+ * Panel.
+ */
+
+/**
+ * @file ReplayBackend.cpp
+ * @date 2026-10-16
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <limits>
+#include <sstream>
+
+#include <fmt/format.h>
+
+#include "dplib/net/can/ReplayBackend.h"
+
+#include "dplib/core/EventDispatcher.h"
+#include "dplib/net/can/CanCapture.h"
+#include "dplib/net/can/CanFrameCodec.h"
+
+#include <errno.h>
+#include <linux/can.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+using namespace datapanel;
+using namespace datapanel::core;
+using namespace datapanel::net::can;
+
+namespace datapanel
+{
+namespace net
+{
+namespace can
+{
+
+/**
+ * @brief Sequential frame reader for one capture format
+ */
+class ReplaySource
+{
+  public:
+    virtual ~ReplaySource() = default;
+
+    /**
+     * @return false at the end of the file
+     */
+    virtual bool next(CanFrame &frame) = 0;
+
+    /**
+     * @brief Go back to the first frame
+     */
+    virtual void rewind() = 0;
+};
+
+}  // namespace can
+}  // namespace net
+}  // namespace datapanel
+
+namespace
+{
+/** Native capture written by CanCaptureWriter */
+class CaptureSource : public ReplaySource
+{
+  public:
+    bool open(const std::string &path, std::string &error)
+    {
+        if (!_reader.open(path)) {
+            error = _reader.errorMessage();
+            return false;
+        }
+        return true;
+    }
+
+    bool next(CanFrame &frame) override
+    {
+        return _reader.next(frame);
+    }
+
+    void rewind() override
+    {
+        _reader.seek(std::numeric_limits<int64_t>::min());
+    }
+
+  private:
+    CanCaptureReader _reader;
+};
+
+/** `candump -l` log; lines that are not frames are skipped */
+class CandumpSource : public ReplaySource
+{
+  public:
+    bool open(const std::string &path, std::string &error)
+    {
+        _file.open(path);
+        if (!_file) {
+            error = fmt::format("Cannot open {}: {}", path, std::strerror(errno));
+            return false;
+        }
+        return true;
+    }
+
+    bool next(CanFrame &frame) override
+    {
+        while (std::getline(_file, _line)) {
+            if (ReplayBackend::parseCandumpLine(_line, frame))
+                return true;
+        }
+        return false;
+    }
+
+    void rewind() override
+    {
+        _file.clear();
+        _file.seekg(0);
+    }
+
+  private:
+    std::ifstream _file;
+    std::string _line;
+};
+
+int hexDigit(char c)
+{
+    if (c >= '0' && c <= '9')
+        return c - '0';
+    if (c >= 'A' && c <= 'F')
+        return c - 'A' + 10;
+    if (c >= 'a' && c <= 'f')
+        return c - 'a' + 10;
+    return -1;
+}
+
+bool isCaptureFile(const std::string &path)
+{
+    char magic[5] = {};
+    std::ifstream file(path, std::ios::binary);
+    return file.read(magic, sizeof(magic)) && std::memcmp(magic, "DPCAP", sizeof(magic)) == 0;
+}
+}  // namespace
+
+ReplayBackend::ReplayBackend(const std::string &channel) : _path(channel), _inbox(DefaultRxQueueSize)
+{
+}
+
+ReplayBackend::~ReplayBackend()
+{
+    close();
+}
+
+std::unique_ptr<CanInterface> ReplayBackend::init(const std::string &channel)
+{
+    return std::unique_ptr<ReplayBackend>(new ReplayBackend(channel));
+}
+
+std::list<CanInterfaceInfo> ReplayBackend::availableChannels()
+{
+    // Any capture file is a channel
+    return {};
+}
+
+bool ReplayBackend::parseOptions()
+{
+    _speed = 1.0;
+    _loop = false;
+
+    const ConfigOptionValue other = configOption(CfgOptOther);
+    const std::string *poptions = std::get_if<std::string>(&other);
+    if (poptions == nullptr)
+        return true;
+
+    std::istringstream options(*poptions);
+    std::string option;
+    while (std::getline(options, option, ',')) {
+        if (option.empty())
+            continue;
+        if (option == "loop") {
+            _loop = true;
+        } else if (option == "speed=max") {
+            _speed = 0;
+        } else if (option.compare(0, 6, "speed=") == 0) {
+            char *end = nullptr;
+            _speed = std::strtod(option.c_str() + 6, &end);
+            if (*end != '\0' || !(_speed > 0)) {
+                setError(fmt::format("Invalid replay speed: {}", option), CanInterface::ConfigurationError);
+                return false;
+            }
+        } else {
+            setError(fmt::format("Unknown replay option: {}", option), CanInterface::ConfigurationError);
+            return false;
+        }
+    }
+    return true;
+}
+
+bool ReplayBackend::open()
+{
+    if (_source)
+        return false;  // already opened
+
+    if (!parseOptions())
+        return false;
+
+    std::string error;
+    if (isCaptureFile(_path)) {
+        auto source = std::make_unique<CaptureSource>();
+        if (source->open(_path, error))
+            _source = std::move(source);
+    } else {
+        auto source = std::make_unique<CandumpSource>();
+        if (source->open(_path, error))
+            _source = std::move(source);
+    }
+    if (!_source) {
+        setError(error, CanInterface::CanBusError::ConnectionError);
+        return false;
+    }
+
+    _eventFd = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (_eventFd < 0) {
+        setError(fmt::format("Could not create eventfd: {}", ::strerror(errno)),
+                 CanInterface::CanBusError::ConnectionError);
+        _source.reset();
+        return false;
+    }
+
+    const ConfigOptionValue queueSize = configOption(CfgOptRxQueueSize);
+    const int *pqueueSize = std::get_if<int>(&queueSize);
+    _inbox.reset((pqueueSize && *pqueueSize > 0) ? *pqueueSize : DefaultRxQueueSize, util::OverflowPolicy::DropNewest);
+    _signalled = false;
+    _waitingForSpace = false;
+    _finished = false;
+    _finishedReported = false;
+    _stats = PacingStatistics();
+    _totalErrorNs = 0;
+    _stopPacer = false;
+
+    setState(CanInterface::ConnectedState);
+
+    eventDispatcher().addFile(_eventFd, EventDispatcher::FileOperation::Read,
+                              std::bind(&ReplayBackend::readInbox, this));
+    _pacer = std::thread(&ReplayBackend::runPacer, this);
+    return true;
+}
+
+bool ReplayBackend::close()
+{
+    if (_pacer.joinable()) {
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _stopPacer = true;
+        }
+        _wake.notify_all();
+        _pacer.join();
+    }
+    if (_eventFd != -1) {
+        eventDispatcher().removeFile(_eventFd, EventDispatcher::FileOperation::Read);
+        ::close(_eventFd);
+        _eventFd = -1;
+    }
+    if (_retryTimer >= 0) {
+        eventDispatcher().removeTimer(_retryTimer);
+        _retryTimer = -1;
+    }
+    _source.reset();
+    setState(CanInterface::DisconnectedState);
+    return true;
+}
+
+bool ReplayBackend::send(const CanFrame &)
+{
+    setError("Replay channels are receive-only", CanInterface::OperationError);
+    return false;
+}
+
+ReplayBackend::PacingStatistics ReplayBackend::pacingStatistics() const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    PacingStatistics stats = _stats;
+    stats.meanErrorNs = stats.frames > 0 ? _totalErrorNs / int64_t(stats.frames) : 0;
+    return stats;
+}
+
+void ReplayBackend::runPacer()
+{
+    using Clock = std::chrono::steady_clock;
+
+    std::unique_lock<std::mutex> lock(_mutex);
+    Clock::time_point baseTime = Clock::now(); /**< When the frame stamped baseNs is due */
+    Clock::time_point lastDue = baseTime;
+    int64_t baseNs = 0;
+    bool startPass = true;
+    uint64_t passFrames = 0;
+    CanFrame frame;
+
+    while (!_stopPacer) {
+        if (!_source->next(frame)) {
+            _stats.loops++;
+            if (!_loop || passFrames == 0)
+                break;
+            _source->rewind();
+            startPass = true;
+            passFrames = 0;
+            continue;
+        }
+        passFrames++;
+
+        if (_speed > 0) {
+            // Each pass starts where the previous one ended
+            if (startPass) {
+                baseTime = lastDue;
+                baseNs = frame.timestampNs();
+            }
+            const auto offset = std::chrono::nanoseconds(int64_t(double(frame.timestampNs() - baseNs) / _speed));
+            const Clock::time_point due = baseTime + offset;
+            if (_wake.wait_until(lock, due, [this]() { return _stopPacer; }))
+                break;
+
+            const int64_t error = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - due).count();
+            _totalErrorNs += error;
+            _stats.maxErrorNs = std::max(_stats.maxErrorNs, error);
+            if (error > LateThresholdNs)
+                _stats.lateFrames++;
+            lastDue = due;
+        }
+        startPass = false;
+
+        // Hold the frame until the dispatcher makes room
+        if (_inbox.size() >= _inbox.capacity()) {
+            _waitingForSpace = true;
+            _wake.wait(lock, [this]() { return _stopPacer || _inbox.size() < _inbox.capacity(); });
+            if (_stopPacer)
+                break;
+        }
+        _inbox.push(frame);
+        _stats.frames++;
+
+        if (!_signalled.exchange(true)) {
+            const uint64_t one = 1;
+            [[maybe_unused]] ssize_t written = ::write(_eventFd, &one, sizeof(one));
+        }
+    }
+
+    if (!_stopPacer) {
+        _finished = true;
+        const uint64_t one = 1;
+        [[maybe_unused]] ssize_t written = ::write(_eventFd, &one, sizeof(one));
+    }
+}
+
+void ReplayBackend::readInbox()
+{
+    uint64_t value;
+    [[maybe_unused]] ssize_t bytesRead = ::read(_eventFd, &value, sizeof(value));
+    _signalled.store(false, std::memory_order_seq_cst);
+
+    bool received = false;
+    bool full = false;
+    while (!_inbox.empty()) {
+        if (rxQueueFull()) {
+            full = true;
+            break;
+        }
+        // Pop straight into the receive queue
+        CanFrame *frame = claimRxFrame();
+        _inbox.pop(*frame);
+        received |= commitRxFrame();
+    }
+
+    if (_waitingForSpace.exchange(false)) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _wake.notify_all();
+    }
+
+    if (received)
+        notifyRxFrames();
+
+    if (full && _retryTimer < 0) {
+        _retryTimer = eventDispatcher().addTimer(RetryMs, [this]() {
+            eventDispatcher().removeTimer(_retryTimer);
+            _retryTimer = -1;
+            readInbox();
+        });
+    }
+
+    if (!full && _finished && _inbox.empty() && !_finishedReported) {
+        _finishedReported = true;
+        replayFinished();
+    }
+}
+
+bool ReplayBackend::parseCandumpLine(const std::string &line, CanFrame &frame)
+{
+    const char *p = line.c_str();
+
+    // (seconds.fraction)
+    if (*p++ != '(')
+        return false;
+    int64_t seconds = 0, fraction = 0, scale = 1000000000;
+    for (; *p >= '0' && *p <= '9'; p++) seconds = seconds * 10 + (*p - '0');
+    if (*p == '.') {
+        for (p++; *p >= '0' && *p <= '9'; p++) {
+            if (scale > 1) {
+                scale /= 10;
+                fraction += (*p - '0') * scale;
+            }
+        }
+    }
+    if (*p++ != ')')
+        return false;
+
+    // Interface name
+    while (*p == ' ') p++;
+    while (*p != ' ' && *p != '\0') p++;
+    while (*p == ' ') p++;
+
+    // Identifier: three hex digits for standard, eight for extended and error frames
+    const char *idStart = p;
+    uint32_t id = 0;
+    for (int digit; (digit = hexDigit(*p)) >= 0; p++) id = (id << 4) | uint32_t(digit);
+    const size_t idDigits = size_t(p - idStart);
+    if (*p++ != '#')
+        return false;
+
+    canfd_frame raw{};
+    if (idDigits == 3) {
+        raw.can_id = id & CAN_SFF_MASK;
+    } else if (idDigits == 8) {
+        raw.can_id = (id & CAN_ERR_FLAG) ? (id & (CAN_ERR_FLAG | CAN_ERR_MASK)) : ((id & CAN_EFF_MASK) | CAN_EFF_FLAG);
+    } else {
+        return false;
+    }
+
+    bool fd = false;
+    size_t maxLength = CAN_MAX_DLEN;
+    if (*p == '#') {
+        // FD frame: flags nibble, then data
+        const int flags = hexDigit(p[1]);
+        if (flags < 0)
+            return false;
+        raw.flags = uint8_t(flags);
+        fd = true;
+        maxLength = CANFD_MAX_DLEN;
+        p += 2;
+    } else if (*p == 'R' || *p == 'r') {
+        raw.can_id |= CAN_RTR_FLAG;
+        p++;
+        if (*p >= '0' && *p <= '8')
+            raw.len = uint8_t(*p++ - '0');
+    }
+
+    if (!(raw.can_id & CAN_RTR_FLAG)) {
+        while (*p != ' ' && *p != '\0') {
+            if (*p == '.') {
+                p++;
+                continue;
+            }
+            const int high = hexDigit(p[0]);
+            const int low = high < 0 ? -1 : hexDigit(p[1]);
+            if (low < 0 || raw.len == maxLength)
+                return false;
+            raw.data[raw.len++] = uint8_t((high << 4) | low);
+            p += 2;
+        }
+    }
+
+    // Optional direction marker
+    while (*p == ' ') p++;
+    const bool transmitted = *p == 'T';
+
+    CanFrameCodec::decode(raw, fd, frame);
+    frame.setTimestampNs(seconds * 1000000000 + fraction);
+    frame.setLocalEcho(transmitted);
+    return true;
+}
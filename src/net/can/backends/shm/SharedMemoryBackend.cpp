@@ -0,0 +1,615 @@
+/**
+ * Copyright (c) 2026 Data Panel Corporation
+ * 181 Cheshire Ln, Suite 300
+ * Plymouth, MN 55441
+ * All rights reserved.
+ *
+ * This is the confidential and proprietary information of Data Panel
+ * Corporation. Such confidential information shall not be disclosed and is for
+ * use only in accordance with the license agreement you entered into with Data
+ * Panel.
+ */
+
+/**
+ * @file SharedMemoryBackend.cpp
+ * @date 2026-10-16
+ */
+
+#include <algorithm>
+#include <climits>
+#include <cstring>
+#include <filesystem>
+#include <functional>
+#include <new>
+
+#include <fmt/format.h>
+
+#include "dplib/net/can/SharedMemoryBackend.h"
+
+#include "dplib/core/EventDispatcher.h"
+#include "dplib/util/SpscRing.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <linux/futex.h>
+#include <signal.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+using namespace datapanel;
+using namespace datapanel::core;
+using namespace datapanel::net::can;
+
+namespace datapanel
+{
+namespace net
+{
+namespace can
+{
+
+/*
+ * Segment layout: a read-write control area (ShmHeader, padded to a page)
+ * followed by the frame ring (capacity ShmSlots), which readers map
+ * read-only.  Everything shared is a lock-free atomic or is written once
+ * before the magic number is published.
+ */
+
+enum ShmReaderState : uint32_t {
+    ReaderFree,
+    ReaderAttaching,
+    ReaderLossy,
+    ReaderLossless,
+};
+
+/** Per-reader state, written by the reader and read by the publisher */
+struct alignas(util::CacheLineSize) ShmReader {
+    std::atomic<uint32_t> state;    /**< ShmReaderState */
+    std::atomic<int32_t> pid;       /**< Process owning the entry */
+    std::atomic<uint32_t> wake;     /**< Futex word the reader sleeps on */
+    std::atomic<uint32_t> sleeping; /**< Set while the reader may be waiting on wake */
+    std::atomic<uint64_t> cursor;   /**< Index of the next frame the reader will consume */
+};
+
+struct ShmHeader {
+    std::atomic<uint32_t> magic; /**< Stored last, once the segment is initialized */
+    uint32_t version;
+    uint32_t slotSize;
+    uint32_t capacity;
+    uint64_t dataOffset;
+    int32_t publisherPid;
+    std::atomic<uint32_t> closed;
+    std::atomic<uint32_t> readerGeneration; /**< Changed whenever a reader attaches or detaches */
+
+    alignas(util::CacheLineSize) std::atomic<uint64_t> head; /**< Number of frames published */
+    std::atomic<uint64_t> dropped;                           /**< Frames held back by lossless readers */
+    std::atomic<uint32_t> sleepers;                          /**< Number of readers with sleeping set */
+
+    ShmReader readers[SharedMemoryPublisher::MaxReaders];
+};
+
+/** Ring entry, guarded like a seqlock */
+struct ShmSlot {
+    std::atomic<uint64_t> seq; /**< Index + 1 of the frame in the slot, or 0 while it is written */
+    CanFrame frame;
+};
+
+static_assert(std::atomic<uint32_t>::is_always_lock_free && std::atomic<uint64_t>::is_always_lock_free,
+              "Shared-memory atomics must be lock-free");
+
+}  // namespace can
+}  // namespace net
+}  // namespace datapanel
+
+namespace
+{
+constexpr uint32_t ShmMagic = 0x4E414344;  // "DCAN"
+constexpr uint32_t ShmVersion = 1;
+constexpr const char *ShmPrefix = "dplib-can-";
+
+std::string shmPath(const std::string &name)
+{
+    return fmt::format("/{}{}", ShmPrefix, name);
+}
+
+size_t controlSize()
+{
+    const size_t page = static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+    return (sizeof(ShmHeader) + page - 1) / page * page;
+}
+
+bool processAlive(int32_t pid)
+{
+    return pid > 0 && (::kill(pid, 0) == 0 || errno == EPERM);
+}
+
+// Not FUTEX_PRIVATE_FLAG: the word is shared between processes
+void futexWait(std::atomic<uint32_t> &word, uint32_t expected)
+{
+    ::syscall(SYS_futex, reinterpret_cast<uint32_t *>(&word), FUTEX_WAIT, expected, nullptr, nullptr, 0);
+}
+
+void futexWake(std::atomic<uint32_t> &word)
+{
+    ::syscall(SYS_futex, reinterpret_cast<uint32_t *>(&word), FUTEX_WAKE, INT_MAX, nullptr, nullptr, 0);
+}
+
+void wakeReader(ShmReader &reader)
+{
+    reader.wake.fetch_add(1, std::memory_order_release);
+    futexWake(reader.wake);
+}
+}  // namespace
+
+SharedMemoryPublisher::SharedMemoryPublisher(std::string name, size_t capacity) : _name(std::move(name))
+{
+    _capacity = 2;
+    while (_capacity < capacity) _capacity <<= 1;
+}
+
+SharedMemoryPublisher::~SharedMemoryPublisher()
+{
+    close();
+}
+
+bool SharedMemoryPublisher::open()
+{
+    if (_header != nullptr) {
+        _errorMessage = "Already open";
+        return false;
+    }
+
+    const std::string path = shmPath(_name);
+    const size_t dataOffset = controlSize();
+
+    // Replace a segment left behind by a publisher that did not close() it
+    int stale = ::shm_open(path.c_str(), O_RDONLY, 0);
+    if (stale >= 0) {
+        struct stat st;
+        void *mem = MAP_FAILED;
+        if (::fstat(stale, &st) == 0 && static_cast<size_t>(st.st_size) >= sizeof(ShmHeader))
+            mem = ::mmap(nullptr, sizeof(ShmHeader), PROT_READ, MAP_SHARED, stale, 0);
+        ::close(stale);
+        if (mem != MAP_FAILED) {
+            const auto *old = static_cast<const ShmHeader *>(mem);
+            const bool live = old->magic.load(std::memory_order_acquire) == ShmMagic &&
+                              !old->closed.load(std::memory_order_acquire) && processAlive(old->publisherPid);
+            const int32_t pid = old->publisherPid;
+            ::munmap(mem, sizeof(ShmHeader));
+            if (live) {
+                _errorMessage = fmt::format("Channel {} is already published by process {}", _name, pid);
+                return false;
+            }
+        }
+        ::shm_unlink(path.c_str());
+    }
+
+    _fd = ::shm_open(path.c_str(), O_RDWR | O_CREAT | O_EXCL | O_CLOEXEC, 0660);
+    if (_fd < 0) {
+        _errorMessage = fmt::format("Could not create {}: {}", path, ::strerror(errno));
+        return false;
+    }
+
+    _mapSize = dataOffset + _capacity * sizeof(ShmSlot);
+    void *mem = MAP_FAILED;
+    if (::ftruncate(_fd, static_cast<off_t>(_mapSize)) == 0)
+        mem = ::mmap(nullptr, _mapSize, PROT_READ | PROT_WRITE, MAP_SHARED, _fd, 0);
+    if (mem == MAP_FAILED) {
+        _errorMessage = fmt::format("Could not map {}: {}", path, ::strerror(errno));
+        ::close(_fd);
+        _fd = -1;
+        ::shm_unlink(path.c_str());
+        return false;
+    }
+
+    // The new segment is zero-filled, which is a valid initial state for every slot
+    _header = new (mem) ShmHeader();
+    _header->version = ShmVersion;
+    _header->slotSize = sizeof(ShmSlot);
+    _header->capacity = static_cast<uint32_t>(_capacity);
+    _header->dataOffset = dataOffset;
+    _header->publisherPid = ::getpid();
+    _slots = reinterpret_cast<ShmSlot *>(static_cast<char *>(mem) + dataOffset);
+    _header->magic.store(ShmMagic, std::memory_order_release);
+
+    _head = 0;
+    _minCursor = UINT64_MAX;
+    _readerGeneration = 0;
+    _errorMessage.clear();
+    return true;
+}
+
+void SharedMemoryPublisher::close()
+{
+    detach();
+    if (_header == nullptr)
+        return;
+
+    _header->closed.store(1, std::memory_order_seq_cst);
+    for (ShmReader &reader : _header->readers) wakeReader(reader);
+
+    ::munmap(_header, _mapSize);
+    ::close(_fd);
+    ::shm_unlink(shmPath(_name).c_str());
+    _header = nullptr;
+    _slots = nullptr;
+    _fd = -1;
+}
+
+uint64_t SharedMemoryPublisher::minLosslessCursor()
+{
+    _readerGeneration = _header->readerGeneration.load(std::memory_order_acquire);
+
+    uint64_t lowest = UINT64_MAX;
+    for (ShmReader &reader : _header->readers) {
+        if (reader.state.load(std::memory_order_acquire) != ReaderLossless)
+            continue;
+
+        const uint64_t cursor = reader.cursor.load(std::memory_order_acquire);
+        // Only a reader holding back the whole ring is worth a liveness check
+        if (_head - cursor >= _capacity && !processAlive(reader.pid.load(std::memory_order_relaxed))) {
+            uint32_t expected = ReaderLossless;
+            reader.state.compare_exchange_strong(expected, ReaderFree, std::memory_order_acq_rel);
+            continue;
+        }
+        lowest = std::min(lowest, cursor);
+    }
+    return lowest;
+}
+
+size_t SharedMemoryPublisher::publish(const CanFrame *frames, size_t count)
+{
+    if (_header == nullptr || count == 0)
+        return 0;
+
+    // _minCursor only grows stale in the safe direction: reader cursors never move backwards
+    const bool readersChanged = _header->readerGeneration.load(std::memory_order_acquire) != _readerGeneration;
+    if (readersChanged || (_minCursor != UINT64_MAX && _head + count - _minCursor > _capacity))
+        _minCursor = minLosslessCursor();
+
+    size_t n = count;
+    if (_minCursor != UINT64_MAX)
+        n = std::min<uint64_t>(count, _capacity - (_head - _minCursor));
+
+    const uint64_t mask = _capacity - 1;
+    for (size_t i = 0; i < n; i++) {
+        ShmSlot &slot = _slots[(_head + i) & mask];
+        slot.seq.store(0, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        slot.frame = frames[i];
+        slot.seq.store(_head + i + 1, std::memory_order_release);
+    }
+
+    if (n < count)
+        _header->dropped.fetch_add(count - n, std::memory_order_relaxed);
+    if (n == 0)
+        return 0;
+
+    _head += n;
+    _header->head.store(_head, std::memory_order_seq_cst);
+
+    // Pairs with the reader setting sleeping before it re-checks head
+    if (_header->sleepers.load(std::memory_order_seq_cst) != 0) {
+        for (ShmReader &reader : _header->readers) {
+            if (reader.sleeping.load(std::memory_order_relaxed))
+                wakeReader(reader);
+        }
+    }
+    return n;
+}
+
+void SharedMemoryPublisher::attach(CanInterface &source)
+{
+    detach();
+    _connection = source.framesTapped.connect([this](const CanFrame *frames, size_t count) { publish(frames, count); });
+}
+
+void SharedMemoryPublisher::detach()
+{
+    _connection.disconnect();
+}
+
+uint64_t SharedMemoryPublisher::published() const
+{
+    return _header != nullptr ? _head : 0;
+}
+
+uint64_t SharedMemoryPublisher::dropped() const
+{
+    return _header != nullptr ? _header->dropped.load(std::memory_order_relaxed) : 0;
+}
+
+SharedMemoryBackend::~SharedMemoryBackend()
+{
+    close();
+}
+
+std::unique_ptr<CanInterface> SharedMemoryBackend::init(const std::string &channel)
+{
+    return std::unique_ptr<SharedMemoryBackend>(new SharedMemoryBackend(channel));
+}
+
+std::list<CanInterfaceInfo> SharedMemoryBackend::availableChannels()
+{
+    std::list<CanInterfaceInfo> channels;
+    const std::string_view prefix(ShmPrefix);
+
+    std::error_code ec;
+    for (const auto &entry : std::filesystem::directory_iterator("/dev/shm", ec)) {
+        const std::string file = entry.path().filename();
+        if (file.compare(0, prefix.size(), prefix) != 0)
+            continue;
+
+        CanInterfaceInfo info;
+        info.plugin = "SharedMemory";
+        info.name = file.substr(prefix.size());
+        info.description = "Shared-memory frame bus";
+        info.supportsFD = true;
+        info.currentBitrate = 0;
+        channels.push_back(info);
+    }
+    return channels;
+}
+
+bool SharedMemoryBackend::open()
+{
+    if (_fd != -1)
+        return false;  // already opened
+
+    _fd = ::shm_open(shmPath(_name).c_str(), O_RDWR | O_CLOEXEC, 0);
+    if (_fd < 0) {
+        setError(fmt::format("Could not open channel {}: {}", _name, ::strerror(errno)),
+                 CanInterface::CanBusError::ConnectionError);
+        return false;
+    }
+
+    struct stat st;
+    _controlSize = controlSize();
+    if (::fstat(_fd, &st) < 0 || static_cast<size_t>(st.st_size) < _controlSize) {
+        setError(fmt::format("Channel {} is not ready", _name), CanInterface::CanBusError::ConnectionError);
+        unmap();
+        return false;
+    }
+
+    void *control = ::mmap(nullptr, _controlSize, PROT_READ | PROT_WRITE, MAP_SHARED, _fd, 0);
+    if (control == MAP_FAILED) {
+        setError(fmt::format("Could not map channel {}: {}", _name, ::strerror(errno)),
+                 CanInterface::CanBusError::ConnectionError);
+        unmap();
+        return false;
+    }
+    _header = static_cast<ShmHeader *>(control);
+
+    const uint32_t capacity = _header->capacity;
+    const bool compatible = _header->magic.load(std::memory_order_acquire) == ShmMagic &&
+                            _header->version == ShmVersion && _header->slotSize == sizeof(ShmSlot) &&
+                            _header->dataOffset == _controlSize && capacity != 0 && (capacity & (capacity - 1)) == 0 &&
+                            static_cast<size_t>(st.st_size) >= _controlSize + capacity * sizeof(ShmSlot);
+    if (!compatible) {
+        setError(fmt::format("Channel {} is not a compatible frame bus", _name),
+                 CanInterface::CanBusError::ConnectionError);
+        unmap();
+        return false;
+    }
+    if (_header->closed.load(std::memory_order_acquire)) {
+        setError(fmt::format("Channel {} was closed by its publisher", _name),
+                 CanInterface::CanBusError::ConnectionError);
+        unmap();
+        return false;
+    }
+
+    _dataSize = capacity * sizeof(ShmSlot);
+    void *data = ::mmap(nullptr, _dataSize, PROT_READ, MAP_SHARED, _fd, static_cast<off_t>(_controlSize));
+    if (data == MAP_FAILED) {
+        _dataSize = 0;
+        setError(fmt::format("Could not map channel {}: {}", _name, ::strerror(errno)),
+                 CanInterface::CanBusError::ConnectionError);
+        unmap();
+        return false;
+    }
+    _slots = static_cast<const ShmSlot *>(data);
+
+    const ConfigOptionValue mode = configOption(CfgOptOther);
+    const std::string *pmode = std::get_if<std::string>(&mode);
+    if (!attachReader(pmode != nullptr && *pmode == LosslessOption)) {
+        setError(fmt::format("All {} readers of channel {} are in use", SharedMemoryPublisher::MaxReaders, _name),
+                 CanInterface::CanBusError::ConnectionError);
+        unmap();
+        return false;
+    }
+
+    _eventFd = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (_eventFd < 0) {
+        setError(fmt::format("Could not create eventfd: {}", ::strerror(errno)),
+                 CanInterface::CanBusError::ConnectionError);
+        unmap();
+        return false;
+    }
+
+    _closedReported = false;
+    _notified = false;
+    _stopWaiter = false;
+
+    setState(CanInterface::ConnectedState);
+
+    eventDispatcher().addFile(_eventFd, EventDispatcher::FileOperation::Read,
+                              std::bind(&SharedMemoryBackend::readRing, this));
+    _waiter = std::thread(&SharedMemoryBackend::waitForFrames, this);
+
+    return true;
+}
+
+bool SharedMemoryBackend::close()
+{
+    if (_waiter.joinable()) {
+        _stopWaiter = true;
+        wakeReader(_header->readers[_reader]);
+        _waiter.join();
+    }
+    if (_eventFd != -1) {
+        eventDispatcher().removeFile(_eventFd, EventDispatcher::FileOperation::Read);
+        ::close(_eventFd);
+        _eventFd = -1;
+    }
+    if (_retryTimer >= 0) {
+        eventDispatcher().removeTimer(_retryTimer);
+        _retryTimer = -1;
+    }
+    unmap();
+    setState(CanInterface::DisconnectedState);
+    return true;
+}
+
+bool SharedMemoryBackend::send(const CanFrame &)
+{
+    setError("Shared-memory channels are receive-only", CanInterface::OperationError);
+    return false;
+}
+
+bool SharedMemoryBackend::attachReader(bool lossless)
+{
+    for (size_t i = 0; i < SharedMemoryPublisher::MaxReaders; i++) {
+        ShmReader &reader = _header->readers[i];
+
+        uint32_t expected = ReaderFree;
+        bool claimed = reader.state.compare_exchange_strong(expected, ReaderAttaching, std::memory_order_acq_rel);
+        if (!claimed && (expected == ReaderLossy || expected == ReaderLossless) &&
+            !processAlive(reader.pid.load(std::memory_order_relaxed))) {
+            // Left behind by a reader that exited without disconnecting
+            claimed = reader.state.compare_exchange_strong(expected, ReaderAttaching, std::memory_order_acq_rel);
+        }
+        if (!claimed)
+            continue;
+
+        reader.pid.store(::getpid(), std::memory_order_relaxed);
+        reader.sleeping.store(0, std::memory_order_relaxed);
+        _cursor = _header->head.load(std::memory_order_acquire);
+        reader.cursor.store(_cursor, std::memory_order_release);
+        reader.state.store(lossless ? ReaderLossless : ReaderLossy, std::memory_order_release);
+        _header->readerGeneration.fetch_add(1, std::memory_order_acq_rel);
+
+        _reader = static_cast<int>(i);
+        _lossless = lossless;
+        _lost = 0;
+        return true;
+    }
+    return false;
+}
+
+void SharedMemoryBackend::unmap()
+{
+    if (_header != nullptr && _reader >= 0) {
+        _header->readers[_reader].state.store(ReaderFree, std::memory_order_release);
+        _header->readerGeneration.fetch_add(1, std::memory_order_acq_rel);
+    }
+    _reader = -1;
+
+    if (_slots != nullptr)
+        ::munmap(const_cast<ShmSlot *>(_slots), _dataSize);
+    if (_header != nullptr)
+        ::munmap(_header, _controlSize);
+    if (_fd != -1)
+        ::close(_fd);
+    _slots = nullptr;
+    _header = nullptr;
+    _fd = -1;
+}
+
+void SharedMemoryBackend::waitForFrames()
+{
+    ShmReader &reader = _header->readers[_reader];
+    uint64_t seen = _cursor;
+
+    while (!_stopWaiter.load(std::memory_order_acquire)) {
+        const uint32_t wake = reader.wake.load(std::memory_order_acquire);
+        reader.sleeping.store(1, std::memory_order_seq_cst);
+        _header->sleepers.fetch_add(1, std::memory_order_seq_cst);
+        if (_header->head.load(std::memory_order_seq_cst) == seen && !_header->closed.load(std::memory_order_acquire) &&
+            !_stopWaiter.load(std::memory_order_acquire))
+            futexWait(reader.wake, wake);
+        _header->sleepers.fetch_sub(1, std::memory_order_seq_cst);
+        reader.sleeping.store(0, std::memory_order_relaxed);
+
+        const uint64_t head = _header->head.load(std::memory_order_acquire);
+        const bool closed = _header->closed.load(std::memory_order_acquire);
+        if (head != seen || closed) {
+            seen = head;
+            // One eventfd write per batch the dispatcher has not started reading yet
+            if (!_notified.exchange(true)) {
+                const uint64_t one = 1;
+                [[maybe_unused]] ssize_t written = ::write(_eventFd, &one, sizeof(one));
+            }
+        }
+        if (closed)
+            break;
+    }
+}
+
+void SharedMemoryBackend::readRing()
+{
+    uint64_t value;
+    [[maybe_unused]] ssize_t bytesRead = ::read(_eventFd, &value, sizeof(value));
+    _notified.store(false, std::memory_order_seq_cst);
+
+    const uint64_t capacity = _header->capacity;
+    const uint64_t mask = capacity - 1;
+    uint64_t head = _header->head.load(std::memory_order_acquire);
+    bool received = false;
+    bool full = false;
+
+    while (_cursor != head) {
+        if (head - _cursor > capacity) {
+            // Fell a ring behind; resume half a ring back so the publisher does not lap us again at once
+            const uint64_t resume = head - capacity / 2;
+            _lost += resume - _cursor;
+            _cursor = resume;
+        }
+
+        if (_lossless && rxQueueFull()) {
+            full = true;
+            break;
+        }
+        CanFrame *frame = claimRxFrame();
+        if (frame == nullptr) {
+            _cursor++;  // Counted by countRxDropped()
+            continue;
+        }
+
+        const ShmSlot &slot = _slots[_cursor & mask];
+        const uint64_t expected = _cursor + 1;
+        if (slot.seq.load(std::memory_order_acquire) == expected) {
+            std::memcpy(static_cast<void *>(frame), &slot.frame, sizeof(CanFrame));
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (slot.seq.load(std::memory_order_relaxed) == expected) {
+                received |= commitRxFrame();
+                _cursor++;
+                continue;
+            }
+        }
+        // The publisher lapped us and overwrote the slot; the claimed queue slot is reused
+        _lost++;
+        _cursor++;
+        head = _header->head.load(std::memory_order_acquire);
+    }
+
+    _header->readers[_reader].cursor.store(_cursor, std::memory_order_release);
+
+    if (received)
+        notifyRxFrames();
+
+    if (full && _retryTimer < 0) {
+        _retryTimer = eventDispatcher().addTimer(RetryMs, [this]() {
+            eventDispatcher().removeTimer(_retryTimer);
+            _retryTimer = -1;
+            readRing();
+        });
+    }
+
+    if (!full && !_closedReported && _header->closed.load(std::memory_order_acquire)) {
+        _closedReported = true;
+        setError(fmt::format("Channel {} was closed by its publisher", _name),
+                 CanInterface::CanBusError::ConnectionError);
+    }
+}
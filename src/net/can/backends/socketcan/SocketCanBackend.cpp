@@ -9,12 +9,14 @@
 #include "dplib/net/can/SocketCanBackend.h"
 
 #include "dplib/net/can/CanBus.h"
+#include "dplib/net/can/CanFrameCodec.h"
 #include "dplib/net/can/CanInterface.h"
 
 #include "dplib/core/Application.h"
 
 #include <linux/can/error.h>
 #include <linux/can/raw.h>
+#include <linux/net_tstamp.h>
 #include <linux/sockios.h>
 #include <errno.h>
 #include <unistd.h>
@@ -28,6 +30,7 @@
 
 #include <libsocketcan.h>
 
+using namespace datapanel;
 using namespace datapanel::core;
 using namespace datapanel::net::can;
 
@@ -115,7 +118,7 @@ std::list<CanInterfaceInfo> SocketCanBackend::availableChannels()
 
 bool SocketCanBackend::applyConfigOption(CanInterface::ConfigOption opt, const CanInterface::ConfigOptionValue &value)
 {
-    bool ok = false;
+    bool ok = true;
 
     switch (opt) {
         case ConfigOption::CfgOptBitrate: {
@@ -158,8 +161,33 @@ bool SocketCanBackend::applyConfigOption(CanInterface::ConfigOption opt, const C
                     CanInterface::CanBusError::ConfigurationError);
             }
         } break;
+        case ConfigOption::CfgOptRxBatchSize: {
+            const int batchSize = std::get<int>(value);
+            if (batchSize < 1 || batchSize > MaxRxBatchSize) {
+                ok = false;
+                setError(fmt::format("Receive batch size must be between 1 and {}", MaxRxBatchSize),
+                         CanInterface::CanBusError::ConfigurationError);
+                break;
+            }
+            _rxBatchSize = batchSize;
+            setupRxBuffers();
+        } break;
+        case ConfigOption::CfgOptTimestampSource:
+            ok = applyTimestampSource(static_cast<TimestampSource>(std::get<int>(value)));
+            break;
+        case ConfigOption::CfgOptRxQueueSize:
+        case ConfigOption::CfgOptTxQueueSize:
+        case ConfigOption::CfgOptQueueOverflowPolicy:
+            // Handled by CanInterface
+            break;
+        case ConfigOption::CfgOptQueuedTx:
+            _queuedTx = std::get<bool>(value);
+            if (_queuedTx && pendingTxFrames())
+                armTx();
+            break;
 
         default:
+            ok = false;
             setError(fmt::format("Unsupported configuration option {}", opt),
                      CanInterface::CanBusError::ConfigurationError);
             break;
@@ -176,6 +204,8 @@ void SocketCanBackend::setConfigOption(ConfigOption opt, const ConfigOptionValue
 
     if (opt == CfgOptFD)
         _fdEnabled = std::get<bool>(value);
+    else if (opt == CfgOptQueuedTx)
+        _queuedTx = std::get<bool>(value);
 }
 
 bool SocketCanBackend::send(const CanFrame &frame)
@@ -189,39 +219,24 @@ bool SocketCanBackend::send(const CanFrame &frame)
         return false;
     }
 
-    canid_t id = frame.id();
-    if (frame.isExtendedId())
-        id |= CAN_EFF_FLAG;
-
-    if (frame.frameType() == CanFrame::RemoteRequestFrame) {
-        id |= CAN_RTR_FLAG;
-    } else if (frame.frameType() == CanFrame::ErrorFrame) {
-        id = static_cast<canid_t>((frame.error()) & CanFrame::AnyError);
-        id |= CAN_ERR_FLAG;
-    }
-
     if (frame.isFD() && !_fdEnabled) {
         setError("Cannot send FD frame when FD is disabled", CanInterface::TxError);
         return false;
     }
 
-    int written = 0;
-    if (frame.isFD()) {
-        canfd_frame tx = {};
-        tx.len = frame.payload().size();
-        tx.can_id = id;
-        tx.flags = frame.isBitrateSwitch() ? CANFD_BRS : 0;
-        tx.flags |= frame.isErrorState() ? CANFD_ESI : 0;
-        ::memcpy(tx.data, frame.payload().data(), tx.len);
-        written = ::write(_socket, &tx, sizeof(tx));
-    } else {
-        can_frame tx = {};
-        tx.can_dlc = frame.payload().size();
-        tx.can_id = id;
-        ::memcpy(tx.data, frame.payload().data(), tx.can_dlc);
-        written = ::write(_socket, &tx, sizeof(tx));
+    if (_queuedTx) {
+        if (!enqueueTxFrame(frame)) {
+            setError("Transmit queue is full", CanInterface::TxError);
+            return false;
+        }
+        armTx();
+        return true;
     }
 
+    canfd_frame tx;
+    const size_t mtu = CanFrameCodec::encode(frame, tx);
+    const int written = ::write(_socket, &tx, mtu);
+
     if (written < 0) {
         setError(fmt::format("Could not send frame: {}", ::strerror(errno)), CanInterface::TxError);
         return false;
@@ -230,6 +245,96 @@ bool SocketCanBackend::send(const CanFrame &frame)
     return true;
 }
 
+void SocketCanBackend::setupTxBuffers()
+{
+    _txBuffers.resize(TxBatchSize);
+    _txIov.resize(TxBatchSize);
+    _txMsgs.resize(TxBatchSize);
+    for (int i = 0; i < TxBatchSize; i++) {
+        _txIov[i].iov_base = &_txBuffers[i];
+        _txIov[i].iov_len = CAN_MTU;
+
+        msghdr &hdr = _txMsgs[i].msg_hdr;
+        hdr = msghdr{};
+        hdr.msg_iov = &_txIov[i];
+        hdr.msg_iovlen = 1;
+    }
+    _txHead = 0;
+    _txCount = 0;
+}
+
+void SocketCanBackend::armTx()
+{
+    // send() may run on a different thread from drainTx(), which disarms the socket when the queue
+    // empties; only the first of them to find the socket unarmed registers it
+    if (_txArmed.exchange(true))
+        return;
+    eventDispatcher().addFile(_socket, EventDispatcher::FileOperation::Write,
+                              std::bind(&SocketCanBackend::drainTx, this));
+}
+
+void SocketCanBackend::disarmTx()
+{
+    eventDispatcher().removeFile(_socket, EventDispatcher::FileOperation::Write);
+    _txArmed = false;
+}
+
+void SocketCanBackend::drainTx()
+{
+    bool transmitted = false;
+
+    while (true) {
+        if (_txHead == _txCount) {
+            _txHead = 0;
+            _txCount = 0;
+            CanFrame frame;
+            while (_txCount < TxBatchSize && pendingTxFrames()) {
+                frame = dequeueTxFrame();
+                _txIov[_txCount].iov_len = CanFrameCodec::encode(frame, _txBuffers[_txCount]);
+                _txCount++;
+            }
+        }
+
+        if (_txCount == 0) {
+            disarmTx();
+            // A frame queued while disarming would otherwise wait for the next send()
+            if (pendingTxFrames())
+                armTx();
+            break;
+        }
+
+        const int sent = ::sendmmsg(_socket, &_txMsgs[_txHead], _txCount - _txHead, MSG_DONTWAIT);
+        _ioStats.txSyscalls++;
+
+        if (sent < 0) {
+            if (errno == EAGAIN || errno == EWOULDBLOCK)
+                break;  // Wait for the next EPOLLOUT
+            if (errno == ENOBUFS) {
+                // The device queue is full but the socket still polls writable; back off
+                disarmTx();
+                _txRetryTimer = eventDispatcher().addTimer(TxRetryMs, [this]() {
+                    eventDispatcher().removeTimer(_txRetryTimer);
+                    _txRetryTimer = -1;
+                    armTx();
+                });
+                break;
+            }
+            // The first frame of the batch was rejected; skip it
+            _ioStats.txErrors++;
+            _txHead++;
+            setError(fmt::format("Could not send frame: {}", ::strerror(errno)), CanInterface::TxError);
+            continue;
+        }
+
+        _txHead += sent;
+        _ioStats.txFrames += sent;
+        transmitted = true;
+    }
+
+    if (transmitted)
+        framesTransmitted();
+}
+
 bool SocketCanBackend::restart()
 {
     return ::can_do_restart(_ifname.c_str()) == 0;
@@ -279,17 +384,21 @@ bool SocketCanBackend::open()
     _addr.can_family = AF_CAN;
     _addr.can_ifindex = interface.ifr_ifindex;
 
+    // Before bind() so no unfiltered frames are queued on the socket
+    installRxFilters();
+
     if (::bind(_socket, reinterpret_cast<struct sockaddr *>(&_addr), sizeof(_addr)) < 0) {
         setError(fmt::format("Could not bind to interface {}: {}", _ifname, ::strerror(errno)),
                  CanInterface::CanBusError::ConnectionError);
         return false;
     }
 
-    _iov.iov_base = &_raw_frame;
-    _msg.msg_name = &_addr;
-    _msg.msg_iov = &_iov;
-    _msg.msg_iovlen = 1;
-    _msg.msg_control = &_ctrlmsg;
+    if (!applyTimestampSource(SoftwareTimestamp)) {
+        return false;
+    }
+
+    setupRxBuffers();
+    setupTxBuffers();
 
     setState(CanInterface::ConnectedState);
 
@@ -302,81 +411,195 @@ bool SocketCanBackend::open()
         }
     }
 
-    Application::instance().addFile(_socket, EventDispatcher::FileOperation::Read,
-                                    std::bind(&SocketCanBackend::readSocket, this));
+    eventDispatcher().addFile(_socket, EventDispatcher::FileOperation::Read,
+                              std::bind(&SocketCanBackend::readSocket, this));
 
     return true;
 }
 
 bool SocketCanBackend::close()
 {
+    if (_socket != -1) {
+        eventDispatcher().removeFile(_socket, EventDispatcher::FileOperation::Read);
+        if (_txArmed)
+            disarmTx();
+        if (_txRetryTimer >= 0) {
+            eventDispatcher().removeTimer(_txRetryTimer);
+            _txRetryTimer = -1;
+        }
+    }
     ::close(_socket);
     _socket = -1;
     setState(CanInterface::DisconnectedState);
     return false;
 }
 
+static can_filter _kernelFilter(const CanFilter &filter)
+{
+    canid_t canId = static_cast<canid_t>(filter.id) & CAN_EFF_MASK;
+    canid_t canMask = static_cast<canid_t>(filter.mask) & CAN_EFF_MASK;
+    if (filter.format != CanFilter::AnyFormat) {
+        canMask |= CAN_EFF_FLAG;
+        canId |= (filter.format == CanFilter::ExtendedFormat) ? CAN_EFF_FLAG : 0;
+    }
+    if (filter.types != CanFilter::AnyFrameType) {
+        canMask |= CAN_RTR_FLAG;
+        canId |= (filter.types == CanFilter::RemoteRequestOnly) ? CAN_RTR_FLAG : 0;
+    }
+    if (filter.inverted)
+        canId |= CAN_INV_FILTER;
+    return can_filter{canId, canMask};
+}
+
+bool SocketCanBackend::applyRxFilters()
+{
+    if (_socket == -1)
+        return false;
+
+    std::vector<can_filter> filters;
+    filters.reserve(std::max<size_t>(rxFilters().size(), 1));
+    for (const CanFilter &filter : rxFilters()) filters.push_back(_kernelFilter(filter));
+    if (filters.empty())
+        filters.push_back(can_filter{0, 0});
+
+    if (filters.size() > MaxRxFilters) {
+        setError(fmt::format("At most {} receive filters are supported", MaxRxFilters),
+                 CanInterface::CanBusError::ConfigurationError);
+        return false;
+    }
+
+    if (::setsockopt(_socket, SOL_CAN_RAW, CAN_RAW_FILTER, filters.data(), filters.size() * sizeof(can_filter)) < 0) {
+        setError(fmt::format("Could not set receive filters: {}", ::strerror(errno)),
+                 CanInterface::CanBusError::ConfigurationError);
+        return false;
+    }
+
+    const can_err_mask_t errorMask = errorFilter() & CAN_ERR_MASK;
+    if (::setsockopt(_socket, SOL_CAN_RAW, CAN_RAW_ERR_FILTER, &errorMask, sizeof(errorMask)) < 0) {
+        setError(fmt::format("Could not set error filter: {}", ::strerror(errno)),
+                 CanInterface::CanBusError::ConfigurationError);
+        return false;
+    }
+
+    return true;
+}
+
+bool SocketCanBackend::applyTimestampSource(TimestampSource source)
+{
+    if (source == HardwareTimestamp) {
+        // Ask the driver to stamp all received frames.  Many CAN drivers
+        // stamp unconditionally and do not implement this request.
+        struct ifreq ifr = {};
+        struct hwtstamp_config hwconfig = {};
+        hwconfig.tx_type = HWTSTAMP_TX_OFF;
+        hwconfig.rx_filter = HWTSTAMP_FILTER_ALL;
+        ::strncpy(ifr.ifr_name, _ifname.c_str(), sizeof(ifr.ifr_name) - 1);
+        ifr.ifr_data = reinterpret_cast<char *>(&hwconfig);
+        if (::ioctl(_socket, SIOCSHWTSTAMP, &ifr) < 0)
+            spdlog::debug("{}: could not enable hardware timestamps: {}", _ifname, ::strerror(errno));
+
+        const int flags = SOF_TIMESTAMPING_RX_HARDWARE | SOF_TIMESTAMPING_RAW_HARDWARE |
+                          SOF_TIMESTAMPING_RX_SOFTWARE | SOF_TIMESTAMPING_SOFTWARE;
+        if (::setsockopt(_socket, SOL_SOCKET, SO_TIMESTAMPING, &flags, sizeof(flags)) < 0) {
+            setError(fmt::format("Could not enable hardware timestamps: {}", ::strerror(errno)),
+                     CanInterface::CanBusError::ConfigurationError);
+            return false;
+        }
+
+        // SO_TIMESTAMPING carries its own software stamp
+        const int disabled = 0;
+        ::setsockopt(_socket, SOL_SOCKET, SO_TIMESTAMPNS, &disabled, sizeof(disabled));
+        return true;
+    }
+
+    const int disabled = 0;
+    ::setsockopt(_socket, SOL_SOCKET, SO_TIMESTAMPING, &disabled, sizeof(disabled));
+
+    const int enabled = 1;
+    if (::setsockopt(_socket, SOL_SOCKET, SO_TIMESTAMPNS, &enabled, sizeof(enabled)) < 0) {
+        setError(fmt::format("Could not enable timestamps: {}", ::strerror(errno)),
+                 CanInterface::CanBusError::ConfigurationError);
+        return false;
+    }
+    return true;
+}
+
+void SocketCanBackend::setupRxBuffers()
+{
+    const size_t count = static_cast<size_t>(_rxBatchSize);
+    _rxBuffers.resize(count);
+    _rxIov.resize(count);
+    _rxControl.resize(count);
+    _rxMsgs.resize(count);
+
+    for (size_t i = 0; i < count; i++) {
+        _rxIov[i].iov_base = &_rxBuffers[i];
+        _rxIov[i].iov_len = sizeof(canfd_frame);
+
+        msghdr &hdr = _rxMsgs[i].msg_hdr;
+        hdr.msg_name = nullptr;
+        hdr.msg_namelen = 0;
+        hdr.msg_iov = &_rxIov[i];
+        hdr.msg_iovlen = 1;
+        hdr.msg_control = _rxControl[i].data;
+        hdr.msg_controllen = sizeof(RxControl::data);
+        hdr.msg_flags = 0;
+    }
+}
+
 void SocketCanBackend::readSocket()
 {
-    std::list<CanFrame> frames;
+    bool received = false;
 
     while (true) {
-        _raw_frame = {};
-        _iov.iov_len = sizeof(_raw_frame);
-        _msg.msg_namelen = sizeof(_addr);
-        _msg.msg_controllen = sizeof(_ctrlmsg);
-        _msg.msg_flags = 0;
+        for (auto &m : _rxMsgs) {
+            m.msg_hdr.msg_controllen = sizeof(RxControl::data);
+            m.msg_hdr.msg_flags = 0;
+            m.msg_len = 0;
+        }
 
-        const int bytesRx = ::recvmsg(_socket, &_msg, 0);
+        const int count = ::recvmmsg(_socket, _rxMsgs.data(), _rxMsgs.size(), MSG_DONTWAIT, nullptr);
+        _ioStats.rxSyscalls++;
 
-        if (bytesRx <= 0) {
+        if (count <= 0)
             break;
-        } else if (bytesRx != CANFD_MTU && bytesRx != CAN_MTU) {
-            spdlog::error("Incomplete CAN frame");
-            setError("Incomplete CAN frame", CanInterface::CanBusError::RxError);
-            continue;
-        } else if (_raw_frame.len > bytesRx - offsetof(canfd_frame, data)) {
-            setError("Invalid CAN frame length", CanInterface::CanBusError::RxError);
-            spdlog::error("Invalid CAN frame length");
-            continue;
-        }
 
-        struct timeval ts = {};
-        if (::ioctl(_socket, SIOCGSTAMP, &ts) < 0) {
-            setError(fmt::format("RX error: {}", ::strerror(errno)), CanInterface::CanBusError::RxError);
-            spdlog::error("That timestamp was whack");
-            ts = {};
+        for (int i = 0; i < count; i++) {
+            msghdr &hdr = _rxMsgs[i].msg_hdr;
+            const canfd_frame &raw = _rxBuffers[i];
+            const unsigned int bytesRx = _rxMsgs[i].msg_len;
+
+            if (bytesRx != CANFD_MTU && bytesRx != CAN_MTU) {
+                spdlog::error("Incomplete CAN frame");
+                setError("Incomplete CAN frame", CanInterface::CanBusError::RxError);
+                continue;
+            } else if (raw.len > bytesRx - offsetof(canfd_frame, data)) {
+                setError("Invalid CAN frame length", CanInterface::CanBusError::RxError);
+                spdlog::error("Invalid CAN frame length");
+                continue;
+            }
+
+            // The frame is still good, but its timestamp may have been cut off
+            if (hdr.msg_flags & MSG_CTRUNC)
+                _ioStats.rxControlTruncated++;
+
+            // Decode straight into the receive queue; a full queue drops the frame
+            CanFrame *frame = claimRxFrame();
+            if (frame == nullptr)
+                continue;
+            CanFrameCodec::decode(raw, bytesRx == CANFD_MTU, *frame);
+            frame->setTimestamp(CanFrameCodec::timestamp(hdr));
+            if (hdr.msg_flags & MSG_CONFIRM)
+                frame->setLocalEcho(true);
+            received |= commitRxFrame();
         }
+        _ioStats.rxFrames += count;
 
-        const CanFrame::Timestamp timestamp(ts.tv_sec, 1000 * ts.tv_usec);
-        CanFrame frame;
-        frame.setTimestamp(timestamp);
-        frame.setFD(bytesRx == CANFD_MTU);
-        frame.setExtendedId(_raw_frame.can_id & CAN_EFF_FLAG);
-
-        if (_raw_frame.can_id & CAN_RTR_FLAG)
-            frame.setFrameType(CanFrame::RemoteRequestFrame);
-        else if (_raw_frame.can_id & CAN_ERR_FLAG)
-            frame.setFrameType(CanFrame::ErrorFrame);
-        else
-            frame.setFrameType(CanFrame::DataFrame);
-        if (_raw_frame.flags & CANFD_BRS)
-            frame.setBitrateSwitch(true);
-        if (_raw_frame.flags & CANFD_ESI)
-            frame.setErrorState(true);
-        if (_msg.msg_flags & MSG_CONFIRM)
-            frame.setLocalEcho(true);
-
-        frame.setId(_raw_frame.can_id & CAN_EFF_MASK);
-
-        std::basic_string_view<uint8_t> sview(_raw_frame.data, _raw_frame.len);
-        std::vector<std::byte> data;
-        std::transform(sview.cbegin(), sview.cend(), std::back_inserter(data),
-                       [](unsigned char c) { return std::byte(c); });
-        frame.setPayload(data);
-
-        frames.push_back(std::move(frame));
+        // A short batch means the socket has been drained
+        if (count < _rxBatchSize)
+            break;
     }
 
-    enqueueRxFrames(frames);
+    if (received)
+        notifyRxFrames();
 }
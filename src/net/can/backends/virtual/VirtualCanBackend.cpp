@@ -0,0 +1,504 @@
+/**
+ * Copyright (c) 2026 Data Panel Corporation
+ * 181 Cheshire Ln, Suite 300
+ * Plymouth, MN 55441
+ * All rights reserved.
+ *
+ * This is the confidential and proprietary information of Data Panel
+ * Corporation. Such confidential information shall not be disclosed and is for
+ * use only in accordance with the license agreement you entered into with Data
+ * Panel.
+ */
+
+/**
+ * @file VirtualCanBackend.cpp
+ * @date 2026-10-16
+ */
+
+#include <algorithm>
+#include <cstring>
+#include <functional>
+#include <map>
+
+#include <fmt/format.h>
+
+#include "dplib/net/can/VirtualCanBackend.h"
+
+#include "dplib/core/EventDispatcher.h"
+#include "dplib/net/can/BitTiming.h"
+
+#include <errno.h>
+#include <sys/eventfd.h>
+#include <time.h>
+#include <unistd.h>
+
+using namespace datapanel;
+using namespace datapanel::core;
+using namespace datapanel::net::can;
+
+namespace
+{
+/** Bits in a destroyed transmission: on average half the frame, then error flag, delimiter and interframe space */
+constexpr uint32_t ErrorFrameBits = 6 + 8 + 3;
+/** Transmit error counter increment per failed transmission */
+constexpr int TxErrorPenalty = 8;
+
+std::mutex registryMutex;
+
+std::map<std::string, std::weak_ptr<VirtualCanBus>> &registry()
+{
+    static std::map<std::string, std::weak_ptr<VirtualCanBus>> buses;
+    return buses;
+}
+
+int64_t clockNs(clockid_t clock)
+{
+    timespec ts;
+    ::clock_gettime(clock, &ts);
+    return ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+/**
+ * Bits of the arbitration field in transmission order; lower values win
+ *
+ * Base identifier, RTR (standard) or SRR (extended), IDE, identifier
+ * extension and RTR (extended).  Dominant bits are 0.
+ */
+uint32_t arbitrationKey(const CanFrame &frame)
+{
+    const uint32_t id = static_cast<uint32_t>(frame.id());
+    const uint32_t rtr = frame.frameType() == CanFrame::RemoteRequestFrame ? 1 : 0;
+    if (!frame.isExtendedId())
+        return (id & CAN_SFF_MASK) << 21 | rtr << 20;
+    return (id >> 18 & CAN_SFF_MASK) << 21 | 1U << 20 | 1U << 19 | (id & 0x3FFFF) << 1 | rtr;
+}
+}  // namespace
+
+VirtualCanBus::VirtualCanBus(std::string name)
+    : _name(std::move(name)), _clockOffset(clockNs(CLOCK_REALTIME) - clockNs(CLOCK_MONOTONIC))
+{
+}
+
+VirtualCanBus::~VirtualCanBus()
+{
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _stopPacer = true;
+    }
+    _wake.notify_all();
+    if (_pacer.joinable())
+        _pacer.join();
+
+    std::lock_guard<std::mutex> lock(registryMutex);
+    const auto it = registry().find(_name);
+    // A new bus with the same name may already have replaced this one
+    if (it != registry().end() && it->second.expired())
+        registry().erase(it);
+}
+
+std::shared_ptr<VirtualCanBus> VirtualCanBus::find(const std::string &name)
+{
+    std::lock_guard<std::mutex> lock(registryMutex);
+    std::weak_ptr<VirtualCanBus> &entry = registry()[name];
+    std::shared_ptr<VirtualCanBus> bus = entry.lock();
+    if (!bus) {
+        bus = std::shared_ptr<VirtualCanBus>(new VirtualCanBus(name));
+        entry = bus;
+    }
+    return bus;
+}
+
+std::list<std::string> VirtualCanBus::names()
+{
+    std::lock_guard<std::mutex> lock(registryMutex);
+    std::list<std::string> result;
+    for (const auto &[name, bus] : registry()) {
+        if (!bus.expired())
+            result.push_back(name);
+    }
+    return result;
+}
+
+void VirtualCanBus::setBitrate(int bitrate)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    _bitrate = std::max(bitrate, 0);
+    // Once started, the pacer stays until the bus goes away so queued frames are never stranded
+    if (_bitrate > 0 && !_pacer.joinable())
+        _pacer = std::thread(&VirtualCanBus::runPacer, this);
+}
+
+void VirtualCanBus::setErrorRate(double probability, uint32_t seed)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    probability = std::clamp(probability, 0.0, 1.0);
+    _errorThreshold = probability >= 1.0 ? UINT32_MAX : static_cast<uint32_t>(probability * 4294967296.0);
+    _random.seed(seed);
+}
+
+void VirtualCanBus::injectError(uint32_t error)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    deliverError(error, clockNs(CLOCK_REALTIME));
+}
+
+VirtualCanBus::Statistics VirtualCanBus::statistics() const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _stats;
+}
+
+size_t VirtualCanBus::nodeCount() const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _nodes.size();
+}
+
+void VirtualCanBus::attach(VirtualCanBackend *node)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    node->_txErrors = 0;
+    node->_hasTxHead = false;
+    _nodes.push_back(node);
+}
+
+void VirtualCanBus::detach(VirtualCanBackend *node)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    _nodes.erase(std::remove(_nodes.begin(), _nodes.end(), node), _nodes.end());
+    node->_hasTxHead = false;
+}
+
+bool VirtualCanBus::corrupted()
+{
+    return _errorThreshold != 0 && _random() < _errorThreshold;
+}
+
+void VirtualCanBus::deliver(const CanFrame &frame, VirtualCanBackend *sender, int64_t timestampNs)
+{
+    CanFrame copy = frame;
+    copy.setTimestampNs(timestampNs);
+    for (VirtualCanBackend *node : _nodes) {
+        if (node != sender) {
+            node->post(copy);
+        } else if (node->_rxOwn.load(std::memory_order_relaxed)) {
+            CanFrame echo = copy;
+            echo.setLocalEcho(true);
+            node->post(echo);
+        }
+    }
+}
+
+void VirtualCanBus::deliverError(uint32_t error, int64_t timestampNs)
+{
+    CanFrame frame(CanFrame::ErrorFrame);
+    frame.setError(static_cast<CanFrame::FrameError>(error & CanFrame::AnyError));
+    frame.setTimestampNs(timestampNs);
+    for (VirtualCanBackend *node : _nodes) node->post(frame);
+}
+
+bool VirtualCanBus::transmit(VirtualCanBackend *sender, const CanFrame &frame)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (sender->_txErrors >= VirtualCanBackend::BusOffLimit)
+        return false;
+
+    const int64_t now = clockNs(CLOCK_REALTIME);
+    while (corrupted()) {
+        _stats.errors++;
+        deliverError(CanFrame::ProtocolError | CanFrame::BusError, now);
+        sender->_txErrors += TxErrorPenalty;
+        if (sender->_txErrors >= VirtualCanBackend::BusOffLimit) {
+            deliverError(CanFrame::BusOffError, now);
+            return false;
+        }
+    }
+
+    if (sender->_txErrors > 0)
+        sender->_txErrors--;
+    _stats.frames++;
+    deliver(frame, sender, now);
+    return true;
+}
+
+void VirtualCanBus::schedule()
+{
+    // Taking the mutex orders the caller's queued frame before the pacer's next look
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+    }
+    _wake.notify_one();
+}
+
+void VirtualCanBus::runPacer()
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+    bool idle = true;
+
+    while (!_stopPacer) {
+        // Arbitration between the oldest pending frame of every interface
+        VirtualCanBackend *winner = nullptr;
+        uint64_t best = UINT64_MAX;
+        for (VirtualCanBackend *node : _nodes) {
+            if (node->_txErrors >= VirtualCanBackend::BusOffLimit)
+                continue;
+            if (!node->_hasTxHead) {
+                if (!node->pendingTxFrames())
+                    continue;
+                node->_txHead = node->dequeueTxFrame();
+                node->_hasTxHead = true;
+            }
+            const uint64_t key = arbitrationKey(node->_txHead);
+            if (key < best) {
+                best = key;
+                winner = node;
+            }
+        }
+
+        if (winner == nullptr) {
+            _wake.wait(lock);
+            idle = true;
+            continue;
+        }
+
+        // Back-to-back frames start when the previous one ended, even if we woke late
+        const int64_t now = clockNs(CLOCK_MONOTONIC);
+        const int64_t start = idle ? std::max(now, _busFreeAt) : _busFreeAt;
+        const CanFrame frame = winner->_txHead;
+        const bool error = corrupted();
+        const uint32_t bits = error ? frameBitCount(frame) / 2 + ErrorFrameBits : frameBitCount(frame);
+        const int bitrate = _bitrate;
+        const int64_t end = start + (bitrate > 0 ? static_cast<int64_t>(bits) * 1000000000 / bitrate : 0);
+        _busFreeAt = end;
+        _stats.bits += bits;
+        idle = false;
+
+        if (end > now) {
+            lock.unlock();
+            const timespec deadline{static_cast<time_t>(end / 1000000000), static_cast<long>(end % 1000000000)};
+            ::clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &deadline, nullptr);
+            lock.lock();
+        }
+
+        // The sender may have disconnected during the transmission
+        if (std::find(_nodes.begin(), _nodes.end(), winner) == _nodes.end())
+            continue;
+
+        if (error) {
+            _stats.errors++;
+            deliverError(CanFrame::ProtocolError | CanFrame::BusError, end + _clockOffset);
+            winner->_txErrors += TxErrorPenalty;
+            if (winner->_txErrors >= VirtualCanBackend::BusOffLimit) {
+                winner->_hasTxHead = false;
+                deliverError(CanFrame::BusOffError, end + _clockOffset);
+            }
+            continue;
+        }
+
+        winner->_hasTxHead = false;
+        if (winner->_txErrors > 0)
+            winner->_txErrors--;
+        _stats.frames++;
+        deliver(frame, winner, end + _clockOffset);
+        winner->_transmitted.fetch_add(1, std::memory_order_relaxed);
+        winner->signal();
+    }
+}
+
+VirtualCanBackend::~VirtualCanBackend()
+{
+    close();
+}
+
+std::unique_ptr<CanInterface> VirtualCanBackend::init(const std::string &channel)
+{
+    return std::unique_ptr<VirtualCanBackend>(new VirtualCanBackend(channel));
+}
+
+std::list<CanInterfaceInfo> VirtualCanBackend::availableChannels()
+{
+    std::list<CanInterfaceInfo> channels;
+    for (const std::string &name : VirtualCanBus::names()) {
+        CanInterfaceInfo info;
+        info.plugin = "Virtual";
+        info.name = name;
+        info.description = "Virtual CAN bus";
+        info.supportsFD = true;
+        info.currentBitrate = VirtualCanBus::find(name)->bitrate();
+        channels.push_back(info);
+    }
+    return channels;
+}
+
+bool VirtualCanBackend::open()
+{
+    if (_bus)
+        return false;  // already opened
+
+    _eventFd = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (_eventFd < 0) {
+        setError(fmt::format("Could not create eventfd: {}", ::strerror(errno)),
+                 CanInterface::CanBusError::ConnectionError);
+        return false;
+    }
+
+    const ConfigOptionValue queueSize = configOption(CfgOptRxQueueSize);
+    const int *pqueueSize = std::get_if<int>(&queueSize);
+    _inbox.reset((pqueueSize && *pqueueSize > 0) ? *pqueueSize : DefaultInboxSize, util::OverflowPolicy::DropNewest);
+    _signalled = false;
+    _transmitted = 0;
+
+    _bus = VirtualCanBus::find(_name);
+    const ConfigOptionValue bitrate = configOption(CfgOptBitrate);
+    if (const int *pbitrate = std::get_if<int>(&bitrate))
+        _bus->setBitrate(*pbitrate);
+    _bus->attach(this);
+
+    setState(CanInterface::ConnectedState);
+
+    eventDispatcher().addFile(_eventFd, EventDispatcher::FileOperation::Read,
+                              std::bind(&VirtualCanBackend::readInbox, this));
+    return true;
+}
+
+bool VirtualCanBackend::close()
+{
+    if (_bus) {
+        _bus->detach(this);
+        _bus.reset();
+    }
+    if (_eventFd != -1) {
+        eventDispatcher().removeFile(_eventFd, EventDispatcher::FileOperation::Read);
+        ::close(_eventFd);
+        _eventFd = -1;
+    }
+    setState(CanInterface::DisconnectedState);
+    return true;
+}
+
+void VirtualCanBackend::setConfigOption(ConfigOption opt, const ConfigOptionValue &value)
+{
+    switch (opt) {
+        case CfgOptBitrate:
+            if (_bus)
+                _bus->setBitrate(std::get<int>(value));
+            break;
+        case CfgOptFD:
+            _fdEnabled = std::get<bool>(value);
+            break;
+        case CfgOptRxOwn:
+            _rxOwn = std::get<bool>(value);
+            break;
+        default:
+            break;
+    }
+    CanInterface::setConfigOption(opt, value);
+}
+
+bool VirtualCanBackend::send(const CanFrame &frame)
+{
+    if (state() != ConnectedState) {
+        return false;
+    }
+
+    if (!frame.isValid()) {
+        setError("Cannot write invalid frame", CanInterface::CanBusError::TxError);
+        return false;
+    }
+
+    if (frame.isFD() && !_fdEnabled) {
+        setError("Cannot send FD frame when FD is disabled", CanInterface::TxError);
+        return false;
+    }
+
+    if (_bus->bitrate() == 0) {
+        if (!_bus->transmit(this, frame)) {
+            setError("Interface is bus-off", CanInterface::TxError);
+            return false;
+        }
+        _transmitted.fetch_add(1, std::memory_order_relaxed);
+        signal();
+        return true;
+    }
+
+    if (busStatus() == CanBusState::BusOff) {
+        setError("Interface is bus-off", CanInterface::TxError);
+        return false;
+    }
+    if (!enqueueTxFrame(frame)) {
+        setError("Transmit queue is full", CanInterface::TxError);
+        return false;
+    }
+    _bus->schedule();
+    return true;
+}
+
+bool VirtualCanBackend::restart()
+{
+    if (!_bus)
+        return false;
+    {
+        std::lock_guard<std::mutex> lock(_bus->_mutex);
+        _txErrors = 0;
+    }
+    // Frames queued before bus-off go out now rather than with the next transmission
+    _bus->schedule();
+    return true;
+}
+
+CanInterface::CanBusState VirtualCanBackend::busStatus()
+{
+    if (!_bus)
+        return CanBusState::Unknown;
+
+    std::lock_guard<std::mutex> lock(_bus->_mutex);
+    if (_txErrors >= BusOffLimit)
+        return CanBusState::BusOff;
+    if (_txErrors >= ErrorPassiveLimit)
+        return CanBusState::Error;
+    if (_txErrors >= WarningLimit)
+        return CanBusState::Warning;
+    return CanBusState::OK;
+}
+
+void VirtualCanBackend::post(const CanFrame &frame)
+{
+    _inbox.push(frame);
+    signal();
+}
+
+void VirtualCanBackend::signal()
+{
+    if (!_signalled.exchange(true)) {
+        const uint64_t one = 1;
+        [[maybe_unused]] ssize_t written = ::write(_eventFd, &one, sizeof(one));
+    }
+}
+
+void VirtualCanBackend::readInbox()
+{
+    uint64_t value;
+    [[maybe_unused]] ssize_t bytesRead = ::read(_eventFd, &value, sizeof(value));
+    _signalled.store(false, std::memory_order_seq_cst);
+
+    bool received = false;
+    while (!_inbox.empty()) {
+        // Pop straight into the receive queue
+        CanFrame *frame = claimRxFrame();
+        if (frame == nullptr) {
+            CanFrame discarded;
+            _inbox.pop(discarded);
+            continue;
+        }
+        _inbox.pop(*frame);
+        // Like SocketCAN, error frames must be asked for; the claimed slot is reused
+        if (frame->frameType() == CanFrame::ErrorFrame && (frame->error() & errorFilter()) == 0)
+            continue;
+        received |= commitRxFrame();
+    }
+
+    if (received)
+        notifyRxFrames();
+    if (_transmitted.exchange(0, std::memory_order_relaxed) != 0)
+        framesTransmitted();
+}
@@ -0,0 +1,590 @@
+/**
+ * Copyright (c) 2026 Data Panel Corporation
+ * 181 Cheshire Ln, Suite 300
+ * Plymouth, MN 55441
+ * All rights reserved.
+ *
+ * This is the confidential and proprietary information of Data Panel
+ * Corporation. Such confidential information shall not be disclosed and is for
+ * use only in accordance with the license agreement you entered into with Data
+ * Panel.
+ */
+
+/**
+ * @file IsoTpTransport.cpp
+ * @date 2026-10-16
+ */
+
+#include <algorithm>
+#include <cstring>
+
+#include <fmt/format.h>
+
+#include "dplib/core/EventDispatcher.h"
+#include "dplib/net/isotp/IsoTpTransport.h"
+
+using namespace datapanel::net::isotp;
+using datapanel::net::can::CanFrame;
+using datapanel::net::can::CanInterface;
+using datapanel::util::ByteView;
+using Clock = std::chrono::steady_clock;
+
+namespace
+{
+constexpr size_t MaxFrameSize = 64;
+constexpr size_t MaxShortLength = 4095; /**< Largest length of a first frame without the 32-bit escape */
+
+/** Protocol control information: high nibble of the first byte */
+enum FrameType : uint8_t {
+    SingleFrame = 0,
+    FirstFrame = 1,
+    ConsecutiveFrame = 2,
+    FlowControl = 3,
+};
+
+/** Flow status of a flow control frame */
+enum FlowStatus : uint8_t {
+    ContinueToSend = 0,
+    Wait = 1,
+    OverflowAbort = 2,
+};
+
+bool isValidFrameSize(size_t size)
+{
+    return size == 8 || size == 12 || size == 16 || size == 20 || size == 24 || size == 32 || size == 48 || size == 64;
+}
+
+/** Smallest CAN FD frame length holding @p size bytes */
+size_t fdFrameSize(size_t size)
+{
+    for (size_t valid : {8, 12, 16, 20, 24, 32, 48, 64})
+        if (size <= valid)
+            return valid;
+    return MaxFrameSize;
+}
+
+/** Decode an STmin byte; reserved values mean the longest time, as ISO 15765-2 requires */
+std::chrono::nanoseconds separationTime(uint8_t stMin)
+{
+    if (stMin <= 0x7F)
+        return std::chrono::milliseconds(stMin);
+    if (stMin >= 0xF1 && stMin <= 0xF9)
+        return std::chrono::microseconds(100 * (stMin - 0xF0));
+    return std::chrono::milliseconds(0x7F);
+}
+
+uint32_t channelKey(CanFrame::FrameId id, bool extended)
+{
+    return uint32_t(id) | (extended ? 0x80000000u : 0);
+}
+}  // namespace
+
+struct IsoTpTransport::Channel {
+    enum TxState {
+        TxIdle,
+        TxWaitFlowControl,
+        TxSending,
+    };
+
+    int number = 0;
+    IsoTpChannelConfig config;
+
+    bool receiving = false;
+    std::unique_ptr<std::byte[]> rxData;
+    size_t rxLength = 0;
+    size_t rxReceived = 0;
+    uint8_t rxSequence = 0;
+    uint8_t rxBlockCount = 0;
+    Clock::time_point rxDeadline;
+
+    TxState txState = TxIdle;
+    std::unique_ptr<std::byte[]> txData;
+    size_t txLength = 0;
+    size_t txOffset = 0;
+    uint8_t txSequence = 0;
+    uint8_t peerBlockSize = 0;
+    uint8_t blockRemaining = 0;
+    int waitCount = 0;
+    bool blocked = false; /**< The last consecutive frame did not fit in the transmit queue */
+    std::chrono::nanoseconds stMin{0};
+    Clock::time_point txDue; /**< When the next consecutive frame may be sent */
+    Clock::time_point txDeadline;
+};
+
+IsoTpTransport::IsoTpTransport() = default;
+
+IsoTpTransport::~IsoTpTransport()
+{
+    detach();
+    stopTimers();
+}
+
+int IsoTpTransport::addChannel(const IsoTpChannelConfig &config)
+{
+    const CanFrame::FrameId idMask = config.extendedId ? can::CAN_EFF_MASK : can::CAN_SFF_MASK;
+    if (config.txId > idMask || config.rxId > idMask) {
+        _errorMessage = "Channel identifier out of range";
+        return -1;
+    }
+    if (!isValidFrameSize(config.frameSize)) {
+        _errorMessage = fmt::format("Invalid frame size {}", config.frameSize);
+        return -1;
+    }
+    if (config.maxMessageSize == 0 || config.maxMessageSize > UINT32_MAX) {
+        _errorMessage = "Invalid maximum message size";
+        return -1;
+    }
+    const uint32_t key = channelKey(config.rxId, config.extendedId);
+    if (_channelByRxId.count(key) != 0) {
+        _errorMessage = fmt::format("Receive identifier 0x{:X} is already used", config.rxId);
+        return -1;
+    }
+
+    auto channel = std::make_unique<Channel>();
+    channel->number = int(_channels.size());
+    channel->config = config;
+    channel->rxData = std::make_unique<std::byte[]>(config.maxMessageSize);
+    channel->txData = std::make_unique<std::byte[]>(config.maxMessageSize);
+    _channelByRxId.emplace(key, channel->number);
+    _channels.push_back(std::move(channel));
+    return int(_channels.size()) - 1;
+}
+
+void IsoTpTransport::setEventDispatcher(core::EventDispatcher *dispatcher)
+{
+    stopTimers();
+    _dispatcher = dispatcher;
+    if (_busy > 0)
+        startTimeoutTimer();
+    updatePacer();
+}
+
+void IsoTpTransport::attach(CanInterface &bus)
+{
+    detach();
+    _bus = &bus;
+    _rxConnection = bus.framesTapped.connect([this](const CanFrame *frames, size_t count) { process(frames, count); });
+    _txConnection = bus.framesTransmitted.connect([this]() {
+        if (_blocked > 0)
+            retryBlocked();
+    });
+    if (_busy > 0)
+        startTimeoutTimer();
+    updatePacer();
+}
+
+void IsoTpTransport::detach()
+{
+    _rxConnection.disconnect();
+    _txConnection.disconnect();
+    stopTimers();
+    _bus = nullptr;
+}
+
+bool IsoTpTransport::send(int channelNumber, ByteView data)
+{
+    if (channelNumber < 0 || size_t(channelNumber) >= _channels.size()) {
+        _errorMessage = fmt::format("No channel {}", channelNumber);
+        return false;
+    }
+    Channel &channel = *_channels[size_t(channelNumber)];
+    if (_bus == nullptr) {
+        _errorMessage = "No interface attached";
+        return false;
+    }
+    if (channel.txState != Channel::TxIdle) {
+        _errorMessage = "Channel is busy sending";
+        return false;
+    }
+    if (data.size() == 0 || data.size() > channel.config.maxMessageSize) {
+        _errorMessage = fmt::format("Cannot send {} bytes on a channel limited to {}", data.size(),
+                                    channel.config.maxMessageSize);
+        return false;
+    }
+
+    const size_t frameSize = channel.config.frameSize;
+    const size_t length = data.size();
+    uint8_t frame[MaxFrameSize];
+
+    // Single frame: the length fits in the first nibble up to 7 bytes, in the second byte beyond
+    if (length <= 7 || (frameSize > 8 && length <= frameSize - 2)) {
+        size_t header = 1;
+        if (length <= 7) {
+            frame[0] = uint8_t(SingleFrame << 4 | length);
+        } else {
+            frame[0] = SingleFrame << 4;
+            frame[1] = uint8_t(length);
+            header = 2;
+        }
+        std::memcpy(frame + header, data.data(), length);
+        if (!sendFrame(channel, frame, header + length)) {
+            _errorMessage = _bus->errorMessage();
+            return false;
+        }
+        sendFinished(channel.number, Ok);
+        return true;
+    }
+
+    size_t header = 2;
+    if (length <= MaxShortLength) {
+        frame[0] = uint8_t(FirstFrame << 4 | length >> 8);
+        frame[1] = uint8_t(length);
+    } else {
+        frame[0] = FirstFrame << 4;
+        frame[1] = 0;
+        frame[2] = uint8_t(length >> 24);
+        frame[3] = uint8_t(length >> 16);
+        frame[4] = uint8_t(length >> 8);
+        frame[5] = uint8_t(length);
+        header = 6;
+    }
+    const size_t first = frameSize - header;
+    std::memcpy(frame + header, data.data(), first);
+    if (!sendFrame(channel, frame, frameSize)) {
+        _errorMessage = _bus->errorMessage();
+        return false;
+    }
+
+    std::memcpy(channel.txData.get(), data.data(), length);
+    channel.txLength = length;
+    channel.txOffset = first;
+    channel.txSequence = 1;
+    channel.waitCount = 0;
+    channel.txState = Channel::TxWaitFlowControl;
+    channel.txDeadline = Clock::now() + std::chrono::milliseconds(TimeoutMs);
+    if (_busy++ == 0)
+        startTimeoutTimer();
+    return true;
+}
+
+bool IsoTpTransport::isSending(int channel) const
+{
+    return channel >= 0 && size_t(channel) < _channels.size() &&
+           _channels[size_t(channel)]->txState != Channel::TxIdle;
+}
+
+void IsoTpTransport::process(const CanFrame *frames, size_t count)
+{
+    if (count == 0)
+        return;
+    const auto now = Clock::now();
+    for (size_t n = 0; n < count; n++) {
+        const CanFrame &frame = frames[n];
+        if (frame.frameType() != CanFrame::DataFrame || frame.isLocalEcho() || frame.payloadSize() == 0)
+            continue;
+        const auto found = _channelByRxId.find(channelKey(frame.id(), frame.isExtendedId()));
+        if (found != _channelByRxId.end())
+            handleFrame(*_channels[size_t(found->second)], frame, now);
+    }
+}
+
+void IsoTpTransport::handleFrame(Channel &channel, const CanFrame &frame, Clock::time_point now)
+{
+    const auto *d = reinterpret_cast<const uint8_t *>(frame.payload().data());
+    const size_t size = frame.payloadSize();
+
+    switch (d[0] >> 4) {
+        case SingleFrame: {
+            size_t length = d[0] & 0xF;
+            size_t header = 1;
+            if (length == 0 && size > 8) {
+                length = d[1];
+                header = 2;
+            }
+            if (length == 0 || header + length > size)
+                return;
+            if (channel.receiving)
+                failReceive(channel, Interrupted);
+            messageReceived(channel.number, ByteView(frame.payload().data() + header, length));
+            break;
+        }
+        case FirstFrame: {
+            size_t length = size_t(d[0] & 0xF) << 8 | d[1];
+            size_t header = 2;
+            if (length == 0 && size >= 6) {
+                length = size_t(d[2]) << 24 | size_t(d[3]) << 16 | size_t(d[4]) << 8 | d[5];
+                header = 6;
+            }
+            if (size < 8 || length <= size - header)
+                return;
+            startReceive(channel, length, d + header, size - header, now);
+            break;
+        }
+        case ConsecutiveFrame: {
+            if (!channel.receiving)
+                return;
+            if ((d[0] & 0xF) != channel.rxSequence) {
+                failReceive(channel, WrongSequence);
+                return;
+            }
+            const size_t count = std::min(channel.rxLength - channel.rxReceived, size - 1);
+            std::memcpy(channel.rxData.get() + channel.rxReceived, d + 1, count);
+            channel.rxReceived += count;
+            channel.rxSequence = (channel.rxSequence + 1) & 0xF;
+
+            if (channel.rxReceived == channel.rxLength) {
+                channel.receiving = false;
+                _busy--;
+                messageReceived(channel.number, ByteView(channel.rxData.get(), channel.rxLength));
+                return;
+            }
+            channel.rxDeadline = now + std::chrono::milliseconds(TimeoutMs);
+            if (channel.config.blockSize != 0 && ++channel.rxBlockCount == channel.config.blockSize) {
+                channel.rxBlockCount = 0;
+                if (!sendFlowControl(channel, ContinueToSend))
+                    failReceive(channel, TxFailed);
+            }
+            break;
+        }
+        case FlowControl:
+            handleFlowControl(channel, d, size, now);
+            break;
+        default:
+            break;
+    }
+}
+
+void IsoTpTransport::startReceive(Channel &channel, size_t length, const uint8_t *data, size_t size,
+                                  Clock::time_point now)
+{
+    if (channel.receiving)
+        failReceive(channel, Interrupted);
+    if (length > channel.config.maxMessageSize) {
+        sendFlowControl(channel, OverflowAbort);
+        receiveFailed(channel.number, Overflow);
+        return;
+    }
+    if (!sendFlowControl(channel, ContinueToSend)) {
+        receiveFailed(channel.number, TxFailed);
+        return;
+    }
+
+    std::memcpy(channel.rxData.get(), data, size);
+    channel.rxLength = length;
+    channel.rxReceived = size;
+    channel.rxSequence = 1;
+    channel.rxBlockCount = 0;
+    channel.rxDeadline = now + std::chrono::milliseconds(TimeoutMs);
+    channel.receiving = true;
+    if (_busy++ == 0)
+        startTimeoutTimer();
+}
+
+void IsoTpTransport::handleFlowControl(Channel &channel, const uint8_t *data, size_t size, Clock::time_point now)
+{
+    // Flow control is only expected after a first frame or a complete block
+    if (channel.txState != Channel::TxWaitFlowControl)
+        return;
+    if (size < 3) {
+        finishSend(channel, BadFrame);
+        return;
+    }
+
+    switch (data[0] & 0xF) {
+        case ContinueToSend:
+            channel.peerBlockSize = data[1];
+            channel.blockRemaining = data[1];
+            channel.stMin = separationTime(data[2]);
+            channel.waitCount = 0;
+            channel.txState = Channel::TxSending;
+            channel.txDue = now;
+            if (channel.stMin.count() > 0)
+                updatePacer();
+            pump(channel, now);
+            break;
+        case Wait:
+            if (++channel.waitCount > MaxWaitFrames)
+                finishSend(channel, WaitLimit);
+            else
+                channel.txDeadline = now + std::chrono::milliseconds(TimeoutMs);
+            break;
+        case OverflowAbort:
+            finishSend(channel, Overflow);
+            break;
+        default:
+            finishSend(channel, BadFrame);
+            break;
+    }
+}
+
+void IsoTpTransport::pump(Channel &channel, Clock::time_point now)
+{
+    const size_t frameSize = channel.config.frameSize;
+    uint8_t frame[MaxFrameSize];
+
+    while (channel.txState == Channel::TxSending) {
+        // Paced frames go out on the pacer tick nearest their due time
+        if (channel.stMin.count() > 0 && now + _pacerPeriod / 2 < channel.txDue)
+            return;
+
+        const size_t count = std::min(frameSize - 1, channel.txLength - channel.txOffset);
+        frame[0] = uint8_t(ConsecutiveFrame << 4 | channel.txSequence);
+        std::memcpy(frame + 1, channel.txData.get() + channel.txOffset, count);
+        if (!sendFrame(channel, frame, count + 1)) {
+            // Retried when the interface reports transmitted frames, failed after the timeout
+            if (!channel.blocked) {
+                channel.blocked = true;
+                channel.txDeadline = now + std::chrono::milliseconds(TimeoutMs);
+                _blocked++;
+            }
+            return;
+        }
+        if (channel.blocked) {
+            channel.blocked = false;
+            _blocked--;
+        }
+
+        channel.txOffset += count;
+        channel.txSequence = (channel.txSequence + 1) & 0xF;
+        if (channel.txOffset == channel.txLength) {
+            finishSend(channel, Ok);
+            return;
+        }
+        if (channel.peerBlockSize != 0 && --channel.blockRemaining == 0) {
+            const bool paced = channel.stMin.count() > 0;
+            channel.txState = Channel::TxWaitFlowControl;
+            channel.txDeadline = now + std::chrono::milliseconds(TimeoutMs);
+            if (paced)
+                updatePacer();
+            return;
+        }
+        if (channel.stMin.count() > 0) {
+            // Keep to the schedule, but never closer than half the separation time after a late tick
+            channel.txDue = std::max(channel.txDue + channel.stMin, now + channel.stMin / 2);
+        }
+    }
+}
+
+void IsoTpTransport::pace()
+{
+    const auto now = Clock::now();
+    for (auto &channel : _channels) {
+        if (channel->txState == Channel::TxSending && channel->stMin.count() > 0)
+            pump(*channel, now);
+    }
+}
+
+void IsoTpTransport::retryBlocked()
+{
+    const auto now = Clock::now();
+    for (auto &channel : _channels) {
+        if (channel->blocked)
+            pump(*channel, now);
+    }
+}
+
+bool IsoTpTransport::sendFrame(Channel &channel, const uint8_t *data, size_t size)
+{
+    if (_bus == nullptr)
+        return false;
+
+    const IsoTpChannelConfig &config = channel.config;
+    uint8_t padded[MaxFrameSize];
+    size_t length = size;
+    if (config.frameSize > 8)
+        length = fdFrameSize(size);
+    else if (config.padding)
+        length = 8;
+    std::memcpy(padded, data, size);
+    std::memset(padded + size, config.paddingByte, length - size);
+
+    CanFrame frame(config.txId, ByteView(reinterpret_cast<const std::byte *>(padded), length));
+    frame.setExtendedId(config.extendedId);
+    if (config.frameSize > 8)
+        frame.setFD(true);
+    return _bus->send(frame);
+}
+
+bool IsoTpTransport::sendFlowControl(Channel &channel, uint8_t status)
+{
+    const uint8_t frame[3] = {uint8_t(FlowControl << 4 | status), channel.config.blockSize, channel.config.stMin};
+    return sendFrame(channel, frame, sizeof(frame));
+}
+
+void IsoTpTransport::finishSend(Channel &channel, Result result)
+{
+    const bool paced = channel.txState == Channel::TxSending && channel.stMin.count() > 0;
+    if (channel.blocked) {
+        channel.blocked = false;
+        _blocked--;
+    }
+    channel.txState = Channel::TxIdle;
+    _busy--;
+    if (paced)
+        updatePacer();
+    sendFinished(channel.number, result);
+}
+
+void IsoTpTransport::failReceive(Channel &channel, Result result)
+{
+    channel.receiving = false;
+    _busy--;
+    receiveFailed(channel.number, result);
+}
+
+void IsoTpTransport::expireTimeouts(Clock::time_point now)
+{
+    for (auto &channel : _channels) {
+        if (channel->blocked)
+            pump(*channel, now);
+        if (channel->receiving && channel->rxDeadline < now)
+            failReceive(*channel, Timeout);
+        if ((channel->txState == Channel::TxWaitFlowControl || channel->blocked) && channel->txDeadline < now)
+            finishSend(*channel, channel->blocked ? TxFailed : Timeout);
+    }
+    if (_busy == 0 && _timeoutTimer >= 0) {
+        _timerDispatcher->removeTimer(_timeoutTimer);
+        _timeoutTimer = -1;
+    }
+}
+
+datapanel::core::EventDispatcher *IsoTpTransport::dispatcher() const
+{
+    if (_dispatcher != nullptr)
+        return _dispatcher;
+    return _bus != nullptr ? &_bus->eventDispatcher() : nullptr;
+}
+
+void IsoTpTransport::startTimeoutTimer()
+{
+    core::EventDispatcher *target = dispatcher();
+    if (_timeoutTimer >= 0 || target == nullptr)
+        return;
+    _timerDispatcher = target;
+    _timeoutTimer = target->addTimer(TimeoutCheckMs, [this]() { expireTimeouts(Clock::now()); });
+}
+
+void IsoTpTransport::updatePacer()
+{
+    // One timer at the shortest separation time in use serves every paced channel
+    std::chrono::nanoseconds period{0};
+    for (auto &channel : _channels) {
+        if (channel->txState == Channel::TxSending && channel->stMin.count() > 0 &&
+            (period.count() == 0 || channel->stMin < period))
+            period = channel->stMin;
+    }
+    if (period == _pacerPeriod && (_pacer >= 0 || period.count() == 0))
+        return;
+
+    if (_pacer >= 0) {
+        _timerDispatcher->removeTimer(_pacer);
+        _pacer = -1;
+    }
+    _pacerPeriod = period;
+    core::EventDispatcher *target = dispatcher();
+    if (period.count() == 0 || target == nullptr)
+        return;
+    _timerDispatcher = target;
+    _pacer = target->addTimer(period, [this]() { pace(); });
+}
+
+void IsoTpTransport::stopTimers()
+{
+    if (_timeoutTimer >= 0)
+        _timerDispatcher->removeTimer(_timeoutTimer);
+    if (_pacer >= 0)
+        _timerDispatcher->removeTimer(_pacer);
+    _timeoutTimer = -1;
+    _pacer = -1;
+    _pacerPeriod = std::chrono::nanoseconds(0);
+}
@@ -0,0 +1,375 @@
+/**
+ * Copyright (c) 2026 Data Panel Corporation
+ * 181 Cheshire Ln, Suite 300
+ * Plymouth, MN 55441
+ * All rights reserved.
+ *
+ * This is the confidential and proprietary information of Data Panel
+ * Corporation. Such confidential information shall not be disclosed and is for
+ * use only in accordance with the license agreement you entered into with Data
+ * Panel.
+ */
+
+/**
+ * @file J1939Transport.cpp
+ * @date 2026-10-16
+ */
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+
+#include "dplib/core/EventDispatcher.h"
+#include "dplib/net/j1939/J1939Transport.h"
+
+using namespace datapanel::net::j1939;
+using datapanel::net::can::CanFrame;
+using datapanel::net::can::CanInterface;
+using datapanel::util::ByteView;
+
+namespace
+{
+constexpr size_t BytesPerPacket = 7;
+
+/** TP.CM control bytes */
+enum Control : uint8_t {
+    Rts = 16,
+    Cts = 17,
+    EndOfMsgAck = 19,
+    Bam = 32,
+    Abort = 255,
+};
+
+inline uint16_t sessionKey(uint8_t source, uint8_t destination)
+{
+    return uint16_t(source << 8 | destination);
+}
+}  // namespace
+
+struct J1939Transport::Session {
+    uint16_t key = 0;
+    bool active = false;
+    bool broadcast = false;
+    bool answering = false; /**< We are the receiver and send CTS */
+    uint8_t priority = 7;
+    Pgn pgn = 0;
+    uint16_t size = 0;
+    uint8_t packets = 0;
+    uint8_t nextSequence = 1;
+    uint8_t windowSize = 0; /**< Packets per CTS the sender accepts */
+    uint8_t windowEnd = 0;  /**< Last packet of the current CTS window */
+    std::chrono::steady_clock::time_point deadline;
+    std::array<std::byte, MaxMessageSize> data;
+};
+
+J1939Transport::J1939Transport(size_t maxSessions)
+    : _sessions(std::min<size_t>(std::max<size_t>(maxSessions, 1), 0xFFFF)), _index(new uint16_t[0x10000]())
+{
+    _free.reserve(_sessions.size());
+    for (size_t n = _sessions.size(); n > 0; n--) _free.push_back(uint16_t(n - 1));
+}
+
+J1939Transport::~J1939Transport()
+{
+    _connection.disconnect();
+    stopTimer();
+}
+
+void J1939Transport::setEventDispatcher(core::EventDispatcher *dispatcher)
+{
+    stopTimer();
+    _dispatcher = dispatcher;
+    if (_activeCount > 0)
+        startTimer();
+}
+
+void J1939Transport::attach(CanInterface &source)
+{
+    detach();
+    _bus = &source;
+    if (_activeCount > 0)
+        startTimer();
+    _connection = source.framesTapped.connect([this](const CanFrame *frames, size_t count) { process(frames, count); });
+}
+
+void J1939Transport::detach()
+{
+    _connection.disconnect();
+    stopTimer();
+    _bus = nullptr;
+    if (_activeCount > 0)
+        startTimer();
+}
+
+void J1939Transport::process(const CanFrame *frames, size_t count)
+{
+    if (count == 0)
+        return;
+    const auto now = std::chrono::steady_clock::now();
+    for (size_t n = 0; n < count; n++) handleFrame(frames[n], now);
+}
+
+void J1939Transport::handleFrame(const CanFrame &frame, std::chrono::steady_clock::time_point now)
+{
+    if (frame.frameType() != CanFrame::DataFrame || !frame.isExtendedId() || frame.isLocalEcho())
+        return;
+
+    const J1939Id id = J1939Id::decode(uint32_t(frame.id()));
+    if (id.pgn == PgnTpCm) {
+        handleConnection(id, frame, now);
+    } else if (id.pgn == PgnTpDt) {
+        handleTransfer(id, frame, now);
+    } else {
+        J1939Message message;
+        message.pgn = id.pgn;
+        message.priority = id.priority;
+        message.source = id.source;
+        message.destination = id.destination;
+        message.timestampNs = frame.timestampNs();
+        message.data = frame.payload();
+        _stats.messages++;
+        messageReceived(message);
+    }
+}
+
+void J1939Transport::handleConnection(const J1939Id &id, const CanFrame &frame,
+                                      std::chrono::steady_clock::time_point now)
+{
+    if (frame.payloadSize() < 8)
+        return;
+    const auto *d = reinterpret_cast<const uint8_t *>(frame.payload().data());
+    const Pgn pgn = d[5] | uint32_t(d[6]) << 8 | uint32_t(d[7] & 0x03) << 16;
+
+    switch (d[0]) {
+        case Rts:
+        case Bam: {
+            const bool broadcast = d[0] == Bam;
+            if (broadcast != (id.destination == GlobalAddress))
+                return;
+            const bool answering = !broadcast && _bus != nullptr && _address != NullAddress &&
+                                   id.destination == _address;
+            const uint16_t size = uint16_t(d[1] | d[2] << 8);
+            const uint8_t packets = d[3];
+            if (size <= 8 || size > MaxMessageSize || packets != (size + BytesPerPacket - 1) / BytesPerPacket) {
+                if (answering) {
+                    const uint8_t abort[8] = {Abort, BadSize, 0xFF, 0xFF, 0xFF, d[5], d[6], d[7]};
+                    sendConnection(id.source, abort);
+                }
+                return;
+            }
+
+            // A new announcement replaces an unfinished transfer between the same nodes
+            const uint16_t key = sessionKey(id.source, id.destination);
+            if (Session *old = findSession(key))
+                closeSession(*old);
+            Session *session = openSession(key);
+            if (session == nullptr) {
+                _stats.noSession++;
+                if (answering) {
+                    const uint8_t abort[8] = {Abort, NoResources, 0xFF, 0xFF, 0xFF, d[5], d[6], d[7]};
+                    sendConnection(id.source, abort);
+                }
+                return;
+            }
+            session->broadcast = broadcast;
+            session->answering = answering;
+            session->priority = id.priority;
+            session->pgn = pgn;
+            session->size = size;
+            session->packets = packets;
+            session->nextSequence = 1;
+            session->windowSize = broadcast || d[4] == 0 ? 0xFF : d[4];
+            session->windowEnd = packets;
+            session->deadline = now + std::chrono::milliseconds(broadcast ? T1Ms : T2Ms);
+            if (answering)
+                sendCts(*session);
+            break;
+        }
+        case Cts: {
+            // Another node's connection: the receiver tells the sender which packets to send next
+            Session *session = findSession(sessionKey(id.destination, id.source));
+            if (session == nullptr || session->answering)
+                return;
+            if (d[1] > 0 && d[2] >= 1 && d[2] <= session->nextSequence)
+                session->nextSequence = d[2];
+            session->deadline = now + std::chrono::milliseconds(T2Ms);
+            break;
+        }
+        case Abort: {
+            for (const uint16_t key : {sessionKey(id.source, id.destination), sessionKey(id.destination, id.source)}) {
+                if (Session *session = findSession(key); session != nullptr && !session->broadcast)
+                    abortSession(*session, PeerAbort, false);
+            }
+            break;
+        }
+        case EndOfMsgAck:
+        default:
+            break;
+    }
+}
+
+void J1939Transport::handleTransfer(const J1939Id &id, const CanFrame &frame,
+                                    std::chrono::steady_clock::time_point now)
+{
+    Session *session = findSession(sessionKey(id.source, id.destination));
+    if (session == nullptr || frame.payloadSize() < 2) {
+        _stats.strayTransfers++;
+        return;
+    }
+
+    const auto *d = reinterpret_cast<const uint8_t *>(frame.payload().data());
+    const uint8_t sequence = d[0];
+    if (sequence != session->nextSequence) {
+        // Repeats are expected after a retransmission request
+        if (sequence < session->nextSequence)
+            return;
+        abortSession(*session, BadSequence, true);
+        return;
+    }
+
+    const size_t offset = (sequence - 1) * BytesPerPacket;
+    const size_t length = std::min({BytesPerPacket, session->size - offset, frame.payloadSize() - 1});
+    std::memcpy(session->data.data() + offset, d + 1, length);
+    session->nextSequence++;
+
+    if (sequence == session->packets) {
+        if (session->answering) {
+            const uint8_t ack[8] = {EndOfMsgAck,
+                                    uint8_t(session->size),
+                                    uint8_t(session->size >> 8),
+                                    session->packets,
+                                    0xFF,
+                                    uint8_t(session->pgn),
+                                    uint8_t(session->pgn >> 8),
+                                    uint8_t(session->pgn >> 16)};
+            sendConnection(id.source, ack);
+        }
+
+        J1939Message message;
+        message.pgn = session->pgn;
+        message.priority = session->priority;
+        message.source = id.source;
+        message.destination = id.destination;
+        message.timestampNs = frame.timestampNs();
+        message.data = ByteView(session->data.data(), session->size);
+        _stats.messages++;
+        _stats.transfers++;
+        messageReceived(message);
+        closeSession(*session);
+        return;
+    }
+
+    session->deadline = now + std::chrono::milliseconds(T1Ms);
+    if (session->answering && sequence == session->windowEnd) {
+        sendCts(*session);
+        session->deadline = now + std::chrono::milliseconds(T2Ms);
+    }
+}
+
+void J1939Transport::expireSessions(std::chrono::steady_clock::time_point now)
+{
+    for (Session &session : _sessions) {
+        if (session.active && session.deadline < now) {
+            _stats.timeouts++;
+            abortSession(session, Timeout, true);
+        }
+    }
+    if (_activeCount == 0)
+        stopTimer();
+}
+
+J1939Transport::Session *J1939Transport::openSession(uint16_t key)
+{
+    if (_free.empty())
+        return nullptr;
+    const uint16_t n = _free.back();
+    _free.pop_back();
+    _index[key] = uint16_t(n + 1);
+
+    Session &session = _sessions[n];
+    session.key = key;
+    session.active = true;
+    if (++_activeCount == 1)
+        startTimer();
+    return &session;
+}
+
+J1939Transport::Session *J1939Transport::findSession(uint16_t key)
+{
+    const uint16_t n = _index[key];
+    return n == 0 ? nullptr : &_sessions[n - 1];
+}
+
+void J1939Transport::closeSession(Session &session)
+{
+    _index[session.key] = 0;
+    session.active = false;
+    _free.push_back(uint16_t(&session - _sessions.data()));
+    // The timer stops at its next expiry if nothing else is in progress
+    _activeCount--;
+}
+
+void J1939Transport::abortSession(Session &session, AbortReason reason, bool notifyPeer)
+{
+    const uint8_t source = uint8_t(session.key >> 8);
+    const uint8_t destination = uint8_t(session.key);
+    const Pgn pgn = session.pgn;
+    if (notifyPeer && session.answering) {
+        const uint8_t abort[8] = {Abort, reason, 0xFF, 0xFF, 0xFF, uint8_t(pgn), uint8_t(pgn >> 8), uint8_t(pgn >> 16)};
+        sendConnection(source, abort);
+    }
+    _stats.aborted++;
+    closeSession(session);
+    transferAborted(source, destination, pgn, reason);
+}
+
+void J1939Transport::sendConnection(uint8_t destination, const uint8_t *data)
+{
+    if (_bus == nullptr || _address == NullAddress)
+        return;
+    J1939Id id;
+    id.priority = 7;
+    id.pgn = PgnTpCm;
+    id.source = _address;
+    id.destination = destination;
+    CanFrame frame(id.encode(), ByteView(reinterpret_cast<const std::byte *>(data), 8));
+    frame.setExtendedId(true);
+    _bus->send(frame);
+}
+
+void J1939Transport::sendCts(Session &session)
+{
+    const uint8_t count = uint8_t(std::min<int>(session.windowSize, session.packets - session.nextSequence + 1));
+    session.windowEnd = uint8_t(session.nextSequence + count - 1);
+    const uint8_t cts[8] = {Cts,
+                            count,
+                            session.nextSequence,
+                            0xFF,
+                            0xFF,
+                            uint8_t(session.pgn),
+                            uint8_t(session.pgn >> 8),
+                            uint8_t(session.pgn >> 16)};
+    sendConnection(uint8_t(session.key >> 8), cts);
+}
+
+void J1939Transport::startTimer()
+{
+    if (_timer >= 0)
+        return;
+    core::EventDispatcher *dispatcher = _dispatcher;
+    if (dispatcher == nullptr && _bus != nullptr)
+        dispatcher = &_bus->eventDispatcher();
+    if (dispatcher == nullptr)
+        return;
+    _timerDispatcher = dispatcher;
+    _timer = dispatcher->addTimer(TimeoutCheckMs, [this]() { expireSessions(std::chrono::steady_clock::now()); });
+}
+
+void J1939Transport::stopTimer()
+{
+    if (_timer < 0)
+        return;
+    _timerDispatcher->removeTimer(_timer);
+    _timer = -1;
+    _timerDispatcher = nullptr;
+}
@@ -1,6 +1,6 @@
 #include "dplib/util/hexdump.h"
 
-#include <fmt/format.h>
+#include <cstring>
 
 /**
  * @example hexdump.cpp
@@ -15,11 +15,59 @@
  * @endcode
  */
 
-std::string datapanel::util::hexdump(const std::vector<std::byte>& data, const std::string& sep) {
-    auto out = fmt::memory_buffer();
-    for (auto i=std::begin(data); i < std::end(data); ++i) {
-        fmt::format_to(std::back_inserter(out),"{:02X}{}", *i, i == (std::end(data)-1) ? "": sep);
+namespace
+{
+/** Two uppercase hex digits for every byte value */
+struct HexPairs {
+    char digits[512];
+
+    constexpr HexPairs() : digits{}
+    {
+        constexpr char hex[] = "0123456789ABCDEF";
+        for (int n = 0; n < 256; n++) {
+            digits[2 * n] = hex[n >> 4];
+            digits[2 * n + 1] = hex[n & 0xF];
+        }
+    }
+};
+
+constexpr HexPairs Pairs;
+
+inline char *putPair(char *out, std::byte value) noexcept
+{
+    std::memcpy(out, &Pairs.digits[2 * size_t(value)], 2);
+    return out + 2;
+}
+}  // namespace
+
+char *datapanel::util::hexdumpTo(ByteView data, char *out, std::string_view sep) noexcept
+{
+    const size_t size = data.size();
+    if (size == 0)
+        return out;
+
+    const std::byte *p = data.data();
+    out = putPair(out, p[0]);
+    if (sep.empty()) {
+        for (size_t i = 1; i < size; i++) out = putPair(out, p[i]);
+    } else if (sep.size() == 1) {
+        const char c = sep[0];
+        for (size_t i = 1; i < size; i++) {
+            *out++ = c;
+            out = putPair(out, p[i]);
+        }
+    } else {
+        for (size_t i = 1; i < size; i++) {
+            std::memcpy(out, sep.data(), sep.size());
+            out = putPair(out + sep.size(), p[i]);
+        }
     }
+    return out;
+}
 
-    return fmt::to_string(out);
+std::string datapanel::util::hexdump(ByteView data, const std::string &sep)
+{
+    std::string out(hexdumpLength(data.size(), sep.size()), '\0');
+    hexdumpTo(data, out.data(), sep);
+    return out;
 }
@@ -0,0 +1,179 @@
+/**
+ * Copyright (c) 2026 Data Panel Corporation
+ * 181 Cheshire Ln, Suite 300
+ * Plymouth, MN 55441
+ * All rights reserved.
+ *
+ * This is the confidential and proprietary information of Data Panel
+ * Corporation. Such confidential information shall not be disclosed and is for
+ * use only in accordance with the license agreement you entered into with Data
+ * Panel.
+ */
+
+/**
+ * @file lz4.cpp
+ * @date 2026-10-16
+ */
+
+#include "dplib/util/lz4.h"
+
+#include <cstdint>
+#include <cstring>
+
+namespace
+{
+constexpr size_t MinMatch = 4;
+constexpr size_t LastLiterals = 5;  // The last five bytes of a block are always literals
+constexpr size_t MatchLimit = 12;   // No match may start within the last twelve bytes
+constexpr size_t MaxOffset = 65535;
+constexpr int HashBits = 12;
+
+inline uint32_t read32(const std::byte *p) noexcept
+{
+    uint32_t v;
+    std::memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+inline uint32_t hash(uint32_t v) noexcept
+{
+    return (v * 2654435761u) >> (32 - HashBits);
+}
+
+/** Append a length continuation: 255 while more remains, then the remainder */
+inline std::byte *putLength(std::byte *op, size_t length) noexcept
+{
+    for (; length >= 255; length -= 255) *op++ = std::byte(255);
+    *op++ = std::byte(length);
+    return op;
+}
+
+/** Append one sequence, or only literals if @p matchLength is 0; nullptr if it does not fit */
+std::byte *putSequence(std::byte *op, std::byte *end, const std::byte *literals, size_t literalLength, size_t offset,
+                       size_t matchLength) noexcept
+{
+    const size_t worst = 1 + literalLength / 255 + 1 + literalLength + 2 + matchLength / 255 + 1;
+    if (size_t(end - op) < worst)
+        return nullptr;
+
+    std::byte *token = op++;
+    uint8_t bits = uint8_t((literalLength < 15 ? literalLength : 15) << 4);
+    if (literalLength >= 15)
+        op = putLength(op, literalLength - 15);
+    std::memcpy(op, literals, literalLength);
+    op += literalLength;
+
+    if (matchLength != 0) {
+        *op++ = std::byte(offset & 0xFF);
+        *op++ = std::byte(offset >> 8);
+        const size_t extra = matchLength - MinMatch;
+        bits |= uint8_t(extra < 15 ? extra : 15);
+        if (extra >= 15)
+            op = putLength(op, extra - 15);
+    }
+    *token = std::byte(bits);
+    return op;
+}
+
+/** Read a length continuation; false if it runs past @p end */
+inline bool getLength(const std::byte *&ip, const std::byte *end, size_t &length) noexcept
+{
+    uint8_t b;
+    do {
+        if (ip >= end)
+            return false;
+        b = uint8_t(*ip++);
+        length += b;
+    } while (b == 255);
+    return true;
+}
+}  // namespace
+
+size_t datapanel::util::lz4Compress(const std::byte *src, size_t size, std::byte *dst, size_t capacity) noexcept
+{
+    std::byte *op = dst;
+    std::byte *const end = dst + capacity;
+    size_t anchor = 0;
+
+    if (size > MatchLimit) {
+        uint32_t table[1 << HashBits] = {};
+        const size_t searchEnd = size - MatchLimit;
+        const size_t extendEnd = size - LastLiterals;
+
+        size_t ip = 1;
+        while (ip < searchEnd) {
+            const uint32_t v = read32(src + ip);
+            const uint32_t h = hash(v);
+            const size_t ref = table[h];
+            table[h] = uint32_t(ip);
+
+            if (ip - ref > MaxOffset || read32(src + ref) != v) {
+                // Skip faster through data that does not compress
+                ip += 1 + ((ip - anchor) >> 6);
+                continue;
+            }
+
+            size_t length = MinMatch;
+            while (ip + length < extendEnd && src[ref + length] == src[ip + length]) length++;
+
+            op = putSequence(op, end, src + anchor, ip - anchor, ip - ref, length);
+            if (op == nullptr)
+                return 0;
+
+            ip += length;
+            anchor = ip;
+            if (ip < searchEnd)
+                table[hash(read32(src + ip - 2))] = uint32_t(ip - 2);
+        }
+    }
+
+    op = putSequence(op, end, src + anchor, size - anchor, 0, 0);
+    return op == nullptr ? 0 : size_t(op - dst);
+}
+
+size_t datapanel::util::lz4Decompress(const std::byte *src, size_t size, std::byte *dst, size_t capacity) noexcept
+{
+    const std::byte *ip = src;
+    const std::byte *const ipEnd = src + size;
+    size_t op = 0;
+
+    while (ip < ipEnd) {
+        const uint8_t token = uint8_t(*ip++);
+
+        size_t literalLength = token >> 4;
+        if (literalLength == 15 && !getLength(ip, ipEnd, literalLength))
+            return 0;
+        if (literalLength > size_t(ipEnd - ip) || literalLength > capacity - op)
+            return 0;
+        std::memcpy(dst + op, ip, literalLength);
+        ip += literalLength;
+        op += literalLength;
+
+        // The last sequence has no match
+        if (ip == ipEnd)
+            break;
+
+        if (ipEnd - ip < 2)
+            return 0;
+        const size_t offset = size_t(uint8_t(ip[0])) | size_t(uint8_t(ip[1])) << 8;
+        ip += 2;
+        if (offset == 0 || offset > op)
+            return 0;
+
+        size_t matchLength = token & 15;
+        if (matchLength == 15 && !getLength(ip, ipEnd, matchLength))
+            return 0;
+        matchLength += MinMatch;
+        if (matchLength > capacity - op)
+            return 0;
+
+        // Matches may overlap their own output
+        if (offset >= matchLength) {
+            std::memcpy(dst + op, dst + op - offset, matchLength);
+        } else {
+            for (size_t i = 0; i < matchLength; i++) dst[op + i] = dst[op - offset + i];
+        }
+        op += matchLength;
+    }
+    return op;
+}
@@ -0,0 +1,198 @@
+#include <doctest/doctest.h>
+#include <dplib/core/EventDispatcher.h>
+#include <dplib/net/can/CanInterface.h>
+#include <dplib/net/can/SocketCanBackend.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+#include <linux/can.h>
+#include <net/if.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+using namespace datapanel;
+using namespace datapanel::net::can;
+
+#if defined(__GNUC__) && !defined(__clang__)
+// The replacement operators below pair malloc with free, which GCC cannot see through
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+
+// Count every allocation made by this test binary while counting is enabled
+static std::atomic<bool> countAllocations{false};
+static std::atomic<uint64_t> allocations{0};
+
+void *operator new(std::size_t size)
+{
+    if (countAllocations.load(std::memory_order_relaxed))
+        allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void *ptr = std::malloc(size ? size : 1))
+        return ptr;
+    throw std::bad_alloc();
+}
+
+void *operator new[](std::size_t size)
+{
+    return ::operator new(size);
+}
+
+void operator delete(void *ptr) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete[](void *ptr) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete(void *ptr, std::size_t) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete[](void *ptr, std::size_t) noexcept
+{
+    std::free(ptr);
+}
+
+namespace
+{
+class AllocationCounter
+{
+  public:
+    AllocationCounter()
+    {
+        allocations = 0;
+        countAllocations = true;
+    }
+    ~AllocationCounter()
+    {
+        countAllocations = false;
+    }
+    uint64_t count() const
+    {
+        return allocations.load();
+    }
+};
+}  // namespace
+
+namespace datapanel
+{
+namespace net
+{
+namespace can
+{
+/** Runs SocketCanBackend's receive path on a socketpair, which needs no CAN interface */
+class SocketCanBackendTest
+{
+  public:
+    static std::unique_ptr<SocketCanBackend> adopt(int socket, core::EventDispatcher &dispatcher)
+    {
+        std::unique_ptr<SocketCanBackend> bus(new SocketCanBackend("socketpair"));
+        bus->setEventDispatcher(&dispatcher);
+        bus->_socket = socket;
+        bus->setupRxBuffers();
+        bus->setState(CanInterface::ConnectedState);
+        return bus;
+    }
+
+    static void readSocket(SocketCanBackend &bus)
+    {
+        bus.readSocket();
+    }
+};
+}  // namespace can
+}  // namespace net
+}  // namespace datapanel
+
+TEST_CASE("rxalloc-in-place-decode")
+{
+    int fds[2];
+    REQUIRE(::socketpair(AF_UNIX, SOCK_SEQPACKET, 0, fds) == 0);
+    core::EventDispatcher dispatcher;
+    auto bus = SocketCanBackendTest::adopt(fds[0], dispatcher);
+
+    // The socketpair rejects kernel filters, so frames take the software filter path
+    bus->setRxFilters({CanFilter{0x100, 0x7F0}});
+
+    can_frame raw{};
+    raw.can_dlc = 8;
+
+    CanFrame frame;
+    AllocationCounter counter;
+    for (int batch = 0; batch < 100; batch++) {
+        for (int n = 0; n < 64; n++) {
+            raw.can_id = 0x100 + (n & 0xFF);
+            if (::write(fds[1], &raw, sizeof(raw)) != sizeof(raw))
+                break;
+        }
+        SocketCanBackendTest::readSocket(*bus);
+        while (bus->countRxPending() > 0) frame = bus->recv();
+    }
+    const uint64_t count = counter.count();
+    CHECK(count == 0);
+    CHECK(bus->ioStatistics().rxFrames == 100 * 64);
+    CHECK(frame.id() >= 0x100);
+    CHECK(frame.id() < 0x110);
+
+    ::close(fds[1]);
+}
+
+TEST_CASE("rxalloc-socketcan")
+{
+    // Requires a virtual CAN interface: ip link add dev vcan0 type vcan && ip link set up vcan0
+    core::EventDispatcher dispatcher;
+    auto bus = SocketCanBackend::init("vcan0");
+    bus->setEventDispatcher(&dispatcher);
+    if (!bus->connect()) {
+        MESSAGE("vcan0 not available, skipping");
+        return;
+    }
+
+    const int tx = ::socket(PF_CAN, SOCK_RAW, CAN_RAW);
+    REQUIRE(tx >= 0);
+    sockaddr_can addr{};
+    addr.can_family = AF_CAN;
+    addr.can_ifindex = ::if_nametoindex("vcan0");
+    REQUIRE(::bind(tx, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) == 0);
+
+    can_frame raw{};
+    raw.can_id = 0x123;
+    raw.can_dlc = 8;
+
+    // Keeps processEvents() from waiting indefinitely if frames go missing
+    const int tick = dispatcher.addTimer(5, []() {});
+
+    const auto exchange = [&](int count) {
+        for (int n = 0; n < count; n++) CHECK(::write(tx, &raw, sizeof(raw)) == sizeof(raw));
+        const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(2);
+        size_t received = 0;
+        while (received < static_cast<size_t>(count) && std::chrono::steady_clock::now() < deadline) {
+            dispatcher.processEvents();
+            CanFrame frame;
+            while (bus->countRxPending() > 0) {
+                frame = bus->recv();
+                received++;
+            }
+        }
+        return received;
+    };
+
+    // Warm up so one-time buffers are allocated before counting
+    CHECK(exchange(64) == 64);
+
+    AllocationCounter counter;
+    const size_t received = exchange(256);
+    const uint64_t count = counter.count();
+    CHECK(count == 0);
+    CHECK(received == 256);
+
+    dispatcher.removeTimer(tick);
+    bus->disconnect();
+    ::close(tx);
+}
@@ -0,0 +1,319 @@
+#include <doctest/doctest.h>
+#include <dplib/net/can/CanCapture.h>
+
+#include <algorithm>
+#include <csignal>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <sys/resource.h>
+#include <unistd.h>
+
+#include "testutil.h"
+
+using datapanel::net::can::CanCaptureChunk;
+using datapanel::net::can::CanCaptureFilter;
+using datapanel::net::can::CanCaptureReader;
+using datapanel::net::can::CanCaptureWriter;
+using datapanel::net::can::CanFrame;
+
+static std::string capturePath(const char *test)
+{
+    return "/tmp/" + std::string(test) + "-" + std::to_string(::getpid()) + ".dpcap";
+}
+
+/** One frame per millisecond, cycling through eight identifiers */
+static std::vector<CanFrame> makeFrames(size_t count, int64_t startNs = 1000000000)
+{
+    std::vector<CanFrame> frames;
+    for (size_t n = 0; n < count; n++) {
+        CanFrame frame(0x100 + (n % 8), std::vector<std::byte>(n % 9, std::byte(n & 0xFF)));
+        frame.setTimestampNs(startNs + int64_t(n) * 1000000);
+        frames.push_back(frame);
+    }
+    return frames;
+}
+
+static std::vector<CanFrame> readAll(CanCaptureReader &reader)
+{
+    std::vector<CanFrame> frames;
+    CanFrame frame;
+    while (reader.next(frame)) frames.push_back(frame);
+    return frames;
+}
+
+static std::vector<char> readFile(const std::string &path)
+{
+    FILE *f = std::fopen(path.c_str(), "rb");
+    std::vector<char> bytes(1 << 20);
+    bytes.resize(std::fread(bytes.data(), 1, bytes.size(), f));
+    std::fclose(f);
+    return bytes;
+}
+
+static void writeFile(const std::string &path, const std::vector<char> &bytes)
+{
+    FILE *f = std::fopen(path.c_str(), "wb");
+    std::fwrite(bytes.data(), 1, bytes.size(), f);
+    std::fclose(f);
+}
+
+template <typename T> static void patch(std::vector<char> &bytes, size_t offset, T value)
+{
+    std::memcpy(bytes.data() + offset, &value, sizeof(value));
+}
+
+static bool sameFrame(const CanFrame &a, const CanFrame &b)
+{
+    return a.frameType() == b.frameType() && a.id() == b.id() && a.error() == b.error() &&
+           a.isExtendedId() == b.isExtendedId() && a.isFD() == b.isFD() &&
+           a.isBitrateSwitch() == b.isBitrateSwitch() && a.isErrorState() == b.isErrorState() &&
+           a.isLocalEcho() == b.isLocalEcho() && a.timestampNs() == b.timestampNs() && a.payloadSize() == b.payloadSize() &&
+           std::equal(a.payload().begin(), a.payload().end(), b.payload().begin());
+}
+
+TEST_CASE("cancapture-roundtrip")
+{
+    std::vector<CanFrame> frames;
+    CanFrame extended(0x18FEF100, std::vector<std::byte>(8, std::byte(0xA5)));
+    extended.setTimestampNs(5);
+    frames.push_back(extended);
+
+    CanFrame fd(0x7FF, std::vector<std::byte>(64, std::byte(0x3C)));
+    fd.setBitrateSwitch(true);
+    fd.setErrorState(true);
+    fd.setLocalEcho(true);
+    fd.setTimestampNs(3);  // Out of order
+    frames.push_back(fd);
+
+    CanFrame remote(CanFrame::RemoteRequestFrame);
+    remote.setId(0x55);
+    remote.setTimestampNs(-20);
+    frames.push_back(remote);
+
+    CanFrame error(CanFrame::ErrorFrame);
+    error.setError(CanFrame::FrameError(CanFrame::BusError | CanFrame::NoAckError));
+    error.setTimestampNs(1700000000123456789);
+    frames.push_back(error);
+
+    for (auto compression : {CanCaptureChunk::None, CanCaptureChunk::Lz4}) {
+        const std::string path = capturePath("cancapture-roundtrip");
+        CanCaptureWriter writer;
+        REQUIRE(writer.open(path, compression));
+        CHECK(writer.write(frames.data(), frames.size()));
+        CHECK(writer.close());
+
+        CanCaptureReader reader;
+        REQUIRE(reader.open(path));
+        CHECK_FALSE(reader.isRecovered());
+        CHECK(reader.frameCount() == frames.size());
+        CHECK(reader.startNs() == -20);
+        CHECK(reader.endNs() == 1700000000123456789);
+
+        const auto read = readAll(reader);
+        REQUIRE(read.size() == frames.size());
+        for (size_t i = 0; i < frames.size(); i++) CHECK(sameFrame(read[i], frames[i]));
+        std::remove(path.c_str());
+    }
+}
+
+TEST_CASE("cancapture-compression")
+{
+    const std::string path = capturePath("cancapture-compression");
+    // Periodic traffic where most payload bytes repeat from one cycle to the next
+    auto frames = makeFrames(20000);
+    for (size_t n = 0; n < frames.size(); n++) {
+        std::vector<std::byte> payload(8, std::byte(0x20 + n % 8));
+        payload[0] = std::byte(n / 8 % 16);
+        frames[n].setPayload(payload);
+    }
+
+    CanCaptureWriter writer;
+    REQUIRE(writer.open(path, CanCaptureChunk::Lz4, 16384));
+    CHECK(writer.write(frames.data(), frames.size()));
+    CHECK(writer.close());
+    CHECK(writer.chunksWritten() > 1);
+
+    CanCaptureReader reader;
+    REQUIRE(reader.open(path));
+    size_t raw = 0, stored = 0;
+    for (size_t i = 0; i < reader.chunkCount(); i++) {
+        CHECK(reader.chunk(i).compression == CanCaptureChunk::Lz4);
+        raw += reader.chunk(i).rawSize;
+        stored += reader.chunk(i).storedSize;
+    }
+    CHECK(stored < raw / 2);
+    CHECK(raw < frames.size() * 16);
+
+    const auto read = readAll(reader);
+    REQUIRE(read.size() == frames.size());
+    CHECK(sameFrame(read.back(), frames.back()));
+    std::remove(path.c_str());
+}
+
+TEST_CASE("cancapture-seek-and-filter")
+{
+    const std::string path = capturePath("cancapture-seek");
+    const int64_t start = 1000000000;
+    const auto frames = makeFrames(10000, start);
+
+    CanCaptureWriter writer;
+    REQUIRE(writer.open(path, CanCaptureChunk::Lz4, 4096));
+    CHECK(writer.write(frames.data(), frames.size()));
+    // A chunk holding only an identifier nobody else uses
+    CanFrame rare(0x18DA00F1, std::vector<std::byte>(8));
+    rare.setTimestampNs(start + 10000 * 1000000LL);
+    CHECK(writer.flush());
+    CHECK(writer.write(rare));
+    CHECK(writer.close());
+
+    CanCaptureReader reader;
+    REQUIRE(reader.open(path));
+    const size_t chunks = reader.chunkCount();
+    REQUIRE(chunks > 10);
+
+    // Seeking to the last second only decodes the chunks that overlap it
+    reader.seek(start + 9000 * 1000000LL);
+    auto read = readAll(reader);
+    REQUIRE(read.size() == 1001);
+    CHECK(read.front().timestampNs() == start + 9000 * 1000000LL);
+    CHECK(reader.chunksDecoded() < chunks / 5);
+
+    // Time window, end exclusive
+    reader.setFilter({start + 100 * 1000000LL, start + 200 * 1000000LL, {}});
+    read = readAll(reader);
+    CHECK(read.size() == 100);
+
+    // Identifier filter
+    reader.setFilter({INT64_MIN, INT64_MAX, {0x103}});
+    read = readAll(reader);
+    CHECK(read.size() == 1250);
+    for (const CanFrame &frame : read) CHECK(frame.id() == 0x103);
+
+    // The bloom filters rule out every chunk but the one holding the identifier
+    const uint64_t decoded = reader.chunksDecoded();
+    reader.setFilter({INT64_MIN, INT64_MAX, {0x18DA00F1}});
+    read = readAll(reader);
+    REQUIRE(read.size() == 1);
+    CHECK(read[0].isExtendedId());
+    CHECK(reader.chunksDecoded() - decoded < 3);
+    std::remove(path.c_str());
+}
+
+TEST_CASE("cancapture-recover-unfinished")
+{
+    const std::string path = capturePath("cancapture-recover");
+    const auto frames = makeFrames(3000);
+
+    {
+        CanCaptureWriter writer;
+        REQUIRE(writer.open(path, CanCaptureChunk::Lz4, 4096));
+        CHECK(writer.write(frames.data(), frames.size()));
+        CHECK(writer.close());
+    }
+
+    // Cut the file inside its last chunk, as if the writer had crashed
+    CanCaptureReader full;
+    REQUIRE(full.open(path));
+    const size_t chunks = full.chunkCount();
+    uint64_t keep = 0;
+    for (size_t i = 0; i + 1 < chunks; i++) keep += full.chunk(i).frameCount;
+    full.close();
+    {
+        FILE *f = std::fopen(path.c_str(), "rb");
+        std::vector<char> bytes(1 << 20);
+        bytes.resize(std::fread(bytes.data(), 1, bytes.size(), f));
+        std::fclose(f);
+        REQUIRE(::truncate(path.c_str(), off_t(bytes.size() - chunks * 80 - 16 - 10)) == 0);
+    }
+
+    CanCaptureReader reader;
+    REQUIRE(reader.open(path));
+    CHECK(reader.isRecovered());
+    CHECK(reader.chunkCount() == chunks - 1);
+    CHECK(readAll(reader).size() == keep);
+    std::remove(path.c_str());
+
+    CHECK_FALSE(reader.open(path));
+}
+
+TEST_CASE("cancapture-corrupt-index")
+{
+    const std::string path = capturePath("cancapture-corrupt");
+    auto frames = makeFrames(1000);
+    for (CanFrame &frame : frames) frame.setPayload(std::vector<std::byte>(8, std::byte(0x55)));
+    {
+        CanCaptureWriter writer;
+        REQUIRE(writer.open(path));
+        CHECK(writer.write(frames.data(), frames.size()));
+        CHECK(writer.close());
+    }
+    const std::vector<char> good = readFile(path);
+    // One chunk, then its 80-byte index entry and the 16-byte trailer
+    const size_t entry = good.size() - 16 - 80;
+    const size_t trailer = good.size() - 16;
+    CanCaptureReader reader;
+    REQUIRE(reader.open(path));
+    REQUIRE(reader.chunkCount() == 1);
+    REQUIRE(reader.chunk(0).compression == CanCaptureChunk::Lz4);
+
+    // A chunk offset that wraps past the index
+    std::vector<char> bytes = good;
+    patch<uint64_t>(bytes, entry, ~uint64_t(0) - 0xFF);
+    writeFile(path, bytes);
+    CHECK_FALSE(reader.open(path));
+    CHECK(reader.errorMessage() == "Capture index is corrupt");
+
+    // An index offset that wraps below zero is not a valid trailer, so the chunks are recovered
+    bytes = good;
+    patch<uint32_t>(bytes, trailer + 8, 0xFFFFFFFF);
+    patch<uint64_t>(bytes, trailer, uint64_t(good.size() - 16) - uint64_t(0xFFFFFFFF) * 80);
+    writeFile(path, bytes);
+    REQUIRE(reader.open(path));
+    CHECK(reader.isRecovered());
+    CHECK(readAll(reader).size() == frames.size());
+
+    // A decompressed size no writer produces is rejected before anything is allocated
+    bytes = good;
+    patch<uint32_t>(bytes, entry + 8 + 16, 0xFFFFFFFF);
+    writeFile(path, bytes);
+    REQUIRE(reader.open(path));
+    CHECK(readAll(reader).empty());
+    CHECK(reader.errorMessage() == "Capture chunk 0 is corrupt");
+    std::remove(path.c_str());
+}
+
+TEST_CASE("cancapture-attach-write-failure")
+{
+    const std::string path = capturePath("cancapture-attach-failure");
+    const auto frames = makeFrames(2000);
+
+    LoopbackInterface bus;
+    REQUIRE(bus.connect());
+    CanCaptureWriter writer;
+    REQUIRE(writer.open(path, CanCaptureChunk::None, 4096));
+    writer.attach(bus);
+    bus.deliver(std::list<CanFrame>(frames.begin(), frames.begin() + 200));
+    CHECK_FALSE(writer.failed());
+
+    // Let the file grow a little further, as if the disk were nearly full
+    rlimit saved;
+    REQUIRE(::getrlimit(RLIMIT_FSIZE, &saved) == 0);
+    const auto previousHandler = std::signal(SIGXFSZ, SIG_IGN);
+    rlimit limited = saved;
+    limited.rlim_cur = rlim_t(readFile(path).size() + 1024);
+    REQUIRE(::setrlimit(RLIMIT_FSIZE, &limited) == 0);
+    const uint64_t written = writer.framesWritten();
+    bus.deliver(std::list<CanFrame>(frames.begin() + 200, frames.end()));
+    ::setrlimit(RLIMIT_FSIZE, &saved);
+    std::signal(SIGXFSZ, previousHandler);
+
+    CHECK(writer.failed());
+    CHECK_FALSE(writer.errorMessage().empty());
+    CHECK(writer.framesWritten() == written);
+    CHECK_FALSE(writer.write(frames[0]));
+    CHECK_FALSE(writer.close());
+    std::remove(path.c_str());
+}
@@ -0,0 +1,80 @@
+#include <doctest/doctest.h>
+#include <dplib/net/can/CanFilter.h>
+#include <dplib/net/can/CanInterface.h>
+
+#include <list>
+
+#include "testutil.h"
+
+using namespace datapanel::net::can;
+
+namespace
+{
+CanFrame dataFrame(CanFrame::FrameId id, bool extended = false)
+{
+    CanFrame frame;
+    frame.setExtendedId(extended);
+    frame.setId(id);
+    return frame;
+}
+}  // namespace
+
+TEST_CASE("canfilter-match")
+{
+    const CanFilter range{0x100, 0x7F0, CanFilter::BaseFormat};
+    CHECK(range.matches(dataFrame(0x100)));
+    CHECK(range.matches(dataFrame(0x10F)));
+    CHECK_FALSE(range.matches(dataFrame(0x110)));
+    CHECK_FALSE(range.matches(dataFrame(0x100, true)));
+
+    CanFilter inverted = range;
+    inverted.inverted = true;
+    CHECK_FALSE(inverted.matches(dataFrame(0x105)));
+    CHECK(inverted.matches(dataFrame(0x200)));
+
+    const CanFilter extended{0x18FEF100, 0x1FFFFFFF, CanFilter::ExtendedFormat};
+    CHECK(extended.matches(dataFrame(0x18FEF100, true)));
+    CHECK_FALSE(extended.matches(dataFrame(0x18FEF101, true)));
+
+    CanFrame rtr = dataFrame(0x100);
+    rtr.setFrameType(CanFrame::RemoteRequestFrame);
+    CanFilter dataOnly{0x100, 0x7FF};
+    dataOnly.types = CanFilter::DataFrames;
+    CHECK(dataOnly.matches(dataFrame(0x100)));
+    CHECK_FALSE(dataOnly.matches(rtr));
+
+    const CanFilter all;
+    CHECK(all.matches(dataFrame(0x7FF)));
+    CHECK(all.matches(rtr));
+}
+
+TEST_CASE("canfilter-software-fallback")
+{
+    LoopbackInterface bus;
+    REQUIRE(bus.connect());
+    CHECK_FALSE(bus.softwareFiltering());
+
+    CHECK_FALSE(bus.setRxFilters({CanFilter{0x100, 0x7FF}, CanFilter{0x200, 0x7FF}}));
+    CHECK(bus.softwareFiltering());
+
+    for (CanFrame::FrameId id : {0x100, 0x150, 0x200, 0x300}) bus.send(dataFrame(id));
+
+    CanFrame error(CanFrame::ErrorFrame);
+    error.setError(CanFrame::BusOffError);
+    bus.send(error);
+
+    std::list<CanFrame> frames = bus.recvAll();
+    REQUIRE(frames.size() == 2);
+    CHECK(frames.front().id() == 0x100);
+    CHECK(frames.back().id() == 0x200);
+
+    bus.setErrorFilter(CanFrame::BusOffError);
+    bus.send(error);
+    frames = bus.recvAll();
+    REQUIRE(frames.size() == 1);
+    CHECK(frames.front().frameType() == CanFrame::ErrorFrame);
+
+    bus.setRxFilters({});
+    bus.send(dataFrame(0x300));
+    CHECK(bus.recvAll().size() == 1);
+}
@@ -0,0 +1,163 @@
+#include <doctest/doctest.h>
+#include <dplib/net/can/CanFrame.h>
+
+#include <chrono>
+#include <cstring>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include <fmt/format.h>
+
+using datapanel::net::can::CanFrame;
+
+TEST_CASE("canframe-payload-roundtrip")
+{
+    std::vector<std::byte> data{std::byte(0xDE), std::byte(0xAD), std::byte(0xBE), std::byte(0xEF)};
+    CanFrame frame(0x123, data);
+
+    CHECK(frame.payloadSize() == 4);
+    CHECK(frame.payload().toVector() == data);
+    CHECK(frame.isFD() == false);
+    CHECK(frame.isValid());
+}
+
+TEST_CASE("canframe-payload-copy")
+{
+    std::vector<std::byte> data(12, std::byte(0x55));
+    CanFrame frame;
+    frame.setPayload(data);
+
+    CanFrame copy = frame;
+    frame.setPayload(std::vector<std::byte>{std::byte(0x01)});
+
+    CHECK(copy.payloadSize() == 12);
+    CHECK(copy.payload()[11] == std::byte(0x55));
+    CHECK(copy.isFD());
+    CHECK(frame.payloadSize() == 1);
+}
+
+TEST_CASE("canframe-payload-truncated")
+{
+    std::vector<std::byte> data(100, std::byte(0xAA));
+    CanFrame frame;
+    CHECK_FALSE(frame.setPayload(data));
+
+    CHECK(frame.payloadSize() == 0);
+    CHECK_FALSE(frame.isFD());
+    CHECK_FALSE(frame.isValid());
+
+    // A payload that fits makes the frame valid again
+    CHECK(frame.setPayload(std::vector<std::byte>(8)));
+    CHECK(frame.isValid());
+}
+
+TEST_CASE("canframe-fd-lengths")
+{
+    CanFrame frame;
+    frame.setPayload(std::vector<std::byte>(12));
+    CHECK(frame.isValid());
+
+    frame.setPayload(std::vector<std::byte>(13));
+    CHECK(frame.isValid() == false);
+}
+
+TEST_CASE("canframe-layout")
+{
+    CHECK(sizeof(CanFrame) == 80);
+    CHECK(std::is_trivially_copyable_v<CanFrame>);
+    CHECK(std::is_standard_layout_v<CanFrame>);
+}
+
+TEST_CASE("canframe-flags-independent")
+{
+    CanFrame frame;
+    frame.setId(0x1ABCDE);
+    frame.setBitrateSwitch(true);
+    frame.setErrorState(true);
+    frame.setLocalEcho(true);
+
+    CHECK(frame.isExtendedId());
+    CHECK(frame.isFD());
+    CHECK(frame.isBitrateSwitch());
+    CHECK(frame.isErrorState());
+    CHECK(frame.isLocalEcho());
+    CHECK(frame.id() == 0x1ABCDE);
+
+    frame.setFD(false);
+    CHECK(frame.isBitrateSwitch() == false);
+    CHECK(frame.isErrorState() == false);
+    CHECK(frame.isLocalEcho());
+    CHECK(frame.isExtendedId());
+
+    frame.setId(CanFrame::FrameId(0x40000000));
+    CHECK(frame.isValid() == false);
+}
+
+TEST_CASE("canframe-memcpy-roundtrip")
+{
+    CanFrame frame(0x321, std::vector<std::byte>(8, std::byte(0x11)));
+    frame.setTimestamp(CanFrame::Timestamp(12, 345678));
+
+    unsigned char raw[sizeof(CanFrame)];
+    std::memcpy(raw, &frame, sizeof(frame));
+    CanFrame copy;
+    std::memcpy(&copy, raw, sizeof(copy));
+
+    CHECK(copy.id() == 0x321);
+    CHECK(copy.payloadSize() == 8);
+    CHECK(copy.payload()[7] == std::byte(0x11));
+    CHECK(copy.timestamp().seconds() == 12);
+    CHECK(copy.timestamp().nanoseconds() == 345678);
+    CHECK(copy.timestampNs() == 12000345678);
+}
+
+TEST_CASE("canframe-format")
+{
+    std::chrono::time_point<std::chrono::system_clock, std::chrono::duration<int>> seconds{
+        std::chrono::duration<int>{1436509052}};
+    const std::string date = fmt::format("{}", seconds);
+
+    CanFrame frame(0x44, std::vector<std::byte>{std::byte(0x2A), std::byte(0x36), std::byte(0xBA)});
+    frame.setTimestampNs(1436509052000012345);
+    CHECK(fmt::format("{}", frame) == date + ".000012345 0x044  [3] 2A 36 BA");
+
+    frame = CanFrame(0x18FEF100, datapanel::util::ByteView());
+    frame.setExtendedId(true);
+    frame.setTimestampNs(1436509053999999999);
+    const std::string nextDate = fmt::format("{}", seconds + std::chrono::duration<int>(1));
+    CHECK(fmt::format("{}", frame) == nextDate + ".999999999 0x18FEF100  [0] ");
+
+    frame.setFrameType(CanFrame::RemoteRequestFrame);
+    frame.setTimestampNs(1436509052000000000);
+    CHECK(fmt::format("{}", frame) == date + ".000000000 0x18FEF100r [0]");
+
+    CanFrame fd(0x7FF, std::vector<std::byte>(64, std::byte(0xA5)));
+    fd.setFD(true);
+    const std::string text = fmt::format("{}", fd);
+    CHECK(text.size() == fmt::format("{}", CanFrame::Timestamp()).size() + 13 + 64 * 3 - 1);
+    CHECK(text.substr(text.size() - 5) == "A5 A5");
+    CHECK(fmt::format("{}", CanFrame(CanFrame::InvalidFrame)) == "[INVALID FRAME]");
+}
+
+TEST_CASE("canframe-timestamp-before-epoch")
+{
+    // The fraction borrows from the seconds rather than going negative
+    const CanFrame::Timestamp justBefore = CanFrame::Timestamp::fromNanoseconds(-1);
+    CHECK(justBefore.seconds() == -1);
+    CHECK(justBefore.nanoseconds() == 999999999);
+    CHECK(justBefore.toNanoseconds() == -1);
+
+    CanFrame frame;
+    frame.setTimestampNs(-1500000000);
+    CHECK(frame.timestamp().seconds() == -2);
+    CHECK(frame.timestamp().nanoseconds() == 500000000);
+    frame.setTimestamp(frame.timestamp());
+    CHECK(frame.timestampNs() == -1500000000);
+
+    const CanFrame::Timestamp micro = CanFrame::Timestamp::fromMicroseconds(-1);
+    CHECK(micro.seconds() == -1);
+    CHECK(micro.nanoseconds() == 999999000);
+    CHECK(CanFrame::Timestamp::fromMicroseconds(1500000).nanoseconds() == 500000000);
+    CHECK(CanFrame::Timestamp(3, -250000000).toNanoseconds() == 2750000000);
+}
@@ -0,0 +1,137 @@
+#include <doctest/doctest.h>
+#include <dplib/net/can/CanFrameCodec.h>
+
+#include <cstring>
+#include <vector>
+
+#include <linux/can.h>
+#include <linux/can/error.h>
+#include <linux/errqueue.h>
+#include <sys/socket.h>
+
+using namespace datapanel;
+using namespace datapanel::net::can;
+
+TEST_CASE("canframecodec-batch-matches-single")
+{
+    // Odd count exercises both the vector blocks and the scalar tail
+    constexpr size_t count = 11;
+    std::vector<canfd_frame> raw(count);
+    std::vector<uint32_t> sizes(count, CAN_MTU);
+    for (size_t n = 0; n < count; n++) {
+        std::memset(&raw[n], 0, sizeof(canfd_frame));
+        raw[n].can_id = 0x100 + n;
+        raw[n].len = n % 9;
+        for (size_t b = 0; b < raw[n].len; b++) raw[n].data[b] = static_cast<uint8_t>(n + b);
+    }
+    raw[1].can_id = 0x18FEF100 | CAN_EFF_FLAG;
+    raw[2].can_id = 0x123 | CAN_RTR_FLAG;
+    raw[3].can_id = CAN_ERR_FLAG | CAN_ERR_BUSOFF;
+    raw[4].len = 64;
+    raw[4].flags = CANFD_BRS;
+    sizes[4] = CANFD_MTU;
+    raw[5].can_id = 0x12345;  // Needs 29 bits without the EFF flag
+    sizes[6] = 3;             // Truncated read
+
+    std::vector<CanFrame> frames(count);
+    CanFrameCodec::decode(raw.data(), sizes.data(), frames.data(), count);
+
+    CHECK(frames[0].frameType() == CanFrame::DataFrame);
+    CHECK(frames[0].id() == 0x100);
+    CHECK_FALSE(frames[0].isExtendedId());
+    CHECK(frames[1].isExtendedId());
+    CHECK(frames[1].id() == 0x18FEF100);
+    CHECK(frames[2].frameType() == CanFrame::RemoteRequestFrame);
+    CHECK(frames[2].id() == 0x123);
+    CHECK(frames[3].frameType() == CanFrame::ErrorFrame);
+    CHECK(frames[3].error() == CanFrame::BusOffError);
+    CHECK(frames[4].isFD());
+    CHECK(frames[4].isBitrateSwitch());
+    CHECK(frames[4].payloadSize() == 64);
+    CHECK(frames[5].isExtendedId());
+    CHECK(frames[6].frameType() == CanFrame::InvalidFrame);
+
+    for (size_t n = 0; n < count; n++) {
+        if (n == 6)
+            continue;
+        CanFrame single;
+        CanFrameCodec::decode(raw[n], sizes[n] == CANFD_MTU, single);
+        CHECK(single.frameType() == frames[n].frameType());
+        CHECK(single.id() == frames[n].id());
+        CHECK(single.isExtendedId() == frames[n].isExtendedId());
+        CHECK(single.payload().toVector() == frames[n].payload().toVector());
+    }
+}
+
+TEST_CASE("canframecodec-round-trip")
+{
+    const std::byte data[] = {std::byte{1}, std::byte{2}, std::byte{3}};
+    CanFrame frame(0x1ABCDE, util::ByteView(data, sizeof(data)));
+
+    canfd_frame raw;
+    CHECK(CanFrameCodec::encode(frame, raw) == CAN_MTU);
+    CHECK(raw.can_id == (0x1ABCDE | CAN_EFF_FLAG));
+    CHECK(raw.len == 3);
+
+    can_frame classic;
+    std::memcpy(&classic, &raw, sizeof(classic));
+    CanFrame decoded;
+    CanFrameCodec::decode(&classic, &decoded, 1);
+    CHECK(decoded.id() == frame.id());
+    CHECK(decoded.isExtendedId());
+    CHECK(decoded.payload().toVector() == frame.payload().toVector());
+}
+
+namespace
+{
+/** Control data laid out as the kernel would deliver it, software stamp first */
+struct ControlData {
+    alignas(cmsghdr) char data[CMSG_SPACE(sizeof(timespec)) + CMSG_SPACE(sizeof(scm_timestamping))];
+};
+
+msghdr controlMessage(ControlData &control, const timespec *software, const scm_timestamping *stamping)
+{
+    size_t used = 0;
+    const auto append = [&](int type, const void *payload, size_t size) {
+        cmsghdr *cmsg = reinterpret_cast<cmsghdr *>(control.data + used);
+        cmsg->cmsg_level = SOL_SOCKET;
+        cmsg->cmsg_type = type;
+        cmsg->cmsg_len = CMSG_LEN(size);
+        std::memcpy(CMSG_DATA(cmsg), payload, size);
+        used += CMSG_SPACE(size);
+    };
+    if (software != nullptr)
+        append(SCM_TIMESTAMPNS, software, sizeof(*software));
+    if (stamping != nullptr)
+        append(SCM_TIMESTAMPING, stamping, sizeof(*stamping));
+
+    msghdr hdr = {};
+    hdr.msg_control = control.data;
+    hdr.msg_controllen = used;
+    return hdr;
+}
+}  // namespace
+
+TEST_CASE("canframecodec-timestamp-from-control-data")
+{
+    ControlData control;
+    const timespec software{100, 200};
+    scm_timestamping stamping = {};
+    stamping.ts[0] = timespec{300, 400};
+    stamping.ts[2] = timespec{500, 600};
+
+    // Both present: the hardware stamp wins even though SCM_TIMESTAMPNS comes first
+    msghdr hdr = controlMessage(control, &software, &stamping);
+    CHECK(CanFrameCodec::timestamp(hdr).toNanoseconds() == 500000000600);
+
+    // No raw hardware stamp: fall back to the SO_TIMESTAMPING software stamp
+    stamping.ts[2] = timespec{0, 0};
+    hdr = controlMessage(control, &software, &stamping);
+    CHECK(CanFrameCodec::timestamp(hdr).toNanoseconds() == 300000000400);
+
+    hdr = controlMessage(control, &software, nullptr);
+    CHECK(CanFrameCodec::timestamp(hdr).toNanoseconds() == 100000000200);
+
+    hdr = controlMessage(control, nullptr, nullptr);
+    CHECK(CanFrameCodec::timestamp(hdr).toNanoseconds() == 0);
+}
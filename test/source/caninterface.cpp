@@ -0,0 +1,199 @@
+#include <doctest/doctest.h>
+#include <dplib/net/can/CanFilter.h>
+#include <dplib/net/can/CanInterface.h>
+#include <dplib/util/SpscRing.h>
+
+#include <list>
+#include <vector>
+
+#include "testutil.h"
+
+using namespace datapanel;
+using namespace datapanel::net::can;
+
+namespace
+{
+void sendIds(CanInterface &bus, int count)
+{
+    for (int id = 0; id < count; id++) {
+        CanFrame frame;
+        frame.setId(id);
+        bus.send(frame);
+    }
+}
+
+std::list<CanFrame::FrameId> receivedIds(CanInterface &bus)
+{
+    std::list<CanFrame::FrameId> ids;
+    for (const CanFrame &frame : bus.recvAll()) ids.push_back(frame.id());
+    return ids;
+}
+}  // namespace
+
+TEST_CASE("caninterface-queue-capacity")
+{
+    LoopbackInterface bus;
+    bus.setConfigOption(CanInterface::CfgOptRxQueueSize, 5);
+    REQUIRE(bus.connect());
+
+    // Capacities round up to a power of two
+    sendIds(bus, 8);
+    CHECK(bus.countRxPending() == 8);
+    CHECK(bus.countRxDropped() == 0);
+
+    sendIds(bus, 1);
+    CHECK(bus.countRxPending() == 8);
+    CHECK(bus.countRxDropped() == 1);
+
+    // Queue options are fixed while connected
+    bus.setConfigOption(CanInterface::CfgOptRxQueueSize, 64);
+    CHECK(bus.error() == CanInterface::ConfigurationError);
+    CHECK(bus.countRxDropped() == 1);
+}
+
+TEST_CASE("caninterface-queue-drop-newest")
+{
+    LoopbackInterface bus;
+    bus.setConfigOption(CanInterface::CfgOptRxQueueSize, 4);
+    bus.setConfigOption(CanInterface::CfgOptQueueOverflowPolicy, static_cast<int>(util::OverflowPolicy::DropNewest));
+    REQUIRE(bus.connect());
+
+    sendIds(bus, 7);
+    CHECK(bus.countRxDropped() == 3);
+    CHECK(receivedIds(bus) == std::list<CanFrame::FrameId>{0, 1, 2, 3});
+}
+
+TEST_CASE("caninterface-queue-drop-oldest")
+{
+    LoopbackInterface bus;
+    bus.setConfigOption(CanInterface::CfgOptRxQueueSize, 4);
+    bus.setConfigOption(CanInterface::CfgOptQueueOverflowPolicy, static_cast<int>(util::OverflowPolicy::DropOldest));
+    REQUIRE(bus.connect());
+
+    sendIds(bus, 7);
+    CHECK(bus.countRxDropped() == 3);
+    CHECK(receivedIds(bus) == std::list<CanFrame::FrameId>{3, 4, 5, 6});
+
+    // Reconfiguring the queues resets the drop count
+    bus.disconnect();
+    bus.setConfigOption(CanInterface::CfgOptRxQueueSize, 8);
+    CHECK(bus.countRxDropped() == 0);
+}
+
+TEST_CASE("caninterface-queue-block-rx-drops")
+{
+    LoopbackInterface bus;
+    bus.setConfigOption(CanInterface::CfgOptRxQueueSize, 4);
+    bus.setConfigOption(CanInterface::CfgOptTxQueueSize, 4);
+    bus.setConfigOption(CanInterface::CfgOptQueueOverflowPolicy, static_cast<int>(util::OverflowPolicy::Block));
+    REQUIRE(bus.connect());
+
+    // The receive queue cannot block on its own thread; it drops instead
+    sendIds(bus, 6);
+    CHECK(bus.countRxDropped() == 2);
+    CHECK(receivedIds(bus) == std::list<CanFrame::FrameId>{0, 1, 2, 3});
+
+    bus.hold = true;
+    sendIds(bus, 4);
+    CHECK(bus.countTxPending() == 4);
+    CHECK(bus.countTxDropped() == 0);
+    CHECK(bus.transmit().id() == 0);
+    CHECK(bus.countTxPending() == 3);
+}
+
+TEST_CASE("caninterface-queue-tx-dropped")
+{
+    LoopbackInterface bus;
+    bus.setConfigOption(CanInterface::CfgOptTxQueueSize, 2);
+    REQUIRE(bus.connect());
+
+    bus.hold = true;
+    sendIds(bus, 5);
+    CHECK(bus.countTxPending() == 2);
+    CHECK(bus.countTxDropped() == 3);
+
+    bus.flushTx();
+    CHECK(bus.countTxPending() == 0);
+    CHECK(bus.transmit().frameType() == CanFrame::InvalidFrame);
+}
+
+TEST_CASE("caninterface-filtered-frames-keep-queue")
+{
+    LoopbackInterface bus;
+    bus.setConfigOption(CanInterface::CfgOptRxQueueSize, 4);
+    bus.setConfigOption(CanInterface::CfgOptQueueOverflowPolicy, static_cast<int>(util::OverflowPolicy::DropOldest));
+    REQUIRE(bus.connect());
+    bus.setRxFilters({CanFilter{0x000, 0x7F0}});
+    REQUIRE(bus.softwareFiltering());
+
+    CanFrame frame;
+    for (CanFrame::FrameId id = 0; id < 4; id++) {
+        frame.setId(id);
+        CHECK(bus.deliverInPlace(frame));
+    }
+
+    // Rejected frames are filtered before they reach the full queue
+    frame.setId(0x100);
+    for (int n = 0; n < 3; n++) CHECK_FALSE(bus.deliverInPlace(frame));
+    CHECK(bus.countRxDropped() == 0);
+    CHECK(receivedIds(bus) == std::list<CanFrame::FrameId>{0, 1, 2, 3});
+}
+
+TEST_CASE("caninterface-tap")
+{
+    LoopbackInterface bus;
+    REQUIRE(bus.connect());
+    bus.setRxFilters({CanFilter{0x000, 0x700}});
+
+    std::vector<size_t> batches;
+    std::list<CanFrame::FrameId> ids;
+    size_t otherTap = 0;
+    sigslot::scoped_connection first = bus.framesTapped.connect([&](const CanFrame *frames, size_t count) {
+        batches.push_back(count);
+        for (size_t n = 0; n < count; n++) ids.push_back(frames[n].id());
+    });
+    sigslot::scoped_connection second =
+        bus.framesTapped.connect([&](const CanFrame *, size_t count) { otherTap += count; });
+
+    std::list<CanFrame> frames;
+    for (CanFrame::FrameId id = 0; id < CanInterface::TapBatchSize + 6; id++) {
+        CanFrame frame;
+        frame.setId(id);
+        frames.push_back(frame);
+    }
+    CanFrame rejected;
+    rejected.setId(0x700);
+    frames.push_back(rejected);
+    bus.deliver(frames);
+
+    // Every tap sees every accepted frame, and the queue still holds them
+    CHECK(batches == std::vector<size_t>{CanInterface::TapBatchSize, 6});
+    CHECK(ids.size() == CanInterface::TapBatchSize + 6);
+    CHECK(ids.back() == CanInterface::TapBatchSize + 5);
+    CHECK(otherTap == CanInterface::TapBatchSize + 6);
+    CHECK(bus.countRxPending() == CanInterface::TapBatchSize + 6);
+
+    CanFrame out[4];
+    CHECK(bus.recv(out, 4) == 4);
+    CHECK(out[3].id() == 3);
+}
+
+TEST_CASE("caninterface-tap-sees-dropped-frames")
+{
+    LoopbackInterface bus;
+    bus.setConfigOption(CanInterface::CfgOptRxQueueSize, 4);
+    REQUIRE(bus.connect());
+
+    size_t tapped = 0;
+    sigslot::scoped_connection tap = bus.framesTapped.connect([&](const CanFrame *, size_t count) { tapped += count; });
+
+    CanFrame frame;
+    for (CanFrame::FrameId id = 0; id < 6; id++) {
+        frame.setId(id);
+        CHECK(bus.deliverInPlace(frame));
+    }
+    bus.notify();
+    CHECK(tapped == 6);
+    CHECK(bus.countRxPending() == 4);
+    CHECK(bus.countRxDropped() == 2);
+}
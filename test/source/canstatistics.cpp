@@ -0,0 +1,157 @@
+#include <doctest/doctest.h>
+#include <dplib/net/can/BitTiming.h>
+#include <dplib/net/can/CanStatistics.h>
+
+#include <atomic>
+#include <cmath>
+#include <thread>
+#include <vector>
+
+#include "testutil.h"
+
+using datapanel::net::can::CanFrame;
+using datapanel::net::can::CanStatistics;
+using datapanel::net::can::frameBitCount;
+
+TEST_CASE("can-statistics-gap-buckets")
+{
+    CHECK(CanStatistics::gapBucket(0) == 0);
+    CHECK(CanStatistics::gapBucket(15) == 15);
+    CHECK(CanStatistics::gapBucket(16) == 16);
+    CHECK(CanStatistics::gapBucket(17) == 16);
+    CHECK(CanStatistics::gapBucket(32) == 24);
+    CHECK(CanStatistics::gapBucket(uint64_t(1) << 40) == CanStatistics::JitterBuckets - 1);
+
+    // Buckets are contiguous and at most 12.5% wide
+    for (size_t bucket = 0; bucket < CanStatistics::JitterBuckets - 1; bucket++) {
+        const uint64_t upper = CanStatistics::gapBucketUpperUs(bucket);
+        CHECK(CanStatistics::gapBucket(upper) == bucket);
+        CHECK(CanStatistics::gapBucket(upper + 1) == bucket + 1);
+        if (bucket > 0)
+            CHECK(double(upper - CanStatistics::gapBucketUpperUs(bucket - 1)) <= 0.125 * double(upper) + 1);
+    }
+}
+
+TEST_CASE("can-statistics-per-id")
+{
+    CanStatistics stats;
+    std::vector<CanFrame> frames;
+    int64_t now = 1000000000;
+    uint64_t bits = 0;
+    // 0x100 every 10 ms, one late frame at 12 ms; 0x100 extended every 100 ms with 12-byte FD frames
+    for (int n = 0; n < 100; n++) {
+        now += n == 50 ? 12000000 : 10000000;
+        frames.push_back(makeFrame(0x100, n % 2 ? 8 : 3, now));
+        if (n % 10 == 0)
+            frames.push_back(makeFrame(0x100, 12, now, true));
+    }
+    frames.push_back(makeFrame(0x100, 0, now));
+    frames.back().setFrameType(CanFrame::ErrorFrame);
+    for (const auto &frame : frames)
+        if (frame.frameType() != CanFrame::ErrorFrame)
+            bits += frameBitCount(frame);
+    stats.process(frames.data(), frames.size());
+
+    CHECK(stats.idCount() == 2);
+    CanStatistics::IdStatistics standard;
+    REQUIRE(stats.find(0x100, false, standard));
+    CHECK(standard.id == 0x100);
+    CHECK_FALSE(standard.extendedId);
+    CHECK(standard.frames == 100);
+    CHECK(standard.gapMinNs == 10000000);
+    CHECK(standard.gapMaxNs == 12000000);
+    CHECK(std::abs(standard.gapMeanNs() - (99 * 10e6 + 2e6) / 99) < 1);
+    CHECK(std::abs(standard.rate() - 99 / ((99 * 10e6 + 2e6) * 1e-9)) < 1e-6);
+    CHECK(standard.gapPercentileNs(50) >= 10000000);
+    CHECK(standard.gapPercentileNs(50) < 11250000);
+    CHECK(standard.gapPercentileNs(100) == 12000000);
+    CHECK(standard.dlc[3] == 50);
+    CHECK(standard.dlc[8] == 50);
+
+    CanStatistics::IdStatistics extended;
+    REQUIRE(stats.find(0x100, true, extended));
+    CHECK(extended.extendedId);
+    CHECK(extended.frames == 10);
+    CHECK(extended.dlc[9] == 10);
+    CHECK_FALSE(stats.find(0x101, false, extended));
+
+    CanStatistics::IdStatistics first;
+    REQUIRE(stats.idStatistics(0, first));
+    CHECK(first.frames == 100);
+    CHECK_FALSE(stats.idStatistics(2, first));
+
+    const auto totals = stats.totals();
+    CHECK(totals.frames == 110);
+    CHECK(totals.errorFrames == 1);
+    CHECK(totals.bits == bits);
+    const double expected = double(bits) / ((99 * 10e6 + 2e6) * 1e-9 * 500000);
+    CHECK(std::abs(CanStatistics::busLoad({}, totals, 500000) - expected) < 1e-12);
+
+    stats.reset();
+    CHECK(stats.totals().frames == 0);
+    REQUIRE(stats.find(0x100, false, standard));
+    CHECK(standard.frames == 0);
+}
+
+TEST_CASE("can-statistics-table-full")
+{
+    CanStatistics stats(2);
+    for (uint32_t id = 1; id <= 3; id++) stats.process(makeFrame(id, 8, id * 1000));
+    CHECK(stats.idCount() == 2);
+    CHECK(stats.totals().frames == 3);
+    CHECK(stats.totals().untracked == 1);
+}
+
+TEST_CASE("can-statistics-concurrent-read")
+{
+    CanStatistics stats;
+    std::atomic<bool> done{false};
+    std::atomic<int> torn{0};
+    std::thread reader([&]() {
+        CanStatistics::IdStatistics id;
+        while (!done.load()) {
+            if (!stats.find(0x123, false, id))
+                continue;
+            uint64_t dlc = 0, gaps = 0;
+            for (const auto count : id.dlc) dlc += count;
+            for (const auto count : id.gaps) gaps += count;
+            if (dlc != id.frames || (id.frames > 0 && gaps != id.frames - 1))
+                torn++;
+        }
+    });
+
+    CanFrame batch[64];
+    int64_t now = 0;
+    for (int round = 0; round < 2000; round++) {
+        for (auto &frame : batch) {
+            now += 1000 + now % 7000;
+            frame = makeFrame(0x123, size_t(now / 1000 % 9), now);
+        }
+        stats.process(batch, 64);
+    }
+    done = true;
+    reader.join();
+    CHECK(torn == 0);
+}
+
+TEST_CASE("can-statistics-attach-leaves-queue")
+{
+    LoopbackInterface bus;
+    REQUIRE(bus.connect());
+
+    CanStatistics stats;
+    CanStatistics second;
+    stats.attach(bus);
+    second.attach(bus);
+    bus.deliver({makeFrame(0x100, 8, 1000), makeFrame(0x200, 8, 2000)});
+
+    // Both engines count every frame, and the application still receives them
+    CHECK(stats.totals().frames == 2);
+    CHECK(second.totals().frames == 2);
+    CHECK(bus.countRxPending() == 2);
+
+    stats.detach();
+    bus.deliver({makeFrame(0x100, 8, 3000)});
+    CHECK(stats.totals().frames == 2);
+    CHECK(second.totals().frames == 3);
+}
@@ -0,0 +1,162 @@
+#include <doctest/doctest.h>
+#include <dplib/ChangeDetector.h>
+
+#include <cmath>
+#include <vector>
+
+#include "testutil.h"
+
+using datapanel::ChangeDetector;
+using datapanel::Message;
+using datapanel::Signal;
+using datapanel::SignalDecoder;
+using datapanel::net::can::CanFrame;
+
+static Signal makeSignal(const std::string &name, unsigned start, unsigned length, double scale = 1)
+{
+    Signal signal;
+    signal.setName(name);
+    signal.setStartBit(start);
+    signal.setLength(length);
+    signal.setScale(scale);
+    return signal;
+}
+
+TEST_CASE("change-detect-frames")
+{
+    ChangeDetector changes;
+    std::vector<CanFrame> emitted;
+    changes.frameChanged.connect([&](const CanFrame &frame) { emitted.push_back(frame); });
+
+    const std::vector<uint8_t> fd(64, 0x5A);
+    std::vector<uint8_t> fdTail = fd;
+    fdTail[63] = 0;
+    const CanFrame frames[] = {
+        makeFrame(0x100, {1, 2, 3}),       // first of its id
+        makeFrame(0x100, {1, 2, 3}),       // repeat
+        makeFrame(0x100, {1, 2, 3}, true), // same number, extended id
+        makeFrame(0x100, {1, 2, 4}),       // last byte changed
+        makeFrame(0x100, {1, 2, 4, 0}),    // longer, same prefix
+        makeFrame(0x100, {1, 2, 4, 0}),    // repeat
+        makeFrame(0x200, fd),              // first of its id
+        makeFrame(0x200, fd),              // repeat
+        makeFrame(0x200, fdTail),          // byte 63 changed
+        makeFrame(0x100, {1, 2, 4, 0}),    // repeat after another id
+    };
+    changes.process(frames, std::size(frames));
+
+    REQUIRE(emitted.size() == 6);
+    CHECK(emitted[1].isExtendedId());
+    CHECK(emitted[3].payloadSize() == 4);
+    CHECK(emitted[5].payloadSize() == 64);
+    CHECK(changes.statistics().frames == std::size(frames));
+    CHECK(changes.statistics().changedFrames == 6);
+
+    // Error frames always pass
+    CanFrame error = makeFrame(0x100, {1, 2, 4, 0});
+    error.setFrameType(CanFrame::ErrorFrame);
+    changes.process(error);
+    changes.process(error);
+    CHECK(emitted.size() == 8);
+
+    changes.reset();
+    changes.process(frames[1]);
+    CHECK(emitted.size() == 9);
+}
+
+TEST_CASE("change-detect-attach")
+{
+    LoopbackInterface bus;
+    REQUIRE(bus.connect());
+
+    ChangeDetector changes;
+    size_t emitted = 0;
+    changes.frameChanged.connect([&](const CanFrame &) { emitted++; });
+    changes.attach(bus);
+    bus.deliver({makeFrame(0x100, {1}), makeFrame(0x100, {1}), makeFrame(0x100, {2})});
+    CHECK(emitted == 2);
+    CHECK(bus.countRxPending() == 3);
+
+    changes.detach();
+    bus.deliver({makeFrame(0x100, {3})});
+    CHECK(emitted == 2);
+}
+
+TEST_CASE("change-detect-table-full")
+{
+    ChangeDetector changes(2);
+    size_t emitted = 0;
+    changes.frameChanged.connect([&](const CanFrame &) { emitted++; });
+    for (int round = 0; round < 3; round++)
+        for (uint32_t id = 1; id <= 3; id++) changes.process(makeFrame(id, {uint8_t(id)}));
+
+    // Ids 1 and 2 are tracked, 3 passes every time
+    CHECK(emitted == 2 + 3);
+    CHECK(changes.statistics().untracked == 3);
+}
+
+TEST_CASE("change-detect-values")
+{
+    Message message;
+    message.setId(0x123);
+    message.setName("Status");
+    Signal mux = makeSignal("Mux", 0, 8);
+    mux.setMultiplexor(true);
+    message.addSignal(mux);
+    message.addSignal(makeSignal("Speed", 8, 16, 0.5));
+    message.addSignal(makeSignal("Counter", 24, 8));
+    Signal a = makeSignal("ModeA", 32, 8);
+    a.setMultiplexValue(1);
+    message.addSignal(a);
+    Signal b = makeSignal("ModeB", 32, 8);
+    b.setMultiplexValue(2);
+    message.addSignal(b);
+
+    SignalDecoder decoder;
+    REQUIRE(decoder.compile({message}));
+    ChangeDetector changes;
+    changes.setDecoder(&decoder);
+    CHECK(changes.setDeadband("Status", "Speed", 2.0));
+    CHECK_FALSE(changes.setDeadband("Status", "Missing", 2.0));
+    CHECK_FALSE(changes.setDeadband(decoder.valueCount(), 2.0));
+    CHECK_FALSE(changes.setDeadband(0, -1));
+
+    const long speed = decoder.valueIndex("Status", "Speed");
+    const long counter = decoder.valueIndex("Status", "Counter");
+    const long modeA = decoder.valueIndex("Status", "ModeA");
+    const long modeB = decoder.valueIndex("Status", "ModeB");
+    std::vector<std::pair<size_t, double>> values;
+    changes.valueChanged.connect(
+        [&](const CanFrame &, size_t slot, double value) { values.emplace_back(slot, value); });
+
+    // Speed 50.0, counter 1, mode A 7: all new
+    changes.process(makeFrame(0x123, {1, 100, 0, 1, 7}));
+    CHECK(values.size() == 4);
+    CHECK(std::isnan(changes.value(size_t(modeB))));
+
+    // Speed +1.5 is inside the deadband, the counter moved
+    values.clear();
+    changes.process(makeFrame(0x123, {1, 103, 0, 2, 7}));
+    REQUIRE(values.size() == 1);
+    CHECK(values[0].first == size_t(counter));
+
+    // Speed +2.5 from the last emitted 50.0 (not from 51.5) passes
+    values.clear();
+    changes.process(makeFrame(0x123, {1, 105, 0, 2, 7}));
+    REQUIRE(values.size() == 1);
+    CHECK(values[0].first == size_t(speed));
+    CHECK(std::abs(values[0].second - 52.5) < 1e-9);
+
+    // Switching to mode B reports the multiplexor and ModeB; ModeA is not carried and keeps its value
+    values.clear();
+    changes.process(makeFrame(0x123, {2, 105, 0, 2, 7}));
+    REQUIRE(values.size() == 2);
+    CHECK(values[1].first == size_t(modeB));
+    CHECK(changes.value(size_t(modeA)) == 7);
+
+    // Back to mode A with the same value: only the multiplexor changed
+    values.clear();
+    changes.process(makeFrame(0x123, {1, 105, 0, 2, 7}));
+    CHECK(values.size() == 1);
+    CHECK(changes.statistics().changedValues == 9);
+}
@@ -0,0 +1,244 @@
+#include <doctest/doctest.h>
+#include <dplib/DbcImporter.h>
+#include <dplib/SignalDecoder.h>
+
+#include <cmath>
+#include <cstring>
+#include <random>
+#include <vector>
+
+using datapanel::DbcImporter;
+using datapanel::Message;
+using datapanel::Signal;
+using datapanel::SignalDecoder;
+using datapanel::net::can::CanFrame;
+
+static const char *const Sample = R"(VERSION ""
+
+NS_ :
+    NS_DESC_
+    CM_
+
+BS_:
+
+BU_: ECU Dash
+
+BO_ 256 Engine: 8 ECU
+ SG_ Speed : 0|16@1+ (0.125,0) [0|8031.875] "rpm" Dash
+ SG_ Temp : 16|8@1- (1,-40) [-40|215] "degC" Dash
+ SG_ Torque : 31|12@0- (0.5,0) [-1024|1023.5] "Nm" Dash
+ SG_ Flag : 63|1@1+ (1,0) [0|1] "" Dash
+
+BO_ 2566844926 Diag: 8 ECU
+ SG_ Mode M : 0|8@1+ (1,0) [0|255] "" Dash
+ SG_ Pressure m1 : 8|16@1+ (0.1,0) [0|6553.5] "kPa" Dash
+ SG_ Level m2 : 8|8@1+ (0.4,0) [0|100] "%" Dash
+
+BO_ 512 Fd: 64 ECU
+ SG_ Ratio : 32|32@1- (1,0) [0|0] "" Dash
+ SG_ Energy : 440|64@1- (1,0) [0|0] "J" Dash
+
+BO_ 3221225472 VECTOR__INDEPENDENT_SIG_MSG: 0 Vector__XXX
+ SG_ Orphan : 0|8@1+ (1,0) [0|0] "" Vector__XXX
+
+CM_ BO_ 256 "Engine data";
+CM_ SG_ 256 Speed "Engine speed,
+measured at the crankshaft";
+BA_DEF_ BO_ "GenMsgCycleTime" INT 0 10000;
+VAL_ 256 Flag 0 "Off" 1 "On" ;
+SIG_VALTYPE_ 512 Ratio : 1;
+)";
+
+/** Reference packing of @p raw into @p payload, one bit at a time */
+static void pack(std::vector<uint8_t> &payload, const Signal &signal, uint64_t raw)
+{
+    const unsigned length = signal.length();
+    if (signal.byteOrder() == Signal::ByteOrder::LittleEndian) {
+        for (unsigned n = 0; n < length; n++) {
+            const unsigned bit = signal.startBit() + n;
+            if ((raw >> n) & 1)
+                payload[bit / 8] |= uint8_t(1 << (bit % 8));
+        }
+    } else {
+        const unsigned msb = signal.startBit() / 8 * 8 + 7 - signal.startBit() % 8;
+        for (unsigned n = 0; n < length; n++) {
+            const unsigned bit = msb + n;
+            if ((raw >> (length - 1 - n)) & 1)
+                payload[bit / 8] |= uint8_t(0x80 >> (bit % 8));
+        }
+    }
+}
+
+TEST_CASE("dbc-import")
+{
+    DbcImporter dbc;
+    REQUIRE(dbc.parse(Sample));
+    REQUIRE(dbc.messages().size() == 3);
+
+    const Message *engine = dbc.message(256);
+    REQUIRE(engine != nullptr);
+    CHECK(engine->name() == "Engine");
+    CHECK(engine->size() == 8);
+    CHECK(engine->transmitter() == "ECU");
+    CHECK(engine->comment() == "Engine data");
+    REQUIRE(engine->signals().size() == 4);
+
+    const Signal *torque = engine->signal("Torque");
+    REQUIRE(torque != nullptr);
+    CHECK(torque->startBit() == 31);
+    CHECK(torque->length() == 12);
+    CHECK(torque->byteOrder() == Signal::ByteOrder::BigEndian);
+    CHECK(torque->valueType() == Signal::ValueType::Signed);
+    CHECK(torque->scale() == 0.5);
+    CHECK(torque->minimum() == -1024);
+    CHECK(torque->unit() == "Nm");
+    CHECK(engine->signal("Speed")->comment() == "Engine speed,\nmeasured at the crankshaft");
+    CHECK(engine->signal("Temp")->offset() == -40);
+
+    const Message *diag = dbc.message(0x18FEF1FE, true);
+    REQUIRE(diag != nullptr);
+    CHECK(diag->signal("Mode")->isMultiplexor());
+    CHECK(diag->signal("Pressure")->multiplexValue() == 1);
+    CHECK(diag->signal("Level")->multiplexValue() == 2);
+    CHECK(diag->signal("Mode")->multiplexValue() == Signal::NotMultiplexed);
+
+    CHECK(dbc.message(512)->signal("Ratio")->valueType() == Signal::ValueType::Float);
+}
+
+TEST_CASE("dbc-import-errors")
+{
+    DbcImporter dbc;
+    CHECK_FALSE(dbc.parse("BO_ 100 A: 8 ECU\n SG_ S : 0|8@2+ (1,0) [0|0] \"\" X\n"));
+    CHECK(dbc.errorLine() == 2);
+    CHECK(dbc.messages().empty());
+
+    CHECK_FALSE(dbc.parse("\n\nBO_ 100 A 8 ECU\n"));
+    CHECK(dbc.errorLine() == 3);
+    CHECK_FALSE(dbc.parse("BO_ 100 A: 8 ECU\n SG_ S : 0|65@1+ (1,0) [0|0] \"\" X\n"));
+    CHECK_FALSE(dbc.load("/nonexistent/file.dbc"));
+    CHECK(dbc.errorLine() == 0);
+}
+
+TEST_CASE("signal-decode")
+{
+    DbcImporter dbc;
+    REQUIRE(dbc.parse(Sample));
+    SignalDecoder decoder;
+    REQUIRE(decoder.compile(dbc.messages()));
+    CHECK(decoder.messageCount() == 3);
+    REQUIRE(decoder.valueCount() == 9);
+    std::vector<double> values(decoder.valueCount());
+
+    // Speed 0x1234, Temp -10, Torque -2047 (Motorola 0x801), Flag set
+    const uint8_t engine[8] = {0x34, 0x12, 0xF6, 0x80, 0x10, 0, 0, 0x80};
+    const CanFrame frame(256, datapanel::util::ByteView(reinterpret_cast<const std::byte *>(engine), 8));
+    const int message = decoder.decode(frame, values.data());
+    REQUIRE(message >= 0);
+    CHECK(decoder.signalCount(message) == 4);
+    CHECK(values[decoder.valueIndex("Engine", "Speed")] == 582.5);
+    CHECK(values[decoder.valueIndex("Engine", "Temp")] == -50);
+    CHECK(values[decoder.valueIndex("Engine", "Torque")] == -1023.5);
+    CHECK(values[decoder.valueIndex("Engine", "Flag")] == 1);
+    CHECK(decoder.valueIndex("Engine", "Missing") == -1);
+
+    // A short frame leaves the signals past its end undefined
+    CHECK(decoder.decode(256, false, engine, 2, values.data()) == message);
+    CHECK(values[decoder.valueIndex("Engine", "Speed")] == 582.5);
+    CHECK(std::isnan(values[decoder.valueIndex("Engine", "Temp")]));
+
+    // Only the signals selected by the multiplexor are decoded
+    const long pressure = decoder.valueIndex("Diag", "Pressure");
+    const long level = decoder.valueIndex("Diag", "Level");
+    const uint8_t mode1[8] = {1, 0x10, 0x27};
+    REQUIRE(decoder.decode(0x18FEF1FE, true, mode1, 8, values.data()) >= 0);
+    CHECK(std::abs(values[pressure] - 1000) < 1e-9);
+    CHECK(std::isnan(values[level]));
+    const uint8_t mode2[8] = {2, 250};
+    REQUIRE(decoder.decode(0x18FEF1FE, true, mode2, 8, values.data()) >= 0);
+    CHECK(std::isnan(values[pressure]));
+    CHECK(std::abs(values[level] - 100) < 1e-9);
+    CHECK(decoder.decode(0x0FEF1FE, false, mode2, 8, values.data()) == -1);
+
+    // Float and 64-bit signals of an FD frame
+    uint8_t fd[64] = {};
+    const float ratio = -1.5f;
+    std::memcpy(fd + 4, &ratio, 4);
+    const int64_t energy = -5;
+    std::memcpy(fd + 55, &energy, 8);
+    REQUIRE(decoder.decode(512, false, fd, 64, values.data()) >= 0);
+    CHECK(values[decoder.valueIndex("Fd", "Ratio")] == -1.5);
+    CHECK(values[decoder.valueIndex("Fd", "Energy")] == -5);
+}
+
+TEST_CASE("signal-decode-layouts")
+{
+    // Random positions, lengths and byte orders against bit-by-bit packing
+    std::mt19937_64 random(1939);
+    for (int round = 0; round < 2000; round++) {
+        Signal signal;
+        const unsigned length = 1 + unsigned(random() % 64);
+        signal.setLength(length);
+        signal.setByteOrder(random() & 1 ? Signal::ByteOrder::BigEndian : Signal::ByteOrder::LittleEndian);
+        signal.setValueType(random() & 1 ? Signal::ValueType::Signed : Signal::ValueType::Unsigned);
+        const unsigned first = unsigned(random() % (512 - length + 1));
+        signal.setStartBit(signal.byteOrder() == Signal::ByteOrder::LittleEndian ? first
+                                                                                  : first / 8 * 8 + 7 - first % 8);
+        Message message;
+        message.setId(0x123);
+        message.addSignal(signal);
+        SignalDecoder decoder;
+        REQUIRE(decoder.compile({message}));
+
+        const uint64_t raw = random() & (length == 64 ? ~uint64_t(0) : (uint64_t(1) << length) - 1);
+        std::vector<uint8_t> payload(64);
+        for (auto &byte : payload) byte = uint8_t(random());
+        std::vector<uint8_t> cleared(64);
+        pack(cleared, signal, ~uint64_t(0) >> (64 - length));
+        for (size_t n = 0; n < 64; n++) payload[n] &= uint8_t(~cleared[n]);
+        pack(payload, signal, raw);
+
+        double value = 0;
+        REQUIRE(decoder.decode(0x123, false, payload.data(), payload.size(), &value) == 0);
+        double expected = double(raw);
+        if (signal.valueType() == Signal::ValueType::Signed && length < 64 && (raw >> (length - 1)))
+            expected = double(int64_t(raw) - (int64_t(1) << (length - 1)) * 2);
+        else if (signal.valueType() == Signal::ValueType::Signed)
+            expected = double(int64_t(raw));
+        CHECK(value == expected);
+    }
+}
+
+TEST_CASE("signal-decode-compile-errors")
+{
+    Message message;
+    message.setId(0x100);
+    Signal signal;
+    signal.setName("Value");
+    signal.setLength(16);
+    signal.setValueType(Signal::ValueType::Float);
+    message.addSignal(signal);
+
+    SignalDecoder decoder;
+    CHECK_FALSE(decoder.compile({message}));
+    CHECK(decoder.valueCount() == 0);
+
+    message.signals()[0].setValueType(Signal::ValueType::Unsigned);
+    message.signals()[0].setStartBit(505);
+    CHECK_FALSE(decoder.compile({message}));
+
+    message.signals()[0].setStartBit(0);
+    CHECK(decoder.compile({message}));
+    CHECK_FALSE(decoder.compile({message, message}));
+
+    // Many messages all resolve through the index
+    std::vector<Message> messages;
+    for (uint32_t n = 0; n < 300; n++) {
+        message.setId(n % 2 ? 0x18F00000 + n * 0x100 : 0x100 + n);
+        message.setExtendedId(n % 2);
+        messages.push_back(message);
+    }
+    REQUIRE(decoder.compile(messages));
+    for (uint32_t n = 0; n < 300; n++) CHECK(decoder.messageIndex(messages[n].id(), n % 2) == int(n));
+    CHECK(decoder.messageIndex(0x100, true) == -1);
+    CHECK(decoder.messageIndex(0x7FF, false) == -1);
+}
@@ -0,0 +1,187 @@
+#include <doctest/doctest.h>
+#include <dplib/core/EventDispatcher.h>
+
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include <sys/socket.h>
+#include <unistd.h>
+
+using datapanel::core::EventDispatcher;
+using namespace std::chrono_literals;
+
+TEST_CASE("eventdispatcher-timer-order")
+{
+    EventDispatcher dispatcher;
+    std::vector<int> fired;
+
+    const int slow = dispatcher.addTimer(35, [&]() { fired.push_back(35); });
+    const int fast = dispatcher.addTimer(10, [&]() { fired.push_back(10); });
+    const int medium = dispatcher.addTimer(25, [&]() { fired.push_back(25); });
+
+    while (fired.size() < 5) dispatcher.processEvents();
+
+    // 10, 20, 25, 30, 35
+    CHECK(fired == std::vector<int>{10, 10, 25, 10, 35});
+
+    CHECK(dispatcher.removeTimer(slow));
+    CHECK(dispatcher.removeTimer(fast));
+    CHECK(dispatcher.removeTimer(medium));
+}
+
+TEST_CASE("eventdispatcher-timer-all-expired")
+{
+    EventDispatcher dispatcher;
+    int count = 0;
+
+    for (int n = 0; n < 5; n++) dispatcher.addTimer(5, [&]() { count++; });
+
+    std::this_thread::sleep_for(10ms);
+    dispatcher.processEvents();
+
+    CHECK(count == 5);
+}
+
+TEST_CASE("eventdispatcher-timer-remove")
+{
+    EventDispatcher dispatcher;
+    bool fired = false;
+
+    const int id = dispatcher.addTimer(1, [&]() { fired = true; });
+    CHECK(dispatcher.removeTimer(id));
+    CHECK(dispatcher.removeTimer(id) == false);
+
+    dispatcher.addTimer(5, []() {});
+    std::this_thread::sleep_for(5ms);
+    dispatcher.processEvents();
+
+    CHECK(fired == false);
+}
+
+TEST_CASE("eventdispatcher-timer-remove-self")
+{
+    EventDispatcher dispatcher;
+    int count = 0;
+    int id = 0;
+
+    id = dispatcher.addTimer(1, [&]() {
+        count++;
+        dispatcher.removeTimer(id);
+    });
+    const int other = dispatcher.addTimer(3, []() {});
+
+    for (int n = 0; n < 5; n++) {
+        std::this_thread::sleep_for(2ms);
+        dispatcher.processEvents();
+    }
+
+    CHECK(count == 1);
+    CHECK(dispatcher.removeTimer(other));
+}
+
+TEST_CASE("eventdispatcher-precise-timer")
+{
+    EventDispatcher dispatcher;
+    REQUIRE(dispatcher.setTimerMode(EventDispatcher::TimerMode::Precise));
+
+    int count = 0;
+    dispatcher.addTimer(std::chrono::microseconds(500), [&]() { count++; });
+
+    const auto start = std::chrono::steady_clock::now();
+    while (count < 10) dispatcher.processEvents();
+    const auto elapsed = std::chrono::steady_clock::now() - start;
+
+    // Ten 500 us periods cannot complete sooner than 5 ms
+    CHECK(elapsed >= 5ms);
+    CHECK(dispatcher.setTimerMode(EventDispatcher::TimerMode::Coarse));
+}
+
+TEST_CASE("eventdispatcher-read-write-same-fd")
+{
+    EventDispatcher dispatcher;
+    int fds[2];
+    REQUIRE(::socketpair(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK, 0, fds) == 0);
+
+    int reads = 0;
+    int writes = 0;
+    CHECK(dispatcher.addFile(fds[0], EventDispatcher::Write, [&]() { writes++; }));
+    CHECK(dispatcher.addFile(fds[0], EventDispatcher::Read, [&]() {
+        char buffer[16];
+        reads += ::read(fds[0], buffer, sizeof(buffer)) > 0;
+    }));
+    CHECK_FALSE(dispatcher.addFile(fds[0], EventDispatcher::Read, []() {}));
+
+    CHECK(::write(fds[1], "x", 1) == 1);
+    dispatcher.processEvents();
+    CHECK(reads == 1);
+    CHECK(writes == 1);
+
+    // Dropping the writer leaves the reader registered
+    CHECK(dispatcher.removeFile(fds[0], EventDispatcher::Write));
+    CHECK(::write(fds[1], "y", 1) == 1);
+    dispatcher.processEvents();
+    CHECK(reads == 2);
+    CHECK(writes == 1);
+
+    CHECK(dispatcher.removeFile(fds[0], EventDispatcher::Read));
+    CHECK_FALSE(dispatcher.removeFile(fds[0], EventDispatcher::Read));
+    ::close(fds[0]);
+    ::close(fds[1]);
+}
+
+TEST_CASE("eventdispatcher-interrupt-between-calls")
+{
+    EventDispatcher dispatcher;
+    bool ran = false;
+
+    dispatcher.post([&]() { ran = true; });
+    dispatcher.interrupt();
+
+    // The interrupt raised before the call is consumed by it
+    CHECK_FALSE(dispatcher.processEvents());
+    CHECK_FALSE(ran);
+
+    CHECK(dispatcher.processEvents());
+    CHECK(ran);
+}
+
+TEST_CASE("eventdispatcher-precise-remove-earliest")
+{
+    EventDispatcher dispatcher;
+    REQUIRE(dispatcher.setTimerMode(EventDispatcher::TimerMode::Precise));
+
+    int count = 0;
+    const int early = dispatcher.addTimer(std::chrono::milliseconds(5), []() {});
+    dispatcher.addTimer(std::chrono::milliseconds(30), [&]() { count++; });
+    CHECK(dispatcher.removeTimer(early));
+
+    // The timerfd follows the remaining timer, so the first wake-up fires it
+    CHECK(dispatcher.processEvents());
+    CHECK(count == 1);
+    CHECK(dispatcher.setTimerMode(EventDispatcher::TimerMode::Coarse));
+}
+
+TEST_CASE("eventdispatcher-current-only-while-processing")
+{
+    EventDispatcher *seen = nullptr;
+    EventDispatcher *nested = nullptr;
+    {
+        EventDispatcher outer;
+        EventDispatcher inner;
+        inner.post([&]() { nested = EventDispatcher::current(); });
+        outer.post([&]() {
+            seen = EventDispatcher::current();
+            inner.processEvents();
+            // The inner call hands the thread back to the outer dispatcher
+            CHECK(EventDispatcher::current() == &outer);
+        });
+
+        CHECK(outer.processEvents());
+        CHECK(seen == &outer);
+        CHECK(nested == &inner);
+        CHECK(EventDispatcher::current() == nullptr);
+    }
+    // Nothing on this thread still refers to the destroyed dispatchers
+    CHECK(EventDispatcher::current() == nullptr);
+}
@@ -0,0 +1,84 @@
+#include <doctest/doctest.h>
+#include <dplib/core/EventLoopThread.h>
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+using datapanel::core::EventDispatcher;
+using datapanel::core::EventLoopThread;
+using namespace std::chrono_literals;
+
+TEST_CASE("eventloopthread-post-order")
+{
+    EventLoopThread loop("test-loop");
+    REQUIRE(loop.start());
+    CHECK_FALSE(loop.start());
+
+    std::vector<int> order;
+    std::atomic<std::thread::id> runner;
+    for (int n = 0; n < 1000; n++) {
+        loop.dispatcher().post([&, n]() {
+            order.push_back(n);
+            runner = std::this_thread::get_id();
+        });
+    }
+    loop.stop();
+
+    CHECK_FALSE(loop.running());
+    REQUIRE(order.size() == 1000);
+    for (int n = 0; n < 1000; n++) CHECK(order[n] == n);
+    CHECK(runner.load() != std::this_thread::get_id());
+}
+
+TEST_CASE("eventloopthread-many-producers")
+{
+    EventLoopThread loop;
+    loop.start();
+
+    constexpr int producers = 4;
+    constexpr int perProducer = 2000;
+    int total = 0;
+    std::vector<std::thread> threads;
+    for (int p = 0; p < producers; p++) {
+        threads.emplace_back([&]() {
+            for (int n = 0; n < perProducer; n++) loop.dispatcher().post([&]() { total++; });
+        });
+    }
+    for (auto &thread : threads) thread.join();
+    loop.stop();
+
+    CHECK(total == producers * perProducer);
+}
+
+TEST_CASE("eventloopthread-current-dispatcher")
+{
+    EventLoopThread loop;
+    loop.start();
+
+    std::atomic<EventDispatcher *> seen{nullptr};
+    loop.dispatcher().post([&]() { seen = EventDispatcher::current(); });
+    loop.stop();
+
+    CHECK(seen.load() == &loop.dispatcher());
+    CHECK(EventDispatcher::current() != &loop.dispatcher());
+}
+
+TEST_CASE("eventdispatcher-post-wakes-wait")
+{
+    EventDispatcher dispatcher;
+    bool ran = false;
+
+    std::thread poster([&]() {
+        std::this_thread::sleep_for(20ms);
+        dispatcher.post([&]() { ran = true; });
+    });
+
+    // No timers or files: only the posted task can end this wait
+    while (!ran) dispatcher.processEvents();
+    poster.join();
+
+    CHECK(ran);
+    CHECK_FALSE(dispatcher.pendingEvents());
+}
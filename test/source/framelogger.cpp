@@ -0,0 +1,208 @@
+#include <doctest/doctest.h>
+#include <dplib/net/can/CanCapture.h>
+#include <dplib/net/can/CanFrameLogger.h>
+#include <dplib/net/can/ReplayBackend.h>
+
+#include <cstdio>
+#include <fstream>
+#include <limits>
+#include <string>
+#include <vector>
+
+#include <fmt/format.h>
+#include <unistd.h>
+
+#include "testutil.h"
+
+using datapanel::net::can::CanCaptureReader;
+using datapanel::net::can::CanFrame;
+using datapanel::net::can::CanFrameLogger;
+using datapanel::net::can::ReplayBackend;
+
+static std::string logPath(const char *test)
+{
+    return fmt::format("/tmp/{}-{}.log", test, ::getpid());
+}
+
+static std::vector<CanFrame> sampleFrames()
+{
+    std::vector<CanFrame> frames;
+
+    CanFrame standard(0x123, std::vector<std::byte>{std::byte(0xDE), std::byte(0xAD)});
+    standard.setTimestampNs(1436509052249713000);
+    frames.push_back(standard);
+
+    CanFrame extended(0x18FEF100, std::vector<std::byte>(8, std::byte(0x0F)));
+    extended.setTimestampNs(1436509052250000000);
+    extended.setLocalEcho(true);
+    frames.push_back(extended);
+
+    CanFrame fd(0x7FF, std::vector<std::byte>(12, std::byte(0xA5)));
+    fd.setBitrateSwitch(true);
+    fd.setTimestampNs(1436509052251000000);
+    frames.push_back(fd);
+
+    CanFrame remote(CanFrame::RemoteRequestFrame);
+    remote.setId(0x42);
+    remote.setTimestampNs(1436509052252000000);
+    frames.push_back(remote);
+
+    CanFrame empty(0x700, std::vector<std::byte>{});
+    empty.setTimestampNs(1436509052253000000);
+    frames.push_back(empty);
+    return frames;
+}
+
+TEST_CASE("framelogger-candump")
+{
+    const std::string path = logPath("framelogger-candump");
+    const auto frames = sampleFrames();
+
+    CanFrameLogger logger;
+    REQUIRE(logger.open(path, CanFrameLogger::Candump, "vcan1"));
+    CHECK(logger.log(frames.data(), frames.size()) == frames.size());
+    CHECK(logger.close());
+    CHECK(logger.written() == frames.size());
+    CHECK(logger.dropped() == 0);
+
+    std::ifstream log(path);
+    std::vector<std::string> lines;
+    for (std::string line; std::getline(log, line);) lines.push_back(line);
+    REQUIRE(lines.size() == frames.size());
+    CHECK(lines[0] == "(1436509052.249713) vcan1 123#DEAD");
+    CHECK(lines[1] == "(1436509052.250000) vcan1 18FEF100#0F0F0F0F0F0F0F0F T");
+    CHECK(lines[2] == "(1436509052.251000) vcan1 7FF##1A5A5A5A5A5A5A5A5A5A5A5A5");
+    CHECK(lines[3] == "(1436509052.252000) vcan1 042#R");
+    CHECK(lines[4] == "(1436509052.253000) vcan1 700#");
+
+    // Every line reads back as the frame that was logged
+    for (size_t i = 0; i < frames.size(); i++) {
+        CanFrame parsed;
+        REQUIRE(ReplayBackend::parseCandumpLine(lines[i], parsed));
+        CHECK(parsed.id() == frames[i].id());
+        CHECK(parsed.frameType() == frames[i].frameType());
+        CHECK(parsed.payloadSize() == frames[i].payloadSize());
+        CHECK(parsed.isLocalEcho() == frames[i].isLocalEcho());
+        CHECK(parsed.timestampNs() == frames[i].timestampNs());
+    }
+    std::remove(path.c_str());
+}
+
+TEST_CASE("framelogger-binary")
+{
+    const std::string path = logPath("framelogger-binary");
+    const auto frames = sampleFrames();
+
+    CanFrameLogger logger;
+    CHECK_FALSE(logger.open("-", CanFrameLogger::Binary));
+    REQUIRE(logger.open(path, CanFrameLogger::Binary));
+    for (const CanFrame &frame : frames) CHECK(logger.log(frame));
+    CHECK(logger.close());
+
+    CanCaptureReader reader;
+    REQUIRE(reader.open(path));
+    CanFrame frame;
+    size_t n = 0;
+    while (reader.next(frame)) {
+        REQUIRE(n < frames.size());
+        CHECK(frame.id() == frames[n].id());
+        CHECK(frame.timestampNs() == frames[n].timestampNs());
+        n++;
+    }
+    CHECK(n == frames.size());
+    std::remove(path.c_str());
+}
+
+TEST_CASE("framelogger-drops-instead-of-blocking")
+{
+    const std::string path = logPath("framelogger-drops");
+    std::vector<CanFrame> burst(10000, CanFrame(0x100, std::vector<std::byte>(8)));
+
+    CanFrameLogger logger(64);
+    REQUIRE(logger.open(path));
+    const size_t queued = logger.log(burst.data(), burst.size());
+    CHECK(queued >= 64);
+    CHECK(queued + logger.dropped() == burst.size());
+    CHECK(logger.close());
+    CHECK(logger.written() == queued);
+
+    // Reopening resets the counters
+    REQUIRE(logger.open(path));
+    CHECK(logger.log(burst[0]));
+    CHECK(logger.close());
+    CHECK(logger.written() == 1);
+    CHECK(logger.dropped() == 0);
+    std::remove(path.c_str());
+}
+
+TEST_CASE("framelogger-counts-frames-after-write-error")
+{
+    std::vector<CanFrame> burst(10000, CanFrame(0x100, std::vector<std::byte>(8)));
+
+    // Every write to /dev/full fails with ENOSPC once the text buffer fills
+    CanFrameLogger logger(16384);
+    REQUIRE(logger.open("/dev/full"));
+    logger.log(burst.data(), burst.size());
+    CHECK_FALSE(logger.close());
+    CHECK_FALSE(logger.errorMessage().empty());
+    CHECK(logger.dropped() > 0);
+    CHECK(logger.written() + logger.dropped() == burst.size());
+
+    // No line ever reached the file, so none counts as written
+    CHECK(logger.written() == 0);
+}
+
+TEST_CASE("framelogger-longest-lines")
+{
+    const std::string path = logPath("framelogger-longest");
+    const std::string channel = "vcan0";
+
+    // Ten-digit seconds, a 29-bit identifier, both FD flags, 64 bytes and the echo mark
+    CanFrame longest(0x1FFFFFFF, std::vector<std::byte>(CanFrame::MaxPayloadSize, std::byte(0xFF)));
+    longest.setBitrateSwitch(true);
+    longest.setErrorState(true);
+    longest.setLocalEcho(true);
+    longest.setTimestampNs(std::numeric_limits<int64_t>::max());
+
+    // The classic frames shift a longest line onto the last bytes of the text buffer
+    const size_t lead = 29;
+    std::vector<CanFrame> frames(lead, CanFrame(0x100, std::vector<std::byte>(8)));
+    frames.resize(2000, longest);
+
+    CanFrameLogger logger(frames.size());
+    REQUIRE(logger.open(path, CanFrameLogger::Candump, channel));
+    CHECK(logger.log(frames.data(), frames.size()) == frames.size());
+    CHECK(logger.close());
+    CHECK(logger.written() == frames.size());
+
+    std::ifstream log(path);
+    size_t lines = 0;
+    for (std::string line; std::getline(log, line); lines++) {
+        if (lines < lead)
+            continue;
+        REQUIRE(line.size() == 162 + channel.size());
+        CHECK(line.substr(0, 20) == "(9223372036.854775) ");
+        CHECK(line.substr(line.size() - 2) == " T");
+    }
+    CHECK(lines == frames.size());
+    std::remove(path.c_str());
+}
+
+TEST_CASE("framelogger-attach-leaves-queue")
+{
+    const std::string path = logPath("framelogger-attach");
+    const auto frames = sampleFrames();
+
+    LoopbackInterface bus;
+    REQUIRE(bus.connect());
+    CanFrameLogger logger;
+    REQUIRE(logger.open(path));
+    logger.attach(bus);
+    bus.deliver(std::list<CanFrame>(frames.begin(), frames.end()));
+    CHECK(logger.close());
+
+    // The logger only taps the interface; the frames are still queued for the application
+    CHECK(logger.written() == frames.size());
+    CHECK(bus.countRxPending() == frames.size());
+    std::remove(path.c_str());
+}
@@ -1,6 +1,8 @@
 #include <doctest/doctest.h>
 #include <dplib/util/hexdump.h>
 
+#include <cstring>
+#include <string>
 #include <vector>
 
 using datapanel::util::hexdump;
@@ -36,3 +38,29 @@ TEST_CASE("hexdump-long-sep")
     std::vector<std::byte> data{std::byte(0xAA), std::byte(0xBB), std::byte(0xCC)};
     CHECK(hexdump(data, ")*=*(") == "AA)*=*(BB)*=*(CC");
 }
+
+TEST_CASE("hexdump-buffer")
+{
+    std::vector<std::byte> data;
+    for (int n = 0; n < 256; n++) data.push_back(std::byte(n));
+
+    for (const char *sep : {"", " ", ", "}) {
+        std::string expected = hexdump(data, sep);
+        std::vector<char> out(datapanel::util::hexdumpLength(data.size(), std::strlen(sep)) + 1, '#');
+        char *end = datapanel::util::hexdumpTo(data, out.data(), sep);
+        CHECK(end == out.data() + out.size() - 1);
+        CHECK(std::string(out.data(), end) == expected);
+        CHECK(out.back() == '#');
+    }
+    CHECK(hexdump(data).substr(0, 8) == "00 01 02");
+    CHECK(hexdump(data).substr(765) == "FF");
+}
+
+TEST_CASE("hexdump-buffer-empty")
+{
+    char out[1] = {'#'};
+    CHECK(datapanel::util::hexdumpTo(datapanel::util::ByteView(), out) == out);
+    CHECK(out[0] == '#');
+    CHECK(datapanel::util::hexdumpLength(0, 3) == 0);
+    CHECK(datapanel::util::hexdumpLength(1, 3) == 2);
+}
@@ -0,0 +1,206 @@
+#include <doctest/doctest.h>
+#include <dplib/core/EventDispatcher.h>
+#include <dplib/net/can/VirtualCanBackend.h>
+#include <dplib/net/isotp/IsoTpTransport.h>
+
+#include <chrono>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "testutil.h"
+
+using datapanel::core::EventDispatcher;
+using datapanel::net::can::CanFrame;
+using datapanel::net::can::CanInterface;
+using datapanel::net::can::VirtualCanBackend;
+using datapanel::net::isotp::IsoTpChannelConfig;
+using datapanel::net::isotp::IsoTpTransport;
+using datapanel::util::ByteView;
+
+static std::vector<std::byte> pattern(size_t size)
+{
+    std::vector<std::byte> data(size);
+    for (size_t n = 0; n < size; n++) data[n] = std::byte(uint8_t(n * 7 + n / 256));
+    return data;
+}
+
+/** A tester and an ECU talking over a virtual bus */
+struct Link {
+    EventDispatcher dispatcher;
+    std::unique_ptr<CanInterface> testerBus;
+    std::unique_ptr<CanInterface> ecuBus;
+    IsoTpTransport tester;
+    IsoTpTransport ecu;
+    int testerChannel = -1;
+    int ecuChannel = -1;
+    std::vector<std::vector<std::byte>> received; /**< Messages the ECU received */
+    std::vector<IsoTpTransport::Result> results;  /**< sendFinished results of the tester */
+
+    Link(const std::string &name, IsoTpChannelConfig ecuConfig, size_t frameSize = 8)
+    {
+        testerBus = VirtualCanBackend::init(name);
+        ecuBus = VirtualCanBackend::init(name);
+        for (auto *bus : {testerBus.get(), ecuBus.get()}) {
+            bus->setEventDispatcher(&dispatcher);
+            bus->setConfigOption(CanInterface::CfgOptFD, frameSize > 8);
+            bus->connect();
+        }
+
+        IsoTpChannelConfig testerConfig;
+        testerConfig.txId = ecuConfig.rxId;
+        testerConfig.rxId = ecuConfig.txId;
+        testerConfig.frameSize = frameSize;
+        testerConfig.maxMessageSize = 8192;
+        ecuConfig.frameSize = frameSize;
+        testerChannel = tester.addChannel(testerConfig);
+        ecuChannel = ecu.addChannel(ecuConfig);
+        tester.attach(*testerBus);
+        ecu.attach(*ecuBus);
+
+        ecu.messageReceived.connect(
+            [this](int, ByteView data) { received.emplace_back(data.begin(), data.end()); });
+        tester.sendFinished.connect([this](int, IsoTpTransport::Result result) { results.push_back(result); });
+    }
+
+    ~Link()
+    {
+        tester.detach();
+        ecu.detach();
+        testerBus->disconnect();
+        ecuBus->disconnect();
+    }
+};
+
+static IsoTpChannelConfig ecuConfig(uint8_t blockSize = 0, uint8_t stMin = 0, size_t maxMessageSize = 4095)
+{
+    IsoTpChannelConfig config;
+    config.txId = 0x7E8;
+    config.rxId = 0x7E0;
+    config.blockSize = blockSize;
+    config.stMin = stMin;
+    config.maxMessageSize = maxMessageSize;
+    return config;
+}
+
+TEST_CASE("isotp-channels")
+{
+    IsoTpTransport isotp;
+    CHECK(isotp.addChannel(ecuConfig()) == 0);
+    CHECK(isotp.addChannel(ecuConfig()) == -1);
+
+    IsoTpChannelConfig config = ecuConfig();
+    config.rxId = 0x7E1;
+    config.frameSize = 10;
+    CHECK(isotp.addChannel(config) == -1);
+    config.frameSize = 64;
+    CHECK(isotp.addChannel(config) == 1);
+    config.rxId = 0x18DAF100;
+    CHECK(isotp.addChannel(config) == -1);
+    config.extendedId = true;
+    CHECK(isotp.addChannel(config) == 2);
+    CHECK(isotp.channelCount() == 3);
+
+    CHECK_FALSE(isotp.send(0, pattern(4)));
+    CHECK_FALSE(isotp.send(7, pattern(4)));
+}
+
+TEST_CASE("isotp-single-and-segmented")
+{
+    Link link("vbus-isotp-classic", ecuConfig(8));
+
+    REQUIRE(link.tester.send(link.testerChannel, pattern(5)));
+    REQUIRE(link.results.size() == 1);
+    CHECK(link.results[0] == IsoTpTransport::Ok);
+    REQUIRE(runUntil(link.dispatcher, [&]() { return link.received.size() == 1; }));
+    CHECK(link.received[0] == pattern(5));
+    // The transport only taps the interface; the single frame is still queued
+    CHECK(link.ecuBus->countRxPending() == 1);
+
+    // Largest classic message, with flow control every eight frames
+    REQUIRE(link.tester.send(link.testerChannel, pattern(4095)));
+    CHECK(link.tester.isSending(link.testerChannel));
+    CHECK_FALSE(link.tester.send(link.testerChannel, pattern(100)));
+    REQUIRE(runUntil(link.dispatcher, [&]() { return link.received.size() == 2; }));
+    CHECK(link.received[1] == pattern(4095));
+    CHECK(runUntil(link.dispatcher, [&]() { return link.results.size() == 2; }));
+    CHECK(link.results[1] == IsoTpTransport::Ok);
+    CHECK_FALSE(link.tester.isSending(link.testerChannel));
+
+    // The ECU answers on the same channel
+    std::vector<std::vector<std::byte>> responses;
+    link.tester.messageReceived.connect(
+        [&](int, ByteView data) { responses.emplace_back(data.begin(), data.end()); });
+    REQUIRE(link.ecu.send(link.ecuChannel, pattern(62)));
+    REQUIRE(runUntil(link.dispatcher, [&]() { return responses.size() == 1; }));
+    CHECK(responses[0] == pattern(62));
+}
+
+TEST_CASE("isotp-fd-long-message")
+{
+    Link link("vbus-isotp-fd", ecuConfig(0, 0, 8192), 64);
+
+    REQUIRE(link.tester.send(link.testerChannel, pattern(60)));
+    REQUIRE(runUntil(link.dispatcher, [&]() { return link.received.size() == 1; }));
+    CHECK(link.received[0] == pattern(60));
+
+    // Beyond 4095 bytes the first frame carries a 32-bit length
+    REQUIRE(link.tester.send(link.testerChannel, pattern(6000)));
+    REQUIRE(runUntil(link.dispatcher, [&]() { return link.received.size() == 2; }));
+    CHECK(link.received[1] == pattern(6000));
+}
+
+TEST_CASE("isotp-separation-time")
+{
+    // 1 ms between frames, 4 frames per block: 20 consecutive frames take at least 19 ms
+    Link link("vbus-isotp-stmin", ecuConfig(4, 1));
+    link.dispatcher.setTimerMode(EventDispatcher::TimerMode::Precise);
+
+    const auto start = std::chrono::steady_clock::now();
+    REQUIRE(link.tester.send(link.testerChannel, pattern(146)));
+    REQUIRE(runUntil(link.dispatcher, [&]() { return link.received.size() == 1; }));
+    const auto elapsed = std::chrono::steady_clock::now() - start;
+    CHECK(link.received[0] == pattern(146));
+    CHECK(elapsed >= std::chrono::microseconds(19 * 500));
+    CHECK(elapsed < std::chrono::milliseconds(500));
+}
+
+TEST_CASE("isotp-failures")
+{
+    Link link("vbus-isotp-failures", ecuConfig(0, 0, 100));
+    std::vector<IsoTpTransport::Result> receiveResults;
+    link.ecu.receiveFailed.connect([&](int, IsoTpTransport::Result result) { receiveResults.push_back(result); });
+
+    // Too long for the ECU
+    REQUIRE(link.tester.send(link.testerChannel, pattern(200)));
+    REQUIRE(runUntil(link.dispatcher, [&]() { return link.results.size() == 1; }));
+    CHECK(link.results[0] == IsoTpTransport::Overflow);
+    REQUIRE(receiveResults.size() == 1);
+    CHECK(receiveResults[0] == IsoTpTransport::Overflow);
+
+    // A lost consecutive frame
+    const auto raw = [](std::initializer_list<uint8_t> bytes) {
+        std::vector<std::byte> payload;
+        for (uint8_t b : bytes) payload.push_back(std::byte(b));
+        return CanFrame(0x7E0, payload);
+    };
+    link.ecu.process(raw({0x10, 20, 1, 2, 3, 4, 5, 6}));
+    link.ecu.process(raw({0x22, 7, 8, 9, 10, 11, 12, 13}));
+    REQUIRE(receiveResults.size() == 2);
+    CHECK(receiveResults[1] == IsoTpTransport::WrongSequence);
+
+    // A reception that stalls
+    link.ecu.process(raw({0x10, 20, 1, 2, 3, 4, 5, 6}));
+    link.ecu.expireTimeouts(std::chrono::steady_clock::now() +
+                            std::chrono::milliseconds(IsoTpTransport::TimeoutMs + 100));
+    REQUIRE(receiveResults.size() == 3);
+    CHECK(receiveResults[2] == IsoTpTransport::Timeout);
+
+    // A peer that never sends flow control
+    link.ecu.detach();
+    REQUIRE(link.tester.send(link.testerChannel, pattern(50)));
+    link.tester.expireTimeouts(std::chrono::steady_clock::now() +
+                               std::chrono::milliseconds(IsoTpTransport::TimeoutMs + 100));
+    REQUIRE(link.results.size() == 2);
+    CHECK(link.results[1] == IsoTpTransport::Timeout);
+}
@@ -0,0 +1,273 @@
+#include <doctest/doctest.h>
+#include <dplib/core/EventDispatcher.h>
+#include <dplib/net/can/VirtualCanBackend.h>
+#include <dplib/net/j1939/J1939Transport.h>
+
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+#include "testutil.h"
+
+using datapanel::core::EventDispatcher;
+using datapanel::net::can::CanFrame;
+using datapanel::net::can::VirtualCanBackend;
+using datapanel::net::j1939::GlobalAddress;
+using datapanel::net::j1939::J1939Id;
+using datapanel::net::j1939::J1939Message;
+using datapanel::net::j1939::J1939Transport;
+using datapanel::net::j1939::Pgn;
+
+/** A received message with its data copied out of the transport */
+struct Received {
+    Pgn pgn;
+    uint8_t source;
+    uint8_t destination;
+    std::vector<std::byte> data;
+};
+
+static CanFrame j1939Frame(uint8_t priority, Pgn pgn, uint8_t source, uint8_t destination,
+                           std::vector<uint8_t> bytes)
+{
+    J1939Id id;
+    id.priority = priority;
+    id.pgn = pgn;
+    id.source = source;
+    id.destination = destination;
+    std::vector<std::byte> payload;
+    for (uint8_t b : bytes) payload.push_back(std::byte(b));
+    CanFrame frame(id.encode(), payload);
+    frame.setExtendedId(true);
+    return frame;
+}
+
+static CanFrame connection(uint8_t source, uint8_t destination, std::vector<uint8_t> bytes)
+{
+    return j1939Frame(7, datapanel::net::j1939::PgnTpCm, source, destination, bytes);
+}
+
+static CanFrame announce(uint8_t control, uint8_t source, uint8_t destination, uint16_t size, Pgn pgn,
+                         uint8_t window = 0xFF)
+{
+    return connection(source, destination,
+                      {control, uint8_t(size), uint8_t(size >> 8), uint8_t((size + 6) / 7), window, uint8_t(pgn),
+                       uint8_t(pgn >> 8), uint8_t(pgn >> 16)});
+}
+
+/** TP.DT number @p sequence of a message whose byte n is n + @p seed */
+static CanFrame transfer(uint8_t source, uint8_t destination, uint8_t sequence, uint16_t size, uint8_t seed)
+{
+    std::vector<uint8_t> bytes{sequence};
+    for (int n = 0; n < 7; n++) {
+        const int offset = (sequence - 1) * 7 + n;
+        bytes.push_back(offset < size ? uint8_t(offset + seed) : 0xFF);
+    }
+    return j1939Frame(7, datapanel::net::j1939::PgnTpDt, source, destination, bytes);
+}
+
+static bool expectedData(const Received &message, uint16_t size, uint8_t seed)
+{
+    if (message.data.size() != size)
+        return false;
+    for (size_t n = 0; n < size; n++)
+        if (message.data[n] != std::byte(uint8_t(n + seed)))
+            return false;
+    return true;
+}
+
+static void collect(J1939Transport &j1939, std::vector<Received> &received)
+{
+    j1939.messageReceived.connect([&received](const J1939Message &message) {
+        received.push_back({message.pgn, message.source, message.destination,
+                            std::vector<std::byte>(message.data.begin(), message.data.end())});
+    });
+}
+
+TEST_CASE("j1939-identifier")
+{
+    const J1939Id pdu1 = J1939Id::decode(0x18EFD027);
+    CHECK(pdu1.priority == 6);
+    CHECK(pdu1.pgn == 0xEF00);
+    CHECK(pdu1.destination == 0xD0);
+    CHECK(pdu1.source == 0x27);
+    CHECK(pdu1.encode() == 0x18EFD027);
+
+    const J1939Id pdu2 = J1939Id::decode(0x0CFECA31);
+    CHECK(pdu2.priority == 3);
+    CHECK(pdu2.pgn == 0xFECA);
+    CHECK(pdu2.destination == GlobalAddress);
+    CHECK(pdu2.source == 0x31);
+    CHECK(pdu2.encode() == 0x0CFECA31);
+
+    // Data page bit
+    CHECK(J1939Id::decode(0x19FF0000 | 0x42).pgn == 0x1FF00);
+}
+
+TEST_CASE("j1939-concurrent-broadcasts")
+{
+    J1939Transport j1939;
+    std::vector<Received> received;
+    collect(j1939, received);
+
+    // 60 ECUs broadcasting DM1 at once, packets interleaved
+    constexpr int ecus = 60;
+    const uint16_t size = 40;
+    for (int ecu = 0; ecu < ecus; ecu++) j1939.process(announce(32, uint8_t(ecu), GlobalAddress, size, 0xFECA));
+    CHECK(j1939.activeSessions() == ecus);
+    for (uint8_t sequence = 1; sequence <= 6; sequence++)
+        for (int ecu = 0; ecu < ecus; ecu++)
+            j1939.process(transfer(uint8_t(ecu), GlobalAddress, sequence, size, uint8_t(ecu)));
+
+    REQUIRE(received.size() == ecus);
+    for (int ecu = 0; ecu < ecus; ecu++) {
+        CHECK(received[ecu].pgn == 0xFECA);
+        CHECK(received[ecu].source == ecu);
+        CHECK(received[ecu].destination == GlobalAddress);
+        CHECK(expectedData(received[ecu], size, uint8_t(ecu)));
+    }
+    CHECK(j1939.activeSessions() == 0);
+    CHECK(j1939.statistics().transfers == ecus);
+
+    // Single frames pass straight through
+    j1939.process(j1939Frame(6, 0xFEF1, 0x00, GlobalAddress, {1, 2, 3, 4, 5, 6, 7, 8}));
+    REQUIRE(received.size() == ecus + 1);
+    CHECK(received.back().pgn == 0xFEF1);
+    CHECK(received.back().data.size() == 8);
+}
+
+TEST_CASE("j1939-listen-to-connection")
+{
+    J1939Transport j1939;
+    std::vector<Received> received;
+    collect(j1939, received);
+
+    // 0x10 sends 20 bytes to 0x20, two packets per CTS; packet 2 is repeated after a retransmission request
+    const uint16_t size = 20;
+    j1939.process(announce(16, 0x10, 0x20, size, 0xEF00, 2));
+    j1939.process(connection(0x20, 0x10, {17, 2, 1, 0xFF, 0xFF, 0x00, 0xEF, 0x00}));
+    j1939.process(transfer(0x10, 0x20, 1, size, 3));
+    j1939.process(transfer(0x10, 0x20, 2, size, 3));
+    j1939.process(connection(0x20, 0x10, {17, 1, 2, 0xFF, 0xFF, 0x00, 0xEF, 0x00}));
+    j1939.process(transfer(0x10, 0x20, 2, size, 3));
+    CHECK(received.empty());
+    j1939.process(connection(0x20, 0x10, {17, 1, 3, 0xFF, 0xFF, 0x00, 0xEF, 0x00}));
+    j1939.process(transfer(0x10, 0x20, 3, size, 3));
+
+    REQUIRE(received.size() == 1);
+    CHECK(received[0].pgn == 0xEF00);
+    CHECK(received[0].source == 0x10);
+    CHECK(received[0].destination == 0x20);
+    CHECK(expectedData(received[0], size, 3));
+
+    // An abort from either side ends the session
+    int aborts = 0;
+    j1939.transferAborted.connect([&](uint8_t, uint8_t, Pgn, J1939Transport::AbortReason reason) {
+        CHECK(reason == J1939Transport::PeerAbort);
+        aborts++;
+    });
+    j1939.process(announce(16, 0x10, 0x20, size, 0xEF00));
+    j1939.process(connection(0x20, 0x10, {255, 3, 0xFF, 0xFF, 0xFF, 0x00, 0xEF, 0x00}));
+    CHECK(aborts == 1);
+    CHECK(j1939.activeSessions() == 0);
+}
+
+TEST_CASE("j1939-errors-and-timeouts")
+{
+    J1939Transport j1939(2);
+    std::vector<J1939Transport::AbortReason> reasons;
+    j1939.transferAborted.connect(
+        [&](uint8_t, uint8_t, Pgn, J1939Transport::AbortReason reason) { reasons.push_back(reason); });
+
+    // Only two sessions
+    for (uint8_t source = 1; source <= 3; source++) j1939.process(announce(32, source, GlobalAddress, 30, 0xFECA));
+    CHECK(j1939.activeSessions() == 2);
+    CHECK(j1939.statistics().noSession == 1);
+    j1939.process(transfer(3, GlobalAddress, 1, 30, 0));
+    CHECK(j1939.statistics().strayTransfers == 1);
+
+    // A lost packet abandons the broadcast
+    j1939.process(transfer(1, GlobalAddress, 1, 30, 0));
+    j1939.process(transfer(1, GlobalAddress, 3, 30, 0));
+    REQUIRE(reasons.size() == 1);
+    CHECK(reasons[0] == J1939Transport::BadSequence);
+
+    // The other stalls
+    const auto now = std::chrono::steady_clock::now();
+    j1939.expireSessions(now);
+    CHECK(j1939.activeSessions() == 1);
+    j1939.expireSessions(now + std::chrono::milliseconds(J1939Transport::T1Ms + 100));
+    CHECK(j1939.activeSessions() == 0);
+    REQUIRE(reasons.size() == 2);
+    CHECK(reasons[1] == J1939Transport::Timeout);
+    CHECK(j1939.statistics().timeouts == 1);
+
+    // Sizes that do not need the transport protocol or do not match the packet count
+    j1939.process(announce(32, 1, GlobalAddress, 8, 0xFECA));
+    j1939.process(connection(1, GlobalAddress, {32, 30, 0, 4, 0xFF, 0xCA, 0xFE, 0x00}));
+    CHECK(j1939.activeSessions() == 0);
+}
+
+TEST_CASE("j1939-answer-connection")
+{
+    EventDispatcher dispatcher;
+    auto sender = VirtualCanBackend::init("vbus-j1939");
+    auto receiver = VirtualCanBackend::init("vbus-j1939");
+    for (auto *bus : {sender.get(), receiver.get()}) {
+        bus->setEventDispatcher(&dispatcher);
+        REQUIRE(bus->connect());
+    }
+
+    J1939Transport j1939;
+    j1939.setAddress(0x20);
+    j1939.attach(*receiver);
+    std::vector<Received> received;
+    collect(j1939, received);
+
+    std::vector<CanFrame> replies;
+    sender->framesReceived.connect([&]() {
+        while (sender->countRxPending() > 0) replies.push_back(sender->recv());
+    });
+
+    // 20 bytes in three packets, at most two per CTS
+    const uint16_t size = 20;
+    CHECK(sender->send(announce(16, 0x10, 0x20, size, 0xEF00, 2)));
+    REQUIRE(runUntil(dispatcher, [&]() { return replies.size() == 1; }));
+    // The transport taps the interface; the application still receives the frame
+    CHECK(receiver->countRxPending() == 1);
+    auto payload = replies[0].payload();
+    CHECK(J1939Id::decode(uint32_t(replies[0].id())).pgn == datapanel::net::j1939::PgnTpCm);
+    CHECK(J1939Id::decode(uint32_t(replies[0].id())).destination == 0x10);
+    CHECK(payload[0] == std::byte(17));
+    CHECK(payload[1] == std::byte(2));
+    CHECK(payload[2] == std::byte(1));
+
+    CHECK(sender->send(transfer(0x10, 0x20, 1, size, 9)));
+    CHECK(sender->send(transfer(0x10, 0x20, 2, size, 9)));
+    REQUIRE(runUntil(dispatcher, [&]() { return replies.size() == 2; }));
+    payload = replies[1].payload();
+    CHECK(payload[0] == std::byte(17));
+    CHECK(payload[1] == std::byte(1));
+    CHECK(payload[2] == std::byte(3));
+
+    CHECK(sender->send(transfer(0x10, 0x20, 3, size, 9)));
+    REQUIRE(runUntil(dispatcher, [&]() { return replies.size() == 3; }));
+    payload = replies[2].payload();
+    CHECK(payload[0] == std::byte(19));
+    CHECK(payload[1] == std::byte(size));
+    CHECK(payload[3] == std::byte(3));
+
+    REQUIRE(received.size() == 1);
+    CHECK(expectedData(received[0], size, 9));
+
+    // A sender that goes quiet gets an abort once T2 expires
+    CHECK(sender->send(announce(16, 0x10, 0x20, size, 0xEF00)));
+    REQUIRE(runUntil(dispatcher, [&]() { return replies.size() == 4; }));
+    j1939.expireSessions(std::chrono::steady_clock::now() + std::chrono::milliseconds(J1939Transport::T2Ms + 100));
+    REQUIRE(runUntil(dispatcher, [&]() { return replies.size() == 5; }));
+    payload = replies[4].payload();
+    CHECK(payload[0] == std::byte(255));
+    CHECK(payload[1] == std::byte(J1939Transport::Timeout));
+
+    j1939.detach();
+    for (auto *bus : {sender.get(), receiver.get()}) bus->disconnect();
+}
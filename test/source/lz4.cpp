@@ -0,0 +1,61 @@
+#include <doctest/doctest.h>
+#include <dplib/util/lz4.h>
+
+#include <random>
+#include <vector>
+
+using datapanel::util::lz4Compress;
+using datapanel::util::lz4CompressBound;
+using datapanel::util::lz4Decompress;
+
+static std::vector<std::byte> roundtrip(const std::vector<std::byte> &data, size_t *packedSize = nullptr)
+{
+    std::vector<std::byte> packed(lz4CompressBound(data.size()));
+    const size_t n = lz4Compress(data.data(), data.size(), packed.data(), packed.size());
+    CHECK(n > 0);
+    if (packedSize != nullptr)
+        *packedSize = n;
+
+    std::vector<std::byte> out(data.size());
+    CHECK(lz4Decompress(packed.data(), n, out.data(), out.size()) == data.size());
+    return out;
+}
+
+TEST_CASE("lz4-repetitive")
+{
+    std::vector<std::byte> data;
+    for (int i = 0; i < 10000; i++) data.push_back(std::byte("CAN frame "[i % 10]));
+
+    size_t packed = 0;
+    CHECK(roundtrip(data, &packed) == data);
+    CHECK(packed < data.size() / 20);
+}
+
+TEST_CASE("lz4-random")
+{
+    std::mt19937 random(7);
+    for (size_t size : {0, 1, 12, 13, 100, 65536, 200000}) {
+        std::vector<std::byte> data(size);
+        // Mix incompressible stretches with runs so both paths are covered
+        for (size_t i = 0; i < size; i++) data[i] = std::byte((i / 300) % 2 ? random() & 0xFF : i & 3);
+        CHECK(roundtrip(data) == data);
+    }
+}
+
+TEST_CASE("lz4-malformed")
+{
+    std::vector<std::byte> data(1000, std::byte(0x55));
+    std::vector<std::byte> packed(lz4CompressBound(data.size()));
+    const size_t n = lz4Compress(data.data(), data.size(), packed.data(), packed.size());
+
+    std::vector<std::byte> out(data.size());
+    CHECK(lz4Decompress(packed.data(), n, out.data(), out.size() - 1) == 0);
+    CHECK(lz4Decompress(packed.data(), n - 3, out.data(), out.size()) != data.size());
+
+    // Offset reaching before the start of the output
+    const std::vector<std::byte> bad{std::byte(0x10), std::byte('x'), std::byte(0x05), std::byte(0x00), std::byte(0)};
+    CHECK(lz4Decompress(bad.data(), bad.size(), out.data(), out.size()) == 0);
+
+    // Output buffer too small for compression
+    CHECK(lz4Compress(data.data(), data.size(), packed.data(), 4) == 0);
+}
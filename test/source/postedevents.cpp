@@ -0,0 +1,117 @@
+#include <doctest/doctest.h>
+#include <dplib/core/Application.h>
+#include <dplib/core/Event.h>
+#include <dplib/core/Object.h>
+
+#include <memory>
+#include <thread>
+#include <vector>
+
+using namespace datapanel::core;
+
+namespace
+{
+class UserEvent : public Event
+{
+  public:
+    UserEvent(int value) : Event(static_cast<EventType>(type())), value(value)
+    {
+    }
+
+    static int type()
+    {
+        static const int registered = Event::registerEventType();
+        return registered;
+    }
+
+    int value;
+};
+
+class Recorder : public Object
+{
+  public:
+    bool event(Event *event) override
+    {
+        if (static_cast<int>(event->type()) == UserEvent::type()) {
+            values.push_back(static_cast<UserEvent *>(event)->value);
+            return true;
+        }
+        return Object::event(event);
+    }
+
+    std::vector<int> values;
+    std::vector<int> timers;
+
+  protected:
+    void timerEvent(TimerEvent *event) override
+    {
+        timers.push_back(event->timerId());
+    }
+};
+}  // namespace
+
+TEST_CASE("postedevents-priority-order")
+{
+    Application &app = Application::instance();
+    Recorder recorder;
+
+    app.postEvent(&recorder, std::make_unique<UserEvent>(1), LowEventPriority);
+    app.postEvent(&recorder, std::make_unique<UserEvent>(2));
+    app.postEvent(&recorder, std::make_unique<UserEvent>(3), HighEventPriority);
+    app.postEvent(&recorder, std::make_unique<UserEvent>(4));
+    CHECK(app.postedEventCount() == 4);
+    CHECK(recorder.values.empty());
+
+    app.sendPostedEvents();
+
+    CHECK(recorder.values == std::vector<int>{3, 2, 4, 1});
+    CHECK(app.postedEventCount() == 0);
+}
+
+TEST_CASE("postedevents-coalesce-timer")
+{
+    Application &app = Application::instance();
+    Recorder recorder;
+
+    app.postEvent(&recorder, std::make_unique<TimerEvent>(7));
+    app.postEvent(&recorder, std::make_unique<TimerEvent>(8));
+    app.postEvent(&recorder, std::make_unique<TimerEvent>(7));
+    app.postEvent(&recorder, std::make_unique<UserEvent>(1));
+    app.postEvent(&recorder, std::make_unique<UserEvent>(1));
+    CHECK(app.postedEventCount() == 4);
+
+    app.sendPostedEvents();
+
+    CHECK(recorder.timers == std::vector<int>{7, 8});
+    CHECK(recorder.values == std::vector<int>{1, 1});
+}
+
+TEST_CASE("postedevents-receiver-destroyed")
+{
+    Application &app = Application::instance();
+    auto doomed = std::make_unique<Recorder>();
+    Recorder survivor;
+
+    app.postEvent(doomed.get(), std::make_unique<UserEvent>(1));
+    app.postEvent(&survivor, std::make_unique<UserEvent>(2));
+    doomed.reset();
+    CHECK(app.postedEventCount() == 1);
+
+    app.sendPostedEvents();
+    CHECK(survivor.values == std::vector<int>{2});
+}
+
+TEST_CASE("postedevents-cross-thread")
+{
+    Application &app = Application::instance();
+    Recorder recorder;
+
+    std::thread poster([&]() {
+        for (int n = 0; n < 1000; n++) app.postEvent(&recorder, std::make_unique<UserEvent>(n));
+    });
+    while (recorder.values.size() < 1000) app.processEvents();
+    poster.join();
+
+    REQUIRE(recorder.values.size() == 1000);
+    for (int n = 0; n < 1000; n++) CHECK(recorder.values[n] == n);
+}
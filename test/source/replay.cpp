@@ -0,0 +1,195 @@
+#include <doctest/doctest.h>
+#include <dplib/core/EventDispatcher.h>
+#include <dplib/net/can/CanCapture.h>
+#include <dplib/net/can/ReplayBackend.h>
+
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include <fmt/format.h>
+#include <unistd.h>
+
+#include "testutil.h"
+
+using datapanel::core::EventDispatcher;
+using datapanel::net::can::CanCaptureWriter;
+using datapanel::net::can::CanFilter;
+using datapanel::net::can::CanFrame;
+using datapanel::net::can::CanInterface;
+using datapanel::net::can::ReplayBackend;
+
+static std::string replayPath(const char *test, const char *extension)
+{
+    return fmt::format("/tmp/{}-{}.{}", test, ::getpid(), extension);
+}
+
+static std::unique_ptr<CanInterface> openReplay(EventDispatcher &dispatcher, const std::string &path,
+                                                const std::string &options)
+{
+    auto bus = ReplayBackend::init(path);
+    bus->setEventDispatcher(&dispatcher);
+    bus->setConfigOption(CanInterface::CfgOptOther, options);
+    return bus;
+}
+
+TEST_CASE("replay-candump-parse")
+{
+    CanFrame frame;
+    REQUIRE(ReplayBackend::parseCandumpLine("(1436509052.249713) vcan0 044#2A366C2BBA", frame));
+    CHECK(frame.id() == 0x44);
+    CHECK_FALSE(frame.isExtendedId());
+    CHECK(frame.payloadSize() == 5);
+    CHECK(frame.payload()[4] == std::byte(0xBA));
+    CHECK(frame.timestampNs() == 1436509052249713000);
+
+    REQUIRE(ReplayBackend::parseCandumpLine("(0.5) can0 18FEF100#0102030405060708 T", frame));
+    CHECK(frame.id() == 0x18FEF100);
+    CHECK(frame.isExtendedId());
+    CHECK(frame.isLocalEcho());
+    CHECK(frame.timestampNs() == 500000000);
+
+    REQUIRE(ReplayBackend::parseCandumpLine("(1.000000) can0 123#R3", frame));
+    CHECK(frame.frameType() == CanFrame::RemoteRequestFrame);
+    CHECK(frame.id() == 0x123);
+
+    REQUIRE(ReplayBackend::parseCandumpLine("(1.000000) can0 7FF##1" + std::string(24, 'A') + " R", frame));
+    CHECK(frame.isFD());
+    CHECK(frame.isBitrateSwitch());
+    CHECK(frame.payloadSize() == 12);
+    CHECK_FALSE(frame.isLocalEcho());
+
+    REQUIRE(ReplayBackend::parseCandumpLine("(1.000000) can0 20000080#0000000000000000", frame));
+    CHECK(frame.frameType() == CanFrame::ErrorFrame);
+    CHECK(frame.error() == CanFrame::BusError);
+
+    CHECK_FALSE(ReplayBackend::parseCandumpLine("", frame));
+    CHECK_FALSE(ReplayBackend::parseCandumpLine("(1.0) can0 12#00", frame));
+    CHECK_FALSE(ReplayBackend::parseCandumpLine("(1.0) can0 123#0", frame));
+    CHECK_FALSE(ReplayBackend::parseCandumpLine("(1.0) can0 123#000000000000000000", frame));
+}
+
+TEST_CASE("replay-candump-max-speed")
+{
+    const std::string path = replayPath("replay-candump", "log");
+    {
+        std::ofstream log(path);
+        log << "# recorded on the bench\n";
+        for (int n = 0; n < 20000; n++)
+            log << fmt::format("(100.{:06}) can0 {:03X}#{:02X}\n", n * 10, 0x100 + n % 16, n & 0xFF);
+    }
+
+    EventDispatcher dispatcher;
+    auto bus = openReplay(dispatcher, path, "speed=max");
+    auto *replay = static_cast<ReplayBackend *>(bus.get());
+    std::vector<CanFrame> frames;
+    bus->framesReceived.connect([&]() {
+        while (bus->countRxPending() > 0) frames.push_back(bus->recv());
+    });
+    bool finished = false;
+    replay->replayFinished.connect([&]() { finished = true; });
+
+    REQUIRE(bus->connect());
+    CHECK(runUntil(dispatcher, [&]() { return finished; }));
+    REQUIRE(frames.size() == 20000);
+    CHECK(frames[7].id() == 0x107);
+    CHECK(frames[7].payload()[0] == std::byte(7));
+    CHECK(frames[7].timestampNs() == 100000070000);
+    CHECK(replay->isFinished());
+    CHECK(replay->pacingStatistics().frames == 20000);
+    CHECK(replay->pacingStatistics().loops == 1);
+    CHECK_FALSE(bus->send(frames[0]));
+    CHECK(bus->error() == CanInterface::OperationError);
+
+    bus->disconnect();
+    std::remove(path.c_str());
+}
+
+TEST_CASE("replay-capture-paced")
+{
+    const std::string path = replayPath("replay-paced", "dpcap");
+    {
+        CanCaptureWriter writer;
+        REQUIRE(writer.open(path));
+        for (int n = 0; n < 20; n++) {
+            CanFrame frame(0x200 + n, std::vector<std::byte>(8, std::byte(n)));
+            frame.setTimestampNs(5000000000 + n * 10000000LL);
+            CHECK(writer.write(frame));
+        }
+        CHECK(writer.close());
+    }
+
+    // 190 ms of traffic at ten times the recorded speed
+    EventDispatcher dispatcher;
+    auto bus = openReplay(dispatcher, path, "speed=10");
+    auto *replay = static_cast<ReplayBackend *>(bus.get());
+    std::vector<CanFrame> frames;
+    bus->framesReceived.connect([&]() {
+        while (bus->countRxPending() > 0) frames.push_back(bus->recv());
+    });
+
+    const auto start = std::chrono::steady_clock::now();
+    REQUIRE(bus->connect());
+    CHECK(runUntil(dispatcher, [&]() { return replay->isFinished(); }));
+    const auto elapsed = std::chrono::steady_clock::now() - start;
+
+    REQUIRE(frames.size() == 20);
+    CHECK(frames.back().id() == 0x213);
+    CHECK(frames.back().timestampNs() == 5190000000);
+    CHECK(elapsed >= std::chrono::milliseconds(19));
+    CHECK(elapsed < std::chrono::milliseconds(500));
+
+    const auto stats = replay->pacingStatistics();
+    CHECK(stats.frames == 20);
+    CHECK(stats.maxErrorNs >= stats.meanErrorNs);
+    CHECK(stats.meanErrorNs >= 0);
+
+    bus->disconnect();
+    std::remove(path.c_str());
+}
+
+TEST_CASE("replay-loop-and-filter")
+{
+    const std::string path = replayPath("replay-loop", "log");
+    {
+        std::ofstream log(path);
+        for (int n = 0; n < 10; n++) log << fmt::format("(1.{:06}) can0 {:03X}#00\n", n, 0x100 + n);
+    }
+
+    EventDispatcher dispatcher;
+    auto bus = openReplay(dispatcher, path, "speed=max,loop");
+    auto *replay = static_cast<ReplayBackend *>(bus.get());
+    bus->setRxFilters({CanFilter{0x105, 0x7FF}});
+    std::vector<CanFrame> frames;
+    bus->framesReceived.connect([&]() {
+        while (bus->countRxPending() > 0) frames.push_back(bus->recv());
+    });
+
+    REQUIRE(bus->connect());
+    CHECK(runUntil(dispatcher, [&]() { return frames.size() >= 3; }));
+    for (const CanFrame &frame : frames) CHECK(frame.id() == 0x105);
+    CHECK(replay->pacingStatistics().loops >= 2);
+    CHECK_FALSE(replay->isFinished());
+
+    bus->disconnect();
+    std::remove(path.c_str());
+}
+
+TEST_CASE("replay-bad-configuration")
+{
+    EventDispatcher dispatcher;
+    auto bus = openReplay(dispatcher, "/nonexistent/capture.log", "");
+    CHECK_FALSE(bus->connect());
+    CHECK(bus->error() == CanInterface::ConnectionError);
+
+    const std::string path = replayPath("replay-options", "log");
+    std::ofstream(path) << "(1.0) can0 123#00\n";
+    for (const char *options : {"speed=fast", "speed=-1", "rewind"}) {
+        bus = openReplay(dispatcher, path, options);
+        CHECK_FALSE(bus->connect());
+        CHECK(bus->error() == CanInterface::ConfigurationError);
+    }
+    std::remove(path.c_str());
+}
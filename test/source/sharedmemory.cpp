@@ -0,0 +1,140 @@
+#include <doctest/doctest.h>
+#include <dplib/core/EventDispatcher.h>
+#include <dplib/net/can/SharedMemoryBackend.h>
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include <unistd.h>
+
+#include "testutil.h"
+
+using datapanel::core::EventDispatcher;
+using datapanel::net::can::CanFrame;
+using datapanel::net::can::CanInterface;
+using datapanel::net::can::SharedMemoryBackend;
+using datapanel::net::can::SharedMemoryPublisher;
+
+static std::string channelName(const char *test)
+{
+    return std::string(test) + "-" + std::to_string(::getpid());
+}
+
+static std::vector<CanFrame> makeFrames(size_t count)
+{
+    std::vector<CanFrame> frames;
+    for (size_t n = 0; n < count; n++) {
+        CanFrame frame(0x100 + n, std::vector<std::byte>{std::byte(n & 0xFF)});
+        frames.push_back(frame);
+    }
+    return frames;
+}
+
+TEST_CASE("sharedmemory-publish-receive")
+{
+    const std::string name = channelName("rx");
+    SharedMemoryPublisher publisher(name, 64);
+    REQUIRE(publisher.open());
+
+    EventDispatcher dispatcher;
+    auto first = SharedMemoryBackend::init(name);
+    auto second = SharedMemoryBackend::init(name);
+    first->setEventDispatcher(&dispatcher);
+    second->setEventDispatcher(&dispatcher);
+    REQUIRE(first->connect());
+    REQUIRE(second->connect());
+
+    const auto frames = makeFrames(10);
+    CHECK(publisher.publish(frames.data(), frames.size()) == 10);
+    CHECK(runUntil(dispatcher, [&]() { return first->countRxPending() == 10 && second->countRxPending() == 10; }));
+
+    for (size_t n = 0; n < frames.size(); n++) {
+        const CanFrame frame = first->recv();
+        CHECK(frame.id() == frames[n].id());
+        CHECK(frame.payload()[0] == frames[n].payload()[0]);
+    }
+    CHECK(second->recvAll().size() == 10);
+    CHECK(first->send(frames[0]) == false);
+    CHECK(first->error() == CanInterface::OperationError);
+
+    first->disconnect();
+    second->disconnect();
+}
+
+TEST_CASE("sharedmemory-lossy-overrun")
+{
+    const std::string name = channelName("lossy");
+    SharedMemoryPublisher publisher(name, 16);
+    REQUIRE(publisher.open());
+
+    EventDispatcher dispatcher;
+    auto bus = SharedMemoryBackend::init(name);
+    bus->setEventDispatcher(&dispatcher);
+    REQUIRE(bus->connect());
+
+    // Lossy readers never hold the publisher back
+    const auto frames = makeFrames(100);
+    CHECK(publisher.publish(frames.data(), frames.size()) == 100);
+    CHECK(publisher.dropped() == 0);
+
+    auto *reader = static_cast<SharedMemoryBackend *>(bus.get());
+    CHECK(runUntil(dispatcher, [&]() { return bus->countRxPending() + reader->countLost() == 100; }));
+    CHECK(reader->countLost() > 0);
+
+    // Frames after the gap are the newest ones, in order
+    const auto received = bus->recvAll();
+    REQUIRE(!received.empty());
+    CHECK(received.back().id() == frames.back().id());
+
+    bus->disconnect();
+}
+
+TEST_CASE("sharedmemory-lossless-backpressure")
+{
+    const std::string name = channelName("lossless");
+    SharedMemoryPublisher publisher(name, 16);
+    REQUIRE(publisher.open());
+
+    EventDispatcher dispatcher;
+    auto bus = SharedMemoryBackend::init(name);
+    bus->setEventDispatcher(&dispatcher);
+    bus->setConfigOption(CanInterface::CfgOptOther, std::string(SharedMemoryBackend::LosslessOption));
+    REQUIRE(bus->connect());
+
+    const auto frames = makeFrames(20);
+    CHECK(publisher.publish(frames.data(), frames.size()) == 16);
+    CHECK(publisher.dropped() == 4);
+
+    CHECK(runUntil(dispatcher, [&]() { return bus->countRxPending() == 16; }));
+    CHECK(bus->recvAll().size() == 16);
+
+    // The reader caught up, so the ring has room again
+    CHECK(publisher.publish(frames.data(), 16) == 16);
+    CHECK(runUntil(dispatcher, [&]() { return bus->countRxPending() == 16; }));
+    CHECK(static_cast<SharedMemoryBackend *>(bus.get())->countLost() == 0);
+
+    bus->disconnect();
+}
+
+TEST_CASE("sharedmemory-publisher-close")
+{
+    const std::string name = channelName("close");
+    SharedMemoryPublisher publisher(name, 16);
+    REQUIRE(publisher.open());
+
+    SharedMemoryPublisher duplicate(name, 16);
+    CHECK_FALSE(duplicate.open());
+
+    EventDispatcher dispatcher;
+    auto bus = SharedMemoryBackend::init(name);
+    bus->setEventDispatcher(&dispatcher);
+    REQUIRE(bus->connect());
+
+    publisher.close();
+    CHECK(runUntil(dispatcher, [&]() { return bus->error() == CanInterface::ConnectionError; }));
+    bus->disconnect();
+
+    auto late = SharedMemoryBackend::init(name);
+    CHECK_FALSE(late->connect());
+}
@@ -0,0 +1,130 @@
+#include <doctest/doctest.h>
+#include <dplib/SignalDecoder.h>
+#include <dplib/SignalExtractor.h>
+
+#include <cmath>
+#include <random>
+#include <string>
+#include <vector>
+
+using datapanel::Message;
+using datapanel::Signal;
+using datapanel::SignalDecoder;
+using datapanel::SignalExtractor;
+using datapanel::net::can::CanFrame;
+
+static Signal makeSignal(const std::string &name, unsigned start, unsigned length, Signal::ByteOrder order,
+                         Signal::ValueType type, double scale = 1, double offset = 0)
+{
+    Signal signal;
+    signal.setName(name);
+    signal.setStartBit(start);
+    signal.setLength(length);
+    signal.setByteOrder(order);
+    signal.setValueType(type);
+    signal.setScale(scale);
+    signal.setOffset(offset);
+    return signal;
+}
+
+static bool same(double a, double b)
+{
+    if (a == b)
+        return true;
+    if (std::isnan(a) || std::isnan(b))
+        return std::isnan(a) && std::isnan(b);
+    return std::abs(a - b) <= 1e-12 * std::max(1.0, std::abs(b));
+}
+
+/** A message mixing every kind of signal */
+static Message testMessage()
+{
+    using Order = Signal::ByteOrder;
+    using Type = Signal::ValueType;
+    Message message;
+    message.setId(0x18FF1234);
+    message.setExtendedId(true);
+    message.setName("Mixed");
+    message.setSize(64);
+
+    Signal mux = makeSignal("Mux", 0, 2, Order::LittleEndian, Type::Unsigned);
+    mux.setMultiplexor(true);
+    message.addSignal(mux);
+    message.addSignal(makeSignal("Speed", 8, 16, Order::LittleEndian, Type::Unsigned, 0.125));
+    message.addSignal(makeSignal("Torque", 31, 12, Order::BigEndian, Type::Signed, 0.5, -10));
+    message.addSignal(makeSignal("Tail", 500, 12, Order::LittleEndian, Type::Signed, 2));
+    message.addSignal(makeSignal("MotorolaTail", 465, 40, Order::BigEndian, Type::Unsigned, 1e-3));
+    message.addSignal(makeSignal("Ratio", 64, 32, Order::LittleEndian, Type::Float, 10));
+    message.addSignal(makeSignal("Counter", 100, 60, Order::LittleEndian, Type::Unsigned));
+    Signal a = makeSignal("ModeA", 40, 8, Order::LittleEndian, Type::Signed);
+    a.setMultiplexValue(1);
+    message.addSignal(a);
+    Signal b = makeSignal("ModeB", 47, 8, Order::BigEndian, Type::Unsigned, 0.4);
+    b.setMultiplexValue(2);
+    message.addSignal(b);
+    return message;
+}
+
+TEST_CASE("signal-extract-matches-decoder")
+{
+    const Message message = testMessage();
+    SignalExtractor extractor;
+    REQUIRE(extractor.compile(message));
+    REQUIRE(extractor.signalCount() == message.signals().size());
+    CHECK(std::string(SignalExtractor::implementation()).size() > 0);
+
+    SignalDecoder decoder;
+    REQUIRE(decoder.compile({message}));
+
+    // Mostly full frames, some short ones, and a count that leaves a tail
+    std::mt19937 random(23);
+    std::vector<CanFrame> frames;
+    for (int n = 0; n < 1003; n++) {
+        std::vector<std::byte> payload(random() % 16 == 0 ? 1 + random() % 63 : 64);
+        for (auto &b : payload) b = std::byte(random());
+        CanFrame frame(message.id(), payload);
+        frame.setFD(true);
+        frames.push_back(frame);
+    }
+
+    std::vector<std::vector<double>> columns;
+    std::vector<std::vector<float>> floatColumns;
+    extractor.extract(frames.data(), frames.size(), columns);
+    extractor.extract(frames.data(), frames.size(), floatColumns);
+    REQUIRE(columns.size() == message.signals().size());
+    REQUIRE(floatColumns.size() == message.signals().size());
+
+    std::vector<double> values(decoder.valueCount());
+    int mismatches = 0;
+    for (size_t n = 0; n < frames.size(); n++) {
+        decoder.decode(frames[n], values.data());
+        for (size_t c = 0; c < columns.size(); c++) {
+            mismatches += !same(columns[c][n], values[c]);
+            mismatches += !same(floatColumns[c][n], double(float(values[c])));
+        }
+    }
+    CHECK(mismatches == 0);
+}
+
+TEST_CASE("signal-extract-selection")
+{
+    const Message message = testMessage();
+    SignalExtractor extractor;
+    CHECK_FALSE(extractor.compile(message, {"Speed", "Missing"}));
+    REQUIRE(extractor.compile(message, {"ModeB", "Speed"}));
+    REQUIRE(extractor.signalCount() == 2);
+
+    const uint8_t bytes[8] = {2, 0x10, 0x00, 0, 0, 250, 0, 0};
+    const CanFrame frame(message.id(), datapanel::util::ByteView(reinterpret_cast<const std::byte *>(bytes), 8));
+    const std::vector<CanFrame> frames(9, frame);
+    std::vector<std::vector<double>> columns;
+    extractor.extract(frames.data(), frames.size(), columns);
+    REQUIRE(columns.size() == 2);
+    for (size_t n = 0; n < frames.size(); n++) {
+        CHECK(std::abs(columns[0][n] - 100) < 1e-9);
+        CHECK(columns[1][n] == 2);
+    }
+
+    extractor.extract(frames.data(), 0, columns);
+    CHECK(columns[0].empty());
+}
@@ -0,0 +1,50 @@
+#include <doctest/doctest.h>
+#include <dplib/core/EventDispatcher.h>
+#include <dplib/net/can/SocketCanBackend.h>
+
+#include <memory>
+
+using namespace datapanel;
+using namespace datapanel::net::can;
+
+// These tests need a virtual CAN interface and are skipped without one:
+//   ip link add dev vcan0 type vcan && ip link set up vcan0
+
+TEST_CASE("socketcan-queued-tx")
+{
+    core::EventDispatcher dispatcher;
+    auto tx = SocketCanBackend::init("vcan0");
+    auto rx = SocketCanBackend::init("vcan0");
+    tx->setEventDispatcher(&dispatcher);
+    rx->setEventDispatcher(&dispatcher);
+    tx->setConfigOption(CanInterface::CfgOptQueuedTx, true);
+    tx->setConfigOption(CanInterface::CfgOptTxQueueSize, 4096);
+    if (!tx->connect() || !rx->connect()) {
+        MESSAGE("vcan0 not available, skipping");
+        return;
+    }
+
+    int batches = 0;
+    tx->framesTransmitted.connect([&]() { batches++; });
+
+    constexpr int count = 1000;
+    CanFrame frame;
+    for (int n = 0; n < count; n++) {
+        frame.setId(n & 0x7FF);
+        CHECK(tx->send(frame));
+    }
+    CHECK(tx->countTxPending() == count);
+
+    size_t received = 0;
+    while (received < count) {
+        dispatcher.processEvents();
+        received += rx->recvAll().size();
+    }
+
+    const auto &stats = static_cast<SocketCanBackend *>(tx.get())->ioStatistics();
+    CHECK(stats.txFrames == count);
+    CHECK(stats.txSyscalls < count);
+    CHECK(batches > 0);
+    CHECK(tx->countTxPending() == 0);
+    CHECK(tx->countTxDropped() == 0);
+}
@@ -0,0 +1,156 @@
+#include <doctest/doctest.h>
+#include <dplib/util/SpscRing.h>
+
+#include <atomic>
+#include <cstdint>
+#include <thread>
+
+using datapanel::util::OverflowPolicy;
+using datapanel::util::SpscRing;
+
+TEST_CASE("spscring-push-pop")
+{
+    SpscRing<int> ring(4);
+    CHECK(ring.empty());
+    CHECK(ring.push(1));
+    CHECK(ring.push(2));
+    CHECK(ring.size() == 2);
+
+    int value = 0;
+    CHECK(ring.pop(value));
+    CHECK(value == 1);
+    CHECK(ring.pop(value));
+    CHECK(value == 2);
+    CHECK(ring.pop(value) == false);
+}
+
+TEST_CASE("spscring-capacity-rounded")
+{
+    SpscRing<int> ring(5);
+    CHECK(ring.capacity() == 8);
+}
+
+TEST_CASE("spscring-drop-newest")
+{
+    SpscRing<int> ring(2, OverflowPolicy::DropNewest);
+    CHECK(ring.push(1));
+    CHECK(ring.push(2));
+    CHECK(ring.push(3) == false);
+    CHECK(ring.dropped() == 1);
+
+    int value = 0;
+    CHECK(ring.pop(value));
+    CHECK(value == 1);
+}
+
+TEST_CASE("spscring-drop-oldest")
+{
+    SpscRing<int> ring(2, OverflowPolicy::DropOldest);
+    CHECK(ring.push(1));
+    CHECK(ring.push(2));
+    CHECK(ring.push(3));
+    CHECK(ring.dropped() == 1);
+    CHECK(ring.size() == 2);
+
+    int value = 0;
+    CHECK(ring.pop(value));
+    CHECK(value == 2);
+    CHECK(ring.pop(value));
+    CHECK(value == 3);
+}
+
+TEST_CASE("spscring-clear")
+{
+    SpscRing<int> ring(4);
+    ring.push(1);
+    ring.push(2);
+    ring.clear();
+    CHECK(ring.empty());
+    CHECK(ring.push(3));
+
+    int value = 0;
+    CHECK(ring.pop(value));
+    CHECK(value == 3);
+}
+
+TEST_CASE("spscring-threads-in-order")
+{
+    constexpr uint64_t count = 200000;
+    SpscRing<uint64_t> ring(64, OverflowPolicy::Block);
+
+    std::thread producer([&]() {
+        for (uint64_t n = 0; n < count; n++) ring.push(n);
+    });
+
+    bool ordered = true;
+    uint64_t expected = 0;
+    uint64_t value = 0;
+    while (expected < count) {
+        if (ring.pop(value)) {
+            ordered = ordered && (value == expected);
+            expected++;
+        } else {
+            std::this_thread::yield();
+        }
+    }
+    producer.join();
+
+    CHECK(ordered);
+    CHECK(ring.dropped() == 0);
+}
+
+TEST_CASE("spscring-drop-oldest-threads")
+{
+    // Both halves carry the same value, so an item read while it was being overwritten shows up torn
+    struct Item {
+        uint64_t first;
+        uint64_t second;
+    };
+    constexpr uint64_t count = 200000;
+    SpscRing<Item> ring(8, OverflowPolicy::DropOldest);
+    std::atomic<bool> done{false};
+
+    std::thread producer([&]() {
+        for (uint64_t n = 0; n < count; n++) ring.push(Item{n, n});
+        done = true;
+    });
+
+    bool intact = true;
+    bool ordered = true;
+    uint64_t popped = 0;
+    uint64_t last = 0;
+    Item item{};
+    while (!done || !ring.empty()) {
+        if (!ring.pop(item))
+            continue;
+        intact = intact && (item.first == item.second);
+        ordered = ordered && (popped == 0 || item.first > last);
+        last = item.first;
+        popped++;
+    }
+    producer.join();
+
+    CHECK(intact);
+    CHECK(ordered);
+    CHECK(popped + ring.dropped() == count);
+}
+
+TEST_CASE("spscring-pop-after-head-moves")
+{
+    // Neither clear() nor a DropOldest eviction may let pop() run past the tail
+    SpscRing<int> ring(4, OverflowPolicy::DropOldest);
+    ring.push(1);
+    ring.push(2);
+    ring.clear();
+
+    int value = 0;
+    CHECK_FALSE(ring.pop(value));
+
+    for (int n = 0; n < 7; n++) ring.push(n);
+    CHECK(ring.dropped() == 3);
+    for (int n = 3; n < 7; n++) {
+        CHECK(ring.pop(value));
+        CHECK(value == n);
+    }
+    CHECK_FALSE(ring.pop(value));
+}
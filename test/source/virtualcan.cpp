@@ -0,0 +1,185 @@
+#include <doctest/doctest.h>
+#include <dplib/core/EventDispatcher.h>
+#include <dplib/net/can/BitTiming.h>
+#include <dplib/net/can/VirtualCanBackend.h>
+
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include "testutil.h"
+
+using datapanel::core::EventDispatcher;
+using datapanel::net::can::CanFrame;
+using datapanel::net::can::CanInterface;
+using datapanel::net::can::frameBitCount;
+using datapanel::net::can::VirtualCanBackend;
+using datapanel::net::can::VirtualCanBus;
+
+static CanFrame frame(CanFrame::FrameId id, size_t length = 8)
+{
+    return CanFrame(id, std::vector<std::byte>(length, std::byte(0x5A)));
+}
+
+TEST_CASE("virtualcan-bit-count")
+{
+    CHECK(frameBitCount(frame(0x123)) == 135);
+    CHECK(frameBitCount(frame(0x18EFD027)) == 160);
+    CHECK(frameBitCount(frame(0x123, 0)) == 55);
+}
+
+TEST_CASE("virtualcan-delivery")
+{
+    EventDispatcher dispatcher;
+    auto a = VirtualCanBackend::init("vbus-delivery");
+    auto b = VirtualCanBackend::init("vbus-delivery");
+    auto other = VirtualCanBackend::init("vbus-elsewhere");
+    for (auto *bus : {a.get(), b.get(), other.get()}) {
+        bus->setEventDispatcher(&dispatcher);
+        REQUIRE(bus->connect());
+    }
+
+    CHECK(a->send(frame(0x100)));
+    CHECK(b->send(frame(0x200)));
+    CHECK(runUntil(dispatcher, [&]() { return a->countRxPending() == 1 && b->countRxPending() == 1; }));
+    CHECK(a->recv().id() == 0x200);
+    CHECK(b->recv().id() == 0x100);
+    CHECK(other->countRxPending() == 0);
+
+    // Own frames come back as local echo only when asked for
+    a->setConfigOption(CanInterface::CfgOptRxOwn, true);
+    CHECK(a->send(frame(0x101)));
+    CHECK(runUntil(dispatcher, [&]() { return a->countRxPending() == 1; }));
+    CHECK(a->recv().isLocalEcho());
+
+    // FD frames need CfgOptFD
+    CHECK_FALSE(a->send(frame(0x102, 64)));
+    a->setConfigOption(CanInterface::CfgOptFD, true);
+    CHECK(a->send(frame(0x102, 64)));
+
+    for (auto *bus : {a.get(), b.get(), other.get()}) bus->disconnect();
+}
+
+TEST_CASE("virtualcan-arbitration")
+{
+    EventDispatcher dispatcher;
+    auto low = VirtualCanBackend::init("vbus-arbitration");
+    auto high = VirtualCanBackend::init("vbus-arbitration");
+    auto listener = VirtualCanBackend::init("vbus-arbitration");
+    for (auto *bus : {low.get(), high.get(), listener.get()}) {
+        bus->setEventDispatcher(&dispatcher);
+        REQUIRE(bus->connect());
+    }
+    constexpr int bitrate = 10000;
+    listener->setConfigOption(CanInterface::CfgOptBitrate, bitrate);
+
+    // Queue frames while the first one occupies the bus for 13.5 ms
+    auto *vbus = static_cast<VirtualCanBackend *>(low.get())->bus();
+    CHECK(high->send(frame(0x700)));
+    while (vbus->statistics().bits == 0) std::this_thread::yield();
+    CHECK(low->send(frame(0x300)));
+    CHECK(low->send(frame(0x200)));
+    CHECK(high->send(frame(0x100)));
+    CHECK(runUntil(dispatcher, [&]() { return listener->countRxPending() == 4; }));
+
+    // Arbitration between the queue heads, first in first out within each interface
+    CHECK(listener->recv().id() == 0x700);
+    const CanFrame first = listener->recv();
+    const CanFrame second = listener->recv();
+    const CanFrame third = listener->recv();
+    CHECK(first.id() == 0x100);
+    CHECK(second.id() == 0x300);
+    CHECK(third.id() == 0x200);
+
+    // Back-to-back frames are stamped exactly one frame time apart
+    const int64_t frameNs = int64_t(frameBitCount(second)) * 1000000000 / bitrate;
+    CHECK(second.timestampNs() - first.timestampNs() == frameNs);
+    CHECK(third.timestampNs() - second.timestampNs() == frameNs);
+    CHECK(vbus->statistics().frames == 4);
+
+    for (auto *bus : {low.get(), high.get(), listener.get()}) bus->disconnect();
+}
+
+TEST_CASE("virtualcan-error-injection")
+{
+    EventDispatcher dispatcher;
+    auto sender = VirtualCanBackend::init("vbus-errors");
+    auto listener = VirtualCanBackend::init("vbus-errors");
+    for (auto *bus : {sender.get(), listener.get()}) {
+        bus->setEventDispatcher(&dispatcher);
+        REQUIRE(bus->connect());
+    }
+    listener->setErrorFilter(CanFrame::BusError | CanFrame::BusOffError);
+
+    auto *node = static_cast<VirtualCanBackend *>(sender.get());
+    node->bus()->setErrorRate(1.0);
+    CHECK_FALSE(sender->send(frame(0x123)));
+    CHECK(sender->busStatus() == CanInterface::CanBusState::BusOff);
+    CHECK(node->bus()->statistics().errors == 32);
+
+    // 32 bus errors and the bus-off notice
+    CHECK(runUntil(dispatcher, [&]() { return listener->countRxPending() == 33; }));
+    const auto errors = listener->recvAll();
+    CHECK(errors.front().frameType() == CanFrame::ErrorFrame);
+    CHECK(errors.back().error() == CanFrame::BusOffError);
+
+    node->bus()->setErrorRate(0.0);
+    CHECK_FALSE(sender->send(frame(0x123)));
+    CHECK(sender->restart());
+    CHECK(sender->busStatus() == CanInterface::CanBusState::OK);
+    CHECK(sender->send(frame(0x123)));
+
+    node->bus()->injectError(CanFrame::BusError);
+    CHECK(runUntil(dispatcher, [&]() { return listener->countRxPending() == 2; }));
+
+    for (auto *bus : {sender.get(), listener.get()}) bus->disconnect();
+}
+
+TEST_CASE("virtualcan-transmitted-immediate")
+{
+    EventDispatcher dispatcher;
+    auto sender = VirtualCanBackend::init("vbus-transmitted");
+    auto listener = VirtualCanBackend::init("vbus-transmitted");
+    for (auto *bus : {sender.get(), listener.get()}) {
+        bus->setEventDispatcher(&dispatcher);
+        REQUIRE(bus->connect());
+    }
+
+    int transmitted = 0;
+    sender->framesTransmitted.connect([&]() { transmitted++; });
+    CHECK(sender->send(frame(0x123)));
+    CHECK(runUntil(dispatcher, [&]() { return transmitted == 1; }));
+    CHECK(listener->countRxPending() == 1);
+
+    for (auto *bus : {sender.get(), listener.get()}) bus->disconnect();
+}
+
+TEST_CASE("virtualcan-restart-resumes-queue")
+{
+    EventDispatcher dispatcher;
+    auto sender = VirtualCanBackend::init("vbus-restart");
+    auto listener = VirtualCanBackend::init("vbus-restart");
+    for (auto *bus : {sender.get(), listener.get()}) {
+        bus->setEventDispatcher(&dispatcher);
+        REQUIRE(bus->connect());
+    }
+    listener->setConfigOption(CanInterface::CfgOptBitrate, 10000);
+
+    // Queue two frames behind one on the bus, then corrupt everything after it
+    auto *vbus = static_cast<VirtualCanBackend *>(sender.get())->bus();
+    CHECK(sender->send(frame(0x100)));
+    while (vbus->statistics().bits == 0) std::this_thread::yield();
+    CHECK(sender->send(frame(0x200)));
+    CHECK(sender->send(frame(0x300)));
+    vbus->setErrorRate(1.0);
+
+    // The first queued frame is lost to bus-off; the second stays queued
+    CHECK(runUntil(dispatcher, [&]() { return sender->busStatus() == CanInterface::CanBusState::BusOff; }));
+    vbus->setErrorRate(0.0);
+    CHECK(sender->restart());
+    CHECK(runUntil(dispatcher, [&]() { return listener->countRxPending() == 2; }));
+    CHECK(listener->recv().id() == 0x100);
+    CHECK(listener->recv().id() == 0x300);
+
+    for (auto *bus : {sender.get(), listener.get()}) bus->disconnect();
+}